@@ -0,0 +1,224 @@
+#include "batch_query.hpp"
+
+#include <stdexcept>
+#include <algorithm>
+#include <string>
+
+#define throw_str(str) "batch_query: " str
+
+batch_query::batch_query(ro_string_table& tbl, uint threads, uint grain) :
+	_tbl(&tbl),
+	_job(nullptr),
+	_steals(0),
+	_generation(0),
+	_grain(grain ? grain : 1),
+	_running(0),
+	_quit(false)
+{
+	if (!threads)
+		threads = std::max(std::thread::hardware_concurrency(), 1u);
+
+	_shares.reset(new work_share[threads]);
+	_workers.reserve(threads);
+	for (uint i = 0; i < threads; ++i)
+		_workers.push_back(std::thread(&batch_query::_worker, this, i));
+}
+
+batch_query::~batch_query()
+{
+	{
+		std::lock_guard<std::mutex> lck(_lock);
+		_quit = true;
+	}
+	_start_cv.notify_all();
+
+	for (auto& thr : _workers)
+		thr.join();
+}
+
+void batch_query::run(std::vector<unique_query>& batch)
+{
+	ro_string_table& tbl = *_tbl;
+	job what = [&tbl, &batch](size_t i)
+	{
+		unique_query& query = batch[i];
+		query.buffer.clear();
+		query.found = tbl.lookup_unique(query.source,
+			query.targets,
+			&query.buffer
+		);
+	};
+	_run(batch.size(), what);
+}
+
+void batch_query::run(std::vector<equal_range_query>& batch)
+{
+	ro_string_table& tbl = *_tbl;
+	job what = [&tbl, &batch](size_t i)
+	{
+		equal_range_query& query = batch[i];
+		query.buffer.clear();
+		query.found = tbl.lookup_equal_range(query.source,
+			query.targets,
+			&query.buffer
+		);
+	};
+	_run(batch.size(), what);
+}
+
+void batch_query::_run(size_t size, const job& what)
+{
+	if (!size)
+		return;
+
+	if (size > 0xFFFFFFFF)
+		_throw_batch_too_big(size);
+
+	std::exception_ptr error;
+	{
+		std::unique_lock<std::mutex> lck(_lock);
+
+		uint threads = _workers.size();
+		size_t share = size / threads;
+		size_t extra = size % threads;
+		size_t begin = 0;
+		for (uint i = 0; i < threads; ++i)
+		{
+			size_t end = begin + share + (i < extra);
+			_shares[i].range.store(_pack(begin, end));
+			begin = end;
+		}
+
+		_job = &what;
+		_error = nullptr;
+		_running = threads;
+		++_generation;
+		_start_cv.notify_all();
+
+		_done_cv.wait(lck, [this]() {return (0 == _running);});
+
+		_job = nullptr;
+		error = _error;
+		_error = nullptr;
+	}
+
+	if (error)
+		std::rethrow_exception(error);
+}
+
+void batch_query::_worker(uint id)
+{
+	uint64_t seen = 0;
+	while (true)
+	{
+		const job * what = nullptr;
+		{
+			std::unique_lock<std::mutex> lck(_lock);
+			_start_cv.wait(lck,
+				[this, seen]() {return (_quit || _generation != seen);}
+			);
+
+			if (_quit)
+				return;
+
+			seen = _generation;
+			what = _job;
+		}
+
+		size_t begin = 0, end = 0;
+		while (_take_own(id, begin, end) || _steal(id, begin, end))
+		{
+			for (size_t i = begin; i < end; ++i)
+			{
+				try {(*what)(i);}
+				catch (...)
+				{
+					std::lock_guard<std::mutex> lck(_lock);
+					if (!_error)
+						_error = std::current_exception();
+				}
+			}
+		}
+
+		{
+			std::lock_guard<std::mutex> lck(_lock);
+			if (0 == --_running)
+				_done_cv.notify_one();
+		}
+	}
+}
+
+bool batch_query::_take_own(uint id, size_t& out_begin, size_t& out_end)
+{
+	std::atomic<uint64_t>& mine = _shares[id].range;
+
+	uint64_t old = mine.load();
+	while (true)
+	{
+		size_t begin = _begin_of(old);
+		size_t end = _end_of(old);
+
+		if (begin >= end)
+			return false;
+
+		size_t new_begin = std::min(begin + _grain, end);
+		if (mine.compare_exchange_weak(old, _pack(new_begin, end)))
+		{
+			out_begin = begin;
+			out_end = new_begin;
+			return true;
+		}
+	}
+}
+
+bool batch_query::_steal(uint id, size_t& out_begin, size_t& out_end)
+{
+	uint threads = _workers.size();
+	while (true)
+	{
+		// pick the victim with the most work left
+		uint victim = id;
+		size_t most = 0;
+		uint64_t old = 0;
+		for (uint i = 1; i < threads; ++i)
+		{
+			uint other = (id + i) % threads;
+			uint64_t range = _shares[other].range.load();
+			size_t left = _end_of(range) - _begin_of(range);
+			if (_begin_of(range) < _end_of(range) && left > most)
+			{
+				most = left;
+				victim = other;
+				old = range;
+			}
+		}
+
+		if (!most)
+			return false;
+
+		// leave the front half to the victim, take the back half
+		size_t begin = _begin_of(old);
+		size_t end = _end_of(old);
+		size_t mid = (most > _grain) ? begin + most/2 : begin;
+		if (_shares[victim].range.compare_exchange_weak(old,
+			_pack(begin, mid)
+		))
+		{
+			size_t first_end = std::min(mid + _grain, end);
+			_shares[id].range.store(_pack(first_end, end));
+			out_begin = mid;
+			out_end = first_end;
+			++_steals;
+			return true;
+		}
+	}
+}
+
+void batch_query::_throw_batch_too_big(size_t size)
+{
+	std::string err(throw_str("batch of "));
+	err += std::to_string(size);
+	err += " queries is too big; the maximum is ";
+	err += std::to_string(0xFFFFFFFFu);
+	throw std::runtime_error(err);
+}
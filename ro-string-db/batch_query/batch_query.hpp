@@ -0,0 +1,147 @@
+#ifndef BATCH_QUERY_HPP
+#define BATCH_QUERY_HPP
+
+#include "ro_string_table.hpp"
+
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <string>
+#include <cstdint>
+
+class batch_query
+{
+	/*
+	   A thread pool which executes large batches of lookups over a single
+	   sealed ro_string_table. The batch is split evenly between the worker
+	   threads at the start. Each worker consumes its own share from the front
+	   in chunks of grain queries, and when it runs out, it steals half of
+	   what remains from the back of another worker's share. This keeps all
+	   threads busy even when some queries cost much more than others, e.g.
+	   equal ranges of very different sizes.
+
+	   Lookups on a sealed ro_string_table do not modify it, so it can be
+	   shared between threads without locking. It must not be appended to, or
+	   destroyed, while a batch is running. Note that the single target
+	   convenience lookups in ro_string_db are *not* thread safe.
+	*/
+	public:
+	typedef unsigned int uint;
+	typedef ro_string_table::field_pair field_pair;
+	typedef ro_string_table::eq_range_result eq_range_result;
+	typedef ro_string_table::value_buffer value_buffer;
+
+	struct unique_query {
+		unique_query(const field_pair& source,
+			const std::vector<field_pair>& targets
+		) :
+			source(source),
+			targets(targets),
+			found(false)
+		{}
+
+		field_pair source;
+		std::vector<field_pair> targets;
+		value_buffer buffer;
+		bool found;
+	};
+	/*
+	   A single lookup_unique(). targets is the caller provided slot for the
+	   results, exactly like in_out_targets for lookup_unique(). found is set
+	   to the return value of the lookup. buffer is where a table with
+	   POOL_COMPRESSED decompresses the values of the query, so they are
+	   valid for as long as the query, or until it's run again.
+	*/
+
+	struct equal_range_query {
+		equal_range_query(const field_pair& source,
+			const std::vector<eq_range_result>& targets
+		) :
+			source(source),
+			targets(targets),
+			found(false)
+		{}
+
+		field_pair source;
+		std::vector<eq_range_result> targets;
+		value_buffer buffer;
+		bool found;
+	};
+	/* Same as above, but for lookup_equal_range(). */
+
+	batch_query(ro_string_table& tbl, uint threads = 0, uint grain = 64);
+	/*
+	   Starts the worker threads. If threads is 0, the number of hardware
+	   threads is used. grain is the number of queries a worker takes from its
+	   share at once; smaller means better balance, larger means less
+	   contention.
+	*/
+
+	~batch_query();
+
+	void run(std::vector<unique_query>& batch);
+	void run(std::vector<equal_range_query>& batch);
+	/*
+	   Executes all queries in batch and returns when all of them are done.
+	   The results are placed in each query's targets and found. If any lookup
+	   throws, the rest of the batch is still processed and the first
+	   exception is rethrown after all workers have finished.
+	*/
+
+	inline uint get_num_threads() const
+	{return _workers.size();}
+
+	inline uint64_t get_steals() const
+	{return _steals.load();}
+	/* The number of successful steals since construction. */
+
+	private:
+	batch_query(const batch_query&) = delete;
+	batch_query& operator=(const batch_query&) = delete;
+
+	typedef std::function<void(size_t)> job;
+
+	struct alignas(64) work_share
+	{
+		work_share() : range(0) {}
+		std::atomic<uint64_t> range;
+	};
+	/*
+	   The begin and end of a worker's share packed in a single word, so the
+	   owner and the thieves can both claim from it with a compare and swap.
+	   Aligned so different shares don't live on the same cache line.
+	*/
+
+	void _run(size_t size, const job& what);
+	void _worker(uint id);
+	bool _take_own(uint id, size_t& out_begin, size_t& out_end);
+	bool _steal(uint id, size_t& out_begin, size_t& out_end);
+	void _throw_batch_too_big(size_t size);
+
+	static inline uint64_t _pack(uint64_t begin, uint64_t end)
+	{return ((begin << 32) | end);}
+	static inline size_t _begin_of(uint64_t range)
+	{return (range >> 32);}
+	static inline size_t _end_of(uint64_t range)
+	{return (range & 0xFFFFFFFF);}
+
+	ro_string_table * _tbl;
+	std::vector<std::thread> _workers;
+	std::unique_ptr<work_share[]> _shares;
+	const job * _job;
+	std::exception_ptr _error;
+	std::mutex _lock;
+	std::condition_variable _start_cv;
+	std::condition_variable _done_cv;
+	std::atomic<uint64_t> _steals;
+	uint64_t _generation;
+	uint _grain;
+	uint _running;
+	bool _quit;
+};
+#endif
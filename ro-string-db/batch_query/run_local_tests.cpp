@@ -0,0 +1,7 @@
+#include "test_batch_query.hpp"
+
+int main()
+{
+	run_test_batch_query();
+	return test_batch_query_failed();
+}
@@ -0,0 +1,269 @@
+#include "../test/test.h"
+#include "batch_query.hpp"
+
+#include <vector>
+#include <string>
+#include <stdexcept>
+
+static bool test_batch_query(void);
+
+static ftest tests[] = {
+	test_batch_query,
+};
+
+static bool didnt_throw = false;
+
+static void fill_table(ro_string_table& str_tbl, int lines)
+{
+	for (int i = 1; i < lines; ++i)
+	{
+		str_tbl.append(std::string("id_") + std::to_string(i));
+		str_tbl.append(std::string("fruit_") + std::to_string(i));
+		str_tbl.append(std::string("type_") + std::to_string(i % 7));
+	}
+	str_tbl.seal();
+}
+
+static bool test_batch_query(void)
+{
+	int all_lines = 1001;
+
+	bool is_unique = true;
+	std::vector<ro_string_table::field_info> fields{
+		ro_string_table::field_info("id", is_unique),
+		ro_string_table::field_info("fruit", is_unique),
+		ro_string_table::field_info("type")
+	};
+
+	ro_string_table str_tbl(all_lines, fields);
+	fill_table(str_tbl, all_lines);
+
+	{ // thread count
+		batch_query exec(str_tbl, 3);
+		check(exec.get_num_threads() == 3);
+
+		batch_query exec_hw(str_tbl);
+		check(exec_hw.get_num_threads() >= 1);
+	}
+
+	std::vector<std::string> keys;
+	for (int i = 0; i < 5000; ++i)
+	{
+		// every tenth key is not in the table
+		int id = (i * 7919) % (all_lines + 100);
+		keys.push_back(std::string((i % 10) ? "id_" : "no_") +
+			std::to_string(id)
+		);
+	}
+
+	{ // unique
+		std::vector<ro_string_table::field_pair> targets{
+			ro_string_table::field_pair("fruit"),
+			ro_string_table::field_pair("type")
+		};
+
+		std::vector<batch_query::unique_query> batch;
+		for (auto& key : keys)
+		{
+			batch.push_back(batch_query::unique_query(
+				ro_string_table::field_pair("id", key.c_str()),
+				targets
+			));
+		}
+
+		batch_query exec(str_tbl, 4, 16);
+		exec.run(batch);
+
+		for (auto& query : batch)
+		{
+			std::vector<ro_string_table::field_pair> expected(targets);
+			bool found = str_tbl.lookup_unique(query.source, expected);
+
+			check(query.found == found);
+			if (found)
+			{
+				check(query.targets[0].field_value
+					== expected[0].field_value
+				);
+				check(query.targets[1].field_value
+					== expected[1].field_value
+				);
+			}
+			else
+				check(!query.targets[0].field_value);
+		}
+
+		// the pool can be reused
+		for (auto& query : batch)
+			query.found = false;
+		exec.run(batch);
+		check(batch[1].found);
+		check(std::string(batch[1].targets[0].field_value)
+			== std::string("fruit_") + (keys[1].c_str() + 3)
+		);
+
+		// empty batch
+		std::vector<batch_query::unique_query> empty;
+		exec.run(empty);
+	}
+
+	{ // equal range
+		std::vector<ro_string_table::eq_range_result> targets{
+			ro_string_table::eq_range_result("id")
+		};
+
+		std::vector<std::string> types{
+			"type_0", "type_3", "type_6", "type_7", "type_1"
+		};
+		std::vector<batch_query::equal_range_query> batch;
+		for (int i = 0; i < 200; ++i)
+		{
+			batch.push_back(batch_query::equal_range_query(
+				ro_string_table::field_pair("type",
+					types[i % types.size()].c_str()
+				),
+				targets
+			));
+		}
+
+		batch_query exec(str_tbl, 3, 1);
+		exec.run(batch);
+
+		for (auto& query : batch)
+		{
+			std::vector<ro_string_table::eq_range_result> expected(targets);
+			bool found = str_tbl.lookup_equal_range(query.source, expected);
+
+			check(query.found == found);
+			check(query.targets[0].values == expected[0].values);
+		}
+		check(!batch[3].found);
+		check(batch[0].targets[0].values.size() == 142);
+	}
+
+	{ // exceptions reach the caller
+		std::vector<batch_query::unique_query> batch;
+		for (int i = 0; i < 100; ++i)
+		{
+			batch.push_back(batch_query::unique_query(
+				ro_string_table::field_pair("id", "id_1"),
+				std::vector<ro_string_table::field_pair>{
+					ro_string_table::field_pair((i == 50) ? "banana" : "fruit")
+				}
+			));
+		}
+
+		batch_query exec(str_tbl, 4, 8);
+		try {exec.run(batch); check(didnt_throw);}
+		catch (std::runtime_error& e)
+		{
+			std::string expected("ro_string_table: lookup fail: no such field 'banana'");
+			check(expected == e.what());
+		}
+
+		// everything else still got done
+		check(batch[0].found);
+		check(batch[99].found);
+
+		// and the pool is still usable
+		batch[50].targets[0].field_name = "fruit";
+		exec.run(batch);
+		check(batch[50].found);
+	}
+
+	{ // compressed pool; the values are in the buffers of the queries
+		ro_string_table packed(all_lines,
+			fields,
+			0,
+			ro_string_table::POOL_COMPRESSED
+		);
+		fill_table(packed, all_lines);
+
+		std::vector<batch_query::unique_query> batch;
+		for (auto& key : keys)
+		{
+			batch.push_back(batch_query::unique_query(
+				ro_string_table::field_pair("id", key.c_str()),
+				std::vector<ro_string_table::field_pair>{
+					ro_string_table::field_pair("fruit"),
+					ro_string_table::field_pair("type")
+				}
+			));
+		}
+
+		std::vector<batch_query::equal_range_query> eq_batch;
+		for (int i = 0; i < 50; ++i)
+		{
+			eq_batch.push_back(batch_query::equal_range_query(
+				ro_string_table::field_pair("type", (i % 2) ? "type_2" : "type_5"),
+				std::vector<ro_string_table::eq_range_result>{
+					ro_string_table::eq_range_result("fruit")
+				}
+			));
+		}
+
+		batch_query exec(packed, 4, 16);
+		exec.run(batch);
+		exec.run(eq_batch);
+
+		for (auto& query : batch)
+		{
+			std::vector<ro_string_table::field_pair> expected{
+				ro_string_table::field_pair("fruit"),
+				ro_string_table::field_pair("type")
+			};
+			bool found = str_tbl.lookup_unique(query.source, expected);
+
+			check(query.found == found);
+			if (found)
+			{
+				check(std::string(query.targets[0].field_value)
+					== expected[0].field_value
+				);
+				check(std::string(query.targets[1].field_value)
+					== expected[1].field_value
+				);
+			}
+		}
+
+		for (auto& query : eq_batch)
+		{
+			std::vector<ro_string_table::eq_range_result> expected{
+				ro_string_table::eq_range_result("fruit")
+			};
+			check(str_tbl.lookup_equal_range(query.source, expected));
+			check(query.found);
+
+			auto& vals = query.targets[0].values;
+			check(vals.size() == expected[0].values.size());
+			for (size_t i = 0; i < vals.size(); ++i)
+				check(std::string(vals[i]) == expected[0].values[i]);
+		}
+	}
+
+	return true;
+}
+
+static int passed, failed;
+void run_test_batch_query(void)
+{
+    int i, end = sizeof(tests)/sizeof(*tests);
+
+    passed = 0;
+    for (i = 0; i < end; ++i)
+        if (tests[i]())
+            ++passed;
+
+    if (passed != end)
+        putchar('\n');
+
+    failed = end - passed;
+    report(passed, failed);
+    return;
+}
+
+int test_batch_query_passed(void)
+{return passed;}
+
+int test_batch_query_failed(void)
+{return failed;}
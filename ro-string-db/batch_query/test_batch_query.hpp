@@ -0,0 +1,6 @@
+#ifndef TEST_BATCH_QUERY_HPP
+#define TEST_BATCH_QUERY_HPP
+void run_test_batch_query(void);
+int test_batch_query_passed(void);
+int test_batch_query_failed(void);
+#endif
@@ -0,0 +1,119 @@
+/*
+   Scaling benchmark for batch_query. Builds a table like the one
+   query_driver/generate_csv.txt produces, then runs the same batch of unique
+   and equal range lookups with 1 to all hardware threads.
+
+   Use: bench-batch-query [lines] [queries]
+*/
+
+#include "batch_query.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include <thread>
+#include <algorithm>
+
+typedef unsigned int uint;
+
+static void make_table(ro_string_table& tbl, uint lines)
+{
+	for (uint i = 1, j = 0; i < lines; ++i)
+	{
+		if (i % 2)
+			++j;
+
+		std::string num = std::to_string(i);
+		tbl.append("id_" + num);
+		tbl.append("fruit_" + num);
+		tbl.append("type_" + std::to_string(j));
+		tbl.append("price_" + num);
+	}
+	tbl.seal();
+}
+
+template <typename T>
+static double time_run(batch_query& exec, std::vector<T>& batch)
+{
+	auto start = std::chrono::steady_clock::now();
+	exec.run(batch);
+	auto end = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+int main(int argc, char * argv[])
+{
+	uint lines = (argc > 1) ? atoi(argv[1]) : 1000000;
+	uint queries = (argc > 2) ? atoi(argv[2]) : 1000000;
+
+	std::vector<ro_string_table::field_info> fields{
+		ro_string_table::field_info("id", true),
+		ro_string_table::field_info("fruit", true),
+		ro_string_table::field_info("type"),
+		ro_string_table::field_info("price")
+	};
+
+	ro_string_table tbl(lines, fields);
+	make_table(tbl, lines);
+
+	std::mt19937 rng(42);
+	std::uniform_int_distribution<uint> pick(1, lines-1);
+
+	std::vector<std::string> ids, types;
+	for (uint i = 0; i < queries; ++i)
+	{
+		uint n = pick(rng);
+		ids.push_back("id_" + std::to_string(n));
+		types.push_back("type_" + std::to_string((n+1)/2));
+	}
+
+	std::vector<batch_query::unique_query> unq;
+	std::vector<batch_query::equal_range_query> eqr;
+	for (uint i = 0; i < queries; ++i)
+	{
+		unq.push_back(batch_query::unique_query(
+			ro_string_table::field_pair("id", ids[i].c_str()),
+			std::vector<ro_string_table::field_pair>{
+				ro_string_table::field_pair("fruit"),
+				ro_string_table::field_pair("price")
+			}
+		));
+		eqr.push_back(batch_query::equal_range_query(
+			ro_string_table::field_pair("type", types[i].c_str()),
+			std::vector<ro_string_table::eq_range_result>{
+				ro_string_table::eq_range_result("id")
+			}
+		));
+	}
+
+	uint max_threads = std::max(std::thread::hardware_concurrency(), 1u);
+	printf("lines %u, queries %u, hardware threads %u\n",
+		lines, queries, max_threads);
+	printf("%8s %14s %10s %14s %10s %10s\n", "threads", "unique ms",
+		"speedup", "eq range ms", "speedup", "steals");
+
+	double unq_base = 0, eqr_base = 0;
+	for (uint threads = 1; threads <= max_threads; ++threads)
+	{
+		batch_query exec(tbl, threads);
+
+		double unq_ms = time_run(exec, unq);
+		double eqr_ms = time_run(exec, eqr);
+		if (1 == threads)
+		{
+			unq_base = unq_ms;
+			eqr_base = eqr_ms;
+		}
+
+		printf("%8u %14.2f %10.2f %14.2f %10.2f %10llu\n", threads,
+			unq_ms, unq_base/unq_ms,
+			eqr_ms, eqr_base/eqr_ms,
+			(unsigned long long)exec.get_steals()
+		);
+	}
+
+	return 0;
+}
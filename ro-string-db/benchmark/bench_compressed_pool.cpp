@@ -0,0 +1,281 @@
+/*
+   Compressed pool benchmark. Makes the columns query_driver/generate_csv.txt
+   makes, "id_1", "fruit_1", ..., plus a url and an address of mostly
+   repeated text on each line, and keeps all of them once in a string_pool
+   and once in a compressed_pool trained on a sample. Prints the bytes of
+   each, then times random reads, decompressed into a stack buffer, and
+   binary searches of the strings in sorted order, which compare against
+   the compressed strings one symbol at a time. Then does the same for two
+   tables of those columns, one with POOL_PLAIN and one with
+   POOL_COMPRESSED, and times lookup_unique() of the url and the address by
+   id, which decompresses both, and lookup_equal_range() of the ids of a
+   type.
+
+   Use: bench-compressed-pool [lines] [queries]
+*/
+
+#include "string_pool.hpp"
+#include "compressed_pool.hpp"
+#include "ro_string_table.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+typedef unsigned int uint;
+typedef std::chrono::steady_clock clk;
+
+static double ns_since(clk::time_point start, size_t ops)
+{
+	return std::chrono::duration<double, std::nano>(clk::now() - start)
+		.count() / ops;
+}
+
+static const uint COLS = 5;
+
+static void make_strings(std::vector<std::string>& out, uint lines)
+{
+	const char * streets[] = {"Main", "Oak", "Station", "Church", "Mill"};
+	const char * cities[] = {"Amsterdam", "Berlin", "Copenhagen", "Dublin",
+		"Edinburgh", "Frankfurt"
+	};
+	for (uint i = 1, j = 0; i < lines; ++i)
+	{
+		if (i % 2)
+			++j;
+		
+		std::string num = std::to_string(i);
+		out.push_back("id_" + num);
+		out.push_back("fruit_" + num);
+		out.push_back("type_" + std::to_string(j));
+		out.push_back("https://shop.example.com/products/fruit_" + num +
+			"?utm_source=newsletter&utm_medium=email"
+		);
+		out.push_back(std::to_string(i % 200 + 1) + " " + streets[i % 5] +
+			" Street, " + cities[i % 6]
+		);
+	}
+}
+
+static double time_unique(ro_string_table& tbl,
+	const std::vector<std::string>& strs,
+	const std::vector<size_t>& which,
+	size_t& out_sum
+)
+{
+	typedef ro_string_table::field_pair fp;
+	std::vector<fp> targets{fp("url"), fp("address")};
+	ro_string_table::value_buffer buf;
+	
+	auto start = clk::now();
+	for (size_t i : which)
+	{
+		const std::string& id = strs[i - i % COLS];
+		buf.clear();
+		if (tbl.lookup_unique(fp("id", id.c_str()), targets, &buf))
+			out_sum += strlen(targets[0].field_value) + targets[1].field_value[0];
+	}
+	return ns_since(start, which.size());
+}
+
+static double time_equal_range(ro_string_table& tbl,
+	const std::vector<std::string>& strs,
+	const std::vector<size_t>& which,
+	size_t& out_sum
+)
+{
+	typedef ro_string_table::field_pair fp;
+	std::vector<ro_string_table::eq_range_result> targets{
+		ro_string_table::eq_range_result("id")
+	};
+	ro_string_table::value_buffer buf;
+	
+	auto start = clk::now();
+	for (size_t i : which)
+	{
+		const std::string& type = strs[i - i % COLS + 2];
+		buf.clear();
+		if (tbl.lookup_equal_range(fp("type", type.c_str()), targets, &buf))
+			out_sum += targets[0].values.size() + targets[0].values[0][3];
+	}
+	return ns_since(start, which.size());
+}
+
+static void bench_tables(const std::vector<std::string>& strs,
+	const std::vector<size_t>& which,
+	uint lines
+)
+{
+	std::vector<ro_string_table::field_info> fields{
+		ro_string_table::field_info("id", true),
+		ro_string_table::field_info("fruit", true),
+		ro_string_table::field_info("type"),
+		ro_string_table::field_info("url"),
+		ro_string_table::field_info("address")
+	};
+	
+	ro_string_table plain(lines, fields);
+	ro_string_table packed(lines, fields, 0, ro_string_table::POOL_COMPRESSED);
+	for (auto& str : strs)
+	{
+		plain.append(str);
+		packed.append(str);
+	}
+	auto start = clk::now();
+	plain.seal();
+	double seal_plain = ns_since(start, 1) / 1e6;
+	
+	start = clk::now();
+	packed.seal();
+	double seal_packed = ns_since(start, 1) / 1e6;
+	
+	printf("\ntable pool bytes, POOL_PLAIN %zu, POOL_COMPRESSED %zu, %.2fx "
+		"smaller\n",
+		plain.get_pool_size(), packed.get_pool_size(),
+		(double)plain.get_pool_size() / packed.get_pool_size()
+	);
+	printf("seal() %.1f ms, with compression %.1f ms\n", seal_plain,
+		seal_packed
+	);
+	
+	size_t sum_plain = 0, sum_packed = 0;
+	double unq_plain = time_unique(plain, strs, which, sum_plain);
+	double unq_packed = time_unique(packed, strs, which, sum_packed);
+	bool unq_same = (sum_plain == sum_packed);
+	
+	// a type is on two lines, so the ranges are short
+	sum_plain = sum_packed = 0;
+	double eqr_plain = time_equal_range(plain, strs, which, sum_plain);
+	double eqr_packed = time_equal_range(packed, strs, which, sum_packed);
+	bool eqr_same = (sum_plain == sum_packed);
+	
+	printf("%-12s %12s %16s %9s\n", "table op", "POOL_PLAIN",
+		"POOL_COMPRESSED", "slowdown"
+	);
+	printf("%-12s %12.1f %16.1f %9.2f %s\n", "unique", unq_plain, unq_packed,
+		unq_packed / unq_plain, (unq_same) ? "" : "MISMATCH"
+	);
+	printf("%-12s %12.1f %16.1f %9.2f %s\n", "equal range", eqr_plain,
+		eqr_packed, eqr_packed / eqr_plain, (eqr_same) ? "" : "MISMATCH"
+	);
+}
+
+int main(int argc, char * argv[])
+{
+	uint lines = (argc > 1) ? atoi(argv[1]) : 1000000;
+	uint queries = (argc > 2) ? atoi(argv[2]) : 1000000;
+	
+	std::vector<std::string> strs;
+	make_strings(strs, lines);
+	
+	string_pool plain;
+	std::vector<uint> plain_at;
+	for (auto& str : strs)
+		plain_at.push_back(plain.append(str));
+	
+	auto start = clk::now();
+	std::vector<const char *> sample;
+	for (auto& str : strs)
+		sample.push_back(str.c_str());
+	compressed_pool packed;
+	packed.train(sample.data(), sample.size());
+	double train_ms = ns_since(start, 1) / 1e6;
+	
+	start = clk::now();
+	std::vector<uint> packed_at;
+	for (auto& str : strs)
+		packed_at.push_back(packed.append(str));
+	double append_ns = ns_since(start, strs.size());
+	
+	printf("strings %zu, raw bytes %zu\n", strs.size(), packed.raw_size());
+	printf("string_pool bytes     %12zu\n", plain.size());
+	printf("compressed_pool bytes %12zu, %.2fx smaller, %u symbols\n",
+		packed.size(), (double)plain.size() / packed.size(),
+		packed.num_symbols()
+	);
+	printf("train %.1f ms, append %.1f ns per string\n\n", train_ms, append_ns);
+	
+	std::mt19937 rng(42);
+	std::uniform_int_distribution<size_t> pick(0, strs.size() - 1);
+	std::vector<size_t> which;
+	for (uint i = 0; i < queries; ++i)
+		which.push_back(pick(rng));
+	
+	// reads: copy out every byte of the string
+	char buff[256];
+	size_t sum_plain = 0, sum_packed = 0;
+	start = clk::now();
+	for (size_t i : which)
+	{
+		const char * str = plain.get(plain_at[i]);
+		size_t len = strlen(str);
+		memcpy(buff, str, len);
+		sum_plain += len + buff[0];
+	}
+	double read_plain = ns_since(start, queries);
+	
+	start = clk::now();
+	for (size_t i : which)
+	{
+		size_t len = packed.get(packed_at[i], buff, sizeof(buff));
+		sum_packed += len + buff[0];
+	}
+	double read_packed = ns_since(start, queries);
+	
+	// lookups: binary search of the strings in sorted order
+	std::vector<uint> order(strs.size());
+	for (uint i = 0; i < order.size(); ++i)
+		order[i] = i;
+	std::sort(order.begin(), order.end(),
+		[&strs](uint a, uint b) {return strs[a] < strs[b];}
+	);
+	
+	size_t found_plain = 0, found_packed = 0;
+	start = clk::now();
+	for (size_t i : which)
+	{
+		const char * key = strs[i].c_str();
+		auto it = std::lower_bound(order.begin(), order.end(), key,
+			[&](uint at, const char * val)
+			{return strcmp(plain.get(plain_at[at]), val) < 0;}
+		);
+		found_plain += (it != order.end() &&
+			0 == strcmp(plain.get(plain_at[*it]), key)
+		);
+	}
+	double find_plain = ns_since(start, queries);
+	
+	start = clk::now();
+	for (size_t i : which)
+	{
+		const std::string& key = strs[i];
+		auto it = std::lower_bound(order.begin(), order.end(), key,
+			[&](uint at, const std::string& val)
+			{return packed.compare(packed_at[at], val.data(), val.size()) < 0;}
+		);
+		found_packed += (it != order.end() &&
+			0 == packed.compare(packed_at[*it], key.data(), key.size())
+		);
+	}
+	double find_packed = ns_since(start, queries);
+	
+	printf("queries %u, ns per operation\n", queries);
+	printf("%-8s %12s %16s %9s\n", "op", "string_pool", "compressed_pool",
+		"slowdown"
+	);
+	printf("%-8s %12.1f %16.1f %9.2f %s\n", "read", read_plain, read_packed,
+		read_packed / read_plain, (sum_plain == sum_packed) ? "" : "MISMATCH"
+	);
+	printf("%-8s %12.1f %16.1f %9.2f %s\n", "lookup", find_plain, find_packed,
+		find_packed / find_plain,
+		(found_plain == found_packed) ? "" : "MISMATCH"
+	);
+	
+	bench_tables(strs, which, lines);
+	return 0;
+}
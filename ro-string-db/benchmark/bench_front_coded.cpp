@@ -0,0 +1,138 @@
+/*
+   Front coded index benchmark. Builds a table with each id column twice,
+   once with INDEX_SORTED and once with INDEX_FRONT_CODED, then times the
+   same random exists() and lookup_prefix() on both. It also prints the
+   bytes a value of the front coded field, to compare with the 8 bytes a
+   value of the sorted one. The ids are those of
+   query_driver/generate_csv.txt, "id_1", "id_2", ..., and paths which share
+   a long prefix, "/customers/eu-west/accounts/00000001", ...
+
+   Use: bench-front-coded [lines] [queries]
+*/
+
+#include "ro_string_table.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+
+typedef unsigned int uint;
+
+static std::string path(uint n)
+{
+	char buff[64];
+	snprintf(buff, sizeof(buff), "/customers/eu-west/accounts/%08u", n);
+	return buff;
+}
+
+static void make_table(ro_string_table& tbl, uint lines)
+{
+	for (uint i = 1; i < lines; ++i)
+	{
+		std::string id = "id_" + std::to_string(i);
+		std::string pth = path(i);
+		tbl.append(id);
+		tbl.append(id);
+		tbl.append(pth);
+		tbl.append(pth);
+	}
+	tbl.seal();
+}
+
+static double time_lookups(ro_string_table& tbl,
+	const char * field,
+	const std::vector<std::string>& keys,
+	bool is_prefix,
+	size_t& found
+)
+{
+	found = 0;
+	ro_string_table::eq_range_view view;
+	auto start = std::chrono::steady_clock::now();
+	for (auto& key : keys)
+	{
+		ro_string_table::field_pair pair(field, key.c_str());
+		if (is_prefix)
+		{
+			tbl.lookup_prefix(pair, view);
+			found += view.size();
+		}
+		else
+			found += tbl.exists(pair);
+	}
+	auto end = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::nano>(end - start).count() /
+		keys.size();
+}
+
+static void report(ro_string_table& tbl,
+	uint values,
+	const char * label,
+	const char * sorted,
+	const char * front_coded,
+	const std::vector<std::string>& keys,
+	bool is_prefix
+)
+{
+	size_t found_sorted = 0, found_coded = 0;
+
+	// once to warm up the caches, then for real
+	time_lookups(tbl, sorted, keys, is_prefix, found_sorted);
+	time_lookups(tbl, front_coded, keys, is_prefix, found_coded);
+	double sorted_ns = time_lookups(tbl, sorted, keys, is_prefix, found_sorted);
+	double coded_ns =
+		time_lookups(tbl, front_coded, keys, is_prefix, found_coded);
+
+	ro_string_table::front_coded_stats stats{0, 0};
+	tbl.get_front_coded_stats(front_coded, stats);
+
+	printf("%-14s %10.1f %10.1f %9.2f %10zu %10zu %9.2f %s\n", label,
+		sorted_ns, coded_ns, sorted_ns / coded_ns, stats.blocks, stats.bytes,
+		(double)stats.bytes / values,
+		(found_sorted == found_coded) ? "" : "MISMATCH"
+	);
+}
+
+int main(int argc, char * argv[])
+{
+	uint lines = (argc > 1) ? atoi(argv[1]) : 1000000;
+	uint queries = (argc > 2) ? atoi(argv[2]) : 1000000;
+
+	std::vector<ro_string_table::field_info> fields{
+		ro_string_table::field_info("id", true),
+		ro_string_table::field_info("id_fc", true)
+			.use_index(ro_string_table::INDEX_FRONT_CODED),
+		ro_string_table::field_info("path", true),
+		ro_string_table::field_info("path_fc", true)
+			.use_index(ro_string_table::INDEX_FRONT_CODED)
+	};
+
+	ro_string_table tbl(lines, fields);
+	make_table(tbl, lines);
+
+	std::mt19937 rng(42);
+	std::uniform_int_distribution<uint> pick(1, lines-1);
+
+	std::vector<std::string> ids, paths, misses, prefixes;
+	for (uint i = 0; i < queries; ++i)
+	{
+		uint n = pick(rng);
+		ids.push_back("id_" + std::to_string(n));
+		paths.push_back(path(n));
+		misses.push_back(path(n + lines));
+		prefixes.push_back(paths.back().substr(0, paths.back().size() - 2));
+	}
+
+	printf("lines %u, queries %u, ns per lookup\n", lines, queries);
+	printf("%-14s %10s %10s %9s %10s %10s %9s\n", "keys", "sorted",
+		"coded", "speedup", "blocks", "bytes", "per value");
+	report(tbl, lines - 1, "id", "id", "id_fc", ids, false);
+	report(tbl, lines - 1, "path", "path", "path_fc", paths, false);
+	report(tbl, lines - 1, "path misses", "path", "path_fc", misses, false);
+	report(tbl, lines - 1, "path prefixes", "path", "path_fc", prefixes, true);
+
+	return 0;
+}
@@ -0,0 +1,126 @@
+/*
+   Learned index benchmark. Builds a table like the one
+   query_driver/generate_csv.txt produces, with each id column twice, once
+   with INDEX_SORTED and once with INDEX_LEARNED, then times the same random
+   lookups on both. The ids are those of generate_csv.txt, "id_1", "id_2", ...,
+   and the same numbers zero padded to a fixed width, which spread evenly.
+
+   Use: bench-learned-index [lines] [queries]
+*/
+
+#include "ro_string_table.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+
+typedef unsigned int uint;
+
+static std::string padded(uint n)
+{
+	char buff[16];
+	snprintf(buff, sizeof(buff), "%08u", n);
+	return buff;
+}
+
+static void make_table(ro_string_table& tbl, uint lines)
+{
+	for (uint i = 1, j = 0; i < lines; ++i)
+	{
+		if (i % 2)
+			++j;
+
+		std::string num = std::to_string(i);
+		std::string id = "id_" + num;
+		std::string pad = padded(i);
+		tbl.append(id);
+		tbl.append(id);
+		tbl.append(pad);
+		tbl.append(pad);
+		tbl.append("type_" + std::to_string(j));
+	}
+	tbl.seal();
+}
+
+static double time_lookups(ro_string_table& tbl,
+	const char * field,
+	const std::vector<std::string>& keys,
+	size_t& found
+)
+{
+	found = 0;
+	auto start = std::chrono::steady_clock::now();
+	for (auto& key : keys)
+		found += tbl.exists(ro_string_table::field_pair(field, key.c_str()));
+	auto end = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::nano>(end - start).count() /
+		keys.size();
+}
+
+static void report(ro_string_table& tbl,
+	const char * label,
+	const char * sorted,
+	const char * learned,
+	const std::vector<std::string>& keys
+)
+{
+	size_t found_sorted = 0, found_learned = 0;
+
+	// once to warm up the caches, then for real
+	time_lookups(tbl, sorted, keys, found_sorted);
+	time_lookups(tbl, learned, keys, found_learned);
+	double sorted_ns = time_lookups(tbl, sorted, keys, found_sorted);
+	double learned_ns = time_lookups(tbl, learned, keys, found_learned);
+
+	ro_string_table::learned_stats stats{0, 0, 0};
+	tbl.get_learned_stats(learned, stats);
+
+	printf("%-14s %10.1f %10.1f %9.2f %10zu %10zu %10zu %s\n", label,
+		sorted_ns, learned_ns, sorted_ns / learned_ns,
+		stats.segments, stats.max_error, stats.bytes,
+		(found_sorted == found_learned) ? "" : "MISMATCH"
+	);
+}
+
+int main(int argc, char * argv[])
+{
+	uint lines = (argc > 1) ? atoi(argv[1]) : 1000000;
+	uint queries = (argc > 2) ? atoi(argv[2]) : 1000000;
+
+	std::vector<ro_string_table::field_info> fields{
+		ro_string_table::field_info("id", true),
+		ro_string_table::field_info("id_learned", true)
+			.use_index(ro_string_table::INDEX_LEARNED),
+		ro_string_table::field_info("padded", true),
+		ro_string_table::field_info("padded_learned", true)
+			.use_index(ro_string_table::INDEX_LEARNED),
+		ro_string_table::field_info("type")
+	};
+
+	ro_string_table tbl(lines, fields);
+	make_table(tbl, lines);
+
+	std::mt19937 rng(42);
+	std::uniform_int_distribution<uint> pick(1, lines-1);
+
+	std::vector<std::string> ids, pads, misses;
+	for (uint i = 0; i < queries; ++i)
+	{
+		uint n = pick(rng);
+		ids.push_back("id_" + std::to_string(n));
+		pads.push_back(padded(n));
+		misses.push_back(padded(n + lines));
+	}
+
+	printf("lines %u, queries %u, ns per exists()\n", lines, queries);
+	printf("%-14s %10s %10s %9s %10s %10s %10s\n", "keys", "sorted",
+		"learned", "speedup", "segments", "max error", "bytes");
+	report(tbl, "id", "id", "id_learned", ids);
+	report(tbl, "padded", "padded", "padded_learned", pads);
+	report(tbl, "padded misses", "padded", "padded_learned", misses);
+
+	return 0;
+}
@@ -0,0 +1,37 @@
+#include "bloom_filter.hpp"
+
+#include <cmath>
+
+void bloom_filter::build(const uint64_t * hashes, size_t n, uint bits_per_key)
+{
+	size_t bits = n * (bits_per_key ? bits_per_key : 1);
+	size_t num_blocks = (bits + sizeof(block) * 8 - 1) / (sizeof(block) * 8);
+	if (!num_blocks)
+		num_blocks = 1;
+	
+	_blocks.assign(num_blocks, block());
+	std::vector<uint> loads(num_blocks, 0);
+	for (size_t i = 0; i < n; ++i)
+	{
+		size_t at = _block_of(hashes[i]);
+		block& blk = _blocks[at];
+		uint32_t low = (uint32_t)hashes[i];
+		for (uint w = 0; w < WORDS; ++w)
+			blk.words[w] |= _bit_of(low, w);
+		++loads[at];
+	}
+	_blocks.shrink_to_fit();
+	_keys = n;
+	
+	// a word with l keys has each bit set with 1 - (63/64)^l, and a miss
+	// gets through if its bit is set in all words of its block
+	double sum = 0;
+	for (uint load : loads)
+		sum += pow(1.0 - pow(63.0/64.0, load), WORDS);
+	_fpr = sum / num_blocks;
+}
+
+size_t bloom_filter::memory() const
+{
+	return _blocks.capacity() * sizeof(block);
+}
@@ -0,0 +1,85 @@
+#ifndef BLOOM_FILTER_HPP
+#define BLOOM_FILTER_HPP
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+class bloom_filter
+{
+	/*
+	   A split block Bloom filter of 64 bit hashes. The filter is an array of
+	   64 byte blocks, each the size of a cache line, and each block is eight
+	   64 bit words. A hash picks one block with its high half, then one bit
+	   in each word of the block with its low half, so a key sets and tests
+	   eight bits which are all in one cache line. A miss therefore costs
+	   one memory access, where a binary search costs one for each level.
+	   This gives up a little accuracy for it; with 10 bits per key about 1%
+	   of the misses get through, instead of about 0.8% for a classic filter
+	   with the same size.
+	*/
+	public:
+	typedef unsigned int uint;
+	
+	bloom_filter() : _keys(0), _fpr(0) {}
+	
+	void build(const uint64_t * hashes, size_t n, uint bits_per_key = 10);
+	/*
+	   Replaces the filter with one which holds n hashes, sized to about
+	   bits_per_key bits for each, rounded up to a whole block.
+	*/
+	
+	inline bool may_contain(uint64_t hash) const
+	{
+		if (_blocks.empty())
+			return false;
+		
+		const block& blk = _blocks[_block_of(hash)];
+		uint32_t low = (uint32_t)hash;
+		for (uint i = 0; i < WORDS; ++i)
+		{
+			if (!(blk.words[i] & _bit_of(low, i)))
+				return false;
+		}
+		return true;
+	}
+	/* False means the hash is certainly not in the filter. */
+	
+	inline size_t keys() const
+	{return _keys;}
+	
+	inline double false_positive_rate() const
+	{return _fpr;}
+	/*
+	   The expected fraction of hashes not in the filter for which
+	   may_contain() is true anyway, computed upon build() from the number
+	   of keys in each block.
+	*/
+	
+	size_t memory() const;
+	
+	private:
+	static const uint WORDS = 8;
+	
+	struct alignas(64) block {
+		uint64_t words[WORDS];
+	};
+	
+	inline size_t _block_of(uint64_t hash) const
+	{return (size_t)(((hash >> 32) * (uint64_t)_blocks.size()) >> 32);}
+	
+	static inline uint64_t _bit_of(uint32_t low, uint word)
+	{
+		// an odd constant per word spreads the six high bits of the product
+		static const uint32_t salt[WORDS] = {
+			0x47B6137Bu, 0x44974D91u, 0x8824AD5Bu, 0xA2B7289Du,
+			0x705495C7u, 0x2DF1424Bu, 0x9EFC4947u, 0x5C6BFB31u
+		};
+		return (uint64_t)1 << ((low * salt[word]) >> 26);
+	}
+	
+	std::vector<block> _blocks;
+	size_t _keys;
+	double _fpr;
+};
+#endif
@@ -0,0 +1,7 @@
+#include "test_bloom_filter.hpp"
+
+int main()
+{
+	run_test_bloom_filter();
+	return test_bloom_filter_failed();
+}
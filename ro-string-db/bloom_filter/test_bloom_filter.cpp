@@ -0,0 +1,92 @@
+#include "../test/test.h"
+#include "bloom_filter.hpp"
+
+#include <vector>
+#include <random>
+#include <cstdint>
+
+static bool test_bloom_filter();
+
+static ftest tests[] = {
+	test_bloom_filter,
+};
+
+static bool test_bloom_filter()
+{
+	{ // empty
+		bloom_filter bf;
+		check(!bf.may_contain(0));
+		check(!bf.may_contain(12345));
+		check(bf.memory() == 0);
+		
+		bf.build(nullptr, 0);
+		check(bf.keys() == 0);
+		check(bf.false_positive_rate() == 0);
+		check(!bf.may_contain(12345));
+	}
+	
+	std::mt19937_64 rng(9);
+	std::vector<uint64_t> in, out;
+	for (int i = 0; i < 100000; ++i)
+	{
+		in.push_back(rng());
+		out.push_back(rng());
+	}
+	
+	for (uint bits : {4, 10, 16})
+	{
+		bloom_filter bf;
+		bf.build(in.data(), in.size(), bits);
+		check(bf.keys() == in.size());
+		check(bf.memory() >= in.size() * bits / 8);
+		check(bf.memory() < in.size() * bits / 8 + 64);
+		
+		// no false negatives
+		bool all_in = true;
+		for (auto h : in)
+			all_in = all_in && bf.may_contain(h);
+		check(all_in);
+		
+		// the measured rate is close to the expected one
+		size_t passed = 0;
+		for (auto h : out)
+			passed += bf.may_contain(h);
+		double measured = (double)passed / out.size();
+		double expected = bf.false_positive_rate();
+		check(expected > 0 && expected < 0.5);
+		check(measured < expected * 1.25 + 0.001);
+		check(measured > expected * 0.75 - 0.001);
+	}
+	
+	{ // the usual setting
+		bloom_filter bf;
+		bf.build(in.data(), in.size());
+		check(bf.false_positive_rate() < 0.015);
+	}
+	
+	return true;
+}
+
+static int passed, failed;
+void run_test_bloom_filter(void)
+{
+    int i, end = sizeof(tests)/sizeof(*tests);
+
+    passed = 0;
+    for (i = 0; i < end; ++i)
+        if (tests[i]())
+            ++passed;
+
+    if (passed != end)
+        putchar('\n');
+
+    failed = end - passed;
+    report(passed, failed);
+    return;
+}
+
+int test_bloom_filter_passed(void)
+{return passed;}
+
+int test_bloom_filter_failed(void)
+{return failed;}
@@ -0,0 +1,6 @@
+#ifndef TEST_BLOOM_FILTER_HPP
+#define TEST_BLOOM_FILTER_HPP
+void run_test_bloom_filter(void);
+int test_bloom_filter_passed(void);
+int test_bloom_filter_failed(void);
+#endif
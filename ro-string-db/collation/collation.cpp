@@ -0,0 +1,234 @@
+#include "collation.hpp"
+
+#include <cstring>
+
+namespace
+{
+	typedef collation::uint uint;
+	typedef unsigned char byte;
+	
+	// invalid UTF-8 bytes order after all code points
+	const uint BAD_BYTE = 0x110000;
+	
+	inline bool is_space(byte ch)
+	{
+		return (' ' == ch || ('\t' <= ch && ch <= '\r'));
+	}
+	
+	inline uint fold_ascii(uint ch)
+	{
+		return ('A' <= ch && ch <= 'Z') ? ch + ('a' - 'A') : ch;
+	}
+	
+	uint decode_utf8(const byte *& str)
+	{
+		// returns the next code point and moves str past it
+		uint ch = *str;
+		uint len = 0, min = 0;
+		
+		if (ch < 0x80)
+		{
+			++str;
+			return ch;
+		}
+		else if (0xC0 == (ch & 0xE0))
+		{
+			len = 1;
+			min = 0x80;
+			ch &= 0x1F;
+		}
+		else if (0xE0 == (ch & 0xF0))
+		{
+			len = 2;
+			min = 0x800;
+			ch &= 0x0F;
+		}
+		else if (0xF0 == (ch & 0xF8))
+		{
+			len = 3;
+			min = 0x10000;
+			ch &= 0x07;
+		}
+		else
+			return BAD_BYTE + *str++;
+		
+		for (uint i = 1; i <= len; ++i)
+		{
+			if (0x80 != (str[i] & 0xC0))
+				return BAD_BYTE + *str++;
+			ch = (ch << 6) | (str[i] & 0x3F);
+		}
+		
+		if (ch < min || ch > 0x10FFFF || (0xD800 <= ch && ch <= 0xDFFF))
+			return BAD_BYTE + *str++;
+		
+		str += len + 1;
+		return ch;
+	}
+	
+	class normal_reader
+	{
+		public:
+		normal_reader(const char * str, int how) :
+			_str(reinterpret_cast<const byte *>(str)), _how(how)
+		{
+			if (_how & collation::TRIM)
+			{
+				while (is_space(*_str))
+					++_str;
+			}
+		}
+		
+		inline uint next()
+		{
+			// returns the next normalized character, 0 at the end
+			if ((_how & collation::TRIM) && is_space(*_str))
+			{
+				// trailing spaces are the end, inner spaces are kept
+				const byte * end = _str;
+				while (is_space(*end))
+					++end;
+				if (!*end)
+					return 0;
+			}
+			
+			if (!*_str)
+				return 0;
+			
+			if (_how & collation::FOLD_UTF8)
+				return collation::fold_utf8(decode_utf8(_str));
+			
+			uint ch = *_str++;
+			return (_how & collation::FOLD_ASCII) ? fold_ascii(ch) : ch;
+		}
+		
+		private:
+		const byte * _str;
+		int _how;
+	};
+}
+
+int collation::compare(const char * a, const char * b, int how)
+{
+	if (!how)
+		return strcmp(a, b);
+	
+	normal_reader ra(a, how), rb(b, how);
+	while (true)
+	{
+		uint cha = ra.next();
+		uint chb = rb.next();
+		
+		if (cha != chb)
+			return (cha < chb) ? -1 : 1;
+		
+		if (!cha)
+			return 0;
+	}
+}
+
+int collation::compare_prefix(const char * str, const char * prefix, int how)
+{
+	if (!how)
+		return strncmp(str, prefix, strlen(prefix));
+	
+	normal_reader rs(str, how), rp(prefix, how);
+	while (true)
+	{
+		uint chp = rp.next();
+		if (!chp)
+			return 0;
+		
+		uint chs = rs.next();
+		if (chs != chp)
+			return (chs < chp) ? -1 : 1;
+	}
+}
+
+uint64_t collation::hash(const char * str, int how)
+{
+	// FNV-1a over the normalized characters, then the splitmix64 finalizer,
+	// so all bits of the result depend on all of the input
+	uint64_t h = 0xCBF29CE484222325ull;
+	normal_reader rd(str, how);
+	for (uint ch = rd.next(); ch; ch = rd.next())
+	{
+		h ^= ch;
+		h *= 0x100000001B3ull;
+	}
+	
+	h ^= h >> 30;
+	h *= 0xBF58476D1CE4E5B9ull;
+	h ^= h >> 27;
+	h *= 0x94D049BB133111EBull;
+	h ^= h >> 31;
+	return h;
+}
+
+collation::uint collation::fold_utf8(uint ch)
+{
+	if (ch < 0x80)
+		return fold_ascii(ch);
+	
+	if (ch < 0x100)
+	{
+		// Latin-1; U+00D7 is the multiplication sign
+		if (0xB5 == ch)
+			return 0x3BC;
+		if (0xC0 <= ch && ch <= 0xDE && ch != 0xD7)
+			return ch + 0x20;
+		return ch;
+	}
+	
+	if (ch < 0x180)
+	{
+		// Latin Extended-A; mostly upper/lower pairs with the upper even
+		if (0x130 == ch || 0x131 == ch || 0x138 == ch || 0x149 == ch)
+			return ch;
+		if (0x178 == ch)
+			return 0xFF;
+		if (0x17F == ch)
+			return 's';
+		if ((0x139 <= ch && ch <= 0x148) || (0x179 <= ch && ch <= 0x17E))
+			return (ch & 1) ? ch + 1 : ch;
+		return (ch & 1) ? ch : ch + 1;
+	}
+	
+	if (0x370 <= ch && ch < 0x400)
+	{
+		// Greek
+		if (0x386 == ch)
+			return 0x3AC;
+		if (0x388 <= ch && ch <= 0x38A)
+			return ch + 0x25;
+		if (0x38C == ch)
+			return 0x3CC;
+		if (0x38E == ch || 0x38F == ch)
+			return ch + 0x3F;
+		if (0x391 <= ch && ch <= 0x3AB && ch != 0x3A2)
+			return ch + 0x20;
+		if (0x3C2 == ch)
+			return 0x3C3;
+		return ch;
+	}
+	
+	if (0x400 <= ch && ch < 0x530)
+	{
+		// Cyrillic
+		if (ch < 0x410)
+			return ch + 0x50;
+		if (ch < 0x430)
+			return ch + 0x20;
+		if ((0x460 <= ch && ch <= 0x481) || (0x48A <= ch && ch <= 0x4BF))
+			return (ch & 1) ? ch : ch + 1;
+		if (0x4C0 == ch)
+			return 0x4CF;
+		if (0x4C1 <= ch && ch <= 0x4CE)
+			return (ch & 1) ? ch + 1 : ch;
+		if (0x4D0 <= ch && ch <= 0x52F)
+			return (ch & 1) ? ch : ch + 1;
+		return ch;
+	}
+	
+	return ch;
+}
@@ -0,0 +1,67 @@
+#ifndef COLLATION_HPP
+#define COLLATION_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+namespace collation
+{
+	typedef unsigned int uint;
+	
+	enum flags {
+		NONE = 0,
+		FOLD_ASCII = 1,
+		TRIM = 2,
+		FOLD_UTF8 = 4
+	};
+	/*
+	   FOLD_ASCII makes 'A' - 'Z' equal to 'a' - 'z'. TRIM ignores leading and
+	   trailing ' ', '\t', '\n', '\v', '\f', and '\r'. FOLD_UTF8 decodes the
+	   strings as UTF-8 and applies simple, one to one, case folding for Latin-1,
+	   Latin Extended-A, Greek, and Cyrillic, which includes FOLD_ASCII. Bytes
+	   which are not valid UTF-8 compare as themselves, after all code points.
+	*/
+	
+	int compare(const char * a, const char * b, int how);
+	/*
+	   Like strcmp(), but as if a and b were normalized by how first. Nothing
+	   is copied; the strings are normalized one character at a time while they
+	   are compared. With NONE this is strcmp().
+	*/
+	
+	inline int compare_bytes(const char * a, size_t alen,
+		const char * b, size_t blen
+	)
+	{
+		if (alen && blen && *a != *b)
+			return (unsigned char)*a - (unsigned char)*b;
+		
+		int cmp = memcmp(a, b, (alen < blen) ? alen : blen);
+		if (cmp)
+			return cmp;
+		return (alen < blen) ? -1 : (alen > blen);
+	}
+	/*
+	   Like compare() with NONE, but for strings of alen and blen bytes, which
+	   may hold '\0'. The first bytes are checked before the call to memcmp(),
+	   since most strings which differ, differ there. A string which is a
+	   prefix of the other is the smaller.
+	*/
+	
+	int compare_prefix(const char * str, const char * prefix, int how);
+	/*
+	   Like compare(), but returns 0 when the normalized str begins with the
+	   normalized prefix.
+	*/
+	
+	uint fold_utf8(uint code_point);
+	/* Returns the simple case folding of code_point. */
+	
+	uint64_t hash(const char * str, int how);
+	/*
+	   A 64 bit hash of str as normalized by how, so strings which compare
+	   equal hash equal. Nothing is copied.
+	*/
+}
+#endif
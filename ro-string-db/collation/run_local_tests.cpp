@@ -0,0 +1,7 @@
+#include "test_collation.hpp"
+
+int main()
+{
+	run_test_collation();
+	return test_collation_failed();
+}
@@ -0,0 +1,237 @@
+#include "../test/test.h"
+#include "collation.hpp"
+
+#include <string>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+
+static bool test_compare();
+static bool test_compare_prefix();
+static bool test_compare_bytes();
+static bool test_fold_utf8();
+static bool test_hash();
+
+static ftest tests[] = {
+	test_compare,
+	test_compare_prefix,
+	test_compare_bytes,
+	test_fold_utf8,
+	test_hash,
+};
+
+static int sign(int n)
+{
+	return (n > 0) - (n < 0);
+}
+
+static bool test_compare()
+{
+	using namespace collation;
+	
+	{ // NONE is strcmp
+		check(0 == compare("abc", "abc", NONE));
+		check(compare("abc", "abd", NONE) < 0);
+		check(compare("Abc", "abc", NONE) < 0);
+		check(compare(" abc", "abc", NONE) < 0);
+	}
+	
+	{ // ascii fold
+		check(0 == compare("Vendor", "vENDOR", FOLD_ASCII));
+		check(compare("apple", "Banana", FOLD_ASCII) < 0);
+		check(compare("Apple", "apples", FOLD_ASCII) < 0);
+		check(compare("ab", "a", FOLD_ASCII) > 0);
+		check(compare(" abc", "abc", FOLD_ASCII) < 0);
+		check(compare("\xC3\x89", "\xC3\xA9", FOLD_ASCII) != 0);
+	}
+	
+	{ // trim
+		check(0 == compare("  acme inc\t", "acme inc", TRIM));
+		check(0 == compare("acme inc", " \r\nacme inc  \n", TRIM));
+		check(compare("acme  inc", "acme inc", TRIM) != 0);
+		check(compare("ACME", "acme", TRIM) != 0);
+		check(0 == compare("   ", "", TRIM));
+		check(compare("a ", "a b", TRIM) < 0);
+		check(compare("a b", "a", TRIM) > 0);
+		check(0 == compare(" ACME ", "acme", TRIM | FOLD_ASCII));
+	}
+	
+	{ // utf8 fold
+		// "Élan" and "élan"
+		check(0 == compare("\xC3\x89lan", "\xC3\xA9lan", FOLD_UTF8));
+		// Greek "ΣΟΦΙΑ" and "σοφια"
+		check(0 == compare("\xCE\xA3\xCE\x9F\xCE\xA6\xCE\x99\xCE\x91",
+			"\xCF\x83\xCE\xBF\xCF\x86\xCE\xB9\xCE\xB1", FOLD_UTF8
+		));
+		// Cyrillic "МОСКВА" and "москва"
+		check(0 == compare("\xD0\x9C\xD0\x9E\xD0\xA1\xD0\x9A\xD0\x92\xD0\x90",
+			"\xD0\xBC\xD0\xBE\xD1\x81\xD0\xBA\xD0\xB2\xD0\xB0", FOLD_UTF8
+		));
+		// "Łódź" and "ŁÓDŹ"
+		check(0 == compare("\xC5\x81\xC3\xB3\x64\xC5\xBA",
+			"\xC5\x81\xC3\x93\x44\xC5\xB9", FOLD_UTF8
+		));
+		check(0 == compare("ABC", "abc", FOLD_UTF8));
+		check(compare("\xC3\xA9", "f", FOLD_UTF8) > 0);
+		
+		// invalid bytes are compared as they are
+		check(0 == compare("a\xFF", "A\xFF", FOLD_UTF8));
+		check(compare("a\xFF", "a\xFE", FOLD_UTF8) > 0);
+		check(compare("a\xC3", "a\xC3\xA9", FOLD_UTF8) > 0);
+		check(compare("\xF4\x90\x80\x80", "\xF4\x8F\xBF\xBF", FOLD_UTF8) > 0);
+	}
+	
+	{ // sorting with compare is consistent
+		std::vector<std::string> words{
+			"b", " A", "a", "B ", "\xC3\x89", "\xC3\xA9", "c", "ab", "Ab", ""
+		};
+		int how = FOLD_UTF8 | TRIM;
+		std::sort(words.begin(), words.end(),
+			[how](const std::string& a, const std::string& b)
+			{return compare(a.c_str(), b.c_str(), how) < 0;}
+		);
+		for (size_t i = 1; i < words.size(); ++i)
+		{
+			check(compare(words[i-1].c_str(), words[i].c_str(), how) <= 0);
+			check(sign(compare(words[i].c_str(), words[i-1].c_str(), how))
+				== -sign(compare(words[i-1].c_str(), words[i].c_str(), how))
+			);
+		}
+		check(words[0] == "");
+		check(words.back() == "\xC3\x89" || words.back() == "\xC3\xA9");
+	}
+	
+	return true;
+}
+
+static bool test_compare_prefix()
+{
+	using namespace collation;
+	
+	check(0 == compare_prefix("apple", "app", NONE));
+	check(compare_prefix("Apple", "app", NONE) < 0);
+	check(0 == compare_prefix("Apple", "app", FOLD_ASCII));
+	check(0 == compare_prefix("  Apple", "APP", FOLD_ASCII | TRIM));
+	check(0 == compare_prefix("apple", "", FOLD_ASCII));
+	check(compare_prefix("ap", "app", FOLD_ASCII) < 0);
+	check(compare_prefix("b", "app", FOLD_ASCII) > 0);
+	check(0 == compare_prefix("\xC3\x89lan vital", "\xC3\xA9LAN", FOLD_UTF8));
+	check(0 == compare_prefix("acme inc", "acme ", TRIM));
+	
+	return true;
+}
+
+static bool test_compare_bytes()
+{
+	using namespace collation;
+	
+	check(0 == compare_bytes("abc", 3, "abc", 3));
+	check(compare_bytes("abc", 3, "abd", 3) < 0);
+	check(compare_bytes("b", 1, "abc", 3) > 0);
+	check(compare_bytes("ab", 2, "abc", 3) < 0);
+	check(compare_bytes("abc", 3, "ab", 2) > 0);
+	check(0 == compare_bytes("", 0, "", 0));
+	check(compare_bytes("", 0, "a", 1) < 0);
+	check(compare_bytes("\xFF", 1, "a", 1) > 0);
+	
+	// '\0' is a byte like any other
+	check(compare_bytes("a\0b", 3, "a\0c", 3) < 0);
+	check(compare_bytes("a\0", 2, "a", 1) > 0);
+	check(compare_bytes("a\0b", 3, "ab", 2) < 0);
+	
+	const char * words[] = {"", "a", "ab", "abc", "b", "ba", "\x7F", "\x80"};
+	for (auto a : words)
+	{
+		for (auto b : words)
+			check(sign(compare_bytes(a, strlen(a), b, strlen(b))) ==
+				sign(compare(a, b, NONE))
+			);
+	}
+	
+	return true;
+}
+
+static bool test_fold_utf8()
+{
+	using namespace collation;
+	
+	check(fold_utf8('A') == 'a');
+	check(fold_utf8('z') == 'z');
+	check(fold_utf8(0xC0) == 0xE0);
+	check(fold_utf8(0xD7) == 0xD7);
+	check(fold_utf8(0xDF) == 0xDF);
+	check(fold_utf8(0xB5) == 0x3BC);
+	check(fold_utf8(0x100) == 0x101);
+	check(fold_utf8(0x101) == 0x101);
+	check(fold_utf8(0x141) == 0x142);
+	check(fold_utf8(0x178) == 0xFF);
+	check(fold_utf8(0x17D) == 0x17E);
+	check(fold_utf8(0x17F) == 's');
+	check(fold_utf8(0x391) == 0x3B1);
+	check(fold_utf8(0x3A3) == 0x3C3);
+	check(fold_utf8(0x3C2) == 0x3C3);
+	check(fold_utf8(0x386) == 0x3AC);
+	check(fold_utf8(0x401) == 0x451);
+	check(fold_utf8(0x42F) == 0x44F);
+	check(fold_utf8(0x4D0) == 0x4D1);
+	check(fold_utf8(0x4E8) == 0x4E9);
+	check(fold_utf8(0x4E00) == 0x4E00);
+	
+	return true;
+}
+
+static bool test_hash()
+{
+	using namespace collation;
+	
+	check(hash("abc", NONE) == hash("abc", NONE));
+	check(hash("abc", NONE) != hash("abd", NONE));
+	check(hash("abc", NONE) != hash("ABC", NONE));
+	check(hash("", NONE) != hash("a", NONE));
+	
+	check(hash("abc", FOLD_ASCII) == hash("ABC", FOLD_ASCII));
+	check(hash(" abc\t", TRIM) == hash("abc", TRIM));
+	check(hash("a b", TRIM) != hash("ab", TRIM));
+	check(hash("\xC3\x89t\xC3\xA9", FOLD_UTF8) == hash("\xC3\xA9T\xC3\xA9", FOLD_UTF8));
+	check(hash(" Vendor ", FOLD_ASCII | TRIM) == hash("vendor", FOLD_ASCII | TRIM));
+	
+	// equal under compare() means equal hashes
+	const char * strs[] = {"Acme", "ACME ", " acme", "Acne", "\xC3\x89", "\xC3\xA9"};
+	for (int how = 0; how < 8; ++how)
+	{
+		for (auto a : strs)
+		{
+			for (auto b : strs)
+			{
+				if (0 == compare(a, b, how))
+					check(hash(a, how) == hash(b, how));
+			}
+		}
+	}
+	
+	return true;
+}
+
+static int passed, failed;
+void run_test_collation(void)
+{
+    int i, end = sizeof(tests)/sizeof(*tests);
+
+    passed = 0;
+    for (i = 0; i < end; ++i)
+        if (tests[i]())
+            ++passed;
+
+    if (passed != end)
+        putchar('\n');
+
+    failed = end - passed;
+    report(passed, failed);
+    return;
+}
+
+int test_collation_passed(void)
+{return passed;}
+
+int test_collation_failed(void)
+{return failed;}
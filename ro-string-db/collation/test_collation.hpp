@@ -0,0 +1,6 @@
+#ifndef TEST_COLLATION_HPP
+#define TEST_COLLATION_HPP
+void run_test_collation(void);
+int test_collation_passed(void);
+int test_collation_failed(void);
+#endif
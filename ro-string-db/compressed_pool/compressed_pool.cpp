@@ -0,0 +1,361 @@
+#include "compressed_pool.hpp"
+
+#include <map>
+#include <utility>
+#include <stdexcept>
+#include <algorithm>
+
+#define throw_str(str) "compressed_pool: " str
+
+static const compressed_pool::uint GENERATIONS = 5;
+
+static uint64_t low_bytes_mask(compressed_pool::uint len)
+{
+	compressed_pool::byte bytes[8] = {0};
+	memset(bytes, 0xFF, len);
+	uint64_t mask = 0;
+	memcpy(&mask, bytes, sizeof(mask));
+	return mask;
+}
+
+// both sides of a match are loaded with memcpy(), so the masks work the same
+// on any byte order
+static const uint64_t first_bytes[9] = {
+	low_bytes_mask(0), low_bytes_mask(1), low_bytes_mask(2),
+	low_bytes_mask(3), low_bytes_mask(4), low_bytes_mask(5),
+	low_bytes_mask(6), low_bytes_mask(7), low_bytes_mask(8)
+};
+
+compressed_pool::compressed_pool() :
+	_num_symbols(0),
+	_raw_size(0),
+	_is_trained(false)
+{
+	memset(_sym, 0, sizeof(_sym));
+	memset(_sym_len, 0, sizeof(_sym_len));
+	memset(_first_begin, 0, sizeof(_first_begin));
+	memset(_by_first, 0, sizeof(_by_first));
+}
+
+inline compressed_pool::uint compressed_pool::_match(const byte * str,
+	size_t len
+) const
+{
+	uint64_t word = 0;
+	memcpy(&word, str, (len < 8) ? len : 8);
+	for (uint i = _first_begin[*str], end = _first_begin[*str + 1];
+		i < end;
+		++i
+	)
+	{
+		uint code = _by_first[i];
+		uint sym_len = _sym_len[code];
+		if (sym_len <= len && (word & first_bytes[sym_len]) == _sym[code])
+			return code;
+	}
+	return ESCAPE;
+}
+
+size_t compressed_pool::_encode(const byte * str, size_t len, byte * out) const
+{
+	byte * start = out;
+	for (size_t pos = 0; pos < len; )
+	{
+		uint code = _match(str + pos, len - pos);
+		*out++ = code;
+		if (ESCAPE == code)
+			*out++ = str[pos++];
+		else
+			pos += _sym_len[code];
+	}
+	return out - start;
+}
+
+void compressed_pool::_set_symbols(const std::vector<candidate>& cands)
+{
+	_num_symbols = (cands.size() < MAX_SYMBOLS) ? cands.size() : MAX_SYMBOLS;
+	
+	// by first byte, then longest first
+	std::vector<std::pair<std::pair<uint, uint>, uint>> order;
+	for (uint i = 0; i < _num_symbols; ++i)
+	{
+		_sym[i] = cands[i].sym;
+		_sym_len[i] = cands[i].len;
+		
+		byte first = 0;
+		memcpy(&first, &_sym[i], 1);
+		order.push_back(std::make_pair(
+			std::make_pair(first, 8 - cands[i].len), i
+		));
+	}
+	std::sort(order.begin(), order.end());
+	
+	memset(_first_begin, 0, sizeof(_first_begin));
+	for (uint i = 0; i < _num_symbols; ++i)
+	{
+		_by_first[i] = order[i].second;
+		++_first_begin[order[i].first.first + 1];
+	}
+	for (uint b = 0; b < 256; ++b)
+		_first_begin[b + 1] += _first_begin[b];
+}
+
+void compressed_pool::train(const char * const * sample, size_t n)
+{
+	if (!_pool.empty())
+		throw std::runtime_error(throw_str("train() after append()"));
+	
+	size_t total = 0;
+	for (size_t i = 0; i < n; ++i)
+		total += strlen(sample[i]);
+	
+	size_t step = (total > SAMPLE_BYTES) ? total / SAMPLE_BYTES : 1;
+	std::vector<std::pair<const byte *, size_t>> strs;
+	for (size_t i = 0; i < n; i += step)
+	{
+		strs.push_back(std::make_pair(
+			reinterpret_cast<const byte *>(sample[i]), strlen(sample[i])
+		));
+	}
+	
+	// ids are the codes, then the bytes which are escaped
+	const uint ids = MAX_SYMBOLS + 256;
+	std::vector<uint32_t> count1(ids), count2(ids * ids);
+	
+	_set_symbols(std::vector<candidate>());
+	for (uint gen = 0; gen < GENERATIONS; ++gen)
+	{
+		std::fill(count1.begin(), count1.end(), 0);
+		std::fill(count2.begin(), count2.end(), 0);
+		
+		for (auto& str : strs)
+		{
+			uint prev = ids;
+			for (size_t pos = 0; pos < str.second; )
+			{
+				uint code = _match(str.first + pos, str.second - pos);
+				uint id = code;
+				if (ESCAPE == code)
+				{
+					id = MAX_SYMBOLS + str.first[pos];
+					pos += 1;
+				}
+				else
+					pos += _sym_len[code];
+				
+				++count1[id];
+				if (prev < ids)
+					++count2[prev * ids + id];
+				prev = id;
+			}
+		}
+		
+		// every symbol and every pair of symbols is a candidate, worth the
+		// bytes it would have covered
+		auto bytes_of = [this](uint id, byte * out) -> uint
+		{
+			if (id < MAX_SYMBOLS)
+			{
+				memcpy(out, &_sym[id], 8);
+				return _sym_len[id];
+			}
+			out[0] = id - MAX_SYMBOLS;
+			return 1;
+		};
+		
+		std::map<std::pair<uint64_t, uint>, uint64_t> gains;
+		for (uint a = 0; a < ids; ++a)
+		{
+			if (!count1[a])
+				continue;
+			
+			byte bytes[16] = {0};
+			uint len_a = bytes_of(a, bytes);
+			uint64_t sym = 0;
+			memcpy(&sym, bytes, 8);
+			gains[std::make_pair(sym, len_a)] += (uint64_t)count1[a] * len_a;
+			
+			if (len_a == 8)
+				continue;
+			
+			for (uint b = 0; b < ids; ++b)
+			{
+				uint32_t cnt = count2[a * ids + b];
+				if (!cnt)
+					continue;
+				
+				byte both[16] = {0};
+				memcpy(both, bytes, len_a);
+				uint len = len_a + bytes_of(b, both + len_a);
+				len = std::min(len, 8u);
+				memset(both + len, 0, 8);
+				memcpy(&sym, both, 8);
+				gains[std::make_pair(sym, len)] += (uint64_t)cnt * len;
+			}
+		}
+		
+		std::vector<candidate> cands;
+		for (auto& gain : gains)
+			cands.push_back({gain.first.first, gain.first.second, gain.second});
+		std::sort(cands.begin(), cands.end(),
+			[](const candidate& a, const candidate& b)
+			{return (a.gain != b.gain) ? a.gain > b.gain : a.len > b.len;}
+		);
+		_set_symbols(cands);
+	}
+	
+	_is_trained = true;
+}
+
+compressed_pool::uint compressed_pool::append(const char * str, size_t len)
+{
+	if (!_is_trained)
+		throw std::runtime_error(throw_str("append() before train()"));
+	
+	_buf.resize(2 * len);
+	size_t codes = _encode(reinterpret_cast<const byte *>(str),
+		len,
+		_buf.data()
+	);
+	
+	uint start = _pool.size();
+	size_t num = codes;
+	do
+	{
+		byte low = num & 0x7F;
+		num >>= 7;
+		_pool.push_back((num) ? (low | 0x80) : low);
+	} while (num);
+	
+	_pool.insert(_pool.end(), _buf.begin(), _buf.begin() + codes);
+	_raw_size += len;
+	return start;
+}
+
+static inline const compressed_pool::byte * codes_at(
+	const compressed_pool::byte * at,
+	size_t& out_num
+)
+{
+	size_t num = 0;
+	for (compressed_pool::uint shift = 0; ; shift += 7)
+	{
+		num |= (size_t)(*at & 0x7F) << shift;
+		if (!(*at++ & 0x80))
+			break;
+	}
+	out_num = num;
+	return at;
+}
+
+size_t compressed_pool::get(uint index, char * out, size_t out_size) const
+{
+	size_t num = 0;
+	const byte * in = codes_at(_pool.data() + index, num);
+	const byte * end = in + num;
+	
+	// while eight more bytes fit, each symbol is one eight byte copy
+	size_t len = 0;
+	while (in < end && out_size - len >= 8)
+	{
+		byte code = *in++;
+		if (ESCAPE == code)
+			out[len++] = *in++;
+		else
+		{
+			memcpy(out + len, &_sym[code], 8);
+			len += _sym_len[code];
+		}
+	}
+	
+	while (in < end)
+	{
+		byte code = *in++;
+		const char * sym = reinterpret_cast<const char *>(in);
+		size_t sym_len = 1;
+		if (ESCAPE == code)
+			++in;
+		else
+		{
+			sym = reinterpret_cast<const char *>(&_sym[code]);
+			sym_len = _sym_len[code];
+		}
+		
+		if (len < out_size)
+			memcpy(out + len, sym, std::min(sym_len, out_size - len));
+		len += sym_len;
+	}
+	return len;
+}
+
+void compressed_pool::get(uint index, std::string& out) const
+{
+	out.resize(get_len(index));
+	get(index, &out[0], out.size());
+}
+
+size_t compressed_pool::get_len(uint index) const
+{
+	size_t num = 0;
+	const byte * in = codes_at(_pool.data() + index, num);
+	const byte * end = in + num;
+	
+	size_t len = 0;
+	for (; in < end; ++in)
+	{
+		if (ESCAPE == *in)
+		{
+			++in;
+			++len;
+		}
+		else
+			len += _sym_len[*in];
+	}
+	return len;
+}
+
+int compressed_pool::compare(uint index, const char * str, size_t len) const
+{
+	size_t num = 0;
+	const byte * in = codes_at(_pool.data() + index, num);
+	const byte * end = in + num;
+	const byte * rhs = reinterpret_cast<const byte *>(str);
+	
+	size_t pos = 0;
+	while (in < end)
+	{
+		byte code = *in++;
+		const byte * sym = in;
+		size_t sym_len = 1;
+		if (ESCAPE == code)
+			++in;
+		else
+		{
+			sym = reinterpret_cast<const byte *>(&_sym[code]);
+			sym_len = _sym_len[code];
+		}
+		
+		size_t left = len - pos;
+		int cmp = memcmp(sym, rhs + pos, std::min(sym_len, left));
+		if (cmp)
+			return cmp;
+		if (left < sym_len)
+			return 1;
+		pos += sym_len;
+	}
+	return (pos < len) ? -1 : 0;
+}
+
+bool compressed_pool::equal(uint a, uint b) const
+{
+	size_t num_a = 0, num_b = 0;
+	const byte * codes_a = codes_at(_pool.data() + a, num_a);
+	const byte * codes_b = codes_at(_pool.data() + b, num_b);
+	return (num_a == num_b && 0 == memcmp(codes_a, codes_b, num_a));
+}
+
+size_t compressed_pool::memory() const
+{
+	return _pool.capacity() + _buf.capacity() + sizeof(_sym) +
+		sizeof(_sym_len) + sizeof(_first_begin) + sizeof(_by_first);
+}
@@ -0,0 +1,128 @@
+#ifndef COMPRESSED_POOL_HPP
+#define COMPRESSED_POOL_HPP
+
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+
+class compressed_pool
+{
+	/*
+	   A string pool which keeps each string compressed with a static table
+	   of up to 255 symbols of 1 to 8 bytes, in the manner of FSST. The table
+	   is trained once, on a sample of the strings: the sample is compressed
+	   with the table so far, and the symbols, and the pairs of adjacent
+	   symbols put together, which cover the most bytes make the next table.
+	   A string is then a code for each symbol, and code 255 followed by the
+	   byte itself for a byte no symbol covers. Every string is compressed
+	   on its own, so each one can be decompressed, or compared, without
+	   touching the others.
+	*/
+	public:
+	typedef unsigned int uint;
+	typedef unsigned char byte;
+	
+	static const uint MAX_SYMBOLS = 255;
+	static const byte ESCAPE = 255;
+	static const size_t SAMPLE_BYTES = 1 << 15;
+	
+	compressed_pool();
+	
+	void train(const char * const * sample, size_t n);
+	/*
+	   Makes the symbol table from the '\0' ended strings of sample, or about
+	   SAMPLE_BYTES of them, taken evenly across. Throws once the pool holds
+	   strings.
+	*/
+	
+	uint append(const char * str, size_t len);
+	inline uint append(const char * str)
+	{return append(str, strlen(str));}
+	inline uint append(const std::string& str)
+	{return append(str.data(), str.size());}
+	/*
+	   Compresses the len bytes at str, which may hold '\0', into the pool
+	   and returns where they start. Throws before train().
+	*/
+	
+	size_t get(uint index, char * out, size_t out_size) const;
+	/*
+	   Decompresses the string at index in out, and returns its length. If
+	   it's longer than out_size, only out_size bytes are written. Nothing
+	   ends the string in out.
+	*/
+	
+	void get(uint index, std::string& out) const;
+	
+	size_t get_len(uint index) const;
+	/* The length of the string at index, without decompressing it. */
+	
+	int compare(uint index, const char * str, size_t len) const;
+	/*
+	   Like memcmp() of the string at index and the len bytes at str, where
+	   the shorter string is the smaller if it's a prefix of the other. The
+	   string is decompressed a symbol at a time, only until it differs.
+	*/
+	
+	bool equal(uint a, uint b) const;
+	/*
+	   True if the strings at a and b are equal. The same string always
+	   compresses to the same codes, so only the codes are compared.
+	*/
+	
+	inline uint num_symbols() const
+	{return _num_symbols;}
+	
+	inline bool is_trained() const
+	{return _is_trained;}
+	
+	inline size_t size() const
+	{return _pool.size();}
+	/* Bytes of compressed strings and their lengths. */
+	
+	inline size_t raw_size() const
+	{return _raw_size;}
+	/* Bytes appended, before they were compressed. */
+	
+	size_t memory() const;
+	
+	inline void shrink_to_fit()
+	{
+		_pool.shrink_to_fit();
+		std::vector<byte>().swap(_buf);
+	}
+	/* Also frees what append() needed. */
+	
+	private:
+	struct candidate {
+		uint64_t sym;
+		uint len;
+		uint64_t gain;
+	};
+	
+	inline uint _match(const byte * str, size_t len) const;
+	size_t _encode(const byte * str, size_t len, byte * out) const;
+	void _set_symbols(const std::vector<candidate>& cands);
+	
+	uint64_t _sym[MAX_SYMBOLS];
+	byte _sym_len[MAX_SYMBOLS];
+	uint _num_symbols;
+	
+	uint16_t _first_begin[257];
+	byte _by_first[MAX_SYMBOLS];
+	
+	std::vector<byte> _pool;
+	std::vector<byte> _buf;
+	size_t _raw_size;
+	bool _is_trained;
+};
+/*
+   Symbol i is the _sym_len[i] low bytes of _sym[i], first byte lowest. The
+   codes of the symbols which begin with byte b are _by_first[_first_begin[b]]
+   up to _by_first[_first_begin[b+1]], longest first, so the first one which
+   matches is the longest. A string in _pool is the number of its codes as a
+   varint, then the codes.
+*/
+#endif
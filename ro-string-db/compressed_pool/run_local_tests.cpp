@@ -0,0 +1,7 @@
+#include "test_compressed_pool.hpp"
+
+int main()
+{
+	run_test_compressed_pool();
+	return test_compressed_pool_failed();
+}
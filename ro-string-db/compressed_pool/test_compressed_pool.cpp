@@ -0,0 +1,228 @@
+#include "../test/test.h"
+#include "compressed_pool.hpp"
+
+#include <string>
+#include <vector>
+#include <random>
+#include <cstring>
+#include <stdexcept>
+
+static bool test_compressed_pool_train();
+static bool test_compressed_pool_round_trip();
+static bool test_compressed_pool_compare();
+
+static ftest tests[] = {
+	test_compressed_pool_train,
+	test_compressed_pool_round_trip,
+	test_compressed_pool_compare,
+};
+
+static bool didnt_throw = false;
+
+static int sign(int n)
+{
+	return (n > 0) - (n < 0);
+}
+
+static void make_strings(std::vector<std::string>& out, size_t n)
+{
+	const char * cities[] = {"Amsterdam", "Berlin", "Copenhagen", "Dublin"};
+	for (size_t i = 0; i < n; ++i)
+	{
+		std::string num = std::to_string(i);
+		out.push_back("https://shop.example.com/fruit_" + num +
+			"?ref=newsletter&city=" + cities[i % 4]
+		);
+	}
+}
+
+static bool test_compressed_pool_train()
+{
+	compressed_pool pool;
+	check(!pool.is_trained());
+	check(pool.num_symbols() == 0);
+	
+	try {pool.append("abc"); check(didnt_throw);}
+	catch(std::runtime_error& e)
+	{
+		std::string expected("compressed_pool: append() before train()");
+		check(expected == e.what());
+	}
+	
+	std::vector<std::string> strs;
+	make_strings(strs, 5000);
+	std::vector<const char *> sample;
+	for (auto& str : strs)
+		sample.push_back(str.c_str());
+	
+	pool.train(sample.data(), sample.size());
+	check(pool.is_trained());
+	check(pool.num_symbols() > 0);
+	check(pool.num_symbols() <= compressed_pool::MAX_SYMBOLS);
+	
+	for (auto& str : strs)
+		pool.append(str);
+	check(pool.raw_size() > 0);
+	check(pool.size() * 2 < pool.raw_size());
+	check(pool.memory() >= pool.size());
+	
+	try {pool.train(sample.data(), sample.size()); check(didnt_throw);}
+	catch(std::runtime_error& e)
+	{
+		std::string expected("compressed_pool: train() after append()");
+		check(expected == e.what());
+	}
+	
+	{ // an empty sample escapes every byte
+		compressed_pool empty;
+		empty.train(nullptr, 0);
+		check(empty.num_symbols() == 0);
+		compressed_pool::uint at = empty.append("xyz");
+		check(empty.size() == 1 + 6);
+		
+		std::string out;
+		empty.get(at, out);
+		check(out == "xyz");
+	}
+	
+	return true;
+}
+
+static bool test_compressed_pool_round_trip()
+{
+	std::vector<std::string> strs;
+	make_strings(strs, 2000);
+	std::vector<const char *> sample;
+	for (auto& str : strs)
+		sample.push_back(str.c_str());
+	
+	compressed_pool pool;
+	pool.train(sample.data(), sample.size());
+	
+	// bytes the sample never had, '\0' among them, and long strings
+	strs.push_back("");
+	strs.push_back(std::string("a\0b\xff\x80", 5));
+	strs.push_back(std::string(1000, 'z'));
+	strs.push_back(strs[0] + strs[1] + strs[2]);
+	std::mt19937 rng(7);
+	for (uint i = 0; i < 200; ++i)
+	{
+		std::string str;
+		for (uint j = 0, end = rng() % 40; j < end; ++j)
+			str += (char)(rng() % 256);
+		strs.push_back(str);
+	}
+	
+	std::vector<compressed_pool::uint> at;
+	for (auto& str : strs)
+		at.push_back(pool.append(str));
+	
+	bool all_same = true;
+	std::string out;
+	for (size_t i = 0; i < strs.size(); ++i)
+	{
+		pool.get(at[i], out);
+		all_same = all_same && out == strs[i];
+		all_same = all_same && pool.get_len(at[i]) == strs[i].size();
+	}
+	check(all_same);
+	
+	{ // a short buffer gets what fits, and the whole length
+		const std::string& str = strs[0];
+		char buff[64];
+		memset(buff, '#', sizeof(buff));
+		check(pool.get(at[0], buff, 10) == str.size());
+		check(0 == memcmp(buff, str.data(), 10));
+		check(buff[10] == '#');
+		
+		check(pool.get(at[0], buff, sizeof(buff)) == str.size());
+		check(0 == memcmp(buff, str.data(), str.size()));
+		
+		check(pool.get(at[0], buff, 0) == str.size());
+		check(buff[0] == str[0]);
+	}
+	
+	return true;
+}
+
+static bool test_compressed_pool_compare()
+{
+	std::vector<std::string> strs;
+	make_strings(strs, 1000);
+	std::vector<const char *> sample;
+	for (auto& str : strs)
+		sample.push_back(str.c_str());
+	
+	compressed_pool pool;
+	pool.train(sample.data(), sample.size());
+	
+	std::vector<std::string> probes{"", "h", "https", "https://shop.",
+		"https://shop.example.com/fruit_1", "https://shop.example.com/fruit_",
+		"https://shop.example.com/fruit_1?ref=newsletter&city=Berlin",
+		"https://shop.example.com/fruit_1?ref=newsletter&city=Berlinx",
+		"zzz", std::string("https\0", 6), "\xff"
+	};
+	probes.push_back(strs[10]);
+	probes.push_back(strs[999]);
+	
+	std::vector<compressed_pool::uint> at;
+	for (size_t i = 0; i < 50; ++i)
+		at.push_back(pool.append(strs[i]));
+	for (auto& probe : probes)
+		at.push_back(pool.append(probe));
+	
+	bool all_same = true;
+	for (size_t i = 0; i < at.size(); ++i)
+	{
+		std::string str;
+		pool.get(at[i], str);
+		for (auto& probe : probes)
+		{
+			all_same = all_same &&
+				sign(pool.compare(at[i], probe.data(), probe.size())) ==
+				sign(str.compare(probe));
+		}
+	}
+	check(all_same);
+	
+	check(0 == pool.compare(at[1], strs[1].c_str(), strs[1].size()));
+	check(pool.compare(at[1], strs[1].c_str(), strs[1].size() - 1) > 0);
+	check(pool.compare(at[1], (strs[1] + "a").c_str(), strs[1].size() + 1) < 0);
+	
+	// a string appended twice is equal to itself, and to nothing else
+	compressed_pool::uint again = pool.append(strs[10]);
+	check(again != at[10] && pool.equal(again, at[10]));
+	for (size_t i = 0; i < at.size(); ++i)
+	{
+		std::string str;
+		pool.get(at[i], str);
+		all_same = all_same && pool.equal(at[i], again) == (str == strs[10]);
+	}
+	check(all_same);
+	
+	return true;
+}
+
+static int passed, failed;
+void run_test_compressed_pool(void)
+{
+    int i, end = sizeof(tests)/sizeof(*tests);
+
+    passed = 0;
+    for (i = 0; i < end; ++i)
+        if (tests[i]())
+            ++passed;
+
+    if (passed != end)
+        putchar('\n');
+
+    failed = end - passed;
+    report(passed, failed);
+    return;
+}
+
+int test_compressed_pool_passed(void)
+{return passed;}
+
+int test_compressed_pool_failed(void)
+{return failed;}
@@ -0,0 +1,6 @@
+#ifndef TEST_COMPRESSED_POOL_HPP
+#define TEST_COMPRESSED_POOL_HPP
+void run_test_compressed_pool(void);
+int test_compressed_pool_passed(void);
+int test_compressed_pool_failed(void);
+#endif
@@ -0,0 +1,306 @@
+#include "front_coded.hpp"
+
+#include <cstring>
+#include <algorithm>
+
+static uint64_t key_of(const front_coded::byte * str, size_t len)
+{
+	uint64_t key = 0;
+	size_t i = 0;
+	for (; i < 8 && i < len; ++i)
+		key = (key << 8) | str[i];
+	for (; i < 8; ++i)
+		key <<= 8;
+	return key;
+}
+
+static void push_varint(std::vector<front_coded::byte>& out, size_t num)
+{
+	do
+	{
+		front_coded::byte low = num & 0x7F;
+		num >>= 7;
+		out.push_back((num) ? (low | 0x80) : low);
+	} while (num);
+}
+
+static inline const front_coded::byte * read_varint(
+	const front_coded::byte * in,
+	size_t& out
+)
+{
+	size_t num = 0;
+	for (front_coded::uint shift = 0; ; shift += 7)
+	{
+		num |= (size_t)(*in & 0x7F) << shift;
+		if (!(*in++ & 0x80))
+			break;
+	}
+	out = num;
+	return in;
+}
+
+static void push_change(std::vector<front_coded::byte>& out,
+	size_t drop,
+	size_t add
+)
+{
+	if (drop < 15 && add < 15)
+		out.push_back((drop << 4) | add);
+	else
+	{
+		out.push_back(0xFF);
+		push_varint(out, drop);
+		push_varint(out, add);
+	}
+}
+
+static inline const front_coded::byte * read_change(
+	const front_coded::byte * in,
+	size_t& out_drop,
+	size_t& out_add
+)
+{
+	front_coded::byte change = *in++;
+	if (change != 0xFF)
+	{
+		out_drop = change >> 4;
+		out_add = change & 0x0F;
+		return in;
+	}
+	
+	in = read_varint(in, out_drop);
+	return read_varint(in, out_add);
+}
+
+static inline void compare_from(const front_coded::byte * str,
+	size_t len,
+	const front_coded::byte * key,
+	size_t key_len,
+	size_t& in_out_match,
+	int& out_cmp
+)
+{
+	// str continues the first in_out_match bytes of key
+	size_t at = in_out_match;
+	size_t i = 0;
+	while (i < len && at < key_len && str[i] == key[at])
+	{
+		++i;
+		++at;
+	}
+	
+	in_out_match = at;
+	if (i < len && at < key_len)
+		out_cmp = (str[i] < key[at]) ? -1 : 1;
+	else if (i < len)
+		out_cmp = 1;
+	else
+		out_cmp = (at < key_len) ? -1 : 0;
+}
+
+static inline bool is_before(int cmp, size_t match, size_t key_len, int which)
+{
+	// which is LOWER, UPPER, or PREFIX_END, in that order
+	if (0 == which)
+		return cmp < 0;
+	if (1 == which)
+		return cmp <= 0;
+	return (cmp < 0 || match >= key_len);
+}
+
+void front_coded::append(const char * str, size_t len)
+{
+	const byte * bytes = reinterpret_cast<const byte *>(str);
+	size_t shared = 0;
+	size_t most = std::min(len, _last.size());
+	while (shared < most && (byte)_last[shared] == bytes[shared])
+		++shared;
+	
+	// sorted, so what all share is the least any two next to each other do
+	if (!_size)
+		_prefix.assign(str, len);
+	else if (shared < _prefix.size())
+		_prefix.resize(shared);
+	
+	if (0 == _size % _block)
+	{
+		_heads.push_back(_bytes.size());
+		push_varint(_bytes, len);
+		_bytes.insert(_bytes.end(), bytes, bytes + len);
+	}
+	else
+	{
+		push_change(_bytes, _last.size() - shared, len - shared);
+		_bytes.insert(_bytes.end(), bytes + shared, bytes + len);
+	}
+	
+	_last.assign(str, len);
+	++_size;
+}
+
+void front_coded::seal()
+{
+	// the same blocks, with _prefix taken out of each head
+	size_t skip = _prefix.size();
+	std::vector<byte> bytes;
+	bytes.reserve(_bytes.size() - skip * _heads.size());
+	_head_keys.resize(_heads.size());
+	for (size_t blk = 0, end = _heads.size(); blk < end; ++blk)
+	{
+		size_t len = 0;
+		const byte * head = read_varint(_bytes.data() + _heads[blk], len);
+		const byte * next = (blk + 1 < end) ?
+			_bytes.data() + _heads[blk + 1] :
+			_bytes.data() + _bytes.size();
+		
+		_heads[blk] = bytes.size();
+		_head_keys[blk] = key_of(head + skip, len - skip);
+		push_varint(bytes, len - skip);
+		bytes.insert(bytes.end(), head + skip, next);
+	}
+	
+	_bytes.swap(bytes);
+	std::string().swap(_last);
+	_bytes.shrink_to_fit();
+	_heads.shrink_to_fit();
+	_head_keys.shrink_to_fit();
+}
+
+const front_coded::byte * front_coded::_head(size_t blk, size_t& out_len) const
+{
+	return read_varint(_bytes.data() + _heads[blk], out_len);
+}
+
+bool front_coded::_head_before(size_t blk,
+	uint64_t head_key,
+	const byte * key,
+	size_t len,
+	bound which
+) const
+{
+	// the eight bytes settle most comparisons; a head which is greater there
+	// may still begin with a shorter prefix
+	if (_head_keys[blk] < head_key)
+		return true;
+	if (_head_keys[blk] > head_key && PREFIX_END != which)
+		return false;
+	
+	size_t skip = _prefix.size();
+	size_t head_len = 0;
+	const byte * head = _head(blk, head_len);
+	int cmp = memcmp(head, key + skip, std::min(head_len, len - skip));
+	if (PREFIX_END == which)
+		return (cmp <= 0);
+	
+	if (!cmp)
+		cmp = (head_len < len - skip) ? -1 : (head_len > len - skip);
+	return (LOWER == which) ? (cmp < 0) : (cmp <= 0);
+}
+
+size_t front_coded::_partition(const byte * key, size_t len, bound which) const
+{
+	if (!_size)
+		return 0;
+	
+	// a key which differs from all strings in what they share is before or
+	// after all of them; one which ends within it begins all of them
+	size_t skip = _prefix.size();
+	size_t most = std::min(len, skip);
+	int cmp = (most) ? memcmp(_prefix.data(), key, most) : 0;
+	if (cmp)
+		return (cmp > 0) ? 0 : _size;
+	if (len < skip)
+		return (PREFIX_END == which) ? _size : 0;
+	
+	// the first block whose head isn't before key
+	uint64_t head_key = key_of(key + skip, len - skip);
+	size_t lo = 0, hi = _heads.size();
+	while (lo < hi)
+	{
+		size_t mid = lo + (hi - lo) / 2;
+		if (_head_before(mid, head_key, key, len, which))
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	
+	if (0 == lo)
+		return 0;
+	
+	// so the answer is after the head of the block before it, or its head
+	size_t blk = lo - 1;
+	size_t head_len = 0;
+	const byte * in = _head(blk, head_len);
+	size_t match = skip;
+	compare_from(in, head_len, key, len, match, cmp);
+	in += head_len;
+	size_t last_len = skip + head_len;
+	
+	size_t pos = blk * _block + 1;
+	size_t end = std::min(blk * _block + _block, _size);
+	for (; pos < end; ++pos)
+	{
+		size_t drop = 0, add = 0;
+		in = read_change(in, drop, add);
+		size_t shared = last_len - drop;
+		last_len = shared + add;
+		
+		// sharing less with the one before than key did, it's greater at
+		// the first byte it doesn't share; sharing more, it compares like
+		// the one before
+		if (shared < match)
+		{
+			match = shared;
+			cmp = 1;
+		}
+		else if (shared == match)
+			compare_from(in, add, key, len, match, cmp);
+		in += add;
+		
+		if (!is_before(cmp, match, len, which))
+			return pos;
+	}
+	return end;
+}
+
+size_t front_coded::lower_bound(const char * key, size_t len) const
+{
+	return _partition(reinterpret_cast<const byte *>(key), len, LOWER);
+}
+
+size_t front_coded::upper_bound(const char * key, size_t len) const
+{
+	return _partition(reinterpret_cast<const byte *>(key), len, UPPER);
+}
+
+size_t front_coded::prefix_end(const char * prefix, size_t len) const
+{
+	return _partition(reinterpret_cast<const byte *>(prefix), len, PREFIX_END);
+}
+
+void front_coded::get(size_t pos, std::string& out) const
+{
+	size_t blk = pos / _block;
+	size_t len = 0;
+	const byte * in = _head(blk, len);
+	out.assign(_prefix);
+	out.append(reinterpret_cast<const char *>(in), len);
+	in += len;
+	
+	for (size_t i = blk * _block; i < pos; ++i)
+	{
+		size_t drop = 0, add = 0;
+		in = read_change(in, drop, add);
+		out.resize(out.size() - drop);
+		out.append(reinterpret_cast<const char *>(in), add);
+		in += add;
+	}
+}
+
+size_t front_coded::memory() const
+{
+	return _bytes.capacity() + _heads.capacity() * sizeof(uint) +
+		_head_keys.capacity() * sizeof(uint64_t) + _prefix.capacity() +
+		_last.capacity();
+}
@@ -0,0 +1,107 @@
+#ifndef FRONT_CODED_HPP
+#define FRONT_CODED_HPP
+
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+class front_coded
+{
+	/*
+	   A sorted array of strings, front coded in blocks. The prefix all the
+	   strings share, e.g. "/users/" of "/users/1", "/users/2", ..., is kept
+	   once. The first string of each block, its head, is kept whole after
+	   that prefix; each one after it only as the number of bytes it drops
+	   from the end of the one before, the number it adds, and the added
+	   bytes. Sorted neighbours share most of their bytes, e.g. ids, so both
+	   numbers usually fit in one byte, and a block of 32 ids in a cache line
+	   or two.
+	   
+	   A search binary searches the heads, mostly by the eight bytes of each
+	   after the prefix, kept in an array of their own, then walks one block.
+	   The walk builds no string: knowing how much of the key the string
+	   before matched and which way it differed, the length the next one
+	   keeps tells how that one compares, and only one which keeps exactly
+	   as much has its bytes compared.
+	*/
+	public:
+	typedef unsigned int uint;
+	typedef unsigned char byte;
+	
+	front_coded(uint block = 32) : _size(0), _block(block) {}
+	
+	void append(const char * str, size_t len);
+	/*
+	   Adds the len bytes at str, which may hold '\0', after all others.
+	   The strings have to come in memcmp() order, shorter first.
+	*/
+	
+	void seal();
+	/*
+	   Takes the shared prefix out of the heads, makes their keys, and frees
+	   what appending needed. Call when done appending, before searching.
+	*/
+	
+	size_t lower_bound(const char * key, size_t len) const;
+	/* The position of the first string not less than key. */
+	
+	size_t upper_bound(const char * key, size_t len) const;
+	/* The position of the first string greater than key. */
+	
+	size_t prefix_end(const char * prefix, size_t len) const;
+	/*
+	   The position after the last string which begins with prefix, so
+	   lower_bound() and prefix_end() of a prefix are the strings which
+	   begin with it.
+	*/
+	
+	void get(size_t pos, std::string& out) const;
+	/* Places the string at pos in out. */
+	
+	inline size_t size() const
+	{return _size;}
+	
+	inline size_t blocks() const
+	{return _heads.size();}
+	
+	inline uint block_size() const
+	{return _block;}
+	
+	size_t memory() const;
+	
+	private:
+	enum bound {
+		LOWER,
+		UPPER,
+		PREFIX_END
+	};
+	
+	size_t _partition(const byte * key, size_t len, bound which) const;
+	bool _head_before(size_t blk,
+		uint64_t head_key,
+		const byte * key,
+		size_t len,
+		bound which
+	) const;
+	const byte * _head(size_t blk, size_t& out_len) const;
+	
+	std::vector<byte> _bytes;
+	std::vector<uint> _heads;
+	std::vector<uint64_t> _head_keys;
+	std::string _prefix;
+	std::string _last;
+	size_t _size;
+	uint _block;
+};
+/*
+   _heads holds where each block begins in _bytes, and _head_keys the first
+   eight bytes of each head after _prefix, as a big endian number, zero
+   padded. A head is its length after _prefix as a varint, then those bytes.
+   Every other string is a byte with the number of bytes dropped in its high
+   four bits and the number added in the low four, or 0xFF and both numbers
+   as varints if either is over 14, then the added bytes. Until seal(), the
+   heads are whole and _prefix is what all strings so far share of _last,
+   the string appended last.
+*/
+#endif
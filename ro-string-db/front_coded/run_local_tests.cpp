@@ -0,0 +1,7 @@
+#include "test_front_coded.hpp"
+
+int main()
+{
+	run_test_front_coded();
+	return test_front_coded_failed();
+}
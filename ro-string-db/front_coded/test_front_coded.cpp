@@ -0,0 +1,267 @@
+#include "../test/test.h"
+#include "front_coded.hpp"
+
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+
+static bool test_front_coded_get();
+static bool test_front_coded_bounds();
+static bool test_front_coded_prefix();
+
+static ftest tests[] = {
+	test_front_coded_get,
+	test_front_coded_bounds,
+	test_front_coded_prefix,
+};
+
+static void make_strings(std::vector<std::string>& out,
+	size_t n,
+	const std::string& prefix = ""
+)
+{
+	// ids which share most of their bytes, a few repeated, and some which
+	// hold '\0' or high bytes, all after prefix
+	std::mt19937 rng(11);
+	std::vector<std::string> strs{"", std::string("\0", 1),
+		std::string("id\0x", 4), "\xff\xfe", "id-"
+	};
+	for (size_t i = 0; i < n; ++i)
+	{
+		std::string id = "id-" + std::to_string(rng() % (n * 2));
+		strs.push_back(id);
+		if (0 == i % 7)
+			strs.push_back(id + "-" + std::to_string(i));
+	}
+	
+	for (auto& str : strs)
+		out.push_back(prefix + str);
+	std::sort(out.begin(), out.end());
+}
+
+static void build(front_coded& fc, const std::vector<std::string>& strs)
+{
+	for (auto& str : strs)
+		fc.append(str.data(), str.size());
+	fc.seal();
+}
+
+static void make_probes(std::vector<std::string>& out,
+	const std::vector<std::string>& strs,
+	const std::string& prefix = ""
+)
+{
+	std::vector<std::string> probes{"", std::string("\0", 1),
+		std::string("\0\0", 2), "a", "i", "id", "id-", "id-1", "id-10",
+		"id-99999999", "id.", "ie", "\xff", "\xff\xfe", "\xff\xff",
+		std::string("id\0", 3)
+	};
+	
+	// before, within and after what all the strings share, too
+	out = probes;
+	for (auto& probe : probes)
+		out.push_back(prefix + probe);
+	for (size_t i = 1; i < prefix.size(); ++i)
+	{
+		out.push_back(prefix.substr(0, i));
+		out.push_back(prefix.substr(0, i) + "\xff");
+	}
+	
+	for (size_t i = 0; i < strs.size(); i += 13)
+	{
+		const std::string& str = strs[i];
+		out.push_back(str);
+		out.push_back(str + "0");
+		if (str.size())
+			out.push_back(str.substr(0, str.size() - 1));
+	}
+}
+
+static bool test_front_coded_get()
+{
+	front_coded empty;
+	check(empty.size() == 0);
+	check(empty.blocks() == 0);
+	check(empty.lower_bound("a", 1) == 0);
+	check(empty.upper_bound("a", 1) == 0);
+	check(empty.prefix_end("", 0) == 0);
+	
+	for (front_coded::uint block : {1, 2, 16, 64})
+	{
+		std::vector<std::string> strs;
+		make_strings(strs, 1000);
+		front_coded fc(block);
+		build(fc, strs);
+		check(fc.size() == strs.size());
+		check(fc.block_size() == block);
+		check(fc.blocks() == (strs.size() + block - 1) / block);
+		
+		bool all_same = true;
+		std::string out;
+		for (size_t i = 0; i < strs.size(); ++i)
+		{
+			fc.get(i, out);
+			all_same = all_same && out == strs[i];
+		}
+		check(all_same);
+		
+		size_t raw = 0;
+		for (auto& str : strs)
+			raw += str.size();
+		if (block >= 16)
+			check(fc.memory() < raw);
+	}
+	
+	{ // neighbours which drop or add more than a byte can count
+		std::mt19937 rng(5);
+		std::vector<std::string> strs;
+		for (size_t i = 0; i < 500; ++i)
+			strs.push_back(std::string(rng() % 300, 'a' + rng() % 3));
+		std::sort(strs.begin(), strs.end());
+		front_coded fc(8);
+		build(fc, strs);
+		
+		bool all_same = true;
+		std::string out;
+		for (size_t i = 0; i < strs.size(); ++i)
+		{
+			fc.get(i, out);
+			all_same = all_same && out == strs[i];
+			size_t lower = std::lower_bound(strs.begin(), strs.end(), strs[i]) -
+				strs.begin();
+			all_same = all_same &&
+				fc.lower_bound(strs[i].data(), strs[i].size()) == lower;
+		}
+		check(all_same);
+	}
+	
+	return true;
+}
+
+static bool test_front_coded_bounds()
+{
+	for (front_coded::uint block : {1, 3, 16})
+	{
+		for (std::string prefix : {"", "/users/eu/"})
+		{
+			std::vector<std::string> strs;
+			make_strings(strs, 2000, prefix);
+			front_coded fc(block);
+			build(fc, strs);
+			
+			std::vector<std::string> probes;
+			make_probes(probes, strs, prefix);
+			
+			bool all_same = true;
+			for (auto& probe : probes)
+			{
+				auto lower = std::lower_bound(strs.begin(), strs.end(), probe);
+				auto upper = std::upper_bound(strs.begin(), strs.end(), probe);
+				all_same = all_same &&
+					fc.lower_bound(probe.data(), probe.size()) ==
+					(size_t)(lower - strs.begin());
+				all_same = all_same &&
+					fc.upper_bound(probe.data(), probe.size()) ==
+					(size_t)(upper - strs.begin());
+			}
+			check(all_same);
+		}
+	}
+	
+	{ // repeated strings across blocks
+		std::vector<std::string> strs(40, "same");
+		strs.insert(strs.begin(), "a");
+		strs.push_back("samf");
+		front_coded fc(4);
+		build(fc, strs);
+		check(fc.lower_bound("same", 4) == 1);
+		check(fc.upper_bound("same", 4) == 41);
+		check(fc.lower_bound("sam", 3) == 1);
+		check(fc.upper_bound("samez", 5) == 41);
+	}
+	
+	{ // only one string, so all of it is shared
+		std::vector<std::string> strs{"only"};
+		front_coded fc;
+		build(fc, strs);
+		check(fc.lower_bound("only", 4) == 0);
+		check(fc.upper_bound("only", 4) == 1);
+		check(fc.lower_bound("onlz", 4) == 1);
+		check(fc.upper_bound("on", 2) == 0);
+		check(fc.prefix_end("on", 2) == 1);
+		check(fc.prefix_end("only!", 5) == 1);
+		check(fc.lower_bound("only!", 5) == 1);
+	}
+	
+	return true;
+}
+
+static bool test_front_coded_prefix()
+{
+	for (std::string prefix : {"", "/users/eu/"})
+	{
+		std::vector<std::string> strs;
+		make_strings(strs, 2000, prefix);
+		front_coded fc;
+		build(fc, strs);
+		
+		std::vector<std::string> probes;
+		make_probes(probes, strs, prefix);
+		
+		bool all_same = true;
+		for (auto& probe : probes)
+		{
+			size_t end = strs.size();
+			for (size_t i = 0; i < strs.size(); ++i)
+			{
+				if (strs[i].compare(0, probe.size(), probe) > 0)
+				{
+					end = i;
+					break;
+				}
+			}
+			all_same = all_same &&
+				fc.prefix_end(probe.data(), probe.size()) == end;
+			
+			size_t begin = fc.lower_bound(probe.data(), probe.size());
+			for (size_t i = begin; i < end; ++i)
+			{
+				all_same = all_same &&
+					0 == strs[i].compare(0, probe.size(), probe);
+			}
+		}
+		check(all_same);
+		
+		check(fc.prefix_end("", 0) == strs.size());
+		check(fc.prefix_end("\xff\xff", 2) == strs.size());
+		check(fc.prefix_end("", 0) - fc.lower_bound("", 0) == strs.size());
+		check(fc.prefix_end(prefix.data(), prefix.size()) == strs.size());
+	}
+	
+	return true;
+}
+
+static int passed, failed;
+void run_test_front_coded(void)
+{
+    int i, end = sizeof(tests)/sizeof(*tests);
+
+    passed = 0;
+    for (i = 0; i < end; ++i)
+        if (tests[i]())
+            ++passed;
+
+    if (passed != end)
+        putchar('\n');
+
+    failed = end - passed;
+    report(passed, failed);
+    return;
+}
+
+int test_front_coded_passed(void)
+{return passed;}
+
+int test_front_coded_failed(void)
+{return failed;}
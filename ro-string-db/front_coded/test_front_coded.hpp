@@ -0,0 +1,6 @@
+#ifndef TEST_FRONT_CODED_HPP
+#define TEST_FRONT_CODED_HPP
+void run_test_front_coded(void);
+int test_front_coded_passed(void);
+int test_front_coded_failed(void);
+#endif
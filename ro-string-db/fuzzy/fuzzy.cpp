@@ -0,0 +1,228 @@
+#include "fuzzy.hpp"
+
+#include <cstring>
+#include <algorithm>
+
+namespace fuzzy
+{
+
+uint edit_distance(const char * a,
+	size_t a_len,
+	const char * b,
+	size_t b_len
+)
+{
+	if (a_len <= pattern::max_len)
+		return pattern(a, a_len).distance(b, b_len);
+	if (b_len <= pattern::max_len)
+		return pattern(b, b_len).distance(a, a_len);
+	
+	std::vector<uint> row(b_len + 1);
+	for (size_t j = 0; j <= b_len; ++j)
+		row[j] = j;
+	
+	for (size_t i = 1; i <= a_len; ++i)
+	{
+		uint diag = row[0];
+		row[0] = i;
+		for (size_t j = 1; j <= b_len; ++j)
+		{
+			uint up = row[j];
+			uint sub = diag + (a[i-1] != b[j-1]);
+			row[j] = std::min(std::min(up, row[j-1]) + 1, sub);
+			diag = up;
+		}
+	}
+	
+	return row[b_len];
+}
+
+pattern::pattern(const char * str, size_t len) : _str(str), _len(len)
+{
+	memset(_peq, 0, sizeof(_peq));
+	if (len <= max_len)
+	{
+		for (size_t i = 0; i < len; ++i)
+			_peq[(unsigned char)str[i]] |= (uint64_t)1 << i;
+	}
+}
+
+uint pattern::distance(const char * text, size_t len) const
+{
+	if (_len > max_len)
+		return edit_distance(_str, _len, text, len);
+	
+	if (!_len)
+		return len;
+	
+	// Pv and Mv are the vertical +1 and -1 deltas of the current column;
+	// the score follows the last row, which is the distance to the whole
+	// pattern
+	uint64_t high = (uint64_t)1 << (_len - 1);
+	uint64_t pv = ~(uint64_t)0;
+	uint64_t mv = 0;
+	uint score = _len;
+	
+	for (size_t i = 0; i < len; ++i)
+	{
+		uint64_t eq = _peq[(unsigned char)text[i]];
+		uint64_t xv = eq | mv;
+		uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+		uint64_t ph = mv | ~(xh | pv);
+		uint64_t mh = pv & xh;
+		
+		if (ph & high)
+			++score;
+		else if (mh & high)
+			--score;
+		
+		// the first row grows by one for each byte of text
+		ph = (ph << 1) | 1;
+		mh <<= 1;
+		pv = mh | ~(xv | ph);
+		mv = ph & xv;
+	}
+	
+	return score;
+}
+
+static inline uint dist_diff(uint a, uint b)
+{
+	return (a > b) ? (a - b) : (b - a);
+}
+
+static bool match_less(const bk_tree::match& a, const bk_tree::match& b)
+{
+	return (a.distance < b.distance ||
+		(a.distance == b.distance && a.id < b.id)
+	);
+}
+
+void bk_tree::build(const uint * ids, size_t n, get_str get, const void * ctx)
+{
+	_nodes.clear();
+	if (!n)
+		return;
+	
+	_nodes.push_back(node(ids[0], 0));
+	for (size_t i = 1; i < n; ++i)
+	{
+		const char * str = get(ctx, ids[i]);
+		pattern pat(str, strlen(str));
+		
+		uint at = 0;
+		while (true)
+		{
+			const char * other = get(ctx, _nodes[at].id);
+			uint dist = pat.distance(other, strlen(other));
+			if (!dist)
+				break;
+			
+			uint child = _nodes[at].first_child;
+			uint last = 0;
+			while (child && _nodes[child].dist != dist)
+			{
+				last = child;
+				child = _nodes[child].next_sibling;
+			}
+			
+			if (child)
+			{
+				at = child;
+				continue;
+			}
+			
+			uint added = _nodes.size();
+			_nodes.push_back(node(ids[i], dist));
+			if (last)
+				_nodes[last].next_sibling = added;
+			else
+				_nodes[at].first_child = added;
+			break;
+		}
+	}
+}
+
+void bk_tree::within(const char * query,
+	uint k,
+	get_str get,
+	const void * ctx,
+	std::vector<match>& out
+) const
+{
+	out.clear();
+	if (_nodes.empty())
+		return;
+	
+	pattern pat(query, strlen(query));
+	std::vector<uint> todo(1, 0);
+	while (!todo.empty())
+	{
+		const node& nd = _nodes[todo.back()];
+		todo.pop_back();
+		
+		const char * str = get(ctx, nd.id);
+		uint dist = pat.distance(str, strlen(str));
+		if (dist <= k)
+			out.push_back(match(nd.id, dist));
+		
+		for (uint child = nd.first_child; child;
+			child = _nodes[child].next_sibling
+		)
+		{
+			if (dist_diff(_nodes[child].dist, dist) <= k)
+				todo.push_back(child);
+		}
+	}
+	
+	std::sort(out.begin(), out.end(), match_less);
+}
+
+void bk_tree::nearest(const char * query,
+	size_t n,
+	get_str get,
+	const void * ctx,
+	std::vector<match>& out
+) const
+{
+	// out is a heap with the worst of the best n on top
+	out.clear();
+	if (_nodes.empty() || !n)
+		return;
+	
+	pattern pat(query, strlen(query));
+	std::vector<uint> todo(1, 0);
+	while (!todo.empty())
+	{
+		const node& nd = _nodes[todo.back()];
+		todo.pop_back();
+		
+		const char * str = get(ctx, nd.id);
+		match mt(nd.id, pat.distance(str, strlen(str)));
+		if (out.size() < n)
+		{
+			out.push_back(mt);
+			std::push_heap(out.begin(), out.end(), match_less);
+		}
+		else if (match_less(mt, out.front()))
+		{
+			std::pop_heap(out.begin(), out.end(), match_less);
+			out.back() = mt;
+			std::push_heap(out.begin(), out.end(), match_less);
+		}
+		
+		for (uint child = nd.first_child; child;
+			child = _nodes[child].next_sibling
+		)
+		{
+			if (out.size() < n ||
+				dist_diff(_nodes[child].dist, mt.distance) <= out.front().distance
+			)
+				todo.push_back(child);
+		}
+	}
+	
+	std::sort(out.begin(), out.end(), match_less);
+}
+
+}
@@ -0,0 +1,122 @@
+#ifndef FUZZY_HPP
+#define FUZZY_HPP
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace fuzzy
+{
+	typedef unsigned int uint;
+	
+	uint edit_distance(const char * a,
+		size_t a_len,
+		const char * b,
+		size_t b_len
+	);
+	/*
+	   Returns the Levenshtein distance between a and b, compared byte by
+	   byte. If either is no longer than 64 bytes this is pattern::distance(),
+	   otherwise the classic dynamic programming over two rows.
+	*/
+	
+	class pattern
+	{
+		/*
+		   Myers' bit-parallel edit distance, in Hyyro's formulation for the
+		   distance between whole strings. The pattern is kept as one bit
+		   mask per byte value, with a bit set for each position of the byte
+		   in the pattern. A column of the dynamic programming matrix is then
+		   updated for a byte of the text with a handful of word operations,
+		   so the distance costs one step per byte of text, rather than one
+		   per byte of text times the pattern length. Made once and used
+		   against any number of texts.
+		*/
+		public:
+		static const size_t max_len = 64;
+		
+		pattern(const char * str, size_t len);
+		/* Patterns longer than max_len fall back to edit_distance(). */
+		
+		uint distance(const char * text, size_t len) const;
+		
+		private:
+		uint64_t _peq[256];
+		const char * _str;
+		size_t _len;
+	};
+	
+	class bk_tree
+	{
+		/*
+		   A Burkhard-Keller tree over a set of strings, each identified by a
+		   number chosen by the caller. Each child hangs under its parent by
+		   its distance to it, so by the triangle inequality only the children
+		   with a distance within k of d need to be visited, where d is the
+		   distance of the query to their parent. The tree does not keep the
+		   strings, only their ids; they are fetched through a get_str
+		   function and its context when needed.
+		*/
+		public:
+		typedef const char * (*get_str)(const void * ctx, uint id);
+		
+		struct match {
+			match(uint id = 0, uint distance = 0) :
+				id(id), distance(distance) {}
+			uint id;
+			uint distance;
+		};
+		
+		bk_tree() {}
+		
+		void build(const uint * ids, size_t n, get_str get, const void * ctx);
+		/* Replaces the tree with one over ids. Equal strings are kept once. */
+		
+		inline size_t size() const
+		{return _nodes.size();}
+		
+		void within(const char * query,
+			uint k,
+			get_str get,
+			const void * ctx,
+			std::vector<match>& out
+		) const;
+		/*
+		   Places the ids of all strings no more than k edits away from query
+		   in out, replacing its contents, ordered by distance, then by id.
+		*/
+		
+		void nearest(const char * query,
+			size_t n,
+			get_str get,
+			const void * ctx,
+			std::vector<match>& out
+		) const;
+		/*
+		   Places the ids of the n strings closest to query in out, ordered
+		   like within(). Once n candidates are found, their greatest distance
+		   bounds the search.
+		*/
+		
+		inline void shrink_to_fit()
+		{_nodes.shrink_to_fit();}
+		
+		private:
+		struct node {
+			node(uint id, uint dist) :
+				id(id), dist(dist), first_child(0), next_sibling(0) {}
+			uint id;
+			uint dist;
+			uint first_child;
+			uint next_sibling;
+		};
+		/*
+		   dist is the distance to the parent. Children of a node are a list
+		   through next_sibling; 0 ends a list, since the root is no one's
+		   child.
+		*/
+		
+		std::vector<node> _nodes;
+	};
+}
+#endif
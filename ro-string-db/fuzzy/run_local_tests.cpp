@@ -0,0 +1,7 @@
+#include "test_fuzzy.hpp"
+
+int main()
+{
+	run_test_fuzzy();
+	return test_fuzzy_failed();
+}
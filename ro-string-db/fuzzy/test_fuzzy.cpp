@@ -0,0 +1,241 @@
+#include "../test/test.h"
+#include "fuzzy.hpp"
+
+#include <vector>
+#include <string>
+#include <random>
+#include <cstring>
+#include <algorithm>
+
+static bool test_edit_distance();
+static bool test_bk_tree();
+
+static ftest tests[] = {
+	test_edit_distance,
+	test_bk_tree,
+};
+
+typedef fuzzy::uint uint;
+
+static uint naive_distance(const std::string& a, const std::string& b)
+{
+	std::vector<std::vector<uint>> dp(a.size() + 1,
+		std::vector<uint>(b.size() + 1)
+	);
+	
+	for (size_t i = 0; i <= a.size(); ++i)
+		dp[i][0] = i;
+	for (size_t j = 0; j <= b.size(); ++j)
+		dp[0][j] = j;
+	
+	for (size_t i = 1; i <= a.size(); ++i)
+	{
+		for (size_t j = 1; j <= b.size(); ++j)
+		{
+			dp[i][j] = std::min(std::min(dp[i-1][j], dp[i][j-1]) + 1,
+				dp[i-1][j-1] + (a[i-1] != b[j-1])
+			);
+		}
+	}
+	
+	return dp[a.size()][b.size()];
+}
+
+static std::string random_str(std::mt19937& rng, size_t max_len)
+{
+	std::uniform_int_distribution<size_t> len(0, max_len);
+	std::uniform_int_distribution<int> ch('a', 'e');
+	
+	std::string str(len(rng), ' ');
+	for (auto& c : str)
+		c = ch(rng);
+	return str;
+}
+
+static bool test_edit_distance()
+{
+	using namespace fuzzy;
+	
+	{ // known
+		check(edit_distance("", 0, "", 0) == 0);
+		check(edit_distance("", 0, "abc", 3) == 3);
+		check(edit_distance("abc", 3, "", 0) == 3);
+		check(edit_distance("kitten", 6, "sitting", 7) == 3);
+		check(edit_distance("flaw", 4, "lawn", 4) == 2);
+		check(edit_distance("vendor", 6, "vednor", 6) == 2);
+		check(edit_distance("\xC3\xA9", 2, "e", 1) == 2);
+		
+		pattern pat("apple", 5);
+		check(pat.distance("apple", 5) == 0);
+		check(pat.distance("appel", 5) == 2);
+		check(pat.distance("aple", 4) == 1);
+		check(pat.distance("applesauce", 10) == 5);
+		check(pat.distance("", 0) == 5);
+	}
+	
+	{ // against the textbook version, both sides of 64 bytes
+		std::mt19937 rng(7);
+		for (int i = 0; i < 2000; ++i)
+		{
+			size_t max_len = (i % 4) ? 20 : 150;
+			std::string a = random_str(rng, max_len);
+			std::string b = random_str(rng, max_len);
+			
+			uint expected = naive_distance(a, b);
+			check(edit_distance(a.c_str(), a.size(), b.c_str(), b.size())
+				== expected
+			);
+			check(pattern(a.c_str(), a.size()).distance(b.c_str(), b.size())
+				== expected
+			);
+		}
+		
+		std::string a(64, 'a'), b(64, 'a');
+		b[63] = 'b';
+		check(edit_distance(a.c_str(), a.size(), b.c_str(), b.size()) == 1);
+		b += 'b';
+		check(edit_distance(a.c_str(), a.size(), b.c_str(), b.size()) == 2);
+	}
+	
+	return true;
+}
+
+static const char * get_word(const void * ctx, uint id)
+{
+	return (*(const std::vector<std::string> *)ctx)[id].c_str();
+}
+
+static bool test_bk_tree()
+{
+	using namespace fuzzy;
+	
+	std::vector<bk_tree::match> out;
+	
+	{ // empty
+		bk_tree tree;
+		tree.build(nullptr, 0, get_word, nullptr);
+		check(tree.size() == 0);
+		tree.within("abc", 2, get_word, nullptr, out);
+		check(out.empty());
+		tree.nearest("abc", 2, get_word, nullptr, out);
+		check(out.empty());
+	}
+	
+	{ // words
+		std::vector<std::string> words{
+			"apple", "apply", "ample", "maple", "apple", "banana", "bandana"
+		};
+		std::vector<uint> ids{0, 1, 2, 3, 4, 5, 6};
+		
+		bk_tree tree;
+		tree.build(ids.data(), ids.size(), get_word, &words);
+		check(tree.size() == 6);
+		
+		tree.within("aple", 1, get_word, &words, out);
+		check(out.size() == 3);
+		check(out[0].id == 0 && out[0].distance == 1);
+		check(out[1].id == 2 && out[1].distance == 1);
+		check(out[2].id == 3 && out[2].distance == 1);
+		
+		tree.within("appel", 2, get_word, &words, out);
+		check(out.size() == 2);
+		check(out[0].id == 0 && out[0].distance == 2);
+		check(out[1].id == 1 && out[1].distance == 2);
+		
+		tree.within("banana", 0, get_word, &words, out);
+		check(out.size() == 1);
+		check(out[0].id == 5);
+		
+		tree.nearest("bandanna", 2, get_word, &words, out);
+		check(out.size() == 2);
+		check(out[0].id == 6 && out[0].distance == 1);
+		check(out[1].id == 5 && out[1].distance == 2);
+		
+		tree.nearest("x", 0, get_word, &words, out);
+		check(out.empty());
+	}
+	
+	{ // against all pairs
+		std::mt19937 rng(11);
+		std::vector<std::string> words;
+		std::vector<uint> ids;
+		for (uint i = 0; i < 500; ++i)
+		{
+			words.push_back(random_str(rng, 8));
+			ids.push_back(i);
+		}
+		
+		bk_tree tree;
+		tree.build(ids.data(), ids.size(), get_word, &words);
+		
+		for (int q = 0; q < 50; ++q)
+		{
+			std::string query = random_str(rng, 8);
+			
+			std::vector<bk_tree::match> all;
+			for (uint i = 0; i < words.size(); ++i)
+			{
+				// of equal words only the first is in the tree
+				auto first = std::find(words.begin(), words.end(), words[i]);
+				if (first - words.begin() == i)
+					all.push_back(bk_tree::match(i, naive_distance(query, words[i])));
+			}
+			std::sort(all.begin(), all.end(),
+				[](const bk_tree::match& a, const bk_tree::match& b)
+				{
+					return (a.distance < b.distance ||
+						(a.distance == b.distance && a.id < b.id)
+					);
+				}
+			);
+			
+			for (uint k = 0; k < 4; ++k)
+			{
+				tree.within(query.c_str(), k, get_word, &words, out);
+				size_t expected = 0;
+				while (expected < all.size() && all[expected].distance <= k)
+					++expected;
+				check(out.size() == expected);
+				for (size_t i = 0; i < out.size(); ++i)
+					check(out[i].id == all[i].id);
+			}
+			
+			for (size_t n : {1, 3, 10})
+			{
+				tree.nearest(query.c_str(), n, get_word, &words, out);
+				check(out.size() == n);
+				for (size_t i = 0; i < n; ++i)
+				{
+					check(out[i].id == all[i].id);
+					check(out[i].distance == all[i].distance);
+				}
+			}
+		}
+	}
+	
+	return true;
+}
+
+static int passed, failed;
+void run_test_fuzzy(void)
+{
+    int i, end = sizeof(tests)/sizeof(*tests);
+
+    passed = 0;
+    for (i = 0; i < end; ++i)
+        if (tests[i]())
+            ++passed;
+
+    if (passed != end)
+        putchar('\n');
+
+    failed = end - passed;
+    report(passed, failed);
+    return;
+}
+
+int test_fuzzy_passed(void)
+{return passed;}
+
+int test_fuzzy_failed(void)
+{return failed;}
@@ -0,0 +1,6 @@
+#ifndef TEST_FUZZY_HPP
+#define TEST_FUZZY_HPP
+void run_test_fuzzy(void);
+int test_fuzzy_passed(void);
+int test_fuzzy_failed(void);
+#endif
@@ -0,0 +1,97 @@
+#include "learned_index.hpp"
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+uint64_t learned_index::key_of(const char * str)
+{
+	uint64_t key = 0;
+	int i = 0;
+	for (; i < 8 && str[i]; ++i)
+		key = (key << 8) | (unsigned char)str[i];
+	for (; i < 8; ++i)
+		key <<= 8;
+	return key;
+}
+
+void learned_index::build(const uint64_t * keys, size_t n, uint epsilon)
+{
+	_segments.clear();
+	_size = n;
+	_max_error = 0;
+	if (!n)
+		return;
+	
+	// the shrinking cone: every new key narrows the slopes which keep all
+	// keys of the segment within epsilon, and once none is left a new
+	// segment starts at that key
+	const double eps = epsilon;
+	const double inf = std::numeric_limits<double>::infinity();
+	segment seg = {keys[0], 0, 0};
+	double lo = 0, hi = inf;
+	for (size_t i = 1; i < n; ++i)
+	{
+		if (keys[i] == keys[i-1])
+			continue;
+		
+		double dx = (double)(keys[i] - seg.key);
+		double dy = (double)(i - seg.pos);
+		double slope_lo = (dy - eps) / dx;
+		double slope_hi = (dy + eps) / dx;
+		if (slope_lo > hi || slope_hi < lo)
+		{
+			seg.slope = (hi == inf) ? lo : (lo + hi) / 2;
+			_segments.push_back(seg);
+			seg.key = keys[i];
+			seg.pos = i;
+			lo = 0;
+			hi = inf;
+		}
+		else
+		{
+			lo = std::max(lo, slope_lo);
+			hi = std::min(hi, slope_hi);
+		}
+	}
+	seg.slope = (hi == inf) ? lo : (lo + hi) / 2;
+	_segments.push_back(seg);
+	_segments.shrink_to_fit();
+	
+	for (size_t i = 0; i < n; ++i)
+	{
+		if (i && keys[i] == keys[i-1])
+			continue;
+		
+		size_t pred = _predict(keys[i]);
+		size_t err = (pred > i) ? pred - i : i - pred;
+		_max_error = std::max(_max_error, err);
+	}
+}
+
+size_t learned_index::_predict(uint64_t key) const
+{
+	auto next = std::upper_bound(_segments.begin(), _segments.end(), key,
+		[](uint64_t key, const segment& seg) {return key < seg.key;}
+	);
+	if (next == _segments.begin())
+		return 0;
+	
+	const segment& seg = *(next - 1);
+	size_t end = (next == _segments.end()) ? _size : next->pos;
+	double pos = seg.pos + seg.slope * (double)(key - seg.key);
+	if (pos >= end)
+		return end;
+	return std::max((size_t)pos, (size_t)seg.pos);
+}
+
+std::pair<size_t, size_t> learned_index::window(uint64_t key) const
+{
+	if (_segments.empty())
+		return std::make_pair(0, 0);
+	
+	size_t pred = _predict(key);
+	size_t first = (pred > _max_error) ? pred - _max_error : 0;
+	size_t last = std::min(pred + _max_error + 1, _size);
+	return std::make_pair(first, last);
+}
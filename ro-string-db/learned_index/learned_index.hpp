@@ -0,0 +1,74 @@
+#ifndef LEARNED_INDEX_HPP
+#define LEARNED_INDEX_HPP
+
+#include <vector>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+
+class learned_index
+{
+	/*
+	   A piecewise linear model of where each of a sorted array of 64 bit keys
+	   is, in the manner of a PGM index. Upon build() the keys are walked
+	   once and cut in segments, each a line from its first key, so that the
+	   line misses the position of the first occurrence of every key in the
+	   segment by at most epsilon. The largest miss is then measured with
+	   the same arithmetic as window() uses, and that is the error bound.
+	   A lookup finds its segment by binary search over the first keys of
+	   the segments, which are few and fit in cache, and evaluates the line.
+	*/
+	public:
+	typedef unsigned int uint;
+	
+	learned_index() : _size(0), _max_error(0) {}
+	
+	static uint64_t key_of(const char * str);
+	/*
+	   The first eight bytes of str as a big endian number, padded with
+	   zeroes after the end of str, so that strcmp() order is key order,
+	   with strings sharing their first eight bytes as equal keys.
+	*/
+	
+	void build(const uint64_t * keys, size_t n, uint epsilon = 32);
+	/* Replaces the model with one of keys, which have to be sorted. */
+	
+	std::pair<size_t, size_t> window(uint64_t key) const;
+	/*
+	   Returns [first, last) positions which, for a key in the array, hold
+	   its first occurrence. For a key which is not, the window is where it
+	   would go if the line were right, and may miss. Without a model, e.g.
+	   before build(), the window is empty.
+	*/
+	
+	inline size_t size() const
+	{return _size;}
+	
+	inline size_t segments() const
+	{return _segments.size();}
+	
+	inline size_t max_error() const
+	{return _max_error;}
+	
+	inline size_t memory() const
+	{return _segments.capacity() * sizeof(segment);}
+	
+	private:
+	struct segment {
+		uint64_t key;
+		uint64_t pos;
+		double slope;
+	};
+	
+	size_t _predict(uint64_t key) const;
+	
+	std::vector<segment> _segments;
+	size_t _size;
+	size_t _max_error;
+};
+/*
+   Segment i holds the keys from _segments[i].key up to, not including, the
+   key of segment i+1, and predicts pos + slope * (key - _segments[i].key),
+   clamped between its own pos and the pos of the next segment.
+*/
+#endif
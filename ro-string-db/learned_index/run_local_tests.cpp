@@ -0,0 +1,7 @@
+#include "test_learned_index.hpp"
+
+int main()
+{
+	run_test_learned_index();
+	return test_learned_index_failed();
+}
@@ -0,0 +1,162 @@
+#include "../test/test.h"
+#include "learned_index.hpp"
+
+#include <string>
+#include <vector>
+#include <random>
+#include <cstring>
+#include <algorithm>
+
+static bool test_learned_index_key_of();
+static bool test_learned_index();
+
+static ftest tests[] = {
+	test_learned_index_key_of,
+	test_learned_index,
+};
+
+static bool test_learned_index_key_of()
+{
+	check(learned_index::key_of("") == 0);
+	check(learned_index::key_of("a") == 0x6100000000000000ull);
+	check(learned_index::key_of("abcdefgh") == 0x6162636465666768ull);
+	check(learned_index::key_of("abcdefghij") ==
+		learned_index::key_of("abcdefgh")
+	);
+	check(learned_index::key_of("\xff") == 0xff00000000000000ull);
+	
+	// key order follows strcmp() order
+	std::vector<std::string> strs{"", "a", "a\x01", "ab", "b", "id_1",
+		"id_10", "id_100", "id_2", "\x80", "\xff\xff"
+	};
+	bool in_order = true;
+	for (size_t i = 1; i < strs.size(); ++i)
+	{
+		in_order = in_order && strcmp(strs[i-1].c_str(), strs[i].c_str()) < 0;
+		in_order = in_order && learned_index::key_of(strs[i-1].c_str()) <
+			learned_index::key_of(strs[i].c_str());
+	}
+	check(in_order);
+	
+	return true;
+}
+
+static bool in_window(const learned_index& model,
+	const std::vector<uint64_t>& keys
+)
+{
+	// the first occurrence of every key is inside its window
+	for (size_t i = 0; i < keys.size(); ++i)
+	{
+		if (i && keys[i] == keys[i-1])
+			continue;
+		
+		auto win = model.window(keys[i]);
+		if (i < win.first || i >= win.second)
+			return false;
+		if (win.second - win.first > 2 * model.max_error() + 1)
+			return false;
+	}
+	return true;
+}
+
+static bool test_learned_index()
+{
+	{ // empty
+		learned_index model;
+		check(model.window(5) == std::make_pair((size_t)0, (size_t)0));
+		model.build(nullptr, 0);
+		check(model.size() == 0);
+		check(model.segments() == 0);
+		check(model.window(5) == std::make_pair((size_t)0, (size_t)0));
+	}
+	
+	{ // one key
+		uint64_t key = 42;
+		learned_index model;
+		model.build(&key, 1);
+		check(model.segments() == 1);
+		check(model.max_error() == 0);
+		check(model.window(42) == std::make_pair((size_t)0, (size_t)1));
+		check(model.window(1) == std::make_pair((size_t)0, (size_t)1));
+		check(model.window(100) == std::make_pair((size_t)0, (size_t)1));
+	}
+	
+	{ // a line is one segment with no error
+		std::vector<uint64_t> keys;
+		for (uint64_t i = 0; i < 10000; ++i)
+			keys.push_back(1000 + i * 7);
+		
+		learned_index model;
+		model.build(keys.data(), keys.size(), 4);
+		check(model.segments() == 1);
+		check(model.max_error() <= 1);
+		check(in_window(model, keys));
+		check(model.memory() > 0);
+	}
+	
+	std::mt19937_64 rng(3);
+	for (unsigned eps : {0, 1, 8, 32, 128})
+	{
+		// random keys with runs of duplicates
+		std::vector<uint64_t> keys;
+		for (int i = 0; i < 20000; ++i)
+		{
+			uint64_t key = rng() >> (rng() % 40);
+			int times = 1 + (rng() % 8 == 0) * (rng() % 50);
+			for (int j = 0; j < times; ++j)
+				keys.push_back(key);
+		}
+		std::sort(keys.begin(), keys.end());
+		
+		learned_index model;
+		model.build(keys.data(), keys.size(), eps);
+		check(model.size() == keys.size());
+		check(model.max_error() <= eps + 1);
+		check(in_window(model, keys));
+		check(model.segments() < keys.size());
+	}
+	
+	{ // keys from strings like generate_csv.txt makes
+		std::vector<std::string> strs;
+		for (int i = 1; i < 100000; ++i)
+			strs.push_back("id_" + std::to_string(i));
+		std::sort(strs.begin(), strs.end());
+		
+		std::vector<uint64_t> keys;
+		for (auto& str : strs)
+			keys.push_back(learned_index::key_of(str.c_str()));
+		
+		learned_index model;
+		model.build(keys.data(), keys.size(), 32);
+		check(model.max_error() <= 33);
+		check(in_window(model, keys));
+		check(model.segments() < keys.size() / 20);
+	}
+	
+	return true;
+}
+
+static int passed, failed;
+void run_test_learned_index(void)
+{
+    int i, end = sizeof(tests)/sizeof(*tests);
+
+    passed = 0;
+    for (i = 0; i < end; ++i)
+        if (tests[i]())
+            ++passed;
+
+    if (passed != end)
+        putchar('\n');
+
+    failed = end - passed;
+    report(passed, failed);
+    return;
+}
+
+int test_learned_index_passed(void)
+{return passed;}
+
+int test_learned_index_failed(void)
+{return failed;}
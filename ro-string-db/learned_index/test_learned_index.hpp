@@ -0,0 +1,6 @@
+#ifndef TEST_LEARNED_INDEX_HPP
+#define TEST_LEARNED_INDEX_HPP
+void run_test_learned_index(void);
+int test_learned_index_passed(void);
+int test_learned_index_failed(void);
+#endif
@@ -0,0 +1,265 @@
+#include "lookup_cache.hpp"
+
+#include <stdexcept>
+#include <functional>
+
+#define throw_str(str) "lookup_cache: " str
+
+lookup_cache::lookup_cache(size_t max_bytes, uint shards) :
+	_max_bytes(max_bytes),
+	_shard_bytes(0)
+{
+	if (!max_bytes)
+		throw std::runtime_error(throw_str("max_bytes is 0"));
+	if (!shards)
+		throw std::runtime_error(throw_str("shards is 0"));
+	
+	// a few counters for each small entry a shard can hold keeps the
+	// estimates apart from the noise of the other keys; the sketch is paid
+	// for out of the budget of the shard
+	size_t share = max_bytes / shards;
+	size_t counters = 64;
+	while (counters < share / 32)
+		counters *= 2;
+	
+	std::vector<shard>(shards).swap(_shards);
+	for (auto& shr : _shards)
+		shr.freq = sketch(counters);
+	
+	size_t sketch_bytes = _shards[0].freq.memory();
+	_shard_bytes = (share > sketch_bytes) ? share - sketch_bytes : 0;
+}
+
+uint64_t lookup_cache::_hash(const std::string& key)
+{
+	// std::hash may be the identity for some types and weak in its high
+	// bits, so the splitmix64 finalizer spreads it
+	uint64_t h = std::hash<std::string>()(key);
+	h ^= h >> 30;
+	h *= 0xBF58476D1CE4E5B9ull;
+	h ^= h >> 27;
+	h *= 0x94D049BB133111EBull;
+	h ^= h >> 31;
+	return h;
+}
+
+size_t lookup_cache::_entry_bytes(const std::string& key, const result& res)
+{
+	// the slot, the key in both the slot and the index, the cells, and
+	// about two pointers of hash table bookkeeping
+	return sizeof(slot) + sizeof(std::pair<const std::string, size_t>) +
+		2 * (key.size() + sizeof(void *)) +
+		res.cells.size() * sizeof(const char *);
+}
+
+bool lookup_cache::get(const std::string& key, result& out)
+{
+	uint64_t hash = _hash(key);
+	shard& shr = _shard_of(hash);
+	std::lock_guard<std::mutex> guard(shr.lock);
+	
+	shr.freq.add(hash);
+	auto it = shr.index.find(key);
+	if (it == shr.index.end())
+	{
+		++shr.counts.misses;
+		return false;
+	}
+	
+	slot& hit = shr.slots[it->second];
+	hit.marked = true;
+	out = hit.res;
+	++shr.counts.hits;
+	return true;
+}
+
+size_t lookup_cache::_find_victims(const shard& shr,
+	size_t need,
+	std::vector<size_t>& out
+)
+{
+	/*
+	   Sweeps as the hand would, without moving it or touching the marks:
+	   the first time around the unmarked entries are the victims, and the
+	   marked ones only lose their marks, so they are the victims the second
+	   time around. need is within the budget, so this ends within two
+	   sweeps. Returns the number of slots swept.
+	*/
+	out.clear();
+	size_t size = shr.slots.size();
+	size_t freed = 0;
+	size_t steps = 0;
+	for (; shr.bytes - freed + need > _shard_bytes; ++steps)
+	{
+		const slot& cand = shr.slots[(shr.hand + steps) % size];
+		if (cand.used && cand.marked == (steps >= size))
+		{
+			out.push_back((shr.hand + steps) % size);
+			freed += cand.bytes;
+		}
+	}
+	return steps;
+}
+
+void lookup_cache::_evict(shard& shr, size_t at)
+{
+	slot& victim = shr.slots[at];
+	shr.index.erase(victim.key);
+	shr.bytes -= victim.bytes;
+	victim = slot();
+	shr.free_slots.push_back(at);
+}
+
+void lookup_cache::put(const std::string& key, const result& res)
+{
+	size_t need = _entry_bytes(key, res);
+	if (need > _shard_bytes)
+		return;
+	
+	uint64_t hash = _hash(key);
+	shard& shr = _shard_of(hash);
+	std::lock_guard<std::mutex> guard(shr.lock);
+	
+	// the results of a key don't change, so a cached one is kept
+	if (shr.index.count(key))
+		return;
+	
+	// admitted only if more frequent than every entry it would push out,
+	// so a rejected entry evicts nothing
+	std::vector<size_t> victims;
+	size_t steps = _find_victims(shr, need, victims);
+	uint freq = shr.freq.estimate(hash);
+	for (size_t at : victims)
+	{
+		if (shr.freq.estimate(shr.slots[at].hash) >= freq)
+		{
+			++shr.counts.rejections;
+			return;
+		}
+	}
+	
+	for (size_t i = 0; i < steps; ++i)
+		shr.slots[(shr.hand + i) % shr.slots.size()].marked = false;
+	if (steps)
+		shr.hand = (shr.hand + steps) % shr.slots.size();
+	
+	for (size_t at : victims)
+	{
+		_evict(shr, at);
+		++shr.counts.evictions;
+	}
+	
+	size_t at = shr.slots.size();
+	if (shr.free_slots.empty())
+		shr.slots.push_back(slot());
+	else
+	{
+		at = shr.free_slots.back();
+		shr.free_slots.pop_back();
+	}
+	
+	slot& ins = shr.slots[at];
+	ins.used = true;
+	ins.marked = true;
+	ins.hash = hash;
+	ins.bytes = need;
+	ins.key = key;
+	ins.res = res;
+	shr.index[key] = at;
+	shr.bytes += need;
+}
+
+void lookup_cache::clear()
+{
+	for (auto& shr : _shards)
+	{
+		std::lock_guard<std::mutex> guard(shr.lock);
+		std::unordered_map<std::string, size_t>().swap(shr.index);
+		std::vector<slot>().swap(shr.slots);
+		std::vector<size_t>().swap(shr.free_slots);
+		shr.hand = 0;
+		shr.bytes = 0;
+		shr.freq.clear();
+	}
+}
+
+void lookup_cache::get_stats(stats& out) const
+{
+	out = stats();
+	for (auto& shr : _shards)
+	{
+		std::lock_guard<std::mutex> guard(shr.lock);
+		out.hits += shr.counts.hits;
+		out.misses += shr.counts.misses;
+		out.evictions += shr.counts.evictions;
+		out.rejections += shr.counts.rejections;
+		out.entries += shr.index.size();
+		out.bytes += shr.bytes + shr.freq.memory();
+	}
+}
+
+lookup_cache::sketch::sketch(size_t counters) :
+	_words((counters * ROWS + 15) / 16, 0),
+	_mask(counters ? counters - 1 : 0),
+	_adds(0),
+	_sample(counters * 10)
+{}
+
+inline size_t lookup_cache::sketch::_counter_of(uint64_t hash, uint row) const
+{
+	static const uint64_t seed[ROWS] = {
+		0x9E3779B97F4A7C15ull, 0xC2B2AE3D27D4EB4Full,
+		0x165667B19E3779F9ull, 0xD6E8FEB86659FD93ull
+	};
+	uint64_t mixed = (hash ^ seed[row]) * 0x2545F4914F6CDD1Dull;
+	return row * (_mask + 1) + ((mixed >> 32) & _mask);
+}
+
+uint lookup_cache::sketch::estimate(uint64_t hash) const
+{
+	if (_words.empty())
+		return 0;
+	
+	uint min = 15;
+	for (uint row = 0; row < ROWS; ++row)
+	{
+		size_t at = _counter_of(hash, row);
+		uint count = (_words[at / 16] >> ((at % 16) * 4)) & 0xF;
+		if (count < min)
+			min = count;
+	}
+	return min;
+}
+
+void lookup_cache::sketch::add(uint64_t hash)
+{
+	if (_words.empty())
+		return;
+	
+	for (uint row = 0; row < ROWS; ++row)
+	{
+		size_t at = _counter_of(hash, row);
+		uint shift = (at % 16) * 4;
+		if (((_words[at / 16] >> shift) & 0xF) < 15)
+			_words[at / 16] += (uint64_t)1 << shift;
+	}
+	
+	if (++_adds >= _sample)
+		_halve();
+}
+
+void lookup_cache::sketch::_halve()
+{
+	// shifting the whole word right moves the low bit of each counter into
+	// the high bit of the one below, so those are masked off
+	for (auto& word : _words)
+		word = (word >> 1) & 0x7777777777777777ull;
+	_adds /= 2;
+}
+
+void lookup_cache::sketch::clear()
+{
+	for (auto& word : _words)
+		word = 0;
+	_adds = 0;
+}
@@ -0,0 +1,151 @@
+#ifndef LOOKUP_CACHE_HPP
+#define LOOKUP_CACHE_HPP
+
+#include <mutex>
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+
+class lookup_cache
+{
+	/*
+	   A bounded, thread safe map of lookup keys to lookup results, which are
+	   a found flag and a vector of string pointers. The cache is split in
+	   shards by the hash of the key, each with its own lock and its own
+	   share of the byte budget, so threads seldom wait on each other.
+	
+	   Each shard evicts with CLOCK: a hit marks its entry, and the hand
+	   sweeps the entries, unmarking the marked ones, until it finds one
+	   which is not marked. A new entry is admitted by TinyLFU: a count-min
+	   sketch of 4 bit counters estimates how often each key was asked for,
+	   hit or miss, and the new entry only replaces the victim if its key was
+	   asked for more often. The counters are halved every so many accesses,
+	   so the estimates follow the recent traffic. A scan of keys seen once
+	   therefore doesn't push out the keys which are asked for all the time.
+	*/
+	public:
+	typedef unsigned int uint;
+	
+	struct result {
+		result() : found(false) {}
+		bool found;
+		std::vector<const char *> cells;
+	};
+	
+	struct stats {
+		stats() :
+			hits(0), misses(0), evictions(0), rejections(0), entries(0), bytes(0)
+		{}
+		size_t hits;
+		size_t misses;
+		size_t evictions;
+		size_t rejections;
+		size_t entries;
+		size_t bytes;
+	};
+	/*
+	   rejections counts the new entries which TinyLFU didn't admit. bytes is
+	   the memory used by the entries, the keys and the sketches.
+	*/
+	
+	lookup_cache(size_t max_bytes, uint shards = 16);
+	/*
+	   max_bytes bounds the memory of the entries, the keys and the sketches
+	   together, split evenly between the shards. Throws if max_bytes or
+	   shards is 0.
+	*/
+	
+	bool get(const std::string& key, result& out);
+	/*
+	   Places the result cached for key in out and returns true, or returns
+	   false and leaves out alone.
+	*/
+	
+	void put(const std::string& key, const result& res);
+	/*
+	   Caches res for key, if admitted. A result larger than the budget of a
+	   shard is never cached.
+	*/
+	
+	void clear();
+	/* Drops all entries and resets the sketches, but not the counters. */
+	
+	void get_stats(stats& out) const;
+	
+	inline size_t max_bytes() const
+	{return _max_bytes;}
+	
+	private:
+	class sketch
+	{
+		public:
+		sketch(size_t counters = 0);
+		
+		void add(uint64_t hash);
+		uint estimate(uint64_t hash) const;
+		void clear();
+		
+		inline size_t memory() const
+		{return _words.capacity() * sizeof(uint64_t);}
+		
+		private:
+		static const uint ROWS = 4;
+		
+		inline size_t _counter_of(uint64_t hash, uint row) const;
+		void _halve();
+		
+		std::vector<uint64_t> _words;
+		size_t _mask;
+		size_t _adds;
+		size_t _sample;
+	};
+	/*
+	   A count-min sketch of 4 bit counters, 16 to a word. A key has one
+	   counter in each of ROWS rows and its estimate is the smallest of them.
+	   After _sample adds all counters are halved.
+	*/
+	
+	struct slot {
+		slot() : used(false), marked(false), hash(0), bytes(0) {}
+		bool used;
+		bool marked;
+		uint64_t hash;
+		size_t bytes;
+		std::string key;
+		result res;
+	};
+	
+	struct shard {
+		shard() : hand(0), bytes(0) {}
+		mutable std::mutex lock;
+		std::unordered_map<std::string, size_t> index;
+		std::vector<slot> slots;
+		std::vector<size_t> free_slots;
+		size_t hand;
+		size_t bytes;
+		sketch freq;
+		stats counts;
+	};
+	
+	static uint64_t _hash(const std::string& key);
+	static size_t _entry_bytes(const std::string& key, const result& res);
+	size_t _find_victims(const shard& shr,
+		size_t need,
+		std::vector<size_t>& out
+	);
+	static void _evict(shard& shr, size_t at);
+	
+	inline shard& _shard_of(uint64_t hash)
+	{return _shards[(hash >> 32) % _shards.size()];}
+	
+	std::vector<shard> _shards;
+	size_t _max_bytes;
+	size_t _shard_bytes;
+};
+/*
+   A slot which is not used is on free_slots, and index maps each cached key
+   to its slot. bytes of a shard is the sum of bytes of its used slots.
+*/
+#endif
@@ -0,0 +1,7 @@
+#include "test_lookup_cache.hpp"
+
+int main()
+{
+	run_test_lookup_cache();
+	return test_lookup_cache_failed();
+}
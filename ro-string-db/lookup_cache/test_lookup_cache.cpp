@@ -0,0 +1,260 @@
+#include "../test/test.h"
+#include "lookup_cache.hpp"
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <stdexcept>
+
+static bool test_lookup_cache();
+static bool test_lookup_cache_scan();
+static bool test_lookup_cache_admission();
+static bool test_lookup_cache_threads();
+
+static ftest tests[] = {
+	test_lookup_cache,
+	test_lookup_cache_scan,
+	test_lookup_cache_admission,
+	test_lookup_cache_threads,
+};
+
+static bool didnt_throw = false;
+
+static lookup_cache::result make_result(bool found,
+	const std::vector<const char *>& cells
+)
+{
+	lookup_cache::result res;
+	res.found = found;
+	res.cells = cells;
+	return res;
+}
+
+static bool test_lookup_cache()
+{
+	const char * apple = "apple";
+	const char * pear = "pear";
+	
+	lookup_cache cache(1 << 16, 4);
+	check(cache.max_bytes() == 1 << 16);
+	
+	lookup_cache::stats st;
+	cache.get_stats(st);
+	check(st.hits == 0 && st.misses == 0 && st.entries == 0);
+	check(st.bytes > 0);
+	
+	lookup_cache::result res;
+	check(!cache.get("a", res));
+	cache.put("a", make_result(true, {apple, pear}));
+	check(cache.get("a", res));
+	check(res.found);
+	check(res.cells.size() == 2);
+	check(res.cells[0] == apple && res.cells[1] == pear);
+	
+	// misses are cached too
+	cache.put("b", make_result(false, {}));
+	res = make_result(true, {apple});
+	check(cache.get("b", res));
+	check(!res.found);
+	check(res.cells.empty());
+	
+	// keys may hold '\0'
+	std::string k1("x\0y", 3), k2("x\0z", 3);
+	cache.put(k1, make_result(true, {apple}));
+	check(cache.get(k1, res));
+	check(!cache.get(k2, res));
+	
+	// the first result for a key stays
+	cache.put("a", make_result(true, {pear}));
+	check(cache.get("a", res));
+	check(res.cells.size() == 2);
+	
+	cache.get_stats(st);
+	check(st.hits == 4);
+	check(st.misses == 2);
+	check(st.entries == 3);
+	check(st.evictions == 0);
+	
+	// larger than a shard
+	std::vector<const char *> big(1 << 12, apple);
+	cache.put("big", make_result(true, big));
+	check(!cache.get("big", res));
+	
+	cache.clear();
+	check(!cache.get("a", res));
+	cache.get_stats(st);
+	check(st.entries == 0);
+	check(st.hits == 4);
+	
+	try {lookup_cache bad(0); check(didnt_throw);}
+	catch (std::runtime_error& e)
+	{check(e.what() == std::string("lookup_cache: max_bytes is 0"));}
+	
+	try {lookup_cache bad(1024, 0); check(didnt_throw);}
+	catch (std::runtime_error& e)
+	{check(e.what() == std::string("lookup_cache: shards is 0"));}
+	
+	return true;
+}
+
+static bool test_lookup_cache_scan()
+{
+	const char * val = "val";
+	const size_t budget = 1 << 15;
+	lookup_cache cache(budget, 1);
+	lookup_cache::result res;
+	
+	// a cache miss is followed by a put, like a lookup would
+	auto ask = [&cache, &res, val](const std::string& key)
+	{
+		bool hit = cache.get(key, res);
+		if (!hit)
+			cache.put(key, make_result(true, {val}));
+		return hit;
+	};
+	
+	std::vector<std::string> hot;
+	for (int i = 0; i < 20; ++i)
+		hot.push_back("hot" + std::to_string(i));
+	
+	for (int round = 0; round < 5; ++round)
+	{
+		for (auto& key : hot)
+			ask(key);
+	}
+	
+	lookup_cache::stats st;
+	cache.get_stats(st);
+	check(st.hits == 80);
+	
+	// a scan of keys asked for once each, far more than fit, while the hot
+	// keys are still asked for now and then
+	for (int i = 0; i < 20000; ++i)
+	{
+		ask("cold" + std::to_string(i));
+		if (i % 500 == 499)
+		{
+			for (auto& key : hot)
+				ask(key);
+		}
+	}
+	
+	cache.get_stats(st);
+	check(st.entries > 20);
+	check(st.evictions > 0);
+	check(st.rejections > st.evictions);
+	check(st.bytes <= budget);
+	
+	bool all_hot = true;
+	for (auto& key : hot)
+		all_hot = all_hot && ask(key);
+	check(all_hot);
+	
+	return true;
+}
+
+static bool test_lookup_cache_admission()
+{
+	const char * val = "val";
+	const size_t budget = 1 << 12;
+	lookup_cache cache(budget, 1);
+	lookup_cache::result res;
+	
+	// most of the shard in small entries, the last one the hand reaches hot
+	for (int i = 0; i < 20; ++i)
+	{
+		std::string key = "s" + std::to_string(i);
+		if (!cache.get(key, res))
+			cache.put(key, make_result(true, {val}));
+	}
+	for (int i = 0; i < 10; ++i)
+		check(cache.get("s19", res));
+	
+	lookup_cache::stats before;
+	cache.get_stats(before);
+	check(before.entries == 20);
+	check(before.evictions == 0);
+	
+	// an entry that pushes out everything, the hot one among the victims;
+	// it is rejected before any of the colder victims is evicted
+	std::vector<const char *> big(budget / sizeof(val) - 64, val);
+	for (int i = 0; i < 5; ++i)
+		check(!cache.get("big", res));
+	cache.put("big", make_result(true, big));
+	
+	lookup_cache::stats after;
+	cache.get_stats(after);
+	check(!cache.get("big", res));
+	check(after.entries == before.entries);
+	check(after.evictions == before.evictions);
+	check(after.rejections == before.rejections + 1);
+	check(cache.get("s19", res));
+	
+	// hotter than every victim, so it gets in
+	for (int i = 0; i < 20; ++i)
+		check(!cache.get("bigger", res));
+	cache.put("bigger", make_result(true, big));
+	check(cache.get("bigger", res));
+	check(res.cells.size() == big.size());
+	
+	cache.get_stats(after);
+	check(after.evictions > before.evictions);
+	check(after.bytes <= budget);
+	
+	return true;
+}
+
+static bool test_lookup_cache_threads()
+{
+	const char * val = "val";
+	lookup_cache cache(1 << 14, 4);
+	
+	std::vector<std::thread> workers;
+	for (int t = 0; t < 4; ++t)
+	{
+		workers.push_back(std::thread([&cache, val, t]()
+			{
+				lookup_cache::result res;
+				for (int i = 0; i < 5000; ++i)
+				{
+					std::string key = std::to_string((i * (t + 1)) % 300);
+					if (!cache.get(key, res))
+						cache.put(key, make_result(true, {val}));
+				}
+			}
+		));
+	}
+	for (auto& thr : workers)
+		thr.join();
+	
+	lookup_cache::stats st;
+	cache.get_stats(st);
+	check(st.hits + st.misses == 20000);
+	check(st.hits > st.misses);
+	
+	return true;
+}
+
+static int passed, failed;
+void run_test_lookup_cache(void)
+{
+    int i, end = sizeof(tests)/sizeof(*tests);
+
+    passed = 0;
+    for (i = 0; i < end; ++i)
+        if (tests[i]())
+            ++passed;
+
+    if (passed != end)
+        putchar('\n');
+
+    failed = end - passed;
+    report(passed, failed);
+    return;
+}
+
+int test_lookup_cache_passed(void)
+{return passed;}
+
+int test_lookup_cache_failed(void)
+{return failed;}
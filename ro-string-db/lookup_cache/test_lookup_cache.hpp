@@ -0,0 +1,6 @@
+#ifndef TEST_LOOKUP_CACHE_HPP
+#define TEST_LOOKUP_CACHE_HPP
+void run_test_lookup_cache(void);
+int test_lookup_cache_passed(void);
+int test_lookup_cache_failed(void);
+#endif
@@ -18,6 +18,9 @@ class matrix
         inline T& get(uint row, uint col)
         {return _memory[_index(row, col)];}
         
+        inline const T& get(uint row, uint col) const
+        {return _memory[_index(row, col)];}
+        
         inline void place(uint row, uint col, const T& what)
         {_memory[_index(row, col)] = what;}
 
@@ -32,7 +35,7 @@ class matrix
 		{return _memory;}
 
     private:
-        inline uint _index(uint row, uint col)
+        inline uint _index(uint row, uint col) const
         {return row*_width+col;}
 
         std::vector<T> _memory;
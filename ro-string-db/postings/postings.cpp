@@ -0,0 +1,97 @@
+#include "postings.hpp"
+
+#include <stdexcept>
+
+#define throw_str(str) "postings: " str
+
+postings::uint postings::append_list(const uint * lines, size_t n)
+{
+	uint prev = 0;
+	for (size_t i = 0; i < n; ++i)
+	{
+		if (lines[i] < prev)
+			throw std::runtime_error(throw_str("lines not in ascending order"));
+		
+		_put_varint(lines[i] - prev);
+		prev = lines[i];
+	}
+	
+	_starts.push_back(_starts.back() + n);
+	_offsets.push_back(_bytes.size());
+	return num_lists() - 1;
+}
+
+postings::uint postings::first(uint list) const
+{
+	reader rd(*this, list, list+1);
+	uint line = 0;
+	rd.next(line);
+	return line;
+}
+
+void postings::decode(uint first_list,
+	uint end_list,
+	std::vector<uint>& out
+) const
+{
+	reader rd(*this, first_list, end_list);
+	out.reserve(out.size() + rd.size());
+	
+	uint line = 0;
+	while (rd.next(line))
+		out.push_back(line);
+}
+
+void postings::shrink_to_fit()
+{
+	_bytes.shrink_to_fit();
+	_starts.shrink_to_fit();
+	_offsets.shrink_to_fit();
+}
+
+size_t postings::memory() const
+{
+	return _bytes.capacity() +
+		(_starts.capacity() + _offsets.capacity()) * sizeof(size_t);
+}
+
+void postings::_put_varint(uint val)
+{
+	while (val >= 0x80)
+	{
+		_bytes.push_back(byte(val | 0x80));
+		val >>= 7;
+	}
+	_bytes.push_back(byte(val));
+}
+
+// class postings::reader
+postings::reader::reader(const postings& post, uint first_list, uint end_list) :
+	_post(&post),
+	_first(first_list),
+	_end(end_list)
+{
+	if (first_list > end_list || end_list > post.num_lists())
+		throw std::runtime_error(throw_str("reader: list out of range"));
+	
+	rewind();
+}
+
+size_t postings::reader::skip(size_t n)
+{
+	size_t i = 0;
+	uint line = 0;
+	for (; i < n && next(line); ++i)
+		continue;
+	return i;
+}
+
+void postings::reader::rewind()
+{
+	_list = _first;
+	_left = (_first < _end) ? _post->count(_first) : 0;
+	_last = 0;
+	_bytes = _post->_bytes.data() + _post->_offsets[_first];
+	_size = _post->count(_first, _end);
+	_done = 0;
+}
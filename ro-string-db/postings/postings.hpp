@@ -0,0 +1,134 @@
+#ifndef POSTINGS_HPP
+#define POSTINGS_HPP
+
+#include <vector>
+#include <cstddef>
+
+class postings
+{
+	/*
+	   A number of ascending lists of line numbers, compressed one after the
+	   other in a single byte vector. Each number is stored as the difference
+	   from the previous one in its list as a varint - seven bits per byte,
+	   the high bit set on all bytes but the last. The first number of a list
+	   is the difference from 0. Dense lists of lines take a byte or two per
+	   line instead of four.
+	*/
+	public:
+	typedef unsigned int uint;
+	typedef unsigned char byte;
+	
+	postings() : _starts{0}, _offsets{0} {}
+	
+	uint append_list(const uint * lines, size_t n);
+	/*
+	   Appends a list of n line numbers, which have to be ascending. Returns
+	   the number of the list.
+	*/
+	
+	inline uint num_lists() const
+	{return _starts.size() - 1;}
+	
+	inline size_t count(uint list) const
+	{return _starts[list+1] - _starts[list];}
+	
+	inline size_t count(uint first_list, uint end_list) const
+	{return _starts[end_list] - _starts[first_list];}
+	/* The number of lines in lists first_list up to, not including, end_list. */
+	
+	uint first(uint list) const;
+	/* The first line of list. */
+	
+	void decode(uint first_list, uint end_list, std::vector<uint>& out) const;
+	/* Appends the lines of lists first_list to end_list - 1 to out. */
+	
+	void shrink_to_fit();
+	
+	size_t memory() const;
+	/* Bytes used by the lists and their bookkeeping. */
+	
+	class reader
+	{
+		/*
+		   Decodes the lines of a number of consecutive lists one at a time,
+		   so they can be streamed without being placed anywhere. Lines come
+		   in list order, and in ascending order within each list.
+		*/
+		public:
+		reader() :
+			_post(nullptr),
+			_first(0),
+			_end(0),
+			_list(0),
+			_left(0),
+			_last(0),
+			_bytes(nullptr),
+			_size(0),
+			_done(0)
+		{}
+		
+		reader(const postings& post, uint first_list, uint end_list);
+		
+		inline bool next(uint& out_line)
+		{
+			if (_done == _size)
+				return false;
+			
+			while (!_left)
+			{
+				++_list;
+				_left = _post->count(_list);
+				_last = 0;
+			}
+			
+			uint val = 0, shift = 0;
+			byte ch = 0;
+			do
+			{
+				ch = *_bytes++;
+				val |= uint(ch & 0x7F) << shift;
+				shift += 7;
+			} while (ch & 0x80);
+			
+			_last += val;
+			--_left;
+			++_done;
+			out_line = _last;
+			return true;
+		}
+		/* Places the next line in out_line. Returns false at the end. */
+		
+		size_t skip(size_t n);
+		/* Moves n lines forward. Returns how many. */
+		
+		void rewind();
+		
+		inline size_t size() const
+		{return _size;}
+		
+		inline size_t remaining() const
+		{return _size - _done;}
+		
+		inline bool is_valid() const
+		{return (nullptr != _post);}
+		
+		private:
+		const postings * _post;
+		uint _first;
+		uint _end;
+		uint _list;
+		size_t _left;
+		uint _last;
+		const byte * _bytes;
+		size_t _size;
+		size_t _done;
+	};
+	
+	private:
+	void _put_varint(uint val);
+	
+	std::vector<byte> _bytes;
+	std::vector<size_t> _starts;
+	std::vector<size_t> _offsets;
+};
+#endif
@@ -0,0 +1,7 @@
+#include "test_postings.hpp"
+
+int main()
+{
+	run_test_postings();
+	return test_postings_failed();
+}
@@ -0,0 +1,151 @@
+#include "../test/test.h"
+#include "postings.hpp"
+
+#include <vector>
+#include <string>
+#include <stdexcept>
+
+static bool test_postings();
+static bool test_postings_reader();
+
+static ftest tests[] = {
+	test_postings,
+	test_postings_reader,
+};
+
+static bool didnt_throw = false;
+
+typedef postings::uint uint;
+
+static bool test_postings()
+{
+	postings post;
+	check(post.num_lists() == 0);
+	
+	std::vector<uint> a{1, 2, 3, 200, 70000, 4000000000u};
+	std::vector<uint> b;
+	std::vector<uint> c{5};
+	
+	check(post.append_list(a.data(), a.size()) == 0);
+	check(post.append_list(b.data(), b.size()) == 1);
+	check(post.append_list(c.data(), c.size()) == 2);
+	
+	check(post.num_lists() == 3);
+	check(post.count(0) == 6);
+	check(post.count(1) == 0);
+	check(post.count(2) == 1);
+	check(post.count(0, 3) == 7);
+	check(post.first(0) == 1);
+	check(post.first(2) == 5);
+	
+	std::vector<uint> out;
+	post.decode(0, 1, out);
+	check(out == a);
+	
+	out.clear();
+	post.decode(0, 3, out);
+	check(out.size() == 7);
+	check(out[5] == 4000000000u);
+	check(out[6] == 5);
+	
+	out.clear();
+	post.decode(1, 2, out);
+	check(out.empty());
+	
+	// 1 + 1 + 1 + 2 + 3 + 5 bytes for a, 1 for c
+	post.shrink_to_fit();
+	check(post.memory() >= 14);
+	
+	{ // throw on unsorted
+		std::vector<uint> bad{3, 2};
+		try {post.append_list(bad.data(), bad.size()); check(didnt_throw);}
+		catch (std::runtime_error& e)
+		{
+			std::string expected("postings: lines not in ascending order");
+			check(expected == e.what());
+		}
+	}
+	
+	return true;
+}
+
+static bool test_postings_reader()
+{
+	postings post;
+	std::vector<std::vector<uint>> lists;
+	for (uint l = 0; l < 20; ++l)
+	{
+		std::vector<uint> lines;
+		for (uint i = l; i < 5000; i += l + 1)
+			lines.push_back(i * (l % 3 + 1));
+		if (l % 7 == 3)
+			lines.clear();
+		lists.push_back(lines);
+		post.append_list(lines.data(), lines.size());
+	}
+	
+	postings::reader empty;
+	check(!empty.is_valid());
+	
+	for (uint first = 0; first < 20; first += 3)
+	{
+		for (uint end = first; end <= 20; end += 4)
+		{
+			std::vector<uint> expected;
+			for (uint l = first; l < end; ++l)
+				expected.insert(expected.end(), lists[l].begin(), lists[l].end());
+			
+			postings::reader rd(post, first, end);
+			check(rd.is_valid());
+			check(rd.size() == expected.size());
+			
+			std::vector<uint> got;
+			uint line = 0;
+			while (rd.next(line))
+				got.push_back(line);
+			check(got == expected);
+			check(rd.remaining() == 0);
+			check(!rd.next(line));
+			
+			rd.rewind();
+			check(rd.remaining() == expected.size());
+			size_t skipped = rd.skip(10);
+			check(skipped == std::min<size_t>(10, expected.size()));
+			if (rd.next(line))
+				check(line == expected[10]);
+		}
+	}
+	
+	try {postings::reader rd(post, 3, 21); check(didnt_throw);}
+	catch (std::runtime_error& e)
+	{
+		std::string expected("postings: reader: list out of range");
+		check(expected == e.what());
+	}
+	
+	return true;
+}
+
+static int passed, failed;
+void run_test_postings(void)
+{
+    int i, end = sizeof(tests)/sizeof(*tests);
+
+    passed = 0;
+    for (i = 0; i < end; ++i)
+        if (tests[i]())
+            ++passed;
+
+    if (passed != end)
+        putchar('\n');
+
+    failed = end - passed;
+    report(passed, failed);
+    return;
+}
+
+int test_postings_passed(void)
+{return passed;}
+
+int test_postings_failed(void)
+{return failed;}
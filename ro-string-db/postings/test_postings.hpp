@@ -0,0 +1,6 @@
+#ifndef TEST_POSTINGS_HPP
+#define TEST_POSTINGS_HPP
+void run_test_postings(void);
+int test_postings_passed(void);
+int test_postings_failed(void);
+#endif
@@ -1,6 +1,7 @@
 #include "ro_string_db.hpp"
 
 #include <fstream>
+#include <cstring>
 #include <stdexcept>
 
 #define throw_str(str) "ro_string_db: " str
@@ -111,7 +112,7 @@ void ro_string_db::_init_str_tbl(init_info& init)
 	if (skip_first)
 		std::getline(in, line);
 	
-	_str_tbl.reset(new ro_string_table(lines_num, tbl_fields));
+	_str_tbl.reset(new ro_string_table(lines_num, tbl_fields, 0, init.pool));
 	
 	std::string field;
 	const char * str_append;
@@ -129,7 +130,8 @@ void ro_string_db::_init_str_tbl(init_info& init)
 			{
 				field = str_append;
 				callback(field);
-				str_append = field.c_str();
+				_str_tbl->append(field);
+				continue;
 			}
 			_str_tbl->append(str_append);
 		}
@@ -213,6 +215,128 @@ void ro_string_db::_field_checks(init_info& init)
 	}
 }
 
+void ro_string_db::use_cache(size_t max_bytes, uint shards)
+{
+	if (max_bytes &&
+		ro_string_table::POOL_COMPRESSED == _str_tbl->get_pool_mode())
+	{
+		throw std::runtime_error(
+			throw_str("use_cache() of a table with POOL_COMPRESSED")
+		);
+	}
+	
+	if (max_bytes)
+		_cache.reset(new lookup_cache(max_bytes, shards));
+	else
+		_cache.reset();
+}
+
+bool ro_string_db::get_cache_stats(cache_stats& out)
+{
+	if (!_cache)
+		return false;
+	
+	_cache->get_stats(out);
+	return true;
+}
+
+void ro_string_db::_cache_key(char kind,
+	const field_pair& source,
+	std::string& out
+)
+{
+	// names end in '\0' and values go after their length, so no two lookups
+	// make the same key, even if the values hold '\0'
+	size_t len = source.value_len;
+	if (!len)
+		len = strlen(source.field_value);
+	
+	out.clear();
+	out += kind;
+	out.append(source.field_name, strlen(source.field_name) + 1);
+	out.append(reinterpret_cast<const char *>(&len), sizeof(len));
+	out.append(source.field_value, len);
+}
+
+bool ro_string_db::_cached_unique(const field_pair& source,
+	std::vector<field_pair>& in_out_targets
+)
+{
+	std::string key;
+	_cache_key('u', source, key);
+	for (auto& target : in_out_targets)
+		key.append(target.field_name, strlen(target.field_name) + 1);
+	
+	lookup_cache::result res;
+	if (!_cache->get(key, res))
+	{
+		res.found = _str_tbl->lookup_unique(source, in_out_targets);
+		if (res.found)
+		{
+			for (auto& target : in_out_targets)
+				res.cells.push_back(target.field_value);
+		}
+		_cache->put(key, res);
+		return res.found;
+	}
+	
+	if (res.found)
+	{
+		bool has_lengths =
+			(ro_string_table::POOL_LENGTHS == _str_tbl->get_pool_mode());
+		for (size_t i = 0, end = in_out_targets.size(); i < end; ++i)
+		{
+			in_out_targets[i].field_value = res.cells[i];
+			if (has_lengths)
+			{
+				in_out_targets[i].value_len =
+					_str_tbl->get_value_len(res.cells[i]);
+			}
+		}
+	}
+	return res.found;
+}
+
+bool ro_string_db::_cached_equal_range(const field_pair& source,
+	std::vector<eq_range_result>& in_out_targets
+)
+{
+	std::string key;
+	_cache_key('e', source, key);
+	for (auto& target : in_out_targets)
+		key.append(target.field_name, strlen(target.field_name) + 1);
+	
+	// the cells are the values of the first target, then of the second, etc.
+	lookup_cache::result res;
+	if (!_cache->get(key, res))
+	{
+		res.found = _str_tbl->lookup_equal_range(source, in_out_targets);
+		if (res.found)
+		{
+			for (auto& target : in_out_targets)
+			{
+				res.cells.insert(res.cells.end(),
+					target.values.begin(),
+					target.values.end()
+				);
+			}
+		}
+		_cache->put(key, res);
+		return res.found;
+	}
+	
+	if (res.found && !in_out_targets.empty())
+	{
+		size_t rows = res.cells.size() / in_out_targets.size();
+		for (size_t i = 0, end = in_out_targets.size(); i < end; ++i)
+		{
+			auto first = res.cells.begin() + i * rows;
+			in_out_targets[i].values.assign(first, first + rows);
+		}
+	}
+	return res.found;
+}
+
 void ro_string_db::_throw_empty_file(const char * fname)
 {
 	std::string err(throw_str("file '"));
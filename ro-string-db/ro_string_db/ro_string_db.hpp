@@ -13,6 +13,7 @@
 
 #include "input.hpp"
 #include "ro_string_table.hpp"
+#include "lookup_cache.hpp"
 
 #include <set>
 #include <vector>
@@ -25,8 +26,28 @@ class ro_string_db
 	typedef unsigned int uint;
 	typedef ro_string_table::field_pair field_pair;
 	typedef ro_string_table::eq_range_result eq_range_result;
+	typedef ro_string_table::cell cell;
+	typedef ro_string_table::value_buffer value_buffer;
+	typedef ro_string_table::eq_range_view eq_range_view;
+	typedef ro_string_table::eq_range_cursor eq_range_cursor;
+	typedef ro_string_table::value_count value_count;
+	typedef ro_string_table::group_cursor group_cursor;
+	typedef ro_string_table::ordered_cursor ordered_cursor;
+	typedef ro_string_table::order_dir order_dir;
+	typedef ro_string_table::fuzzy_match fuzzy_match;
+	typedef ro_string_table::filter_stats filter_stats;
+	typedef ro_string_table::learned_stats learned_stats;
+	typedef ro_string_table::front_coded_stats front_coded_stats;
 	typedef ro_string_table::field_info field_info;
+	typedef ro_string_table::composite_info composite_info;
+	typedef ro_string_table::range_incl range_incl;
+	typedef ro_string_table::in_flags in_flags;
+	typedef ro_string_table::field_type field_type;
+	typedef ro_string_table::collate_flags collate_flags;
+	typedef ro_string_table::index_kind index_kind;
+	typedef ro_string_table::pool_mode pool_mode;
 	typedef ro_string_table::byte byte;
+	typedef lookup_cache::stats cache_stats;
 	typedef void (*on_field_split)(std::string& field);
 	
 	struct init_info
@@ -41,7 +62,8 @@ class ro_string_db
 			fields_to_keep(fields_to_keep),
 			csv_file_name(csv_file_name),
 			on_field(on_field),
-			delim(delim)
+			delim(delim),
+			pool(ro_string_table::POOL_PLAIN)
 		{}
 		
 		std::vector<std::string>& all_csv_field_names;
@@ -49,6 +71,7 @@ class ro_string_db
 		const char * csv_file_name;
 		on_field_split on_field;
 		char delim;
+		pool_mode pool;
 	};
 	/*
 	   init_info is everything the ro_string_db needs to create itself.
@@ -71,6 +94,12 @@ class ro_string_db
 	   fields_to_keep must be a subset of all_csv_field_names, and must have
 	   the same relative order. If any of these conditions are not met, an
 	   exception is thrown.
+	   
+	   pool is the pool_mode of the table. With POOL_LENGTHS the strings
+	   on_field leaves are kept whole, so it can unescape e.g. "\0" to a '\0'
+	   byte; otherwise they end at their first '\0'. With POOL_COMPRESSED
+	   the values handed out are decompressed; see pool_mode in
+	   ro_string_table.
 	*/
 	
 	ro_string_db(init_info& init);
@@ -83,17 +112,23 @@ class ro_string_db
 		field_pair& unq = _single_unq[0];
 		unq.field_name = target_name;
 		unq.field_value = nullptr;
-		lookup_unique(source, _single_unq);
+		_single_values.clear();
+		lookup_unique(source, _single_unq, &_single_values);
 		*out_value = &unq;
 		return unq.field_value;
 	}
 	/* A convenience function for looking up a single target field. */
 	
 	inline bool lookup_unique(const field_pair& source,
-		std::vector<field_pair>& in_out_targets
+		std::vector<field_pair>& in_out_targets,
+		value_buffer * buffer = nullptr
 	)
-	{return _str_tbl->lookup_unique(source, in_out_targets);}
-	/* See lookup_unique() in ro_string_table. */
+	{
+		return (_cache) ?
+			_cached_unique(source, in_out_targets) :
+			_str_tbl->lookup_unique(source, in_out_targets, buffer);
+	}
+	/* See lookup_unique() in ro_string_table, and use_cache() below. */
 	
 	inline bool lookup_equal_range(const field_pair& source,
 		const char * target_name,
@@ -103,22 +138,343 @@ class ro_string_db
 		eq_range_result& eqr = _single_eqr[0];
 		eqr.field_name = target_name;
 		eqr.values.clear();
-		lookup_equal_range(source, _single_eqr);
+		_single_values.clear();
+		lookup_equal_range(source, _single_eqr, &_single_values);
 		*out_values = &eqr;
 		return eqr.values.size();
 	}
-	/* Another convenience function for looking up a single target field. */
+	/*
+	   Another convenience function for looking up a single target field.
+	   With POOL_COMPRESSED the values of both convenience functions are
+	   decompressed in a buffer of the db, and are valid until the next call
+	   of either.
+	*/
 	
 	inline bool lookup_equal_range(const field_pair& source,
-		std::vector<eq_range_result>& in_out_targets
+		std::vector<eq_range_result>& in_out_targets,
+		value_buffer * buffer = nullptr
 	) 
-	{return _str_tbl->lookup_equal_range(source, in_out_targets);}
+	{
+		return (_cache) ?
+			_cached_equal_range(source, in_out_targets) :
+			_str_tbl->lookup_equal_range(source, in_out_targets, buffer);
+	}
+	/* See lookup_equal_range() in ro_string_table, and use_cache() below. */
+	
+	inline bool lookup_equal_range(const field_pair& source,
+		eq_range_view& out
+	)
+	{return _str_tbl->lookup_equal_range(source, out);}
+	/* See lookup_equal_range() in ro_string_table. */
+	
+	inline bool lookup_equal_range(const field_pair& source,
+		eq_range_cursor& out
+	)
+	{return _str_tbl->lookup_equal_range(source, out);}
 	/* See lookup_equal_range() in ro_string_table. */
 	
+	inline bool lookup_prefix(const field_pair& source,
+		std::vector<eq_range_result>& in_out_targets,
+		value_buffer * buffer = nullptr
+	)
+	{return _str_tbl->lookup_prefix(source, in_out_targets, buffer);}
+	
+	inline bool lookup_prefix(const field_pair& source, eq_range_view& out)
+	{return _str_tbl->lookup_prefix(source, out);}
+	
+	inline bool lookup_prefix(const field_pair& source, eq_range_cursor& out)
+	{return _str_tbl->lookup_prefix(source, out);}
+	/* See lookup_prefix() in ro_string_table. */
+	
+	inline bool lookup_range(const char * field_name,
+		const char * low,
+		const char * high,
+		std::vector<eq_range_result>& in_out_targets,
+		int incl = ro_string_table::INCL_BOTH,
+		value_buffer * buffer = nullptr
+	)
+	{
+		return _str_tbl->lookup_range(field_name, low, high,
+			in_out_targets, incl, buffer
+		);
+	}
+	
+	inline bool lookup_range(const char * field_name,
+		const char * low,
+		const char * high,
+		eq_range_view& out,
+		int incl = ro_string_table::INCL_BOTH
+	)
+	{return _str_tbl->lookup_range(field_name, low, high, out, incl);}
+	
+	inline bool lookup_range(const char * field_name,
+		const char * low,
+		const char * high,
+		eq_range_cursor& out,
+		int incl = ro_string_table::INCL_BOTH
+	)
+	{return _str_tbl->lookup_range(field_name, low, high, out, incl);}
+	/* See lookup_range() in ro_string_table. */
+	
+	inline bool lookup_numeric(const field_pair& source,
+		std::vector<eq_range_result>& in_out_targets,
+		value_buffer * buffer = nullptr
+	)
+	{return _str_tbl->lookup_numeric(source, in_out_targets, buffer);}
+	
+	inline bool lookup_numeric(const field_pair& source, eq_range_view& out)
+	{return _str_tbl->lookup_numeric(source, out);}
+	
+	inline bool lookup_numeric(const field_pair& source, eq_range_cursor& out)
+	{return _str_tbl->lookup_numeric(source, out);}
+	/* See lookup_numeric() in ro_string_table. */
+	
+	inline bool lookup_numeric_range(const char * field_name,
+		const char * low,
+		const char * high,
+		std::vector<eq_range_result>& in_out_targets,
+		int incl = ro_string_table::INCL_BOTH,
+		value_buffer * buffer = nullptr
+	)
+	{
+		return _str_tbl->lookup_numeric_range(field_name, low, high,
+			in_out_targets, incl, buffer
+		);
+	}
+	
+	inline bool lookup_numeric_range(const char * field_name,
+		const char * low,
+		const char * high,
+		eq_range_view& out,
+		int incl = ro_string_table::INCL_BOTH
+	)
+	{return _str_tbl->lookup_numeric_range(field_name, low, high, out, incl);}
+	
+	inline bool lookup_numeric_range(const char * field_name,
+		const char * low,
+		const char * high,
+		eq_range_cursor& out,
+		int incl = ro_string_table::INCL_BOTH
+	)
+	{return _str_tbl->lookup_numeric_range(field_name, low, high, out, incl);}
+	/* See lookup_numeric_range() in ro_string_table. */
+	
+	inline bool lookup_composite(const std::vector<field_pair>& keys,
+		std::vector<field_pair>& in_out_targets,
+		value_buffer * buffer = nullptr
+	)
+	{return _str_tbl->lookup_composite(keys, in_out_targets, buffer);}
+	
+	inline bool lookup_composite(const std::vector<field_pair>& keys,
+		std::vector<eq_range_result>& in_out_targets,
+		value_buffer * buffer = nullptr
+	)
+	{return _str_tbl->lookup_composite(keys, in_out_targets, buffer);}
+	
+	inline bool lookup_composite(const std::vector<field_pair>& keys,
+		eq_range_view& out
+	)
+	{return _str_tbl->lookup_composite(keys, out);}
+	
+	inline bool lookup_composite(const std::vector<field_pair>& keys,
+		eq_range_cursor& out
+	)
+	{return _str_tbl->lookup_composite(keys, out);}
+	/* See lookup_composite() in ro_string_table. */
+	
+	inline bool lookup_and(const std::vector<field_pair>& predicates,
+		std::vector<uint>& out_rows
+	)
+	{return _str_tbl->lookup_and(predicates, out_rows);}
+	
+	inline bool lookup_and(const std::vector<field_pair>& predicates,
+		std::vector<eq_range_result>& in_out_targets,
+		value_buffer * buffer = nullptr
+	)
+	{return _str_tbl->lookup_and(predicates, in_out_targets, buffer);}
+	/* See lookup_and() in ro_string_table. */
+	
+	inline bool lookup_in(const char * field_name,
+		const std::vector<const char *>& values,
+		std::vector<uint>& out_rows,
+		int flags = ro_string_table::IN_DEFAULT
+	)
+	{return _str_tbl->lookup_in(field_name, values, out_rows, flags);}
+	
+	inline bool lookup_in(const char * field_name,
+		const std::vector<const char *>& values,
+		std::vector<eq_range_result>& in_out_targets,
+		int flags = ro_string_table::IN_DEFAULT,
+		value_buffer * buffer = nullptr
+	)
+	{
+		return _str_tbl->lookup_in(field_name, values, in_out_targets,
+			flags, buffer
+		);
+	}
+	/* See lookup_in() in ro_string_table. */
+	
+	inline bool exists(const field_pair& source)
+	{return _str_tbl->exists(source);}
+	
+	inline size_t count(const field_pair& source)
+	{return _str_tbl->count(source);}
+	/* See exists() and count() in ro_string_table. */
+	
+	inline void group_by(const char * field_name, group_cursor& out)
+	{_str_tbl->group_by(field_name, out);}
+	
+	inline void group_counts(const char * field_name,
+		std::vector<value_count>& out,
+		uint threads = 1,
+		value_buffer * buffer = nullptr
+	)
+	{_str_tbl->group_counts(field_name, out, threads, buffer);}
+	
+	inline void group_top(const char * field_name,
+		size_t k,
+		std::vector<value_count>& out,
+		uint threads = 1,
+		value_buffer * buffer = nullptr
+	)
+	{_str_tbl->group_top(field_name, k, out, threads, buffer);}
+	/* See group_by(), group_counts() and group_top() in ro_string_table. */
+	
+	inline void order_by(const char * field_name,
+		ordered_cursor& out,
+		int dir = ro_string_table::ORDER_ASC
+	)
+	{_str_tbl->order_by(field_name, out, dir);}
+	
+	inline void order_by(const char * field_name,
+		const char * from,
+		ordered_cursor& out,
+		int dir = ro_string_table::ORDER_ASC,
+		bool inclusive = true
+	)
+	{_str_tbl->order_by(field_name, from, out, dir, inclusive);}
+	/* See order_by() in ro_string_table. */
+	
+	inline bool lookup_fuzzy(const field_pair& source,
+		uint max_distance,
+		std::vector<fuzzy_match>& out,
+		value_buffer * buffer = nullptr
+	)
+	{return _str_tbl->lookup_fuzzy(source, max_distance, out, buffer);}
+	
+	inline bool lookup_nearest(const field_pair& source,
+		size_t n,
+		std::vector<fuzzy_match>& out,
+		value_buffer * buffer = nullptr
+	)
+	{return _str_tbl->lookup_nearest(source, n, out, buffer);}
+	/* See lookup_fuzzy() and lookup_nearest() in ro_string_table. */
+	
+	inline bool lookup_contains(const field_pair& source,
+		std::vector<uint>& out_rows
+	)
+	{return _str_tbl->lookup_contains(source, out_rows);}
+	
+	inline bool lookup_contains(const field_pair& source,
+		std::vector<eq_range_result>& in_out_targets,
+		value_buffer * buffer = nullptr
+	)
+	{return _str_tbl->lookup_contains(source, in_out_targets, buffer);}
+	/* See lookup_contains() in ro_string_table. */
+	
+	inline size_t get_substring_memory(const char * field_name)
+	{return _str_tbl->get_substring_memory(field_name);}
+	/* See get_substring_memory() in ro_string_table. */
+	
+	inline bool get_filter_stats(const char * field_name, filter_stats& out)
+	{return _str_tbl->get_filter_stats(field_name, out);}
+	/* See get_filter_stats() in ro_string_table. */
+	
+	inline bool get_learned_stats(const char * field_name, learned_stats& out)
+	{return _str_tbl->get_learned_stats(field_name, out);}
+	/* See get_learned_stats() in ro_string_table. */
+	
+	inline bool get_front_coded_stats(const char * field_name,
+		front_coded_stats& out
+	)
+	{return _str_tbl->get_front_coded_stats(field_name, out);}
+	/* See get_front_coded_stats() in ro_string_table. */
+	
+	inline bool lookup_tokens(const char * field_name,
+		const std::vector<const char *>& tokens,
+		std::vector<uint>& out_rows,
+		int how = ro_string_table::TOKENS_ALL
+	)
+	{return _str_tbl->lookup_tokens(field_name, tokens, out_rows, how);}
+	
+	inline bool lookup_tokens(const char * field_name,
+		const std::vector<const char *>& tokens,
+		std::vector<eq_range_result>& in_out_targets,
+		int how = ro_string_table::TOKENS_ALL,
+		value_buffer * buffer = nullptr
+	)
+	{
+		return _str_tbl->lookup_tokens(field_name, tokens, in_out_targets,
+			how, buffer
+		);
+	}
+	/* See lookup_tokens() in ro_string_table. */
+	
+	inline uint get_field_col(const char * field_name)
+	{return _str_tbl->get_field_col(field_name);}
+	/* See get_field_col() in ro_string_table. */
+	
 	inline uint get_num_rows() {return _str_tbl->get_num_rows();}
 	inline uint get_num_cols() {return _str_tbl->get_num_cols();}
-	inline const char * get_str_at(uint row, uint col)
-	{return _str_tbl->get_str_at(row, col);}
+	inline const char * get_str_at(uint row,
+		uint col,
+		value_buffer * buffer = nullptr
+	)
+	{return _str_tbl->get_str_at(row, col, buffer);}
+	
+	inline void get_row(uint row,
+		std::vector<cell>& out,
+		value_buffer * buffer = nullptr
+	)
+	{_str_tbl->get_row(row, out, buffer);}
+	
+	inline void get_rows(const std::vector<uint>& rows,
+		std::vector<cell>& out,
+		value_buffer * buffer = nullptr
+	)
+	{_str_tbl->get_rows(rows, out, buffer);}
+	/* See get_row() and get_rows() in ro_string_table. */
+	
+	inline cell get_cell_at(uint row,
+		uint col,
+		value_buffer * buffer = nullptr
+	)
+	{return _str_tbl->get_cell_at(row, col, buffer);}
+	
+	inline size_t get_value_len(const char * value) const
+	{return _str_tbl->get_value_len(value);}
+	/* See get_cell_at() and get_value_len() in ro_string_table. */
+	
+	void use_cache(size_t max_bytes, uint shards = 16);
+	/*
+	   Puts a lookup_cache of at most max_bytes in front of lookup_unique()
+	   and lookup_equal_range() with target vectors, keyed by the source
+	   field, the source value and the names of the targets. A repeated
+	   lookup then copies the cached pointers to the targets instead of
+	   searching the field and resolving each target again. Misses are
+	   cached as well. Since the table doesn't change, nothing is ever
+	   invalidated. The cache is thread safe; the views and the cursors are
+	   not cached, since they copy nothing anyway. Calling it again replaces
+	   the cache with an empty one, and a max_bytes of 0 removes it. Throws
+	   for a table with POOL_COMPRESSED, whose values are in the buffers of
+	   the callers, where a cached pointer can't outlive them.
+	*/
+	
+	bool get_cache_stats(cache_stats& out);
+	/*
+	   Places the hits, misses, evictions, rejections, entries and bytes of
+	   the cache in out. Returns false if there is no cache.
+	*/
 	
 	inline void dbg_dump_tbl()
 	{_str_tbl->dbg_dump();}
@@ -162,11 +518,24 @@ class ro_string_db
 	void _fields_to_keep(init_info& info, std::set<uint>& out);
 	void _init_str_tbl(init_info& info);
 	
+	bool _cached_unique(const field_pair& source,
+		std::vector<field_pair>& in_out_targets
+	);
+	bool _cached_equal_range(const field_pair& source,
+		std::vector<eq_range_result>& in_out_targets
+	);
+	static void _cache_key(char kind,
+		const field_pair& source,
+		std::string& out
+	);
+	
 	static void _throw_empty_file(const char * fname);
 	
 	std::unique_ptr<ro_string_table> _str_tbl;
+	std::unique_ptr<lookup_cache> _cache;
 	std::vector<field_pair> _single_unq;
 	std::vector<eq_range_result> _single_eqr;
+	value_buffer _single_values;
 };
 
 #endif
@@ -8,10 +8,12 @@
 
 static bool test_ro_string_db_statics(void);
 static bool test_ro_string_db(void);
+static bool test_ro_string_db_cache(void);
 
 static ftest tests[] = {
 	test_ro_string_db_statics,
 	test_ro_string_db,
+	test_ro_string_db_cache,
 };
 
 static bool didnt_throw = false;
@@ -552,6 +554,102 @@ static bool test_ro_string_db(void)
 	return true;
 }
 
+static bool test_ro_string_db_cache(void)
+{
+	typedef ro_string_db::field_pair field_pair;
+	typedef ro_string_db::eq_range_result eq_range_result;
+	
+	std::vector<ro_string_db::field_info> fields{
+		ro_string_db::field_info("id", true),
+		ro_string_db::field_info("fruit", true),
+		ro_string_db::field_info("type"),
+		ro_string_db::field_info("price")
+	};
+	
+	std::vector<const char *> l0 = {"id", "fruit", "type", "price"};
+	std::vector<std::string> fld_names(l0.begin(), l0.end());
+	ro_string_db::init_info init(FRUIT_FILE, ';', fld_names, fields);
+	ro_string_db str_db(init);
+	
+	ro_string_db::cache_stats st;
+	check(!str_db.get_cache_stats(st));
+	
+	str_db.use_cache(1 << 16);
+	check(str_db.get_cache_stats(st));
+	check(st.hits == 0 && st.misses == 0 && st.entries == 0);
+	
+	for (int i = 0; i < 3; ++i)
+	{
+		std::vector<field_pair> targets{field_pair("fruit"),
+			field_pair("price")
+		};
+		check(str_db.lookup_unique(field_pair("id", "4"), targets));
+		check(std::string(targets[0].field_value) == "mango");
+		check(std::string(targets[1].field_value) == "10.50");
+		
+		targets[0].field_value = nullptr;
+		check(!str_db.lookup_unique(field_pair("id", "9"), targets));
+		check(!targets[0].field_value);
+		
+		std::vector<eq_range_result> eqr{eq_range_result("fruit"),
+			eq_range_result("id")
+		};
+		check(str_db.lookup_equal_range(field_pair("type", "normal"), eqr));
+		check(eqr[0].values.size() == 3);
+		check(std::string(eqr[0].values[0]) == "apple");
+		check(std::string(eqr[0].values[2]) == "pear");
+		check(eqr[1].values.size() == 3);
+		check(std::string(eqr[1].values[1]) == "3");
+		
+		// the same source with other targets is another lookup
+		std::vector<eq_range_result> eqr2{eq_range_result("price")};
+		check(str_db.lookup_equal_range(field_pair("type", "normal"), eqr2));
+		check(eqr2[0].values.size() == 3);
+		check(std::string(eqr2[0].values[0]) == "5.32");
+		
+		ro_string_db::field_pair * out = nullptr;
+		check(str_db.lookup_unique(field_pair("fruit", "pear"), "id", &out));
+		check(std::string(out->field_value) == "5");
+	}
+	
+	check(str_db.get_cache_stats(st));
+	check(st.misses == 5);
+	check(st.hits == 10);
+	check(st.entries == 5);
+	check(st.bytes > 0 && st.bytes <= (1 << 16));
+	
+	// errors are not cached
+	std::vector<field_pair> bad{field_pair("banana")};
+	for (int i = 0; i < 2; ++i)
+	{
+		try {str_db.lookup_unique(field_pair("id", "1"), bad); check(didnt_throw);}
+		catch (std::runtime_error& e)
+		{check(e.what() == std::string("ro_string_table: lookup fail: no such field 'banana'"));}
+	}
+	
+	str_db.use_cache(0);
+	check(!str_db.get_cache_stats(st));
+	
+	// the values of a compressed pool are decompressed in the buffer of
+	// the caller, so there is nothing to cache
+	init.pool = ro_string_table::POOL_COMPRESSED;
+	ro_string_db packed_db(init);
+	ro_string_db::field_pair * out = nullptr;
+	check(packed_db.lookup_unique(field_pair("fruit", "pear"), "id", &out));
+	check(std::string(out->field_value) == "5");
+	
+	ro_string_db::value_buffer buf;
+	std::vector<field_pair> targets{field_pair("id")};
+	check(packed_db.lookup_unique(field_pair("fruit", "pear"), targets, &buf));
+	check(std::string(targets[0].field_value) == "5");
+	try {packed_db.use_cache(1 << 16); check(didnt_throw);}
+	catch (std::runtime_error& e)
+	{check(e.what() == std::string("ro_string_db: use_cache() of a table with POOL_COMPRESSED"));}
+	check(!packed_db.get_cache_stats(st));
+	
+	return true;
+}
+
 static int passed, failed;
 void run_test_ro_string_db(void)
 {
@@ -1,18 +1,133 @@
 #include "ro_string_table.hpp"
 #include <stdexcept>
 #include <cstring>
+#include <cstdlib>
+#include <cctype>
+#include <cerrno>
+#include <cmath>
 #include <string>
-#include <cstring>
+#include <algorithm>
+#include <thread>
 
 // dbg
 #include <iostream>
 
 #define throw_str(str) "ro_string_table: " str
 
+#if defined(__GNUC__)
+#define prefetch(addr) __builtin_prefetch(addr)
+#else
+#define prefetch(addr) ((void)(addr))
+#endif
+
+static inline int compare_pooled(const string_pool& pool,
+	string_pool::uint at,
+	const char * val,
+	size_t len,
+	int how
+)
+{
+	// with lengths, values without a collation compare as bytes, '\0' and all
+	if (pool.has_lengths() && collation::NONE == how)
+	{
+		return collation::compare_bytes(pool.get(at),
+			pool.get_len(at),
+			val,
+			len
+		);
+	}
+	return collation::compare(pool.get(at), val, how);
+}
+
+static inline int compare_pooled(const string_pool& pool,
+	string_pool::uint a,
+	string_pool::uint b,
+	int how
+)
+{
+	// interned values are equal where they are the same string
+	if (a == b)
+		return 0;
+	
+	size_t len = (pool.has_lengths()) ? pool.get_len(b) : 0;
+	return compare_pooled(pool, a, pool.get(b), len, how);
+}
+
+static const size_t UNPACK_BUFF = 256;
+
+static inline const char * unpack(const compressed_pool& pool,
+	compressed_pool::uint at,
+	char * buff,
+	std::string& big
+)
+{
+	// most values fit the UNPACK_BUFF bytes of buff, on the caller's stack
+	size_t len = pool.get(at, buff, UNPACK_BUFF - 1);
+	if (len < UNPACK_BUFF)
+	{
+		buff[len] = '\0';
+		return buff;
+	}
+	pool.get(at, big);
+	return big.c_str();
+}
+
+static inline int compare_packed(const compressed_pool& pool,
+	compressed_pool::uint at,
+	const char * val,
+	size_t len,
+	int how
+)
+{
+	if (collation::NONE == how)
+		return pool.compare(at, val, len);
+	
+	char buff[UNPACK_BUFF];
+	std::string big;
+	return collation::compare(unpack(pool, at, buff, big), val, how);
+}
+
+static inline bool equal_packed(const compressed_pool& pool,
+	compressed_pool::uint a,
+	compressed_pool::uint b,
+	int how
+)
+{
+	if (a == b)
+		return true;
+	if (collation::NONE == how)
+		return pool.equal(a, b);
+	
+	char buff[UNPACK_BUFF];
+	std::string big;
+	const char * str = unpack(pool, b, buff, big);
+	return 0 == compare_packed(pool, a, str, strlen(str), how);
+}
+
+static inline uint64_t hash_bytes(const char * str, size_t len)
+{
+	// FNV-1a, then the splitmix64 finalizer, as collation::hash() does, but
+	// over the raw bytes, since interned values are equal byte for byte
+	uint64_t h = 0xCBF29CE484222325ull;
+	for (size_t i = 0; i < len; ++i)
+	{
+		h ^= (unsigned char)str[i];
+		h *= 0x100000001B3ull;
+	}
+	
+	h ^= h >> 30;
+	h *= 0xBF58476D1CE4E5B9ull;
+	h ^= h >> 27;
+	h *= 0x94D049BB133111EBull;
+	h ^= h >> 31;
+	return h;
+}
+
 // class ro_string_table
 ro_string_table::ro_string_table(uint lines,
         const std::vector<field_info>& fields,
-        size_t pool_init_size
+        size_t pool_init_size,
+        pool_mode mode
 ) :
 	_fields(
 		gen_comp_less<ro_string_table::single_field_data, const char*>(
@@ -26,18 +141,59 @@ ro_string_table::ro_string_table(uint lines,
 		)
 	),
 	_data_map(lines, fields.size()),
-	_pool(pool_init_size),
+	_pool(pool_init_size, (POOL_LENGTHS == mode)),
+	_pool_mode(mode),
 	_str_ctx_lup(
 		[](const ro_string_table::num_field_info& lhs,
 			const ro_string_table::num_field_info& dummy_rhs,
 			ro_string_table::single_field_data::context_lookup ctx
 		)
 		{
-			return strcmp(ctx.str_pool->get(lhs.index_of_string), ctx.str);
+			if (ctx.packed)
+			{
+				return compare_packed(*ctx.packed,
+					lhs.index_of_string,
+					ctx.str,
+					ctx.str_len,
+					ctx.how
+				);
+			}
+			return compare_pooled(*ctx.str_pool,
+				lhs.index_of_string,
+				ctx.str,
+				ctx.str_len,
+				ctx.how
+			);
+		}
+	),
+	_str_ctx_prefix_lup(
+		[](const ro_string_table::num_field_info& lhs,
+			const ro_string_table::num_field_info& dummy_rhs,
+			ro_string_table::single_field_data::context_lookup ctx
+		)
+		{
+			char buff[UNPACK_BUFF];
+			std::string big;
+			const char * str = (ctx.packed) ?
+				unpack(*ctx.packed, lhs.index_of_string, buff, big) :
+				ctx.str_pool->get(lhs.index_of_string);
+			if (ctx.how)
+				return collation::compare_prefix(str, ctx.str, ctx.how);
+			if (ctx.str_pool->has_lengths())
+			{
+				size_t len = ctx.str_pool->get_len(lhs.index_of_string);
+				return collation::compare_bytes(str,
+					(len < ctx.str_len) ? len : ctx.str_len,
+					ctx.str,
+					ctx.str_len
+				);
+			}
+			return strncmp(str, ctx.str, ctx.str_len);
 		}
 	),
 	_is_sealed(false),
 	_are_fields_set(false),
+	_shares_strings(false),
 	_current_line(0),
 	_current_field(0)
 {
@@ -55,41 +211,133 @@ void ro_string_table::_set_fields(const std::vector<field_info>& fields)
 		for (uint i = 0, end = fields.size(); i < end; ++i)
 		{
 			auto& field = fields[i];
-			uint place_in_pool = _append_to_table(field.name.c_str());
+			uint place_in_pool = _append_to_table(field.name.c_str(),
+				field.name.size()
+			);
 			
 			ro_string_table::num_field_info tmp(0, place_in_pool);
-			_fields.append(
-				single_field_data(i, tmp, _pool, field.is_unique, _num_lines)
+			single_field_data sfd(i,
+				tmp,
+				_pool,
+				_packed,
+				field.is_unique,
+				_num_lines,
+				field.type,
+				field.decimal_places,
+				field.collation,
+				field.index
 			);
+			if (field.is_fuzzy)
+				sfd.set_fuzzy();
+			if (field.has_substrings)
+				sfd.set_substrings(_data_map);
+			if (field.has_tokens)
+			{
+				sfd.set_tokens(field.token_delimiters.c_str(),
+					field.token_lowercase
+				);
+			}
+			if (field.has_filter)
+				sfd.set_filter(field.filter_bits);
+			if (INDEX_FRONT_CODED == field.index)
+				sfd.set_front_coded(_data_map);
+			if (field.has_interning)
+				sfd.set_interning();
+			_fields.append(sfd);
 		}
 		_are_fields_set = true;
+		_set_composites(fields);
 	}
 	else
 		throw std::runtime_error(throw_str("can't set fields twice"));
 }
 
+void ro_string_table::_set_composites(const std::vector<field_info>& fields)
+{
+	for (uint i = 0, end = fields.size(); i < end; ++i)
+	{
+		for (auto& comp : fields[i].composites)
+		{
+			std::vector<uint> cols{i};
+			std::vector<int> collations{fields[i].collation};
+			
+			for (auto& name : comp.fields)
+			{
+				uint col = 0;
+				while (col < end && fields[col].name != name)
+					++col;
+				
+				if (col == end)
+				{
+					std::string err(throw_str("composite index on '"));
+					err += fields[i].name;
+					for (auto& other : comp.fields)
+						err += ", " + other;
+					err += "': no such field '";
+					err += name;
+					err += "'";
+					throw std::runtime_error(err);
+				}
+				
+				cols.push_back(col);
+				collations.push_back(fields[col].collation);
+			}
+			
+			_composites.push_back(composite_index(cols,
+				collations,
+				_data_map,
+				_pool,
+				_packed,
+				comp.is_unique
+			));
+		}
+	}
+}
+
 void ro_string_table::append(const char * str)
+{
+	append(str, strlen(str));
+}
+
+void ro_string_table::append(const char * str, size_t len)
 {
 	if (!_is_sealed)
 	{
+		if (!_pool.has_lengths() && memchr(str, '\0', len))
+		{
+			throw std::runtime_error(
+				throw_str("append() of a value with '\\0' needs POOL_LENGTHS")
+			);
+		}
+		
 		int line_number = _current_line;
-		int field = _current_field;
-		int place_in_pool = _append_to_table(str);
+		const auto& noconst = _fields.get(_current_field);
+		auto& field = const_cast<ro_string_table::single_field_data&>(noconst);
+		int place_in_pool = _append_to_table(str, len, &field);
 		
 		ro_string_table::num_field_info numfi(line_number, place_in_pool);
-		const auto& noconst = _fields.get(field);
-		const_cast<ro_string_table::single_field_data&>
-			(noconst).append_info(numfi);
+		field.append_info(numfi);
 	}
 	else
 		throw std::runtime_error(throw_str("append() called after seal()"));
 }
 
-uint ro_string_table::_append_to_table(const char * str)
+uint ro_string_table::_append_to_table(const char * str,
+	size_t len,
+	ro_string_table::single_field_data * field
+)
 {
 	if (_current_line < _num_lines)
 	{
-		uint place_in_pool = _pool.append(str);
+		uint place_in_pool = 0;
+		if (field && field->find_interned(str, len, place_in_pool))
+			_shares_strings = true;
+		else
+		{
+			place_in_pool = _pool.append(str, len);
+			if (field)
+				field->add_interned(str, len, place_in_pool);
+		}
 		_data_map.place(_current_line, _current_field, place_in_pool);
 
 		++_current_field;
@@ -119,10 +367,85 @@ void ro_string_table::seal()
 		const_cast<ro_string_table::single_field_data&>(noconst).seal();
 	}
 	_fields.seal();
+	
+	for (auto& comp : _composites)
+		comp.seal(_current_line);
+	
+	if (POOL_COMPRESSED == _pool_mode)
+		_compress_pool();
+	
 	_pool.shrink_to_fit();
 	_is_sealed = true;
 }
 
+void ro_string_table::_compress_pool()
+{
+	/*
+	   The values went in the pool in the order of their cells, so a cell
+	   which points before the last value compressed holds an interned one,
+	   already compressed. Row 0 has the names, which stay where they are in
+	   a pool of their own.
+	*/
+	const size_t begin = _num_fields;
+	const size_t end = (size_t)_current_line * _num_fields + _current_field;
+	if (!_num_fields || end <= begin)
+		return;
+	
+	// whole rows spread over the table, so that every column is in the
+	// sample, and about as many bytes as train() takes, so it takes all
+	std::vector<const char *> sample;
+	size_t step = std::max<size_t>(
+		_pool.size() / compressed_pool::SAMPLE_BYTES, 1
+	);
+	for (size_t i = begin; i < end; i += step * _num_fields)
+	{
+		for (size_t j = i; j < i + _num_fields && j < end; ++j)
+		{
+			uint at = _data_map.get(j / _num_fields, j % _num_fields);
+			sample.push_back(_pool.get(at));
+		}
+	}
+	_packed.train(sample.data(), sample.size());
+	
+	std::vector<uint> olds, news;
+	uint last = _data_map.get(0, _num_fields - 1);
+	for (size_t i = begin; i < end; ++i)
+	{
+		uint row = i / _num_fields, col = i % _num_fields;
+		uint at = _data_map.get(row, col);
+		uint to = 0;
+		if (at > last)
+		{
+			to = _packed.append(_pool.get(at));
+			last = at;
+			if (_shares_strings)
+			{
+				olds.push_back(at);
+				news.push_back(to);
+			}
+		}
+		else
+		{
+			auto old = std::lower_bound(olds.begin(), olds.end(), at);
+			to = news[old - olds.begin()];
+		}
+		_data_map.place(row, col, to);
+	}
+	_packed.shrink_to_fit();
+	
+	string_pool names(0, _pool.has_lengths());
+	for (uint col = 0; col < _num_fields; ++col)
+		names.append(_pool.get(_data_map.get(0, col)));
+	_pool = names;
+	
+	for (int i = 0, end = _fields.size(); i < end; ++i)
+	{
+		const auto& noconst = _fields.get(i);
+		const_cast<ro_string_table::single_field_data&>(noconst)
+			.repoint(_data_map);
+	}
+}
+
 bool ro_string_table::_lookup_field(const char * name,
 	const ro_string_table::single_field_data ** out
 )
@@ -147,23 +470,45 @@ bool ro_string_table::_lookup_field(const char * name,
 bool ro_string_table::_lookup_field_val(
 	const ro_string_table::single_field_data& field,
 	const char * val,
-	const num_field_info ** out
+	uint& out_row,
+	size_t len
 )
 {
+	if (!field.may_contain(val))
+		return false;
+	
+	if (field.is_front_coded())
+	{
+		const front_coded& values = field.get_front_coded();
+		size_t val_len = (len) ? len : strlen(val);
+		size_t at = values.lower_bound(val, val_len);
+		if (at == values.upper_bound(val, val_len))
+			return false;
+		
+		out_row = field.rows()[at];
+		return true;
+	}
+	
 	gen_comp_less_ctx_lower_bound<ro_string_table::num_field_info,
 		ro_string_table::single_field_data::context_lookup>
-		less_val_ctx(_str_ctx_lup,
-			ro_string_table::single_field_data::context_lookup(&_pool, val)
-		);
+		less_val_ctx(_str_ctx_lup, _value_ctx(val, field.get_collation(), len));
 	
 	auto& noconst = const_cast<ro_string_table::single_field_data&>(field);
-	return noconst.lookup(out, less_val_ctx);
+	const ro_string_table::num_field_info * out_nfi = nullptr;
+	if (!noconst.lookup(&out_nfi, less_val_ctx, val))
+		return false;
+	
+	out_row = field.first_line_of(*out_nfi);
+	return true;
 }
 
 bool ro_string_table::lookup_unique(const field_pair& source,
-	std::vector<field_pair>& in_out_targets
+	std::vector<field_pair>& in_out_targets,
+	value_buffer * buffer
 )
 {
+	_check_buffer(buffer);
+	
 	bool ret = false;
 	
 	if (_is_sealed)
@@ -176,21 +521,22 @@ bool ro_string_table::lookup_unique(const field_pair& source,
 			const ro_string_table::single_field_data& source_field = **out_sfd;
 			if (source_field.is_unique())
 			{
-				const ro_string_table::num_field_info * out_nfi_ = nullptr;
-				const ro_string_table::num_field_info ** out_nfi = &out_nfi_;
+				uint value_row = 0;
 				if (_lookup_field_val(source_field,
 						source.field_value,
-						out_nfi
+						value_row,
+						source.value_len
 					))
 				{
 					for (field_pair& pair : in_out_targets)
 					{						
 						if (_lookup_field(pair.field_name, out_sfd))
 						{
-							uint value_row = (*out_nfi)->original_line_number;
 							uint value_col = (*out_sfd)->field_number();	
-							pair.field_value = 
-								_pool.get(_data_map.get(value_row, value_col));
+							uint at = _data_map.get(value_row, value_col);
+							pair.field_value = _value_of(at, buffer);
+							if (_pool.has_lengths())
+								pair.value_len = _pool.get_len(at);
 						}
 						else
 							_throw_no_such_field(pair.field_name);
@@ -210,145 +556,2112 @@ bool ro_string_table::lookup_unique(const field_pair& source,
 	return ret;
 }
 
-bool ro_string_table::lookup_equal_range(const field_pair& source,
-	std::vector<eq_range_result>& in_out_targets
+bool ro_string_table::_field_equal_range(const char * field_name,
+	const ro_string_table::single_field_data::context_lookup& ctx,
+	string_context_lookup cmp,
+	const ro_string_table::single_field_data ** out_field,
+	std::pair<size_t, size_t>& out_range
 )
 {
 	bool ret = false;
 	
 	if (_is_sealed)
 	{
-		const ro_string_table::single_field_data * out_sfd_ = nullptr;
-		const ro_string_table::single_field_data ** out_sfd = &out_sfd_;
-		if (_lookup_field(source.field_name, out_sfd))
+		if (_lookup_field(field_name, out_field))
 		{
 			ro_string_table::single_field_data&
 				source_field =
-					const_cast<ro_string_table::single_field_data&>(**out_sfd);
+					const_cast<ro_string_table::single_field_data&>(**out_field);
+			
+			// only a lookup of the whole value can be answered by the filter
+			if (cmp == _str_ctx_lup && !source_field.may_contain(ctx.str))
+			{
+				out_range.first = out_range.second = 0;
+				return false;
+			}
+			
+			if (source_field.is_front_coded())
+			{
+				// a prefix context has its length, a value one only with lengths
+				const front_coded& values = source_field.get_front_coded();
+				bool is_prefix = (cmp == _str_ctx_prefix_lup);
+				size_t len = (is_prefix || ctx.str_len) ?
+					ctx.str_len : strlen(ctx.str);
+				out_range.first = values.lower_bound(ctx.str, len);
+				out_range.second = (is_prefix) ?
+					values.prefix_end(ctx.str, len) :
+					values.upper_bound(ctx.str, len);
+				return (out_range.first < out_range.second);
+			}
 				
 			gen_comp_less_ctx_lower_bound<ro_string_table::num_field_info,
 				ro_string_table::single_field_data::context_lookup>
-				less_lwr_ctx(_str_ctx_lup);
+				less_lwr_ctx(cmp);
 			
 			gen_comp_less_ctx_upper_bound<ro_string_table::num_field_info,
 				ro_string_table::single_field_data::context_lookup>
-				less_upr_ctx(_str_ctx_lup);
+				less_upr_ctx(cmp);
+			
+			ro_string_table::single_field_data::context_lookup fld_ctx(ctx);
+			fld_ctx.how = source_field.get_collation();
 			
 			sort_vector<ro_string_table::num_field_info,
 				ro_string_table::single_field_data::context_lookup>
-			::equal_range_ctx_compars cmprs(less_lwr_ctx, less_upr_ctx,
-				ro_string_table::single_field_data
-				::context_lookup(&_pool, source.field_value)
-			);
+			::equal_range_ctx_compars cmprs(less_lwr_ctx, less_upr_ctx, fld_ctx);
+			
+			ret = source_field.equal_range(out_range, cmprs, ctx.str);
+		}
+		else
+			_throw_no_such_field(field_name);
+	}
+	else
+		_throw_not_sealed();
+		
+	return ret;
+}
+
+bool ro_string_table::_field_range(const char * field_name,
+	const char * low,
+	const char * high,
+	int incl,
+	const ro_string_table::single_field_data ** out_field,
+	std::pair<size_t, size_t>& out_range
+)
+{
+	bool ret = false;
+	
+	if (_is_sealed)
+	{
+		if (_lookup_field(field_name, out_field))
+		{
+			ro_string_table::single_field_data&
+				field =
+					const_cast<ro_string_table::single_field_data&>(**out_field);
+			
+			gen_comp_less_ctx_lower_bound<ro_string_table::num_field_info,
+				ro_string_table::single_field_data::context_lookup>
+				less_lwr_ctx(_str_ctx_lup);
+			
+			gen_comp_less_ctx_upper_bound<ro_string_table::num_field_info,
+				ro_string_table::single_field_data::context_lookup>
+				less_upr_ctx(_str_ctx_lup);
 			
-			std::pair<size_t, size_t> range;
-			if (source_field.equal_range(range, cmprs))
+			// a front coded field is searched without the contexts
+			const front_coded * values =
+				(field.is_front_coded()) ? &field.get_front_coded() : nullptr;
+			
+			size_t begin = 0, end = field.size();
+			if (low)
 			{
-				for (eq_range_result& elem : in_out_targets)
+				if (values)
 				{
-					const char * res_fld_name = elem.field_name;
-					std::vector<const char *>& res_vect = elem.values;
-					
-					res_vect.clear();
-					if (_lookup_field(res_fld_name, out_sfd))
-					{
-						uint value_col = (*out_sfd)->field_number();
-						for (size_t i = range.first; i < range.second; ++i)
-						{
-							uint value_row =
-								source_field.get(i).original_line_number;
-							res_vect.push_back(
-								_pool.get(_data_map.get(value_row, value_col))
-							);
-						}
-					}
-					else
-						_throw_no_such_field(res_fld_name);
+					begin = (incl & INCL_LOW) ?
+						values->lower_bound(low, strlen(low)) :
+						values->upper_bound(low, strlen(low));
+				}
+				else
+				{
+					less_lwr_ctx.set_context(
+						_value_ctx(low, field.get_collation())
+					);
+					less_upr_ctx.set_context(
+						_value_ctx(low, field.get_collation())
+					);
+					begin = (incl & INCL_LOW) ?
+						field.lower_bound(less_lwr_ctx, low) :
+						field.upper_bound(less_upr_ctx, low);
+				}
+			}
+			
+			if (high)
+			{
+				if (values)
+				{
+					end = (incl & INCL_HIGH) ?
+						values->upper_bound(high, strlen(high)) :
+						values->lower_bound(high, strlen(high));
+				}
+				else
+				{
+					less_lwr_ctx.set_context(
+						_value_ctx(high, field.get_collation())
+					);
+					less_upr_ctx.set_context(
+						_value_ctx(high, field.get_collation())
+					);
+					end = (incl & INCL_HIGH) ?
+						field.upper_bound(less_upr_ctx, high) :
+						field.lower_bound(less_lwr_ctx, high);
 				}
-				ret = true;
 			}
+			
+			if (end < begin)
+				end = begin;
+			
+			out_range.first = begin;
+			out_range.second = end;
+			ret = (begin < end);
 		}
 		else
-			_throw_no_such_field(source.field_name);
+			_throw_no_such_field(field_name);
 	}
 	else
 		_throw_not_sealed();
-		
+	
 	return ret;
 }
 
-void ro_string_table::_throw_no_such_field(const char * field_name)
+void ro_string_table::_fill_eq_range(const row_run& run,
+	std::vector<eq_range_result>& in_out_targets,
+	value_buffer * buffer
+)
 {
-	std::string err(throw_str("lookup fail: no such field '"));
-	err += field_name;
-	err += "'";
-	throw std::runtime_error(err);
+	const ro_string_table::single_field_data * out_sfd_ = nullptr;
+	const ro_string_table::single_field_data ** out_sfd = &out_sfd_;
+	
+	for (eq_range_result& elem : in_out_targets)
+	{
+		const char * res_fld_name = elem.field_name;
+		std::vector<const char *>& res_vect = elem.values;
+		
+		res_vect.clear();
+		if (_lookup_field(res_fld_name, out_sfd))
+		{
+			uint value_col = (*out_sfd)->field_number();
+			for (size_t i = 0; i < run.size; ++i)
+			{
+				uint value_row = run.get(i);
+				uint at = _data_map.get(value_row, value_col);
+				res_vect.push_back(_value_of(at, buffer));
+			}
+		}
+		else
+			_throw_no_such_field(res_fld_name);
+	}
 }
 
-void ro_string_table::_throw_field_not_unique(const char * field_name)
+ro_string_table::row_run ro_string_table::_nfi_run(
+	const ro_string_table::single_field_data& source_field,
+	const std::pair<size_t, size_t>& range
+)
 {
-	std::string err(throw_str("unique lookup of non-unique field '"));
-	err += field_name;
-	err += "'";
-	throw std::runtime_error(err);
+	if (source_field.is_front_coded())
+	{
+		return row_run(
+			reinterpret_cast<const byte *>(source_field.rows() + range.first),
+			sizeof(uint),
+			range.second - range.first
+		);
+	}
+	
+	const ro_string_table::num_field_info * first =
+		source_field.data() + range.first;
+	
+	return row_run(
+		reinterpret_cast<const byte *>(&first->original_line_number),
+		sizeof(ro_string_table::num_field_info),
+		range.second - range.first
+	);
 }
 
-void ro_string_table::_throw_not_sealed()
+void ro_string_table::_set_view(const row_run& run, eq_range_view& out)
 {
-	throw std::runtime_error(throw_str("lookup before seal()"));
+	out._tbl = this;
+	out._run = run;
 }
 
-void ro_string_table::_dbg_dump_pool() const
+void ro_string_table::_set_cursor(const row_run& run, eq_range_cursor& out)
 {
-	int len = 0;
-	for (size_t i = 0; i < _pool.size(); ++i)
+	out._tbl = this;
+	out._run = run;
+	out._pos = 0;
+}
+
+void ro_string_table::_field_rows(
+	const ro_string_table::single_field_data& field,
+	const std::pair<size_t, size_t>& range,
+	std::vector<uint>& out_rows
+)
+{
+	if (field.is_dictionary())
+		field.get_postings().decode(range.first, range.second, out_rows);
+	else
 	{
-		const char * pch = _pool.get(i);
-		if (*pch)
-		{
-			std::cout << *pch;
-			++len;
-		}
-		else
-		{
-			std::cout << "|" << static_cast<int>(i-len) << "|";
-			len = 0;
-		}
+		row_run run = _nfi_run(field, range);
+		for (size_t i = 0; i < run.size; ++i)
+			out_rows.push_back(run.get(i));
 	}
-	std::cout << std::endl;
 }
 
-void ro_string_table::dbg_dump()
+void ro_string_table::_fill_field_range(
+	const ro_string_table::single_field_data& field,
+	const std::pair<size_t, size_t>& range,
+	std::vector<eq_range_result>& in_out_targets,
+	value_buffer * buffer
+)
 {
-	std::cout << "@@@ FIELDS @@@" << std::endl;
-	for (size_t i = 0, end = _fields.size(); i < end; ++i)
+	if (field.is_dictionary())
 	{
-		const auto& noconst = _fields.get(i);
-		const_cast<ro_string_table::single_field_data&>(noconst).dbg_dump();
+		std::vector<uint> rows;
+		_field_rows(field, range, rows);
+		_fill_eq_range(
+			row_run(reinterpret_cast<const byte *>(rows.data()),
+				sizeof(uint),
+				rows.size()
+			),
+			in_out_targets,
+			buffer
+		);
 	}
-	std::cout << std::endl;
-	
-	std::cout << "@@@ POOL @@@" << std::endl;
-	_dbg_dump_pool();
-	
-	std::cout << std::endl;
+	else
+		_fill_eq_range(_nfi_run(field, range), in_out_targets, buffer);
+}
+
+void ro_string_table::_set_field_view(
+	const ro_string_table::single_field_data& field,
+	const std::pair<size_t, size_t>& range,
+	eq_range_view& out
+)
+{
+	if (field.is_dictionary())
+		_throw_view_of_dictionary(field);
 	
-	std::cout << "@@@ TABLE @@@" << std::endl;
-	for (uint i = 0; i < _num_lines; ++i)
-	{
-		for (uint j = 0; j < _num_fields; ++j)
-			std::cout << get_str_at(i, j) << " ";
-		std::cout << std::endl;
-	}
+	if (range.first < range.second)
+		_set_view(_nfi_run(field, range), out);
 }
 
-// class ro_string_table::single_field_data
-ro_string_table::single_field_data::single_field_data(
-	int field_num,
+void ro_string_table::_set_field_cursor(
+	const ro_string_table::single_field_data& field,
+	const std::pair<size_t, size_t>& range,
+	eq_range_cursor& out
+)
+{
+	if (field.is_dictionary())
+	{
+		const postings& post = field.get_postings();
+		out._tbl = this;
+		out._reader = postings::reader(post, range.first, range.second);
+		out._run = row_run(nullptr, 0, out._reader.size());
+		out._pos = 0;
+	}
+	else
+		_set_cursor(_nfi_run(field, range), out);
+}
+
+bool ro_string_table::lookup_equal_range(const field_pair& source,
+	std::vector<eq_range_result>& in_out_targets,
+	value_buffer * buffer
+)
+{
+	_check_buffer(buffer);
+	
+	const ro_string_table::single_field_data * out_sfd_ = nullptr;
+	const ro_string_table::single_field_data ** out_sfd = &out_sfd_;
+	std::pair<size_t, size_t> range(0, 0);
+	
+	bool ret = _field_equal_range(source.field_name,
+		_value_ctx(source),
+		_str_ctx_lup,
+		out_sfd,
+		range
+	);
+	
+	if (ret)
+		_fill_field_range(**out_sfd, range, in_out_targets, buffer);
+		
+	return ret;
+}
+
+bool ro_string_table::lookup_equal_range(const field_pair& source,
+	eq_range_view& out
+)
+{
+	const ro_string_table::single_field_data * out_sfd_ = nullptr;
+	const ro_string_table::single_field_data ** out_sfd = &out_sfd_;
+	std::pair<size_t, size_t> range(0, 0);
+	
+	out = eq_range_view();
+	bool ret = _field_equal_range(source.field_name,
+		_value_ctx(source),
+		_str_ctx_lup,
+		out_sfd,
+		range
+	);
+	
+	if (*out_sfd)
+		_set_field_view(**out_sfd, range, out);
+	
+	return ret;
+}
+
+bool ro_string_table::lookup_equal_range(const field_pair& source,
+	eq_range_cursor& out
+)
+{
+	const ro_string_table::single_field_data * out_sfd_ = nullptr;
+	const ro_string_table::single_field_data ** out_sfd = &out_sfd_;
+	std::pair<size_t, size_t> range(0, 0);
+	
+	bool prefetch = out._prefetch;
+	out = eq_range_cursor();
+	out._prefetch = prefetch;
+	
+	bool ret = _field_equal_range(source.field_name,
+		_value_ctx(source),
+		_str_ctx_lup,
+		out_sfd,
+		range
+	);
+	
+	if (ret)
+		_set_field_cursor(**out_sfd, range, out);
+	
+	return ret;
+}
+
+bool ro_string_table::exists(const field_pair& source)
+{
+	if (!_is_sealed)
+		_throw_not_sealed();
+	
+	const ro_string_table::single_field_data * out_sfd_ = nullptr;
+	const ro_string_table::single_field_data ** out_sfd = &out_sfd_;
+	if (!_lookup_field(source.field_name, out_sfd))
+		_throw_no_such_field(source.field_name);
+	
+	uint row = 0;
+	return _lookup_field_val(**out_sfd,
+		source.field_value,
+		row,
+		source.value_len
+	);
+}
+
+size_t ro_string_table::count(const field_pair& source)
+{
+	const ro_string_table::single_field_data * out_sfd_ = nullptr;
+	const ro_string_table::single_field_data ** out_sfd = &out_sfd_;
+	std::pair<size_t, size_t> range(0, 0);
+	
+	if (!_field_equal_range(source.field_name,
+			_value_ctx(source),
+			_str_ctx_lup,
+			out_sfd,
+			range
+		))
+		return 0;
+	
+	const ro_string_table::single_field_data& field = **out_sfd;
+	return (field.is_dictionary()) ?
+		field.get_postings().count(range.first, range.second) :
+		(range.second - range.first);
+}
+
+bool ro_string_table::lookup_prefix(const field_pair& source,
+	std::vector<eq_range_result>& in_out_targets,
+	value_buffer * buffer
+)
+{
+	_check_buffer(buffer);
+	
+	const ro_string_table::single_field_data * out_sfd_ = nullptr;
+	const ro_string_table::single_field_data ** out_sfd = &out_sfd_;
+	std::pair<size_t, size_t> range(0, 0);
+	
+	bool ret = _field_equal_range(source.field_name,
+		_prefix_ctx(source),
+		_str_ctx_prefix_lup,
+		out_sfd,
+		range
+	);
+	
+	if (ret)
+		_fill_field_range(**out_sfd, range, in_out_targets, buffer);
+		
+	return ret;
+}
+
+bool ro_string_table::lookup_prefix(const field_pair& source,
+	eq_range_view& out
+)
+{
+	const ro_string_table::single_field_data * out_sfd_ = nullptr;
+	const ro_string_table::single_field_data ** out_sfd = &out_sfd_;
+	std::pair<size_t, size_t> range(0, 0);
+	
+	out = eq_range_view();
+	bool ret = _field_equal_range(source.field_name,
+		_prefix_ctx(source),
+		_str_ctx_prefix_lup,
+		out_sfd,
+		range
+	);
+	
+	if (*out_sfd)
+		_set_field_view(**out_sfd, range, out);
+	
+	return ret;
+}
+
+bool ro_string_table::lookup_prefix(const field_pair& source,
+	eq_range_cursor& out
+)
+{
+	const ro_string_table::single_field_data * out_sfd_ = nullptr;
+	const ro_string_table::single_field_data ** out_sfd = &out_sfd_;
+	std::pair<size_t, size_t> range(0, 0);
+	
+	bool prefetch = out._prefetch;
+	out = eq_range_cursor();
+	out._prefetch = prefetch;
+	
+	bool ret = _field_equal_range(source.field_name,
+		_prefix_ctx(source),
+		_str_ctx_prefix_lup,
+		out_sfd,
+		range
+	);
+	
+	if (ret)
+		_set_field_cursor(**out_sfd, range, out);
+	
+	return ret;
+}
+
+bool ro_string_table::lookup_range(const char * field_name,
+	const char * low,
+	const char * high,
+	std::vector<eq_range_result>& in_out_targets,
+	int incl,
+	value_buffer * buffer
+)
+{
+	_check_buffer(buffer);
+	
+	const ro_string_table::single_field_data * out_sfd_ = nullptr;
+	const ro_string_table::single_field_data ** out_sfd = &out_sfd_;
+	std::pair<size_t, size_t> range(0, 0);
+	
+	bool ret = _field_range(field_name, low, high, incl, out_sfd, range);
+	if (ret)
+		_fill_field_range(**out_sfd, range, in_out_targets, buffer);
+	
+	return ret;
+}
+
+bool ro_string_table::lookup_range(const char * field_name,
+	const char * low,
+	const char * high,
+	eq_range_view& out,
+	int incl
+)
+{
+	const ro_string_table::single_field_data * out_sfd_ = nullptr;
+	const ro_string_table::single_field_data ** out_sfd = &out_sfd_;
+	std::pair<size_t, size_t> range(0, 0);
+	
+	out = eq_range_view();
+	bool ret = _field_range(field_name, low, high, incl, out_sfd, range);
+	if (*out_sfd)
+		_set_field_view(**out_sfd, range, out);
+	
+	return ret;
+}
+
+bool ro_string_table::lookup_range(const char * field_name,
+	const char * low,
+	const char * high,
+	eq_range_cursor& out,
+	int incl
+)
+{
+	const ro_string_table::single_field_data * out_sfd_ = nullptr;
+	const ro_string_table::single_field_data ** out_sfd = &out_sfd_;
+	std::pair<size_t, size_t> range(0, 0);
+	
+	bool prefetch = out._prefetch;
+	out = eq_range_cursor();
+	out._prefetch = prefetch;
+	
+	bool ret = _field_range(field_name, low, high, incl, out_sfd, range);
+	if (ret)
+		_set_field_cursor(**out_sfd, range, out);
+	
+	return ret;
+}
+
+bool ro_string_table::_field_numeric_range(const char * field_name,
+	const char * low,
+	const char * high,
+	int incl,
+	row_run& out
+)
+{
+	bool ret = false;
+	
+	if (_is_sealed)
+	{
+		const ro_string_table::single_field_data * out_sfd_ = nullptr;
+		const ro_string_table::single_field_data ** out_sfd = &out_sfd_;
+		
+		if (_lookup_field(field_name, out_sfd))
+		{
+			ro_string_table::single_field_data&
+				field =
+					const_cast<ro_string_table::single_field_data&>(**out_sfd);
+			
+			if (!field.is_numeric())
+				_throw_field_not_numeric(field_name);
+			
+			auto cmp = [](const ro_string_table::num_field_key& lhs,
+				const ro_string_table::num_field_key& dummy_rhs,
+				ro_string_table::num_context ctx
+			)
+			{
+				return ro_string_table::single_field_data::compare_num(
+					lhs.value, ctx.value, ctx.type
+				);
+			};
+			
+			gen_comp_less_ctx_lower_bound<ro_string_table::num_field_key,
+				ro_string_table::num_context> less_lwr_ctx(cmp);
+			
+			gen_comp_less_ctx_upper_bound<ro_string_table::num_field_key,
+				ro_string_table::num_context> less_upr_ctx(cmp);
+			
+			num_value val;
+			size_t begin = 0, end = field.num_size();
+			if (low)
+			{
+				if (!field.parse(low, val))
+					_throw_bad_number(field, low);
+				
+				num_context ctx(field.get_type(), val);
+				less_lwr_ctx.set_context(ctx);
+				less_upr_ctx.set_context(ctx);
+				begin = (incl & INCL_LOW) ?
+					field.num_lower_bound(less_lwr_ctx) :
+					field.num_upper_bound(less_upr_ctx);
+			}
+			
+			if (high)
+			{
+				if (!field.parse(high, val))
+					_throw_bad_number(field, high);
+				
+				num_context ctx(field.get_type(), val);
+				less_lwr_ctx.set_context(ctx);
+				less_upr_ctx.set_context(ctx);
+				end = (incl & INCL_HIGH) ?
+					field.num_upper_bound(less_upr_ctx) :
+					field.num_lower_bound(less_lwr_ctx);
+			}
+			
+			if (end < begin)
+				end = begin;
+			
+			const ro_string_table::num_field_key * first =
+				field.num_data() + begin;
+			out = row_run(
+				reinterpret_cast<const byte *>(&first->original_line_number),
+				sizeof(ro_string_table::num_field_key),
+				end - begin
+			);
+			ret = (begin < end);
+		}
+		else
+			_throw_no_such_field(field_name);
+	}
+	else
+		_throw_not_sealed();
+	
+	return ret;
+}
+
+bool ro_string_table::lookup_numeric(const field_pair& source,
+	std::vector<eq_range_result>& in_out_targets,
+	value_buffer * buffer
+)
+{
+	return lookup_numeric_range(source.field_name,
+		source.field_value,
+		source.field_value,
+		in_out_targets,
+		INCL_BOTH,
+		buffer
+	);
+}
+
+bool ro_string_table::lookup_numeric(const field_pair& source,
+	eq_range_view& out
+)
+{
+	return lookup_numeric_range(source.field_name,
+		source.field_value,
+		source.field_value,
+		out
+	);
+}
+
+bool ro_string_table::lookup_numeric(const field_pair& source,
+	eq_range_cursor& out
+)
+{
+	return lookup_numeric_range(source.field_name,
+		source.field_value,
+		source.field_value,
+		out
+	);
+}
+
+bool ro_string_table::lookup_numeric_range(const char * field_name,
+	const char * low,
+	const char * high,
+	std::vector<eq_range_result>& in_out_targets,
+	int incl,
+	value_buffer * buffer
+)
+{
+	_check_buffer(buffer);
+	
+	row_run run;
+	bool ret = _field_numeric_range(field_name, low, high, incl, run);
+	if (ret)
+		_fill_eq_range(run, in_out_targets, buffer);
+	
+	return ret;
+}
+
+bool ro_string_table::lookup_numeric_range(const char * field_name,
+	const char * low,
+	const char * high,
+	eq_range_view& out,
+	int incl
+)
+{
+	row_run run;
+	out = eq_range_view();
+	bool ret = _field_numeric_range(field_name, low, high, incl, run);
+	if (ret)
+		_set_view(run, out);
+	
+	return ret;
+}
+
+bool ro_string_table::lookup_numeric_range(const char * field_name,
+	const char * low,
+	const char * high,
+	eq_range_cursor& out,
+	int incl
+)
+{
+	row_run run;
+	bool prefetch = out._prefetch;
+	out = eq_range_cursor();
+	out._prefetch = prefetch;
+	
+	bool ret = _field_numeric_range(field_name, low, high, incl, run);
+	if (ret)
+		_set_cursor(run, out);
+	
+	return ret;
+}
+
+const ro_string_table::composite_index * ro_string_table::_find_composite(
+	const std::vector<field_pair>& keys,
+	bool full_unique
+)
+{
+	const ro_string_table::composite_index * found = nullptr;
+	
+	for (auto& comp : _composites)
+	{
+		if (comp.begins_with(keys))
+		{
+			if (!full_unique)
+				return &comp;
+			
+			if (comp.num_cols() == keys.size())
+			{
+				found = &comp;
+				if (comp.is_unique())
+					return found;
+			}
+		}
+	}
+	
+	std::string names;
+	for (auto& key : keys)
+	{
+		if (!names.empty())
+			names += ", ";
+		names += key.field_name;
+	}
+	
+	if (found)
+	{
+		std::string err(throw_str("unique lookup of non-unique composite index '"));
+		err += names;
+		err += "'";
+		throw std::runtime_error(err);
+	}
+	
+	std::string err(throw_str("lookup fail: no composite index on '"));
+	err += names;
+	err += "'";
+	throw std::runtime_error(err);
+	
+	return nullptr; // make gcc happy
+}
+
+bool ro_string_table::_composite_range(const std::vector<field_pair>& keys,
+	row_run& out
+)
+{
+	bool ret = false;
+	
+	if (_is_sealed)
+	{
+		ro_string_table::composite_index& comp =
+			const_cast<ro_string_table::composite_index&>(
+				*_find_composite(keys, false)
+			);
+		
+		std::pair<size_t, size_t> range(0, 0);
+		ret = comp.equal_range(keys.data(), keys.size(), range);
+		out = row_run(
+			reinterpret_cast<const byte *>(comp.data() + range.first),
+			sizeof(uint),
+			range.second - range.first
+		);
+	}
+	else
+		_throw_not_sealed();
+	
+	return ret;
+}
+
+bool ro_string_table::lookup_composite(const std::vector<field_pair>& keys,
+	std::vector<field_pair>& in_out_targets,
+	value_buffer * buffer
+)
+{
+	_check_buffer(buffer);
+	
+	bool ret = false;
+	
+	if (_is_sealed)
+	{
+		ro_string_table::composite_index& comp =
+			const_cast<ro_string_table::composite_index&>(
+				*_find_composite(keys, true)
+			);
+		
+		std::pair<size_t, size_t> range(0, 0);
+		if (comp.equal_range(keys.data(), keys.size(), range))
+		{
+			const ro_string_table::single_field_data * out_sfd_ = nullptr;
+			const ro_string_table::single_field_data ** out_sfd = &out_sfd_;
+			
+			uint value_row = comp.data()[range.first];
+			for (field_pair& pair : in_out_targets)
+			{
+				if (_lookup_field(pair.field_name, out_sfd))
+				{
+					uint value_col = (*out_sfd)->field_number();
+					uint at = _data_map.get(value_row, value_col);
+					pair.field_value = _value_of(at, buffer);
+					if (_pool.has_lengths())
+						pair.value_len = _pool.get_len(at);
+				}
+				else
+					_throw_no_such_field(pair.field_name);
+			}
+			ret = true;
+		}
+	}
+	else
+		_throw_not_sealed();
+	
+	return ret;
+}
+
+bool ro_string_table::lookup_composite(const std::vector<field_pair>& keys,
+	std::vector<eq_range_result>& in_out_targets,
+	value_buffer * buffer
+)
+{
+	_check_buffer(buffer);
+	
+	row_run run;
+	bool ret = _composite_range(keys, run);
+	if (ret)
+		_fill_eq_range(run, in_out_targets, buffer);
+	
+	return ret;
+}
+
+bool ro_string_table::lookup_composite(const std::vector<field_pair>& keys,
+	eq_range_view& out
+)
+{
+	row_run run;
+	out = eq_range_view();
+	bool ret = _composite_range(keys, run);
+	if (ret)
+		_set_view(run, out);
+	
+	return ret;
+}
+
+bool ro_string_table::lookup_composite(const std::vector<field_pair>& keys,
+	eq_range_cursor& out
+)
+{
+	row_run run;
+	bool prefetch = out._prefetch;
+	out = eq_range_cursor();
+	out._prefetch = prefetch;
+	
+	bool ret = _composite_range(keys, run);
+	if (ret)
+		_set_cursor(run, out);
+	
+	return ret;
+}
+
+size_t ro_string_table::_gallop(const row_run& run, size_t from, uint row)
+{
+	return _gallop_if(from, run.size,
+		[&run, row](size_t i) {return run.get(i) < row;}
+	);
+}
+
+bool ro_string_table::lookup_and(const std::vector<field_pair>& predicates,
+	std::vector<uint>& out_rows
+)
+{
+	out_rows.clear();
+	
+	if (!_is_sealed)
+		_throw_not_sealed();
+	
+	std::vector<row_run> runs;
+	runs.reserve(predicates.size());
+	
+	// dictionary fields have no row ids to read in place, so theirs are
+	// decoded here; reserved, so the runs can point inside
+	std::vector<std::vector<uint>> decoded;
+	decoded.reserve(predicates.size());
+	for (const field_pair& pred : predicates)
+	{
+		const ro_string_table::single_field_data * out_sfd_ = nullptr;
+		const ro_string_table::single_field_data ** out_sfd = &out_sfd_;
+		std::pair<size_t, size_t> range(0, 0);
+		
+		if (!_field_equal_range(pred.field_name,
+				_value_ctx(pred),
+				_str_ctx_lup,
+				out_sfd,
+				range
+			))
+		{
+			// check the names of the rest before giving up
+			for (const field_pair& other : predicates)
+				get_field_col(other.field_name);
+			return false;
+		}
+		
+		if ((*out_sfd)->is_dictionary())
+		{
+			decoded.push_back(std::vector<uint>());
+			std::vector<uint>& rows = decoded.back();
+			_field_rows(**out_sfd, range, rows);
+			runs.push_back(row_run(reinterpret_cast<const byte *>(rows.data()),
+				sizeof(uint),
+				rows.size()
+			));
+		}
+		else
+			runs.push_back(_nfi_run(**out_sfd, range));
+	}
+	
+	if (runs.empty())
+		return false;
+	
+	// most selective first; the candidates can only shrink
+	std::sort(runs.begin(), runs.end(),
+		[](const row_run& a, const row_run& b) {return a.size < b.size;}
+	);
+	
+	const row_run& first = runs[0];
+	out_rows.resize(first.size);
+	for (size_t i = 0; i < first.size; ++i)
+		out_rows[i] = first.get(i);
+	
+	for (size_t r = 1, end = runs.size(); r < end && !out_rows.empty(); ++r)
+	{
+		const row_run& run = runs[r];
+		size_t pos = 0, kept = 0;
+		for (size_t i = 0, cnt = out_rows.size(); i < cnt; ++i)
+		{
+			uint row = out_rows[i];
+			pos = _gallop(run, pos, row);
+			if (pos == run.size)
+				break;
+			
+			if (run.get(pos) == row)
+				out_rows[kept++] = row;
+		}
+		out_rows.resize(kept);
+	}
+	
+	return !out_rows.empty();
+}
+
+bool ro_string_table::lookup_and(const std::vector<field_pair>& predicates,
+	std::vector<eq_range_result>& in_out_targets,
+	value_buffer * buffer
+)
+{
+	_check_buffer(buffer);
+	
+	std::vector<uint> rows;
+	bool ret = lookup_and(predicates, rows);
+	
+	if (ret)
+	{
+		row_run run(reinterpret_cast<const byte *>(rows.data()),
+			sizeof(uint),
+			rows.size()
+		);
+		_fill_eq_range(run, in_out_targets, buffer);
+	}
+	
+	return ret;
+}
+
+bool ro_string_table::lookup_in(const char * field_name,
+	const std::vector<const char *>& values,
+	std::vector<uint>& out_rows,
+	int flags
+)
+{
+	out_rows.clear();
+	
+	if (!_is_sealed)
+		_throw_not_sealed();
+	
+	const ro_string_table::single_field_data * out_sfd_ = nullptr;
+	const ro_string_table::single_field_data ** out_sfd = &out_sfd_;
+	if (!_lookup_field(field_name, out_sfd))
+		_throw_no_such_field(field_name);
+	
+	const ro_string_table::single_field_data& field = **out_sfd;
+	const string_pool& pool = _pool;
+	const compressed_pool * packed = _packed_pool();
+	int how = field.get_collation();
+	
+	std::vector<const char *> sorted(values);
+	std::sort(sorted.begin(), sorted.end(),
+		[how](const char * a, const char * b)
+		{return collation::compare(a, b, how) < 0;}
+	);
+	
+	size_t pos = 0, end = field.size();
+	size_t last_begin = 0, last_end = 0;
+	const char * last = nullptr;
+	for (const char * val : sorted)
+	{
+		if (last && 0 == collation::compare(last, val, how))
+		{
+			if (!(flags & IN_DEDUP))
+			{
+				_field_rows(field,
+					std::pair<size_t, size_t>(last_begin, last_end),
+					out_rows
+				);
+			}
+			continue;
+		}
+		last = val;
+		
+		if (field.is_front_coded())
+		{
+			const front_coded& values = field.get_front_coded();
+			last_begin = values.lower_bound(val, strlen(val));
+			last_end = values.upper_bound(val, strlen(val));
+		}
+		else
+		{
+			const ro_string_table::num_field_info * data = field.data();
+			size_t len = (pool.has_lengths() || packed) ? strlen(val) : 0;
+			auto cmp = [data, &pool, packed, val, len, how](size_t i)
+			{
+				uint at = data[i].index_of_string;
+				return (packed) ?
+					compare_packed(*packed, at, val, len, how) :
+					compare_pooled(pool, at, val, len, how);
+			};
+			
+			last_begin = _gallop_if(pos, end,
+				[&cmp](size_t i) {return cmp(i) < 0;}
+			);
+			last_end = _gallop_if(last_begin, end,
+				[&cmp](size_t i) {return cmp(i) <= 0;}
+			);
+		}
+		
+		_field_rows(field,
+			std::pair<size_t, size_t>(last_begin, last_end),
+			out_rows
+		);
+		
+		pos = last_end;
+	}
+	
+	if (flags & IN_ROW_ORDER)
+		std::sort(out_rows.begin(), out_rows.end());
+	
+	return !out_rows.empty();
+}
+
+bool ro_string_table::lookup_in(const char * field_name,
+	const std::vector<const char *>& values,
+	std::vector<eq_range_result>& in_out_targets,
+	int flags,
+	value_buffer * buffer
+)
+{
+	_check_buffer(buffer);
+	
+	std::vector<uint> rows;
+	bool ret = lookup_in(field_name, values, rows, flags);
+	
+	if (ret)
+	{
+		row_run run(reinterpret_cast<const byte *>(rows.data()),
+			sizeof(uint),
+			rows.size()
+		);
+		_fill_eq_range(run, in_out_targets, buffer);
+	}
+	
+	return ret;
+}
+
+void ro_string_table::get_row(uint row,
+	std::vector<cell>& out,
+	value_buffer * buffer
+)
+{
+	_check_buffer(buffer);
+	
+	out.resize(_num_fields);
+	_cells_of(row, out.data(), buffer);
+}
+
+void ro_string_table::get_rows(const uint * rows,
+	size_t n,
+	std::vector<cell>& out,
+	value_buffer * buffer
+)
+{
+	_check_buffer(buffer);
+	
+	// the matrix row is needed to find the strings, so it's fetched first
+	const size_t dist = 4;
+	
+	out.resize(n * _num_fields);
+	for (size_t i = 0; i < n && i < 2*dist; ++i)
+	{
+		if (rows[i] < _current_line)
+			prefetch(&_data_map.get(rows[i], 0));
+	}
+	
+	for (size_t i = 0; i < n; ++i)
+	{
+		if (i + 2*dist < n && rows[i + 2*dist] < _current_line)
+			prefetch(&_data_map.get(rows[i + 2*dist], 0));
+		
+		if (i + dist < n)
+			_prefetch_cells(rows[i + dist]);
+		
+		_cells_of(rows[i], out.data() + i*_num_fields, buffer);
+	}
+}
+
+void ro_string_table::_cells_of(uint row, cell * out, value_buffer * buffer)
+{
+	/*
+	   The pool gets the strings in the same order the matrix does, so a
+	   string ends where the one in the next cell begins. With lengths the
+	   next one begins after its length, which is read instead, and with
+	   interning the next cell may point to a string from long before.
+	   Compressed values are decompressed, and their lengths counted.
+	*/
+	if (row >= _current_line)
+		_throw_bad_row(row);
+	
+	if (!_num_fields)
+		return;
+	
+	const uint * offs = &_data_map.get(row, 0);
+	if (_packed.is_trained())
+	{
+		for (uint col = 0; col < _num_fields; ++col)
+		{
+			const char * str = (row) ?
+				buffer->_unpack(_packed, offs[col]) :
+				_pool.get(offs[col]);
+			out[col] = cell(str, strlen(str));
+		}
+		return;
+	}
+	
+	if (_pool.has_lengths() || _shares_strings)
+	{
+		for (uint col = 0; col < _num_fields; ++col)
+			out[col] = cell(_pool.get(offs[col]), _pool.get_len(offs[col]));
+		return;
+	}
+	
+	const uint last = _num_fields - 1;
+	for (uint col = 0; col < last; ++col)
+		out[col] = cell(_pool.get(offs[col]), offs[col+1] - offs[col] - 1);
+	
+	uint end = (row+1 < _current_line || _current_field) ?
+		_data_map.get(row+1, 0) : _pool.size();
+	out[last] = cell(_pool.get(offs[last]), end - offs[last] - 1);
+}
+
+void ro_string_table::_prefetch_cells(uint row)
+{
+	if (row < _current_line && !_is_packed(row))
+	{
+		const uint * offs = &_data_map.get(row, 0);
+		for (uint col = 0; col < _num_fields; ++col)
+			prefetch(_pool.get(offs[col]));
+	}
+}
+
+const ro_string_table::single_field_data& ro_string_table::_sealed_field(
+	const char * field_name
+)
+{
+	if (!_is_sealed)
+		_throw_not_sealed();
+	
+	const ro_string_table::single_field_data * out_sfd_ = nullptr;
+	const ro_string_table::single_field_data ** out_sfd = &out_sfd_;
+	if (!_lookup_field(field_name, out_sfd))
+		_throw_no_such_field(field_name);
+	
+	return **out_sfd;
+}
+
+size_t ro_string_table::_group_end(
+	const ro_string_table::single_field_data& field,
+	size_t from
+)
+{
+	if (field.is_dictionary())
+		return from + 1;
+	
+	// get() rather than data(), which a front coded field doesn't have
+	const string_pool& pool = _pool;
+	uint val = field.get(from).index_of_string;
+	int how = field.get_collation();
+	
+	if (const compressed_pool * packed = _packed_pool())
+	{
+		return _gallop_if(from, field.size(),
+			[&field, packed, val, how](size_t i)
+			{
+				return equal_packed(*packed,
+					field.get(i).index_of_string,
+					val,
+					how
+				);
+			}
+		);
+	}
+	
+	return _gallop_if(from, field.size(),
+		[&field, &pool, val, how](size_t i)
+		{
+			return 0 == compare_pooled(pool,
+				field.get(i).index_of_string,
+				val,
+				how
+			);
+		}
+	);
+}
+
+size_t ro_string_table::_group_count(
+	const ro_string_table::single_field_data& field,
+	size_t begin,
+	size_t end
+)
+{
+	return (field.is_dictionary()) ?
+		field.get_postings().count(begin, end) :
+		(end - begin);
+}
+
+void ro_string_table::group_by(const char * field_name, group_cursor& out)
+{
+	out = group_cursor();
+	out._field = &_sealed_field(field_name);
+	out._tbl = this;
+}
+
+size_t ro_string_table::group_cursor::next(size_t n,
+	std::vector<value_count>& out
+)
+{
+	out.clear();
+	if (!_field)
+		return 0;
+	
+	const ro_string_table::single_field_data& field = *_field;
+	_values.clear();
+	for (size_t end = field.size(); out.size() < n && _pos < end; )
+	{
+		size_t group_end = _tbl->_group_end(field, _pos);
+		out.push_back(value_count(
+			_tbl->_value_of(field.get(_pos).index_of_string, &_values),
+			_tbl->_group_count(field, _pos, group_end)
+		));
+		_pos = group_end;
+	}
+	
+	return out.size();
+}
+
+bool ro_string_table::group_cursor::at_end() const
+{
+	return (!_field || _pos >= _field->size());
+}
+
+void ro_string_table::_group_parts(
+	const ro_string_table::single_field_data& field,
+	uint threads,
+	std::vector<size_t>& out_bounds
+)
+{
+	// moves each split point forward to the beginning of a group
+	size_t size = field.size();
+	out_bounds.assign(1, 0);
+	for (uint i = 1; i < threads; ++i)
+	{
+		size_t at = std::max((size * i) / threads, out_bounds.back());
+		if (at > 0 && at < size)
+			at = _group_end(field, at - 1);
+		out_bounds.push_back(std::min(at, size));
+	}
+	out_bounds.push_back(size);
+}
+
+void ro_string_table::group_counts(const char * field_name,
+	std::vector<value_count>& out,
+	uint threads,
+	value_buffer * buffer
+)
+{
+	_check_buffer(buffer);
+	
+	const ro_string_table::single_field_data& field = _sealed_field(field_name);
+	out.clear();
+	
+	if (!threads)
+		threads = std::max(std::thread::hardware_concurrency(), 1u);
+	
+	std::vector<size_t> bounds;
+	_group_parts(field, threads, bounds);
+	
+	// the values are placed by this thread, after the others are done with
+	// the parts, since buffer is not to be shared
+	std::vector<std::vector<ranked_group>> parts(threads);
+	auto walk = [this, &field, &bounds, &parts](uint part)
+	{
+		std::vector<ranked_group>& res = parts[part];
+		for (size_t pos = bounds[part], end = bounds[part+1]; pos < end; )
+		{
+			size_t group_end = _group_end(field, pos);
+			res.push_back(ranked_group(pos,
+				value_count(nullptr, _group_count(field, pos, group_end))
+			));
+			pos = group_end;
+		}
+	};
+	
+	std::vector<std::thread> workers;
+	for (uint i = 1; i < threads; ++i)
+		workers.push_back(std::thread(walk, i));
+	walk(0);
+	for (auto& thr : workers)
+		thr.join();
+	
+	for (auto& part : parts)
+	{
+		for (auto& grp : part)
+		{
+			uint at = field.get(grp.first).index_of_string;
+			grp.second.value = _value_of(at, buffer);
+			out.push_back(grp.second);
+		}
+	}
+}
+
+void ro_string_table::_group_top_part(
+	const ro_string_table::single_field_data& field,
+	size_t begin,
+	size_t end,
+	size_t k,
+	std::vector<ranked_group>& out
+)
+{
+	// the heap keeps the worst of the best k on top; of two equal counts the
+	// group which comes later in sorted order is worse
+	out.clear();
+	if (!k)
+		return;
+	
+	for (size_t pos = begin; pos < end; )
+	{
+		size_t group_end = _group_end(field, pos);
+		ranked_group grp(pos,
+			value_count(nullptr, _group_count(field, pos, group_end))
+		);
+		
+		if (out.size() < k)
+		{
+			out.push_back(grp);
+			std::push_heap(out.begin(), out.end(), _is_better_group);
+		}
+		else if (_is_better_group(grp, out.front()))
+		{
+			std::pop_heap(out.begin(), out.end(), _is_better_group);
+			out.back() = grp;
+			std::push_heap(out.begin(), out.end(), _is_better_group);
+		}
+		pos = group_end;
+	}
+}
+
+void ro_string_table::group_top(const char * field_name,
+	size_t k,
+	std::vector<value_count>& out,
+	uint threads,
+	value_buffer * buffer
+)
+{
+	_check_buffer(buffer);
+	
+	const ro_string_table::single_field_data& field = _sealed_field(field_name);
+	out.clear();
+	
+	if (!threads)
+		threads = std::max(std::thread::hardware_concurrency(), 1u);
+	
+	std::vector<size_t> bounds;
+	_group_parts(field, threads, bounds);
+	
+	std::vector<std::vector<ranked_group>> parts(threads);
+	auto walk = [this, &field, &bounds, &parts, k](uint part)
+	{_group_top_part(field, bounds[part], bounds[part+1], k, parts[part]);};
+	
+	std::vector<std::thread> workers;
+	for (uint i = 1; i < threads; ++i)
+		workers.push_back(std::thread(walk, i));
+	walk(0);
+	for (auto& thr : workers)
+		thr.join();
+	
+	std::vector<ranked_group> all;
+	for (auto& part : parts)
+		all.insert(all.end(), part.begin(), part.end());
+	
+	std::sort(all.begin(), all.end(), _is_better_group);
+	for (size_t i = 0, end = std::min(k, all.size()); i < end; ++i)
+	{
+		uint at = field.get(all[i].first).index_of_string;
+		all[i].second.value = _value_of(at, buffer);
+		out.push_back(all[i].second);
+	}
+}
+
+void ro_string_table::order_by(const char * field_name,
+	ordered_cursor& out,
+	int dir
+)
+{
+	order_by(field_name, nullptr, out, dir);
+}
+
+void ro_string_table::order_by(const char * field_name,
+	const char * from,
+	ordered_cursor& out,
+	int dir,
+	bool inclusive
+)
+{
+	out = ordered_cursor();
+	
+	const ro_string_table::single_field_data& field = _sealed_field(field_name);
+	bool is_reverse = (ORDER_DESC == dir);
+	const char * low = (is_reverse) ? nullptr : from;
+	const char * high = (is_reverse) ? from : nullptr;
+	int incl = (inclusive) ? INCL_BOTH : INCL_NONE;
+	
+	if (field.is_numeric())
+	{
+		row_run run;
+		_field_numeric_range(field_name, low, high, incl, run);
+		out._tbl = this;
+		out._run = run;
+		out._size = run.size;
+		out._reverse = is_reverse;
+	}
+	else
+	{
+		const ro_string_table::single_field_data * out_sfd_ = nullptr;
+		const ro_string_table::single_field_data ** out_sfd = &out_sfd_;
+		std::pair<size_t, size_t> range;
+		_field_range(field_name, low, high, incl, out_sfd, range);
+		_set_ordered(field, range, dir, out);
+	}
+}
+
+void ro_string_table::_set_ordered(
+	const ro_string_table::single_field_data& field,
+	const std::pair<size_t, size_t>& range,
+	int dir,
+	ordered_cursor& out
+)
+{
+	out._tbl = this;
+	out._reverse = (ORDER_DESC == dir);
+	
+	if (field.is_dictionary())
+	{
+		out._dict = &field;
+		out._first_entry = range.first;
+		out._last_entry = range.second;
+		out._size = field.get_postings().count(range.first, range.second);
+	}
+	else
+	{
+		out._run = _nfi_run(field, range);
+		out._size = out._run.size;
+	}
+	
+	out.rewind();
+}
+
+const ro_string_table::single_field_data& ro_string_table::_fuzzy_field(
+	const char * field_name
+)
+{
+	const ro_string_table::single_field_data& field = _sealed_field(field_name);
+	if (!field.is_fuzzy())
+		_throw_no_fuzzy_index(field);
+	return field;
+}
+
+void ro_string_table::_fill_fuzzy(
+	const ro_string_table::single_field_data& field,
+	const std::vector<fuzzy::bk_tree::match>& matches,
+	std::vector<fuzzy_match>& out,
+	value_buffer * buffer
+)
+{
+	out.clear();
+	for (auto& mt : matches)
+	{
+		out.push_back(fuzzy_match(
+			_value_of(field.get(mt.id).index_of_string, buffer),
+			mt.distance,
+			_group_count(field, mt.id, _group_end(field, mt.id))
+		));
+	}
+}
+
+bool ro_string_table::lookup_fuzzy(const field_pair& source,
+	uint max_distance,
+	std::vector<fuzzy_match>& out,
+	value_buffer * buffer
+)
+{
+	_check_buffer(buffer);
+	
+	const ro_string_table::single_field_data& field =
+		_fuzzy_field(source.field_name);
+	
+	single_field_data::value_ctx ctx(&field);
+	std::vector<fuzzy::bk_tree::match> matches;
+	field.get_fuzzy().within(source.field_value,
+		max_distance,
+		single_field_data::fuzzy_str,
+		&ctx,
+		matches
+	);
+	_fill_fuzzy(field, matches, out, buffer);
+	
+	return !out.empty();
+}
+
+bool ro_string_table::lookup_nearest(const field_pair& source,
+	size_t n,
+	std::vector<fuzzy_match>& out,
+	value_buffer * buffer
+)
+{
+	_check_buffer(buffer);
+	
+	const ro_string_table::single_field_data& field =
+		_fuzzy_field(source.field_name);
+	
+	single_field_data::value_ctx ctx(&field);
+	std::vector<fuzzy::bk_tree::match> matches;
+	field.get_fuzzy().nearest(source.field_value,
+		n,
+		single_field_data::fuzzy_str,
+		&ctx,
+		matches
+	);
+	_fill_fuzzy(field, matches, out, buffer);
+	
+	return !out.empty();
+}
+
+bool ro_string_table::lookup_contains(const field_pair& source,
+	std::vector<uint>& out_rows
+)
+{
+	const ro_string_table::single_field_data& field =
+		_sealed_field(source.field_name);
+	if (!field.has_substrings())
+		_throw_no_substring_index(field);
+	
+	single_field_data::value_ctx ctx(&field);
+	return (field.get_substrings().find(source.field_value,
+		single_field_data::substring_str,
+		&ctx,
+		out_rows
+	) > 0);
+}
+
+bool ro_string_table::lookup_contains(const field_pair& source,
+	std::vector<eq_range_result>& in_out_targets,
+	value_buffer * buffer
+)
+{
+	_check_buffer(buffer);
+	
+	std::vector<uint> rows;
+	bool ret = lookup_contains(source, rows);
+	if (ret)
+	{
+		_fill_eq_range(
+			row_run(reinterpret_cast<const byte *>(rows.data()),
+				sizeof(uint),
+				rows.size()
+			),
+			in_out_targets,
+			buffer
+		);
+	}
+	
+	return ret;
+}
+
+size_t ro_string_table::get_substring_memory(const char * field_name)
+{
+	const ro_string_table::single_field_data * out_sfd_ = nullptr;
+	const ro_string_table::single_field_data ** out_sfd = &out_sfd_;
+	if (!_lookup_field(field_name, out_sfd))
+		_throw_no_such_field(field_name);
+	
+	return ((*out_sfd)->has_substrings()) ?
+		(*out_sfd)->get_substrings().memory() :
+		0;
+}
+
+bool ro_string_table::get_filter_stats(const char * field_name,
+	filter_stats& out
+)
+{
+	const ro_string_table::single_field_data& field = _sealed_field(field_name);
+	if (!field.has_filter())
+		return false;
+	
+	out.keys = field.get_filter().keys();
+	out.bytes = field.get_filter().memory();
+	out.false_positive_rate = field.get_filter().false_positive_rate();
+	return true;
+}
+
+bool ro_string_table::get_learned_stats(const char * field_name,
+	learned_stats& out
+)
+{
+	const ro_string_table::single_field_data& field = _sealed_field(field_name);
+	if (!field.is_learned())
+		return false;
+	
+	out.segments = field.get_learned().segments();
+	out.max_error = field.get_learned().max_error();
+	out.bytes = field.get_learned().memory();
+	return true;
+}
+
+bool ro_string_table::get_front_coded_stats(const char * field_name,
+	front_coded_stats& out
+)
+{
+	const ro_string_table::single_field_data& field = _sealed_field(field_name);
+	if (!field.is_front_coded())
+		return false;
+	
+	out.blocks = field.get_front_coded().blocks();
+	out.bytes = field.front_coded_memory();
+	return true;
+}
+
+bool ro_string_table::is_interned(const char * field_name)
+{
+	return _sealed_field(field_name).is_interning();
+}
+
+bool ro_string_table::lookup_tokens(const char * field_name,
+	const std::vector<const char *>& tokens,
+	std::vector<uint>& out_rows,
+	int how
+)
+{
+	const ro_string_table::single_field_data& field = _sealed_field(field_name);
+	if (!field.has_tokens())
+		_throw_no_token_index(field);
+	
+	if (TOKENS_ANY == how)
+		field.get_tokens().find_any(tokens, out_rows);
+	else
+		field.get_tokens().find_all(tokens, out_rows);
+	
+	return !out_rows.empty();
+}
+
+bool ro_string_table::lookup_tokens(const char * field_name,
+	const std::vector<const char *>& tokens,
+	std::vector<eq_range_result>& in_out_targets,
+	int how,
+	value_buffer * buffer
+)
+{
+	_check_buffer(buffer);
+	
+	std::vector<uint> rows;
+	bool ret = lookup_tokens(field_name, tokens, rows, how);
+	if (ret)
+	{
+		_fill_eq_range(
+			row_run(reinterpret_cast<const byte *>(rows.data()),
+				sizeof(uint),
+				rows.size()
+			),
+			in_out_targets,
+			buffer
+		);
+	}
+	
+	return ret;
+}
+
+uint ro_string_table::get_field_col(const char * field_name)
+{
+	const ro_string_table::single_field_data * out_sfd_ = nullptr;
+	const ro_string_table::single_field_data ** out_sfd = &out_sfd_;
+	
+	if (!_lookup_field(field_name, out_sfd))
+		_throw_no_such_field(field_name);
+	
+	return (*out_sfd)->field_number();
+}
+
+// class ro_string_table::eq_range_cursor
+size_t ro_string_table::eq_range_cursor::skip(size_t n)
+{
+	size_t step = std::min(n, remaining());
+	if (_reader.is_valid())
+		_reader.skip(step);
+	_pos += step;
+	return step;
+}
+
+size_t ro_string_table::eq_range_cursor::next(size_t n,
+	std::vector<uint>& out_rows
+)
+{
+	size_t page = std::min(n, remaining());
+	
+	out_rows.clear();
+	for (size_t i = 0; i < page; ++i)
+		out_rows.push_back(_next_row());
+	
+	if (_prefetch)
+		_prefetch_rows(n, nullptr, 0);
+	
+	return page;
+}
+
+size_t ro_string_table::eq_range_cursor::next(size_t n,
+	std::vector<eq_range_result>& in_out_targets
+)
+{
+	size_t page = std::min(n, remaining());
+	
+	const ro_string_table::single_field_data * out_sfd_ = nullptr;
+	const ro_string_table::single_field_data ** out_sfd = &out_sfd_;
+	
+	size_t num_cols = in_out_targets.size();
+	std::vector<uint> cols(num_cols);
+	for (size_t t = 0; t < num_cols; ++t)
+	{
+		eq_range_result& elem = in_out_targets[t];
+		elem.values.clear();
+		if (!page)
+			continue;
+		
+		if (_tbl->_lookup_field(elem.field_name, out_sfd))
+			cols[t] = (*out_sfd)->field_number();
+		else
+			_tbl->_throw_no_such_field(elem.field_name);
+	}
+	
+	_values.clear();
+	for (size_t i = 0; i < page; ++i)
+	{
+		uint row = _next_row();
+		for (size_t t = 0; t < num_cols; ++t)
+		{
+			uint at = _tbl->_data_map.get(row, cols[t]);
+			in_out_targets[t].values.push_back(_tbl->_value_of(at, &_values));
+		}
+	}
+	
+	if (_prefetch)
+		_prefetch_rows(n, cols.data(), num_cols);
+	
+	return page;
+}
+
+void ro_string_table::eq_range_cursor::_prefetch_rows(size_t n,
+	const uint * cols,
+	size_t num_cols
+) const
+{
+	// decodes ahead with a copy of the reader, so the position stays
+	postings::reader ahead(_reader);
+	size_t end = _pos + std::min(n, remaining());
+	for (size_t i = _pos; i < end; ++i)
+	{
+		uint row = 0;
+		if (ahead.is_valid())
+			ahead.next(row);
+		else
+			row = _run.get(i);
+		
+		if (num_cols)
+		{
+			for (size_t t = 0; t < num_cols; ++t)
+				prefetch(&_tbl->_data_map.get(row, cols[t]));
+		}
+		else
+			prefetch(&_tbl->_data_map.get(row, 0));
+	}
+}
+
+// class ro_string_table::ordered_cursor
+void ro_string_table::ordered_cursor::rewind()
+{
+	_pos = 0;
+	_buf.clear();
+	_buf_pos = 0;
+	_next_entry = (_reverse) ? _last_entry : _first_entry;
+}
+
+void ro_string_table::ordered_cursor::_load_entry()
+{
+	size_t entry = (_reverse) ? --_next_entry : _next_entry++;
+	
+	_buf.clear();
+	_buf_pos = 0;
+	_dict->get_postings().decode(entry, entry + 1, _buf);
+	if (_reverse)
+		std::reverse(_buf.begin(), _buf.end());
+}
+
+uint ro_string_table::ordered_cursor::_next_row()
+{
+	uint row = 0;
+	if (_dict)
+	{
+		while (_buf_pos >= _buf.size())
+			_load_entry();
+		row = _buf[_buf_pos++];
+	}
+	else
+		row = _run.get((_reverse) ? (_size - 1 - _pos) : _pos);
+	
+	++_pos;
+	return row;
+}
+
+size_t ro_string_table::ordered_cursor::skip(size_t n)
+{
+	size_t step = std::min(n, remaining());
+	
+	if (_dict)
+	{
+		// whole values are skipped by their counts, without decoding
+		size_t left = step;
+		size_t in_buf = std::min(left, _buf.size() - _buf_pos);
+		_buf_pos += in_buf;
+		left -= in_buf;
+		
+		const postings& post = _dict->get_postings();
+		while (left)
+		{
+			size_t entry = (_reverse) ? (_next_entry - 1) : _next_entry;
+			size_t count = post.count(entry);
+			if (count <= left)
+			{
+				_next_entry = (_reverse) ? entry : (entry + 1);
+				left -= count;
+			}
+			else
+			{
+				_load_entry();
+				_buf_pos = left;
+				left = 0;
+			}
+		}
+	}
+	
+	_pos += step;
+	return step;
+}
+
+size_t ro_string_table::ordered_cursor::next(size_t n,
+	std::vector<uint>& out_rows
+)
+{
+	size_t page = std::min(n, remaining());
+	
+	out_rows.clear();
+	for (size_t i = 0; i < page; ++i)
+		out_rows.push_back(_next_row());
+	
+	return page;
+}
+
+size_t ro_string_table::ordered_cursor::next(size_t n,
+	std::vector<eq_range_result>& in_out_targets
+)
+{
+	size_t page = std::min(n, remaining());
+	
+	const ro_string_table::single_field_data * out_sfd_ = nullptr;
+	const ro_string_table::single_field_data ** out_sfd = &out_sfd_;
+	
+	size_t num_cols = in_out_targets.size();
+	std::vector<uint> cols(num_cols);
+	for (size_t t = 0; t < num_cols; ++t)
+	{
+		eq_range_result& elem = in_out_targets[t];
+		elem.values.clear();
+		if (!page)
+			continue;
+		
+		if (_tbl->_lookup_field(elem.field_name, out_sfd))
+			cols[t] = (*out_sfd)->field_number();
+		else
+			_tbl->_throw_no_such_field(elem.field_name);
+	}
+	
+	_values.clear();
+	for (size_t i = 0; i < page; ++i)
+	{
+		uint row = _next_row();
+		for (size_t t = 0; t < num_cols; ++t)
+		{
+			uint at = _tbl->_data_map.get(row, cols[t]);
+			in_out_targets[t].values.push_back(_tbl->_value_of(at, &_values));
+		}
+	}
+	
+	return page;
+}
+
+void ro_string_table::_throw_no_such_field(const char * field_name)
+{
+	std::string err(throw_str("lookup fail: no such field '"));
+	err += field_name;
+	err += "'";
+	throw std::runtime_error(err);
+}
+
+void ro_string_table::_throw_field_not_unique(const char * field_name)
+{
+	std::string err(throw_str("unique lookup of non-unique field '"));
+	err += field_name;
+	err += "'";
+	throw std::runtime_error(err);
+}
+
+void ro_string_table::_throw_field_not_numeric(const char * field_name)
+{
+	std::string err(throw_str("numeric lookup of non-numeric field '"));
+	err += field_name;
+	err += "'";
+	throw std::runtime_error(err);
+}
+
+void ro_string_table::_throw_bad_number(
+	const ro_string_table::single_field_data& field,
+	const char * str
+)
+{
+	std::string err(throw_str("numeric lookup: '"));
+	err += str;
+	err += "' is not a valid ";
+	err += field.type_name();
+	err += " for field '";
+	err += field.get_name();
+	err += "'";
+	throw std::runtime_error(err);
+}
+
+void ro_string_table::_throw_no_buffer()
+{
+	throw std::runtime_error(
+		throw_str("no value_buffer for a table with POOL_COMPRESSED")
+	);
+}
+
+void ro_string_table::_throw_not_sealed()
+{
+	throw std::runtime_error(throw_str("lookup before seal()"));
+}
+
+void ro_string_table::_throw_bad_row(uint row)
+{
+	std::string err(throw_str("row "));
+	err += std::to_string(row);
+	err += " out of range; rows appended: ";
+	err += std::to_string(_current_line);
+	throw std::runtime_error(err);
+}
+
+void ro_string_table::_throw_no_fuzzy_index(
+	const ro_string_table::single_field_data& field
+)
+{
+	std::string err(throw_str("fuzzy lookup of field '"));
+	err += field.get_name();
+	err += "' without a fuzzy index";
+	throw std::runtime_error(err);
+}
+
+void ro_string_table::_throw_no_substring_index(
+	const ro_string_table::single_field_data& field
+)
+{
+	std::string err(throw_str("substring lookup of field '"));
+	err += field.get_name();
+	err += "' without a substring index";
+	throw std::runtime_error(err);
+}
+
+void ro_string_table::_throw_no_token_index(
+	const ro_string_table::single_field_data& field
+)
+{
+	std::string err(throw_str("token lookup of field '"));
+	err += field.get_name();
+	err += "' without a token index";
+	throw std::runtime_error(err);
+}
+
+void ro_string_table::_throw_view_of_dictionary(
+	const ro_string_table::single_field_data& field
+)
+{
+	std::string err(throw_str("eq_range_view of dictionary field '"));
+	err += field.get_name();
+	err += "'; use a cursor or a vector instead";
+	throw std::runtime_error(err);
+}
+
+void ro_string_table::_dbg_dump_pool() const
+{
+	int len = 0;
+	for (size_t i = 0; i < _pool.size(); ++i)
+	{
+		const char * pch = _pool.get(i);
+		if (*pch)
+		{
+			std::cout << *pch;
+			++len;
+		}
+		else
+		{
+			std::cout << "|" << static_cast<int>(i-len) << "|";
+			len = 0;
+		}
+	}
+	std::cout << std::endl;
+}
+
+void ro_string_table::dbg_dump()
+{
+	std::cout << "@@@ FIELDS @@@" << std::endl;
+	for (size_t i = 0, end = _fields.size(); i < end; ++i)
+	{
+		const auto& noconst = _fields.get(i);
+		const_cast<ro_string_table::single_field_data&>(noconst).dbg_dump();
+	}
+	std::cout << std::endl;
+	
+	std::cout << "@@@ POOL @@@" << std::endl;
+	_dbg_dump_pool();
+	
+	std::cout << std::endl;
+	
+	std::cout << "@@@ TABLE @@@" << std::endl;
+	for (uint i = 0; i < _num_lines; ++i)
+	{
+		for (uint j = 0; j < _num_fields; ++j)
+			std::cout << get_str_at(i, j) << " ";
+		std::cout << std::endl;
+	}
+}
+
+// class ro_string_table::single_field_data
+ro_string_table::single_field_data::single_field_data(
+	int field_num,
 	num_field_info name_id,
 	const string_pool& str_pool,
+	const compressed_pool& packed,
 	bool is_unique,
-	uint init_vect_reserve
+	uint init_vect_reserve,
+	field_type type,
+	uint decimal_places,
+	int collation,
+	index_kind kind
 ) :
 	_field_data(
 		gen_comp_less<ro_string_table::num_field_info,
@@ -358,26 +2671,196 @@ ro_string_table::single_field_data::single_field_data(
 				ro_string_table::single_field_data::context_lookup ctx
 			)
 			{
-				const char * str_lhs = ctx.str_pool->get(lhs.index_of_string);
-				const char * str_rhs = ctx.str_pool->get(rhs.index_of_string);
-				return strcmp(str_lhs, str_rhs);
+				int cmp = compare_pooled(*ctx.str_pool,
+					lhs.index_of_string,
+					rhs.index_of_string,
+					ctx.how
+				);
+				if (0 == cmp)
+				{
+					// equal values come in line order, so equal ranges can
+					// be intersected
+					uint a = lhs.original_line_number;
+					uint b = rhs.original_line_number;
+					cmp = ((a > b) - (a < b));
+				}
+				return cmp;
 			},
 			ro_string_table::single_field_data::context_lookup(&str_pool,
-				nullptr
+				nullptr,
+				0,
+				collation
+			)
+		)
+	),
+	_num_data(
+		gen_comp_less<ro_string_table::num_field_key,
+			ro_string_table::num_context>(
+			[](const ro_string_table::num_field_key& lhs,
+				const ro_string_table::num_field_key& rhs,
+				ro_string_table::num_context ctx
 			)
+			{
+				int cmp = compare_num(lhs.value, rhs.value, ctx.type);
+				if (0 == cmp)
+				{
+					uint a = lhs.original_line_number;
+					uint b = rhs.original_line_number;
+					cmp = ((a > b) - (a < b));
+				}
+				return cmp;
+			},
+			ro_string_table::num_context(type)
 		)
 	),
+	_data_map(nullptr),
 	_field_name_id(name_id),
 	_str_pool(&str_pool),
+	_packed(&packed),
 	_field_num(field_num),
-	_is_unique(is_unique)
+	_type(type),
+	_decimal_places(decimal_places),
+	_collation(collation),
+	_filter_bits(0),
+	_kind(kind),
+	_is_unique(is_unique),
+	_is_fuzzy(false),
+	_has_substrings(false),
+	_has_tokens(false),
+	_has_filter(false),
+	_is_interning(false)
 {
 	_field_data.reserve(init_vect_reserve);
+	if (is_numeric())
+		_num_data.reserve(init_vect_reserve);
+}
+
+void ro_string_table::single_field_data::append_info(const nfi& num_fi)
+{
+	_field_data.append(num_fi);
+	
+	if (is_numeric())
+	{
+		num_value val;
+		const char * str = _str_pool->get(num_fi.index_of_string);
+		if (!parse(str, val))
+		{
+			std::string err("single_field_data::append_info(): ");
+			err += "string '";
+			err += str;
+			err += "' on line ";
+			err += std::to_string(num_fi.original_line_number);
+			err += " is not a valid ";
+			err += type_name();
+			err += " for field '";
+			err += get_name();
+			err += "'";
+			throw std::runtime_error(err);
+		}
+		_num_data.append(num_field_key(val, num_fi.original_line_number));
+	}
+}
+
+int ro_string_table::single_field_data::compare_num(const num_value& a,
+	const num_value& b,
+	field_type type
+)
+{
+	if (TYPE_DOUBLE == type)
+		return ((a.d > b.d) - (a.d < b.d));
+	return ((a.i > b.i) - (a.i < b.i));
+}
+
+const char * ro_string_table::single_field_data::type_name() const
+{
+	switch (_type)
+	{
+		case TYPE_INT64: return "int64";
+		case TYPE_DOUBLE: return "double";
+		case TYPE_DECIMAL: return "decimal";
+		default: return "string";
+	}
+}
+
+bool ro_string_table::single_field_data::parse(const char * str,
+	num_value& out
+) const
+{
+	if (TYPE_INT64 == _type)
+	{
+		char * end = nullptr;
+		errno = 0;
+		out.i = strtoll(str, &end, 10);
+		return (end != str && !*end && ERANGE != errno);
+	}
+	else if (TYPE_DOUBLE == _type)
+	{
+		char * end = nullptr;
+		errno = 0;
+		out.d = strtod(str, &end);
+		
+		// ERANGE is also set for subnormals, which are kept; only overflow
+		// is refused
+		bool overflow = (ERANGE == errno && std::isinf(out.d));
+		return (end != str && !*end && !overflow && !std::isnan(out.d));
+	}
+	else if (TYPE_DECIMAL == _type)
+	{
+		// exact fixed point; no rounding, so no more than _decimal_places
+		// significant digits after the point are accepted
+		const long long max = 0x7FFFFFFFFFFFFFFFLL;
+		const char * pch = str;
+		bool is_neg = false;
+		if ('+' == *pch || '-' == *pch)
+			is_neg = ('-' == *pch++);
+		
+		long long val = 0;
+		uint digits = 0, places = 0;
+		for (; isdigit(*pch); ++pch, ++digits)
+		{
+			int dig = *pch - '0';
+			if (val > (max - dig) / 10)
+				return false;
+			val = val*10 + dig;
+		}
+		
+		if ('.' == *pch)
+		{
+			for (++pch; isdigit(*pch); ++pch, ++digits)
+			{
+				int dig = *pch - '0';
+				if (places < _decimal_places)
+				{
+					if (val > (max - dig) / 10)
+						return false;
+					val = val*10 + dig;
+					++places;
+				}
+				else if (dig)
+					return false;
+			}
+		}
+		
+		if (!digits || *pch)
+			return false;
+		
+		for (; places < _decimal_places; ++places)
+		{
+			if (val > max / 10)
+				return false;
+			val *= 10;
+		}
+		
+		out.i = (is_neg) ? -val : val;
+		return true;
+	}
+	
+	return false;
 }
 
 void ro_string_table::single_field_data::_check_unique()
 {
-	const char * stra = nullptr, * strb = nullptr;
+	const char * stra = nullptr;
 	if (_is_unique)
 	{
 		for (size_t i = 1; i < _field_data.size(); ++i)
@@ -385,11 +2868,16 @@ void ro_string_table::single_field_data::_check_unique()
 			single_field_data::nfi a = _field_data.get(i-1);
 			single_field_data::nfi b = _field_data.get(i);
 			stra = _str_pool->get(a.index_of_string);
-			strb = _str_pool->get(b.index_of_string);
 			
-			if (0 == strcmp(stra, strb))
+			if (0 == compare_pooled(*_str_pool,
+					a.index_of_string,
+					b.index_of_string,
+					_collation
+				))
 				goto _throw;
 		}
+		
+		_check_unique_num();
 	}
 	
 	return;
@@ -404,16 +2892,422 @@ _throw:
 	throw std::runtime_error(err);
 }
 
+void ro_string_table::single_field_data::_make_dictionary()
+{
+	// the data is sorted by value, then line, so each distinct value is a
+	// run of ascending lines
+	std::vector<nfi> dict;
+	std::vector<uint> lines;
+	for (size_t i = 0, end = _field_data.size(); i < end; )
+	{
+		nfi first = _field_data.get(i);
+		
+		lines.clear();
+		for (; i < end; ++i)
+		{
+			nfi cur = _field_data.get(i);
+			if (compare_pooled(*_str_pool,
+					cur.index_of_string,
+					first.index_of_string,
+					_collation
+				) != 0
+			)
+				break;
+			
+			lines.push_back(cur.original_line_number);
+		}
+		
+		uint list = _postings.append_list(lines.data(), lines.size());
+		dict.push_back(nfi::of_list(list, first.index_of_string));
+	}
+	_postings.shrink_to_fit();
+	
+	_field_data.clear();
+	_field_data.reserve(dict.size());
+	for (auto& entry : dict)
+		_field_data.append(entry);
+	_field_data.seal();
+}
+
+void ro_string_table::single_field_data::_make_fuzzy()
+{
+	std::vector<uint> ids;
+	const char * prev = nullptr;
+	for (size_t i = 0, end = _field_data.size(); i < end; ++i)
+	{
+		const char * str = _str_pool->get(_field_data.get(i).index_of_string);
+		if (!prev || collation::compare(str, prev, _collation) != 0)
+			ids.push_back(i);
+		prev = str;
+	}
+	
+	value_ctx ctx(this);
+	_fuzzy.build(ids.data(), ids.size(), fuzzy_str, &ctx);
+	_fuzzy.shrink_to_fit();
+}
+
+void ro_string_table::single_field_data::_make_substrings()
+{
+	// the values are still in the plain pool, so they stay where they are
+	// while the suffixes are sorted
+	for (size_t i = 0, end = _field_data.size(); i < end; ++i)
+	{
+		nfi entry = _field_data.get(i);
+		_substrings.add(entry.original_line_number,
+			strlen(_str_pool->get(entry.index_of_string))
+		);
+	}
+	
+	value_ctx ctx(this);
+	_substrings.build(substring_str, &ctx, 0);
+}
+
+void ro_string_table::single_field_data::set_tokens(const char * delimiters,
+	bool lowercase
+)
+{
+	_tokens = token_index(delimiters, lowercase);
+	_has_tokens = true;
+}
+
+void ro_string_table::single_field_data::_make_tokens()
+{
+	for (size_t i = 0, end = _field_data.size(); i < end; ++i)
+	{
+		nfi entry = _field_data.get(i);
+		_tokens.add(_str_pool->get(entry.index_of_string),
+			entry.original_line_number
+		);
+	}
+	_tokens.build();
+}
+
+void ro_string_table::single_field_data::set_filter(uint bits_per_key)
+{
+	_filter_bits = bits_per_key;
+	_has_filter = true;
+}
+
+bool ro_string_table::single_field_data::find_interned(const char * str,
+	size_t len,
+	uint& out
+)
+{
+	if (!_is_interning)
+		return false;
+	
+	if (_field_data.size() == INTERN_SAMPLE &&
+		_interned.size() > INTERN_SAMPLE / 2
+	)
+	{
+		_is_interning = false;
+		std::unordered_multimap<uint64_t, uint>().swap(_interned);
+		return false;
+	}
+	
+	auto range = _interned.equal_range(hash_bytes(str, len));
+	for (auto it = range.first; it != range.second; ++it)
+	{
+		uint at = it->second;
+		if (_str_pool->get_len(at) == len &&
+			0 == memcmp(_str_pool->get(at), str, len)
+		)
+		{
+			out = at;
+			return true;
+		}
+	}
+	return false;
+}
+
+void ro_string_table::single_field_data::add_interned(const char * str,
+	size_t len,
+	uint at
+)
+{
+	if (_is_interning)
+		_interned.emplace(hash_bytes(str, len), at);
+}
+
+void ro_string_table::single_field_data::_make_filter()
+{
+	// equal values are next to each other and hash equal, so each distinct
+	// value is added once
+	std::vector<uint64_t> hashes;
+	for (size_t i = 0, end = _field_data.size(); i < end; ++i)
+	{
+		const char * str = _str_pool->get(_field_data.get(i).index_of_string);
+		uint64_t hash = collation::hash(str, _collation);
+		if (hashes.empty() || hashes.back() != hash)
+			hashes.push_back(hash);
+	}
+	_filter.build(hashes.data(), hashes.size(), _filter_bits);
+}
+
+void ro_string_table::single_field_data::_make_learned()
+{
+	std::vector<uint64_t> keys(_field_data.size());
+	for (size_t i = 0, end = keys.size(); i < end; ++i)
+	{
+		const char * str = _str_pool->get(_field_data.get(i).index_of_string);
+		keys[i] = learned_index::key_of(str);
+	}
+	_learned.build(keys.data(), keys.size());
+}
+
+void ro_string_table::single_field_data::_make_front_coded()
+{
+	for (size_t i = 0, end = _field_data.size(); i < end; ++i)
+	{
+		uint at = _field_data.get(i).index_of_string;
+		_front_coded.append(_str_pool->get(at), _str_pool->get_len(at));
+	}
+	_front_coded.seal();
+	
+	// the rows are all lookups need, and get() finds the rest in _data_map
+	_rows.resize(_field_data.size());
+	for (size_t i = 0, end = _rows.size(); i < end; ++i)
+		_rows[i] = _field_data.get(i).original_line_number;
+	_field_data.clear();
+}
+
+const char * ro_string_table::single_field_data::fuzzy_str(const void * ctx,
+	uint id
+)
+{
+	const value_ctx * vctx = (const value_ctx *)ctx;
+	const single_field_data * sfd = vctx->field;
+	return sfd->_value_of(sfd->get(id).index_of_string, vctx->value);
+}
+
+const char * ro_string_table::single_field_data::substring_str(
+	const void * ctx,
+	uint row
+)
+{
+	const value_ctx * vctx = (const value_ctx *)ctx;
+	const single_field_data * sfd = vctx->field;
+	uint at = sfd->_data_map->get(row, sfd->_field_num);
+	return sfd->_value_of(at, vctx->value);
+}
+
+const char * ro_string_table::single_field_data::_value_of(uint at,
+	std::string& buf
+) const
+{
+	if (!_packed->is_trained())
+		return _str_pool->get(at);
+	
+	_packed->get(at, buf);
+	return buf.c_str();
+}
+
+void ro_string_table::single_field_data::repoint(const matrix<uint>& data_map)
+{
+	// a front coded field has no entries; get() reads data_map anyway
+	for (size_t i = 0, end = _field_data.size(); i < end; ++i)
+	{
+		nfi entry = _field_data.get(i);
+		entry.index_of_string = data_map.get(first_line_of(entry), _field_num);
+		_field_data.set(i, entry);
+	}
+}
+
+void ro_string_table::single_field_data::_check_unique_num()
+{
+	if (_is_unique && is_numeric())
+	{
+		for (size_t i = 1; i < _num_data.size(); ++i)
+		{
+			const num_field_key& a = _num_data.get(i-1);
+			const num_field_key& b = _num_data.get(i);
+			
+			if (0 == compare_num(a.value, b.value, _type))
+			{
+				std::string err("single_field_data::check_unique(): ");
+				err += "number on line ";
+				err += std::to_string(b.original_line_number);
+				err += " equals the one on line ";
+				err += std::to_string(a.original_line_number);
+				err += " in numeric field '";
+				err += get_name();
+				err += "' marked as unique";
+				throw std::runtime_error(err);
+			}
+		}
+	}
+}
+
 void ro_string_table::single_field_data::dbg_dump() const
 {
+	std::string buf;
 	std::cout << get_name() << ":";
-	for (int i = 0, end = _field_data.size(); i < end; ++i)
+	for (int i = 0, end = size(); i < end; ++i)
 	{
-		auto tmp = _field_data.get(i);
-		std::cout << tmp.original_line_number
-			<< " " << tmp.index_of_string
-			<< " " << _str_pool->get(tmp.index_of_string)
+		auto tmp = get(i);
+		if (_postings.num_lists())
+			std::cout << "list " << tmp.list_id();
+		else
+			std::cout << tmp.original_line_number;
+		std::cout << " " << tmp.index_of_string
+			<< " " << _value_of(tmp.index_of_string, buf)
 			<< " ";
 	}
 	std::cout << std::endl;
 }
+
+// class ro_string_table::composite_index
+ro_string_table::composite_index::composite_index(
+	const std::vector<uint>& cols,
+	const std::vector<int>& collations,
+	const matrix<uint>& data_map,
+	const string_pool& str_pool,
+	const compressed_pool& packed,
+	bool is_unique
+) :
+	_lines(gen_comp_less<uint, context_lookup>(_compare)),
+	_cols(cols),
+	_collations(collations),
+	_data_map(&data_map),
+	_str_pool(&str_pool),
+	_packed(&packed),
+	_is_unique(is_unique)
+{}
+
+void ro_string_table::composite_index::seal(uint lines)
+{
+	// the context has to point to this object, which is only known for sure
+	// once it's in its final place
+	sort_vector<uint, context_lookup> sorted(
+		gen_comp_less<uint, context_lookup>(_compare, context_lookup(this))
+	);
+	
+	sorted.reserve((lines) ? lines-1 : 0);
+	for (uint i = 1; i < lines; ++i)
+		sorted.append(i);
+	sorted.seal();
+	
+	_lines = std::move(sorted);
+	_check_unique();
+}
+
+bool ro_string_table::composite_index::equal_range(const field_pair * keys,
+	uint num_keys,
+	std::pair<size_t, size_t>& out_range
+)
+{
+	gen_comp_less_ctx_lower_bound<uint, context_lookup> less_lwr_ctx(_compare);
+	gen_comp_less_ctx_upper_bound<uint, context_lookup> less_upr_ctx(_compare);
+	
+	sort_vector<uint, context_lookup>::equal_range_ctx_compars cmprs(
+		less_lwr_ctx,
+		less_upr_ctx,
+		context_lookup(this, keys, num_keys)
+	);
+	
+	uint dummy = 0;
+	return _lines.equal_range(dummy, out_range, cmprs);
+}
+
+bool ro_string_table::composite_index::begins_with(
+	const std::vector<field_pair>& keys
+) const
+{
+	if (keys.empty() || keys.size() > _cols.size())
+		return false;
+	
+	for (uint i = 0, end = keys.size(); i < end; ++i)
+	{
+		const char * name = _str_pool->get(_data_map->get(0, _cols[i]));
+		if (strcmp(name, keys[i].field_name) != 0)
+			return false;
+	}
+	return true;
+}
+
+int ro_string_table::composite_index::compare_lines(uint a,
+	uint b,
+	uint num_cols
+) const
+{
+	for (uint i = 0; i < num_cols; ++i)
+	{
+		int cmp = compare_pooled(*_str_pool,
+			value_index(a, i),
+			value_index(b, i),
+			_collations[i]
+		);
+		if (cmp)
+			return cmp;
+	}
+	return 0;
+}
+
+std::string ro_string_table::composite_index::get_name() const
+{
+	std::string name;
+	for (uint i = 0, end = _cols.size(); i < end; ++i)
+	{
+		if (i)
+			name += ", ";
+		name += _str_pool->get(_data_map->get(0, _cols[i]));
+	}
+	return name;
+}
+
+int ro_string_table::composite_index::_compare(const uint& lhs,
+	const uint& rhs,
+	context_lookup ctx
+)
+{
+	const ro_string_table::composite_index& index = *ctx.index;
+	if (!ctx.keys)
+	{
+		int cmp = index.compare_lines(lhs, rhs, index.num_cols());
+		return (cmp) ? cmp : ((lhs > rhs) - (lhs < rhs));
+	}
+	
+	const string_pool& pool = *index._str_pool;
+	const compressed_pool& packed = *index._packed;
+	for (uint i = 0; i < ctx.num_keys; ++i)
+	{
+		const field_pair& key = ctx.keys[i];
+		size_t len = key.value_len;
+		if ((pool.has_lengths() || packed.is_trained()) && !len)
+			len = strlen(key.field_value);
+		
+		uint at = index.value_index(lhs, i);
+		int how = index.collation_of(i);
+		int cmp = (packed.is_trained()) ?
+			compare_packed(packed, at, key.field_value, len, how) :
+			compare_pooled(pool, at, key.field_value, len, how);
+		if (cmp)
+			return cmp;
+	}
+	return 0;
+}
+
+void ro_string_table::composite_index::_check_unique()
+{
+	if (_is_unique)
+	{
+		for (size_t i = 1; i < _lines.size(); ++i)
+		{
+			uint a = _lines.get(i-1);
+			uint b = _lines.get(i);
+			
+			if (0 == compare_lines(a, b, _cols.size()))
+			{
+				std::string err("composite_index::check_unique(): ");
+				err += "the tuple on line ";
+				err += std::to_string(b);
+				err += " equals the one on line ";
+				err += std::to_string(a);
+				err += " in composite index '";
+				err += get_name();
+				err += "' marked as unique";
+				throw std::runtime_error(err);
+			}
+		}
+	}
+}
@@ -5,23 +5,134 @@
 #include "string_pool.hpp"
 #include "sort_vector.ipp"
 #include "generic_compar.ipp"
+#include "collation.hpp"
+#include "postings.hpp"
+#include "fuzzy.hpp"
+#include "suffix_array.hpp"
+#include "token_index.hpp"
+#include "bloom_filter.hpp"
+#include "learned_index.hpp"
+#include "front_coded.hpp"
+#include "compressed_pool.hpp"
 
+#include <deque>
 #include <vector>
 #include <string>
+#include <cstring>
+#include <unordered_map>
 
 class ro_string_table
 {
+	struct num_field_info;
+	class single_field_data;
+	class composite_index;
+	
+	struct row_run
+	{
+		row_run(const unsigned char * rows = nullptr,
+			size_t stride = 0,
+			size_t size = 0
+		) :
+			rows(rows),
+			stride(stride),
+			size(size)
+		{}
+		
+		inline unsigned int get(size_t i) const
+		{return *reinterpret_cast<const unsigned int *>(rows + i*stride);}
+		
+		const unsigned char * rows;
+		size_t stride;
+		size_t size;
+	};
+	/*
+	   A run of adjacent entries in some sorted array of a field, each of which
+	   contains a line number. rows points to the line number of the first
+	   entry, stride is the size of an entry. This way views and cursors work
+	   the same over any such array, no matter the type of its entries.
+	*/
+	
 	public:
 	typedef unsigned int uint;
 	typedef unsigned char byte;
 
 	struct field_pair {
-		field_pair(const char * field_name, const char * field_value = nullptr)
-			: field_name(field_name), field_value(field_value) {}
+		field_pair(const char * field_name,
+			const char * field_value = nullptr,
+			size_t value_len = 0
+		) :
+			field_name(field_name),
+			field_value(field_value),
+			value_len(value_len)
+		{}
 		const char * field_name;
 		const char * field_value;
+		size_t value_len;
+	};
+	/*
+	   Used as a lookup source and as the result of a unique lookup. value_len
+	   is the length of field_value, or 0 for up to the first '\0'; only a
+	   table with POOL_LENGTHS needs it, for values which hold '\0', and only
+	   such a table sets it in the results.
+	*/
+	
+	struct cell {
+		cell(const char * str = nullptr, size_t len = 0) : str(str), len(len) {}
+		const char * str;
+		size_t len;
+	};
+	/* A value from the table and its length, without the '\0'. */
+	
+	class value_buffer
+	{
+		/*
+		   Where a table with POOL_COMPRESSED decompresses the values it hands
+		   out; see pool_mode. The caller owns it and passes it to the calls
+		   which hand out values, and each call adds its values to it. A value
+		   gets a string of its own, which stays where it is until clear(),
+		   so a buffer can hold the values of any number of calls.
+		*/
+		public:
+		static const size_t KEEP = 256;
+		
+		value_buffer() : _used(0) {}
+		
+		inline size_t size() const
+		{return _used;}
+		/* The number of values held. */
+		
+		inline void clear()
+		{
+			if (_values.size() > KEEP)
+			{
+				_values.resize(KEEP);
+				_values.shrink_to_fit();
+			}
+			_used = 0;
+		}
+		/*
+		   Drops the values. The strings of up to KEEP of them are kept for
+		   reuse, the rest freed, so one large result doesn't hold on to its
+		   memory.
+		*/
+		
+		private:
+		friend class ro_string_table;
+		
+		inline const char * _unpack(const compressed_pool& pool,
+			unsigned int at
+		)
+		{
+			if (_used == _values.size())
+				_values.emplace_back();
+			std::string& val = _values[_used++];
+			pool.get(at, val);
+			return val.c_str();
+		}
+		
+		std::deque<std::string> _values;
+		size_t _used;
 	};
-	/* Used as a lookup source and as the result of a unique lookup. */
 	
 	struct eq_range_result {
 		eq_range_result(const char * name) : field_name(name) {}
@@ -30,15 +141,383 @@ class ro_string_table
 	};
 	/* Equal range may return an array of values for each field name. */
 	
+	class eq_range_view
+	{
+		/*
+		   A lightweight view of the rows matched by an equal range. It points
+		   directly in the sorted field data of the source field, so getting
+		   it costs only the lookup, regardless of how many rows match. Values
+		   are fetched on demand by column number, which can be obtained once
+		   with get_field_col(). The view is valid for as long as the table
+		   it came from.
+		*/
+		public:
+		eq_range_view() : _tbl(nullptr) {}
+		
+		inline size_t size() const
+		{return _run.size;}
+		
+		inline bool empty() const
+		{return (0 == _run.size);}
+		
+		inline uint row_at(size_t i) const
+		{return _run.get(i);}
+		/* The line number of the i-th hit, usable with get_str_at(). */
+		
+		inline const char * value_at(size_t i,
+			uint col,
+			value_buffer * buffer = nullptr
+		) const
+		{return _tbl->get_str_at(row_at(i), col, buffer);}
+		/*
+		   The value of column col on the line of the i-th hit. buffer is
+		   for a table with POOL_COMPRESSED, as with get_str_at().
+		*/
+		
+		private:
+		friend class ro_string_table;
+		
+		ro_string_table * _tbl;
+		row_run _run;
+	};
+	
+	class eq_range_cursor
+	{
+		/*
+		   Walks the rows matched by an equal range a page at a time. Opening
+		   it costs only the lookup; rows and values are fetched from the
+		   source field data as next() is called. If prefetching is enabled,
+		   each call to next() also issues prefetches for the table cells of
+		   the page after the one it returns, so they are likely in cache when
+		   the caller comes back for them. Like eq_range_view, the cursor is
+		   valid for as long as the table it came from.
+		*/
+		public:
+		eq_range_cursor() :
+			_tbl(nullptr),
+			_pos(0),
+			_prefetch(false)
+		{}
+		
+		inline size_t count() const
+		{return _run.size;}
+		/* The number of all matched rows. */
+		
+		inline size_t remaining() const
+		{return (_run.size - _pos);}
+		/* The number of matched rows not yet returned or skipped. */
+		
+		inline void rewind()
+		{
+			_pos = 0;
+			if (_reader.is_valid())
+				_reader.rewind();
+		}
+		
+		inline void set_prefetch(bool on)
+		{_prefetch = on;}
+		
+		size_t skip(size_t n);
+		/* Moves n rows forward without reading them. Returns how many. */
+		
+		size_t next(size_t n, std::vector<uint>& out_rows);
+		/*
+		   Places the line numbers of up to n of the remaining rows in
+		   out_rows, replacing its contents. Returns how many were placed.
+		*/
+		
+		size_t next(size_t n, std::vector<eq_range_result>& in_out_targets);
+		/*
+		   Like above, but each eq_range_result in in_out_targets gets up to
+		   n values of its field from the next rows, as with
+		   lookup_equal_range(). Throws if a target field does not exist.
+		*/
+		
+		private:
+		friend class ro_string_table;
+		
+		void _prefetch_rows(size_t n, const uint * cols, size_t num_cols) const;
+		
+		inline uint _next_row()
+		{
+			uint row = 0;
+			if (_reader.is_valid())
+				_reader.next(row);
+			else
+				row = _run.get(_pos);
+			++_pos;
+			return row;
+		}
+		
+		ro_string_table * _tbl;
+		row_run _run;
+		postings::reader _reader;
+		value_buffer _values;
+		size_t _pos;
+		bool _prefetch;
+	};
+	/*
+	   Over a dictionary field the cursor streams the rows out of the
+	   compressed postings with _reader, and _run only holds their number.
+	   With POOL_COMPRESSED, next() decompresses the values in _values.
+	*/
+	
+	struct value_count {
+		value_count(const char * value = nullptr, size_t count = 0) :
+			value(value), count(count) {}
+		const char * value;
+		size_t count;
+	};
+	/*
+	   A distinct value of a field and the number of rows it's on. value is
+	   the string from the first of these rows.
+	*/
+	
+	class group_cursor
+	{
+		/*
+		   Walks the distinct values of a field in sorted order, a page at a
+		   time. Equal values are adjacent in the field data, so the end of
+		   each group is found with an exponential search from its beginning,
+		   which costs log(group size) comparisons rather than one per row.
+		   On a dictionary field each entry is a group and its count is
+		   already known. Valid for as long as the table it came from.
+		*/
+		public:
+		group_cursor() : _tbl(nullptr), _field(nullptr), _pos(0) {}
+		
+		size_t next(size_t n, std::vector<value_count>& out);
+		/*
+		   Places up to n of the next groups in out, replacing its contents.
+		   Returns how many were placed.
+		*/
+		
+		bool at_end() const;
+		
+		inline void rewind()
+		{_pos = 0;}
+		
+		private:
+		friend class ro_string_table;
+		
+		ro_string_table * _tbl;
+		const single_field_data * _field;
+		value_buffer _values;
+		size_t _pos;
+	};
+	
+	class ordered_cursor
+	{
+		/*
+		   Walks the rows of a table in the sorted order of a field, forward
+		   or in reverse, a page at a time. Opening it costs one lookup for
+		   the starting bound; rows come straight from the field data, so
+		   nothing is copied or sorted. Rows with equal values come in line
+		   order, or in reverse line order when walking in reverse. Valid for
+		   as long as the table it came from.
+		*/
+		public:
+		ordered_cursor() :
+			_tbl(nullptr),
+			_dict(nullptr),
+			_first_entry(0),
+			_last_entry(0),
+			_next_entry(0),
+			_size(0),
+			_pos(0),
+			_buf_pos(0),
+			_reverse(false)
+		{}
+		
+		inline size_t count() const
+		{return _size;}
+		/* The number of all rows from the starting bound on. */
+		
+		inline size_t remaining() const
+		{return (_size - _pos);}
+		/* The number of rows not yet returned or skipped. */
+		
+		void rewind();
+		
+		size_t skip(size_t n);
+		/* Moves n rows forward without reading them. Returns how many. */
+		
+		size_t next(size_t n, std::vector<uint>& out_rows);
+		size_t next(size_t n, std::vector<eq_range_result>& in_out_targets);
+		/* Same as the respective next() of eq_range_cursor. */
+		
+		private:
+		friend class ro_string_table;
+		
+		uint _next_row();
+		void _load_entry();
+		
+		ro_string_table * _tbl;
+		row_run _run;
+		const single_field_data * _dict;
+		std::vector<uint> _buf;
+		value_buffer _values;
+		size_t _first_entry;
+		size_t _last_entry;
+		size_t _next_entry;
+		size_t _size;
+		size_t _pos;
+		size_t _buf_pos;
+		bool _reverse;
+	};
+	/*
+	   Over a dictionary field the rows are decoded one value at a time in
+	   _buf, walking the entries from _first_entry to _last_entry; otherwise
+	   _run holds all rows in ascending order.
+	*/
+	
+	enum field_type {
+		TYPE_STRING,
+		TYPE_INT64,
+		TYPE_DOUBLE,
+		TYPE_DECIMAL
+	};
+	
+	enum collate_flags {
+		COLL_NONE = collation::NONE,
+		COLL_FOLD_ASCII = collation::FOLD_ASCII,
+		COLL_TRIM = collation::TRIM,
+		COLL_FOLD_UTF8 = collation::FOLD_UTF8
+	};
+	
+	enum index_kind {
+		INDEX_SORTED,
+		INDEX_DICTIONARY,
+		INDEX_LEARNED,
+		INDEX_FRONT_CODED
+	};
+	
+	enum pool_mode {
+		POOL_PLAIN,
+		POOL_LENGTHS,
+		POOL_COMPRESSED
+	};
+	/*
+	   With POOL_LENGTHS the string pool keeps the length of each value in a
+	   varint before it. Values of fields with COLL_NONE then compare by
+	   length and memcmp() instead of strcmp(), lengths come without a
+	   strlen(), and values can hold '\0'; see append(). It costs a byte for
+	   each value shorter than 128 bytes, two up to 16K.
+	   
+	   With POOL_COMPRESSED the values are moved to a compressed_pool upon
+	   seal(), after the indexes are built; its symbols are trained on a
+	   sample of the values. Until then they are kept as with POOL_PLAIN, so
+	   seal() briefly needs both. The field names stay plain. Lookups
+	   compare with the compressed values, a symbol at a time and only until
+	   they differ, or decompress a value on the stack for a collation. A
+	   value which is handed out is decompressed first, into the value_buffer
+	   the caller passes as the last argument of the call, and is valid for
+	   as long as the values of that buffer; such a call throws without one.
+	   A cursor decompresses into a buffer of its own instead, and the values
+	   of a next() are valid until the next one. Values can't hold '\0'.
+	*/
+	
+	struct composite_info
+	{
+		composite_info(const std::vector<std::string>& fields,
+			bool is_unique = false
+		) :
+			fields(fields),
+			is_unique(is_unique)
+		{}
+		
+		std::vector<std::string> fields;
+		bool is_unique;
+	};
+	/* The fields of a composite index after the first one. See field_info. */
+	
     struct field_info
     {
-        field_info(std::string name, bool is_unique = false) :
+        field_info(std::string name,
+			bool is_unique = false,
+			field_type type = TYPE_STRING,
+			uint decimal_places = 0,
+			int collation = COLL_NONE
+		) :
 			name(name),
-			is_unique(is_unique)
+			is_unique(is_unique),
+			type(type),
+			decimal_places(decimal_places),
+			collation(collation),
+			index(INDEX_SORTED),
+			is_fuzzy(false),
+			has_substrings(false),
+			has_tokens(false),
+			token_lowercase(true),
+			has_filter(false),
+			filter_bits(10),
+			has_interning(false)
 		{}
 		
         std::string name;
         bool is_unique;
+        field_type type;
+        uint decimal_places;
+        int collation;
+        std::vector<composite_info> composites;
+        index_kind index;
+        bool is_fuzzy;
+        bool has_substrings;
+        bool has_tokens;
+        std::string token_delimiters;
+        bool token_lowercase;
+        bool has_filter;
+        uint filter_bits;
+        bool has_interning;
+        
+        inline field_info& use_index(index_kind kind)
+        {
+			index = kind;
+			return *this;
+		}
+        
+        inline field_info& use_fuzzy()
+        {
+			is_fuzzy = true;
+			return *this;
+		}
+        
+        inline field_info& use_substrings()
+        {
+			has_substrings = true;
+			return *this;
+		}
+        
+        inline field_info& use_tokens(const char * delimiters = " \t",
+			bool lowercase = true
+		)
+        {
+			has_tokens = true;
+			token_delimiters = delimiters;
+			token_lowercase = lowercase;
+			return *this;
+		}
+        
+        inline field_info& use_filter(uint bits_per_key = 10)
+        {
+			has_filter = true;
+			filter_bits = bits_per_key;
+			return *this;
+		}
+        
+        inline field_info& use_interning()
+        {
+			has_interning = true;
+			return *this;
+		}
+        
+        inline field_info& index_with(const std::vector<std::string>& fields,
+			bool is_unique = false
+		)
+		{
+			composites.push_back(composite_info(fields, is_unique));
+			return *this;
+		}
     };
 	/*
 	   And array of field_info defines which fields from the csv will be read
@@ -46,11 +525,110 @@ class ro_string_table
 	   same relative order. Fields marked as unique are checked for duplicate
 	   strings when seal() is called. An exception is thrown when a duplicate is
 	   found.
+	   
+	   A field with a type other than TYPE_STRING is numeric. Each of its
+	   values is parsed as it's appended and kept in an additional array, which
+	   is sorted numerically upon seal(), so the field can be looked up by
+	   numeric value and range as well. The strings stay as they are, so
+	   lookups return the original text. TYPE_INT64 values are whole numbers,
+	   TYPE_DOUBLE are anything strtod() accepts except NaN and values too
+	   large for a double; a literal "inf" is accepted, and subnormals such
+	   as "1e-310" are kept as they are. TYPE_DECIMAL values are fixed point
+	   numbers with at most decimal_places digits after the point, which are
+	   kept and compared exactly as scaled integers. A
+	   value which doesn't parse causes append() to throw. A numeric field
+	   marked as unique must also not have numerically equal values, e.g.
+	   "1.5" and "1.50".
+	   
+	   collation is a bitwise or of collate_flags and changes what equal means
+	   for the string index of the field. With COLL_FOLD_ASCII "Acme" equals
+	   "ACME", with COLL_TRIM " acme " equals "acme", and COLL_FOLD_UTF8 also
+	   folds the case of non-ASCII letters; see collation.hpp. The index is
+	   sorted by the normalized value and every lookup on the field compares
+	   the same way, uniqueness included. The pool still keeps the original
+	   bytes, so results are returned as they were appended.
+	   
+	   index_with() declares a composite index which begins with this field
+	   and continues with the given fields, e.g.
+	   field_info("region").index_with({"sku"}, is_unique). All of them have to
+	   be in the array of field_info. The index is sorted by the tuple of
+	   strings, each compared with the collation of its field, and can then be
+	   searched by lookup_composite(). Unique composite indexes are checked
+	   for duplicate tuples when seal() is called, like unique fields are.
+	   
+	   use_index() picks how the field is indexed. INDEX_SORTED, the default,
+	   keeps a sorted entry for every row. INDEX_DICTIONARY is for fields with
+	   few distinct values, e.g. field_info("type").use_index(INDEX_DICTIONARY).
+	   Upon seal() the field keeps only a sorted dictionary of its distinct
+	   values, each with a compressed list of the rows it's on, in line order.
+	   Lookups binary search the dictionary instead of all rows. The rows of a
+	   dictionary field can be returned in vectors and cursors, but not in an
+	   eq_range_view, since they are not stored anywhere uncompressed.
+	   
+	   INDEX_LEARNED, experimental, keeps the sorted entries of INDEX_SORTED
+	   and adds a learned_index, a piecewise linear model fit upon seal()
+	   over the first eight bytes of each value, which predicts where a
+	   value is to within an error bound measured at build time. Lookups of
+	   a value, a prefix or a range search that window first and widen it
+	   only if the value isn't there, so results are the same as with
+	   INDEX_SORTED. It pays off on keys spread evenly over their range,
+	   e.g. ids; see benchmark/bench_learned_index.cpp. Fields with a
+	   collation other than COLL_NONE don't get a model, since it orders
+	   bytes, and are searched like INDEX_SORTED.
+	   
+	   INDEX_FRONT_CODED is INDEX_SORTED in less memory. Upon seal() the
+	   sorted values are front coded in blocks of 32: the first value of a
+	   block whole, then for each of the others only how many bytes it drops
+	   from the end of the one before and the bytes it adds. The 8 byte
+	   entries of INDEX_SORTED are then replaced by the 4 byte row of each
+	   value. Lookups of a value, a prefix or a range binary search the first
+	   values of the blocks, then walk one block, and don't read the string
+	   pool, which costs about two cache misses a step with INDEX_SORTED.
+	   Results are the same. It suits unique keys which share long prefixes,
+	   e.g. ids, whose blocks take 2 or 3 bytes a value, so the field takes
+	   about 6.5 bytes a value instead of 8; see get_front_coded_stats().
+	   Like INDEX_LEARNED, fields with a collation other than COLL_NONE
+	   aren't front coded.
+	   
+	   use_fuzzy() adds an approximate index to the field, built upon seal()
+	   over its distinct values, which lookup_fuzzy() and lookup_nearest()
+	   search by edit distance.
+	   
+	   use_substrings() adds a suffix array of all values of the field, built
+	   upon seal() with all hardware threads, which lookup_contains() searches
+	   for substrings. It doesn't copy the values, which it reads from the
+	   pool, but takes about nine bytes per byte of them; see
+	   get_substring_memory().
+	   
+	   use_tokens() adds an inverted index of the tokens in the values of the
+	   field, which are split on any of the delimiter bytes and, if lowercase,
+	   have 'A' - 'Z' lowercased. Upon seal() each distinct token gets a
+	   compressed list of the rows it's on, and lookup_tokens() intersects or
+	   joins these lists.
+	   
+	   use_filter() adds a Bloom filter of the distinct values of the field,
+	   built upon seal() with about bits_per_key bits for each. The values
+	   are hashed as normalized by the collation of the field. Exact lookups
+	   of a value, i.e. lookup_unique(), exists(), lookup_equal_range() and
+	   the like, ask the filter first and return at once for most values the
+	   field doesn't have, without a binary search. With 10 bits per key
+	   about 1% of such values still get to the search; see
+	   get_filter_stats(). Prefix and range lookups don't use the filter.
+	   
+	   use_interning() makes append() store each distinct value of the field
+	   in the pool once, and point every row which has it to that copy. A
+	   hash map of the values seen is kept until seal(). Equal values then
+	   have the same place in the pool, and compare equal by it before any
+	   string is read. Meant for fields with few distinct values, e.g. a
+	   type or a country; if more than half of the first INTERN_SAMPLE values
+	   of the field are distinct, it stops interning, since the map would
+	   cost more than it saves. See is_interned() and get_pool_size().
 	*/
 	
 	ro_string_table(uint lines,
         const std::vector<field_info>& fields,
-        size_t pool_init_size = 0
+        size_t pool_init_size = 0,
+        pool_mode mode = POOL_PLAIN
     );
     /*
        ro_string_table has to know the number of lines in the input file in
@@ -59,11 +637,17 @@ class ro_string_table
        csv. However, if the user opts to pre-calculate the size of the pool,
        they can set pool_init_size in order to reserve space. Upon seal(),
        shrink_to_fit() is called on each structure anyway, however, the standard
-       does not guarantee the shirk request will be honored.
+       does not guarantee the shirk request will be honored. mode picks the
+       layout of the pool; see pool_mode.
     */
     
     inline void append(const std::string& str)
-	{append(str.c_str());}
+	{
+		if (_pool.has_lengths())
+			append(str.data(), str.size());
+		else
+			append(str.c_str());
+	}
 	
 	void append(const char * str);
 	/* 
@@ -72,6 +656,15 @@ class ro_string_table
 	   sealed.
 	*/
 	
+	void append(const char * str, size_t len);
+	/*
+	   Like above, but for the len bytes at str, which may hold '\0' if the
+	   table has POOL_LENGTHS, and throws if they do otherwise. Lookups of
+	   such values need field_pair::value_len. The fuzzy, substring, token,
+	   Bloom filter and learned indexes, and numeric fields, only see a
+	   value up to its first '\0'.
+	*/
+	
 	void seal();
 	/*
 	   Marks the table as sealed. This causes the internal structures to get
@@ -81,7 +674,8 @@ class ro_string_table
 	*/
 	
 	bool lookup_unique(const field_pair& source,
-		std::vector<field_pair>& in_out_targets
+		std::vector<field_pair>& in_out_targets,
+		value_buffer * buffer = nullptr
 	);
 	/*
 	   Looks up the field with the value specified by source. If it's not found,
@@ -99,7 +693,8 @@ class ro_string_table
 	*/
 	
 	bool lookup_equal_range(const field_pair& source,
-		std::vector<eq_range_result>& in_out_targets
+		std::vector<eq_range_result>& in_out_targets,
+		value_buffer * buffer = nullptr
 	);
 	/*
 	   Like lookup_unique(), but source.field_value can exist more than once.
@@ -108,16 +703,491 @@ class ro_string_table
 	   not check source.field_name for uniqueness. Lookup takes twice as long,
 	   since a lower and an upper bound have to be found.
 	*/
+	
+	bool lookup_equal_range(const field_pair& source, eq_range_view& out);
+	/*
+	   Like above, but nothing is copied. out is set to view the matching rows
+	   and true is returned if there is at least one. Throws like above.
+	*/
+	
+	bool lookup_equal_range(const field_pair& source, eq_range_cursor& out);
+	/*
+	   Like above, but out is set to a cursor at the first matching row.
+	   Throws like above.
+	*/
+	
+	bool exists(const field_pair& source);
+	/*
+	   Returns true if source.field_name has the value source.field_value on
+	   any row. A single binary search; no targets, no allocation. Throws like
+	   lookup_equal_range().
+	*/
+	
+	size_t count(const field_pair& source);
+	/*
+	   Returns the number of rows on which source.field_name has the value
+	   source.field_value, from the bounds of its equal range, in logarithmic
+	   time. Throws like lookup_equal_range().
+	*/
+	
+	bool lookup_prefix(const field_pair& source,
+		std::vector<eq_range_result>& in_out_targets,
+		value_buffer * buffer = nullptr
+	);
+	bool lookup_prefix(const field_pair& source, eq_range_view& out);
+	bool lookup_prefix(const field_pair& source, eq_range_cursor& out);
+	/*
+	   Like the respective lookup_equal_range(), but matches all rows on which
+	   the value of source.field_name begins with source.field_value. Since
+	   the field data is sorted, these rows are adjacent and the bounds are
+	   found in logarithmic time. An empty prefix matches every row.
+	*/
+	
+	enum range_incl {
+		INCL_NONE = 0,
+		INCL_LOW = 1,
+		INCL_HIGH = 2,
+		INCL_BOTH = INCL_LOW | INCL_HIGH
+	};
+	
+	bool lookup_range(const char * field_name,
+		const char * low,
+		const char * high,
+		std::vector<eq_range_result>& in_out_targets,
+		int incl = INCL_BOTH,
+		value_buffer * buffer = nullptr
+	);
+	bool lookup_range(const char * field_name,
+		const char * low,
+		const char * high,
+		eq_range_view& out,
+		int incl = INCL_BOTH
+	);
+	bool lookup_range(const char * field_name,
+		const char * low,
+		const char * high,
+		eq_range_cursor& out,
+		int incl = INCL_BOTH
+	);
+	/*
+	   Like the respective lookup_equal_range(), but matches all rows on which
+	   the value of field_name is between low and high, as compared by
+	   strcmp(). incl tells if each bound is part of the range itself. Either
+	   bound can be nullptr, in which case the range is open on that side, so
+	   "greater than" and "less than" lookups are possible as well. If low is
+	   greater than high the range is empty. Cost is log(number of lines) for
+	   each given bound.
+	*/
+	
+	bool lookup_numeric(const field_pair& source,
+		std::vector<eq_range_result>& in_out_targets,
+		value_buffer * buffer = nullptr
+	);
+	bool lookup_numeric(const field_pair& source, eq_range_view& out);
+	bool lookup_numeric(const field_pair& source, eq_range_cursor& out);
+	/*
+	   Like the respective lookup_equal_range(), but source.field_value is
+	   parsed according to the type of source.field_name and matched by
+	   numeric value, so "4.2" finds "4.20". Throws if the field is not
+	   numeric, or if source.field_value does not parse.
+	*/
+	
+	bool lookup_numeric_range(const char * field_name,
+		const char * low,
+		const char * high,
+		std::vector<eq_range_result>& in_out_targets,
+		int incl = INCL_BOTH,
+		value_buffer * buffer = nullptr
+	);
+	bool lookup_numeric_range(const char * field_name,
+		const char * low,
+		const char * high,
+		eq_range_view& out,
+		int incl = INCL_BOTH
+	);
+	bool lookup_numeric_range(const char * field_name,
+		const char * low,
+		const char * high,
+		eq_range_cursor& out,
+		int incl = INCL_BOTH
+	);
+	/*
+	   Like lookup_range(), but the bounds are parsed and compared as
+	   numbers of the type of field_name. Rows come in numeric order. Throws
+	   like lookup_numeric().
+	*/
+	
+	bool lookup_composite(const std::vector<field_pair>& keys,
+		std::vector<field_pair>& in_out_targets,
+		value_buffer * buffer = nullptr
+	);
+	/*
+	   Like lookup_unique(), but the source is a full tuple of a unique
+	   composite index. keys have to name all fields of the index in their
+	   order. Throws if there is no such index or it isn't unique.
+	*/
+	
+	bool lookup_composite(const std::vector<field_pair>& keys,
+		std::vector<eq_range_result>& in_out_targets,
+		value_buffer * buffer = nullptr
+	);
+	bool lookup_composite(const std::vector<field_pair>& keys,
+		eq_range_view& out
+	);
+	bool lookup_composite(const std::vector<field_pair>& keys,
+		eq_range_cursor& out
+	);
+	/*
+	   Like the respective lookup_equal_range(), but matches the rows on which
+	   each field in keys has its value. keys have to name the leading fields
+	   of some composite index in their order, e.g. {region} or {region, sku}
+	   for the index on region, sku. The rows come sorted by the rest of the
+	   tuple. Throws if there is no such index.
+	*/
+	
+	bool lookup_and(const std::vector<field_pair>& predicates,
+		std::vector<uint>& out_rows
+	);
+	bool lookup_and(const std::vector<field_pair>& predicates,
+		std::vector<eq_range_result>& in_out_targets,
+		value_buffer * buffer = nullptr
+	);
+	/*
+	   Finds the rows on which every field in predicates has its value, as if
+	   by lookup_equal_range() on each and keeping only the common rows. The
+	   first version places the line numbers in out_rows in ascending order,
+	   the second one fills in_out_targets for them, in the same order.
+	   Returns true if there are any such rows. Throws like
+	   lookup_equal_range().
+	   
+	   The equal range of a value is sorted by line number, so the ranges are
+	   intersected without materializing anything, starting with the shortest
+	   one. Each candidate is looked for with an exponential search from the
+	   position of the previous one, which costs about
+	   candidates * log(range / candidates) comparisons per predicate. Only the
+	   rows which survive all predicates are looked up in the targets.
+	*/
+	
+	enum in_flags {
+		IN_DEFAULT = 0,
+		IN_DEDUP = 1,
+		IN_ROW_ORDER = 2
+	};
+	
+	bool lookup_in(const char * field_name,
+		const std::vector<const char *>& values,
+		std::vector<uint>& out_rows,
+		int flags = IN_DEFAULT
+	);
+	bool lookup_in(const char * field_name,
+		const std::vector<const char *>& values,
+		std::vector<eq_range_result>& in_out_targets,
+		int flags = IN_DEFAULT,
+		value_buffer * buffer = nullptr
+	);
+	/*
+	   Finds the rows on which field_name has any of values, as if by
+	   lookup_equal_range() for each value, and returns their union, either
+	   as line numbers or as the target values on those lines. Returns true
+	   if any row matches.
+	   
+	   The values are sorted and the field index is walked once, in order,
+	   skipping ahead to each next value with an exponential search, so the
+	   name of the field is looked up once and no range is visited twice. By
+	   default the rows come grouped by value, in the order of the sorted
+	   values, and a value given n times yields its rows n times. With
+	   IN_DEDUP each distinct value, with regard to the collation of the field,
+	   is counted once. With IN_ROW_ORDER the rows are sorted by line number.
+	*/
+	
+	void group_by(const char * field_name, group_cursor& out);
+	/* Opens a group_cursor over field_name. Throws if there is no such field. */
+	
+	void group_counts(const char * field_name,
+		std::vector<value_count>& out,
+		uint threads = 1,
+		value_buffer * buffer = nullptr
+	);
+	/*
+	   Places all distinct values of field_name with their counts in out, in
+	   sorted order. With more than one thread, 0 meaning all hardware
+	   threads, the field data is split in as many parts on group boundaries,
+	   each part is walked by its own thread, and the results are joined.
+	*/
+	
+	void group_top(const char * field_name,
+		size_t k,
+		std::vector<value_count>& out,
+		uint threads = 1,
+		value_buffer * buffer = nullptr
+	);
+	/*
+	   Like group_counts(), but out gets only the k most frequent values,
+	   most frequent first, equal counts in sorted order of the values. Each
+	   part keeps its own k best in a heap, and the parts are merged, since no
+	   group is split between parts.
+	*/
+	
+	enum order_dir {
+		ORDER_ASC,
+		ORDER_DESC
+	};
+	
+	void order_by(const char * field_name,
+		ordered_cursor& out,
+		int dir = ORDER_ASC
+	);
+	void order_by(const char * field_name,
+		const char * from,
+		ordered_cursor& out,
+		int dir = ORDER_ASC,
+		bool inclusive = true
+	);
+	/*
+	   Opens an ordered_cursor over all rows in the order of field_name, or
+	   only over the rows from the value from on: the rows with a greater
+	   value when walking ORDER_ASC, with a lesser one when walking
+	   ORDER_DESC, and if inclusive, the rows equal to from as well. The
+	   first n rows in order are then one next() away. Numeric fields are
+	   walked in numeric order, and from is parsed as a number; other
+	   fields are compared with their collation. Throws if there is no
+	   such field, or if from does not parse.
+	*/
+	
+	struct fuzzy_match {
+		fuzzy_match(const char * value = nullptr,
+			uint distance = 0,
+			size_t count = 0
+		) :
+			value(value), distance(distance), count(count) {}
+		const char * value;
+		uint distance;
+		size_t count;
+	};
+	/*
+	   A distinct value of a field, its edit distance from the value looked
+	   up, and the number of rows it's on.
+	*/
+	
+	bool lookup_fuzzy(const field_pair& source,
+		uint max_distance,
+		std::vector<fuzzy_match>& out,
+		value_buffer * buffer = nullptr
+	);
+	/*
+	   Places in out all distinct values of source.field_name no more than
+	   max_distance insertions, deletions or substitutions of a byte away from
+	   source.field_value, closest first, equal distances in sorted order.
+	   Returns true if any were found. The field needs use_fuzzy(); the
+	   search visits only the parts of its tree which can hold a match, and
+	   each visited value is measured with a bit-parallel kernel. Distances
+	   are between the bytes as appended, whatever the collation of the
+	   field. Throws if there is no such field, or it has no fuzzy index.
+	*/
+	
+	bool lookup_nearest(const field_pair& source,
+		size_t n,
+		std::vector<fuzzy_match>& out,
+		value_buffer * buffer = nullptr
+	);
+	/* Like lookup_fuzzy(), but out gets the n values closest to the source. */
+	
+	bool lookup_contains(const field_pair& source, std::vector<uint>& out_rows);
+	bool lookup_contains(const field_pair& source,
+		std::vector<eq_range_result>& in_out_targets,
+		value_buffer * buffer = nullptr
+	);
+	/*
+	   Matches all rows on which the value of source.field_name contains
+	   source.field_value, compared byte by byte, whatever the collation of
+	   the field. The first places the line numbers of the rows in out_rows,
+	   in line order, the second fills the targets like lookup_equal_range().
+	   The field needs use_substrings(); the occurrences are found by binary
+	   search in its suffix array, in m log(n) time for a value of length m,
+	   plus the number of occurrences k, and their rows are put in line order
+	   in k log(k). Throws if there is no such field, or it has no substring
+	   index.
+	*/
+	
+	size_t get_substring_memory(const char * field_name);
+	/*
+	   Returns the bytes used by the substring index of field_name, or 0 if
+	   it has none. Throws if there is no such field.
+	*/
+	
+	struct filter_stats {
+		size_t keys;
+		size_t bytes;
+		double false_positive_rate;
+	};
+	
+	bool get_filter_stats(const char * field_name, filter_stats& out);
+	/*
+	   Places in out the number of distinct values in the filter of
+	   field_name, the bytes it uses, and the expected fraction of values
+	   not in the field which pass it anyway. Returns false, and leaves out
+	   alone, if the field has no filter. Throws if there is no such field,
+	   or before seal().
+	*/
+	
+	struct learned_stats {
+		size_t segments;
+		size_t max_error;
+		size_t bytes;
+	};
+	
+	bool get_learned_stats(const char * field_name, learned_stats& out);
+	/*
+	   Places in out the number of segments of the model of field_name, its
+	   error bound in positions, and the bytes it uses. Returns false, and
+	   leaves out alone, if the field has no model. Throws if there is no
+	   such field, or before seal().
+	*/
+	
+	struct front_coded_stats {
+		size_t blocks;
+		size_t bytes;
+	};
+	
+	bool get_front_coded_stats(const char * field_name, front_coded_stats& out);
+	/*
+	   Places in out the number of blocks of the front coded values of
+	   field_name and the bytes they and the rows of the values use, to be
+	   compared with 8 bytes a value for INDEX_SORTED. Returns false, and
+	   leaves out alone, if the field isn't front coded. Throws if there is
+	   no such field, or before seal().
+	*/
+	
+	static const uint INTERN_SAMPLE = 4096;
+	
+	bool is_interned(const char * field_name);
+	/*
+	   True if field_name has use_interning() and kept interning to the end.
+	   Throws if there is no such field, or before seal().
+	*/
+	
+	inline size_t get_pool_size() const
+	{return _pool.size() + _packed.size();}
+	/*
+	   Bytes in the string pool. With POOL_COMPRESSED, once sealed, the
+	   bytes of the compressed values and of the field names.
+	*/
+	
+	enum token_match {
+		TOKENS_ALL,
+		TOKENS_ANY
+	};
+	
+	bool lookup_tokens(const char * field_name,
+		const std::vector<const char *>& tokens,
+		std::vector<uint>& out_rows,
+		int how = TOKENS_ALL
+	);
+	bool lookup_tokens(const char * field_name,
+		const std::vector<const char *>& tokens,
+		std::vector<eq_range_result>& in_out_targets,
+		int how = TOKENS_ALL,
+		value_buffer * buffer = nullptr
+	);
+	/*
+	   Matches the rows on which the value of field_name has all of tokens
+	   with TOKENS_ALL, or any of them with TOKENS_ANY. Each token is
+	   lowercased like the field's are, if so configured. The first places
+	   the line numbers of the rows in out_rows, in line order, the second
+	   fills the targets like lookup_equal_range(). The field needs
+	   use_tokens(). For TOKENS_ALL the lists of the tokens are intersected
+	   from the shortest one, and a token not in the field at all ends the
+	   lookup without decoding anything. Throws if there is no such field, or
+	   it has no token index.
+	*/
+	
+	uint get_field_col(const char * field_name);
+	/*
+	   Returns the column number of field_name, as used by get_str_at() and
+	   eq_range_view::value_at(). Throws if there is no such field.
+	*/
 
 	inline uint get_num_rows() {return _data_map.get_rows();}
 	inline uint get_num_cols() {return _data_map.get_cols();}
-	inline const char * get_str_at(uint row, uint col)
-	{return _pool.get(_data_map.get(row, col));}
+	inline const char * get_str_at(uint row,
+		uint col,
+		value_buffer * buffer = nullptr
+	)
+	{
+		_check_buffer(buffer);
+		uint at = _data_map.get(row, col);
+		return (_is_packed(row)) ? buffer->_unpack(_packed, at) : _pool.get(at);
+	}
 	/*
 	   get_num_rows(), get_num_cols(), and get_str_at() allow for linear 
 	   iteration of the whole csv as it exist in memory. row represents a line
 	   number in the csv, col represents the field found at field number col
-	   at line number row.
+	   at line number row. buffer is where a table with POOL_COMPRESSED
+	   decompresses the value, like for every call which takes one; see
+	   pool_mode.
+	*/
+
+	inline cell get_cell_at(uint row,
+		uint col,
+		value_buffer * buffer = nullptr
+	)
+	{
+		_check_buffer(buffer);
+		uint at = _data_map.get(row, col);
+		if (_is_packed(row))
+		{
+			const char * str = buffer->_unpack(_packed, at);
+			return cell(str, strlen(str));
+		}
+		return cell(_pool.get(at), _pool.get_len(at));
+	}
+	/*
+	   Like get_str_at(), but with the length of the value, which costs a
+	   strlen() unless the table has POOL_LENGTHS.
+	*/
+	
+	inline size_t get_value_len(const char * value) const
+	{
+		return (_pool.has_lengths()) ?
+			_pool.get_len(value - _pool.get(0)) :
+			strlen(value);
+	}
+	/*
+	   The length of value, which has to point to the start of a value in
+	   the table, as returned by any lookup. Without POOL_LENGTHS this is
+	   strlen().
+	*/
+	
+	inline pool_mode get_pool_mode() const
+	{return _pool_mode;}
+	
+	void get_row(uint row,
+		std::vector<cell>& out,
+		value_buffer * buffer = nullptr
+	);
+	/*
+	   Places all get_num_cols() values of row in out, in column order, as
+	   pointer and length pairs. The lengths come from the positions of the
+	   strings in the pool, so no strlen() is needed unless the pool is
+	   compressed. Throws if row hasn't been appended in full.
+	*/
+	
+	void get_rows(const uint * rows,
+		size_t n,
+		std::vector<cell>& out,
+		value_buffer * buffer = nullptr
+	);
+	inline void get_rows(const std::vector<uint>& rows,
+		std::vector<cell>& out,
+		value_buffer * buffer = nullptr
+	)
+	{get_rows(rows.data(), rows.size(), out, buffer);}
+	/*
+	   Like get_row(), but for n rows at once. out holds n * get_num_cols()
+	   cells, row after row. While a row is read, the matrix row of a later
+	   one and the strings of the one after it are prefetched, so the cache
+	   misses of different rows overlap. Meant for rows which come from a
+	   lookup, or for exporting everything.
 	*/
 
 	void dbg_dump();
@@ -131,6 +1201,12 @@ class ro_string_table
 			index_of_string(index)
 		{}
 		
+		static inline num_field_info of_list(uint list, uint index)
+		{return num_field_info(list, index);}
+		
+		inline uint list_id() const
+		{return original_line_number;}
+		
         uint original_line_number;
         uint index_of_string;
     };
@@ -139,8 +1215,49 @@ class ro_string_table
 	   num_field_info. index_of_string points to the beginning of the respective
 	   string inside the string pool, and original_line_number is used to
 	   associate different fields to each other upon lookup.
+	   
+	   A sealed dictionary field has an entry for each distinct value, which
+	   is on the rows of a list in the postings instead of on a line. Such an
+	   entry is made with of_list() and its list is read with list_id(); its
+	   original_line_number is not a row and isn't read.
 	*/
 	
+	union num_value
+	{
+		long long i;
+		double d;
+	};
+	
+	struct num_field_key
+	{
+		num_field_key(num_value value, uint line_num) :
+			value(value),
+			original_line_number(line_num)
+		{}
+		
+		num_value value;
+		uint original_line_number;
+	};
+	/*
+	   The parsed value of a string from a numeric field. i is used for
+	   TYPE_INT64 and TYPE_DECIMAL, d for TYPE_DOUBLE.
+	*/
+	
+	struct num_context
+	{
+		num_context(field_type type = TYPE_STRING) : type(type)
+		{value.i = 0;}
+		
+		num_context(field_type type, num_value value) :
+			type(type),
+			value(value)
+		{}
+		
+		field_type type;
+		num_value value;
+	};
+	/* Like context_lookup below, but for comparing numeric keys. */
+	
 	class single_field_data
     {
 		/*
@@ -154,42 +1271,273 @@ class ro_string_table
         struct context_lookup
         {
 			context_lookup(const string_pool * str_pool = nullptr,
-				const char * str = nullptr
+				const char * str = nullptr,
+				size_t str_len = 0,
+				int how = COLL_NONE,
+				const compressed_pool * packed = nullptr
 			) :
 				str_pool(str_pool),
-				str(str)
+				str(str),
+				str_len(str_len),
+				how(how),
+				packed(packed)
 			{}
 			
 			const string_pool * str_pool;
 			const char * str;
+			size_t str_len;
+			int how;
+			const compressed_pool * packed;
 		};
         /*
            Since strings in the sorted vector are represented by num_field_info,
            we need to know about the string pool in order to get the actual
            string. The value that we are looking for, however, is represented
            by an ordinary char *, so context_lookup allows us to transparently
-           compare num_field_info to C strings.
+           compare num_field_info to C strings. str_len is used by
+           comparisons which look at a prefix of str, and with POOL_LENGTHS
+           by all comparisons with COLL_NONE. how is the collation of the
+           field. packed is the compressed pool the values are in, if they
+           are; str_len is then always set.
         */
         
         single_field_data(
             int field_num,
             num_field_info name_id,
             const string_pool& str_pool,
+            const compressed_pool& packed,
             bool is_unique = false,
-            uint init_vect_reserve = 0
+            uint init_vect_reserve = 0,
+            field_type type = TYPE_STRING,
+            uint decimal_places = 0,
+            int collation = COLL_NONE,
+            index_kind kind = INDEX_SORTED
         );
         
-        inline void append_info(const nfi& num_fi)
-        {_field_data.append(num_fi);}
+        void append_info(const nfi& num_fi);
 
         inline void seal()
         {
+			std::unordered_multimap<uint64_t, uint>().swap(_interned);
 			_field_data.seal();
+			if (is_numeric())
+				_num_data.seal();
 			_check_unique();
+			if (_has_substrings)
+				_make_substrings();
+			if (_has_tokens)
+				_make_tokens();
+			if (_has_filter)
+				_make_filter();
+			if (is_dictionary())
+				_make_dictionary();
+			if (INDEX_LEARNED == _kind && COLL_NONE == _collation)
+				_make_learned();
+			if (_is_fuzzy)
+				_make_fuzzy();
+			if (INDEX_FRONT_CODED == _kind && COLL_NONE == _collation)
+				_make_front_coded();
+		}
+		
+		inline void set_fuzzy()
+		{_is_fuzzy = true;}
+		/* Makes the field keep a bk_tree; see field_info::use_fuzzy(). */
+		
+		inline bool is_fuzzy() const
+		{return _is_fuzzy;}
+		
+		inline const fuzzy::bk_tree& get_fuzzy() const
+		{return _fuzzy;}
+		/*
+		   After seal(), the ids in the tree are the positions in the field
+		   data of the first entry of each distinct value.
+		*/
+		
+		struct value_ctx
+		{
+			value_ctx(const single_field_data * field) : field(field) {}
+			const single_field_data * field;
+			mutable std::string value;
+		};
+		/*
+		   The context of a walk of the tree or a search of the suffix array:
+		   the field, and where a compressed value is decompressed, so only
+		   the one returned last is valid. One per lookup, so lookups can run
+		   side by side.
+		*/
+		
+		static const char * fuzzy_str(const void * ctx, uint id);
+		/* The get_str function of the tree, with a value_ctx as context. */
+		
+		inline void set_substrings(const matrix<uint>& data_map)
+		{
+			_data_map = &data_map;
+			_has_substrings = true;
+		}
+		/*
+		   Makes the field keep a suffix_array; see use_substrings() of
+		   field_info. Its ids are rows, whose values are found in data_map.
+		*/
+		
+		inline bool has_substrings() const
+		{return _has_substrings;}
+		
+		inline const suffix_array& get_substrings() const
+		{return _substrings;}
+		
+		static const char * substring_str(const void * ctx, uint row);
+		/* The get_str function of the suffix array, with a value_ctx. */
+		
+		void set_tokens(const char * delimiters, bool lowercase);
+		/* Makes the field keep a token_index; see field_info::use_tokens(). */
+		
+		inline bool has_tokens() const
+		{return _has_tokens;}
+		
+		inline const token_index& get_tokens() const
+		{return _tokens;}
+		
+		void set_filter(uint bits_per_key);
+		/* Makes the field keep a bloom_filter; see field_info::use_filter(). */
+		
+		inline void set_interning()
+		{_is_interning = true;}
+		
+		inline bool is_interning() const
+		{return _is_interning;}
+		
+		bool find_interned(const char * str, size_t len, uint& out);
+		void add_interned(const char * str, size_t len, uint at);
+		/*
+		   find_interned() places in out where the value str of len bytes
+		   already is in the pool, if it is; add_interned() remembers that
+		   it's at at. Both do nothing if the field isn't interning, and the
+		   first stops the interning once INTERN_SAMPLE values show too many
+		   of them distinct.
+		*/
+		
+		inline bool has_filter() const
+		{return _has_filter;}
+		
+		inline const bloom_filter& get_filter() const
+		{return _filter;}
+		
+		inline bool may_contain(const char * val) const
+		{
+			return (!_has_filter ||
+				_filter.may_contain(collation::hash(val, _collation))
+			);
 		}
+		/*
+		   False means no value of the field equals val. Always true without
+		   a filter.
+		*/
+		
+		inline bool is_dictionary() const
+		{return (INDEX_DICTIONARY == _kind);}
+		
+		inline bool is_learned() const
+		{return (_learned.size() > 0);}
+		
+		inline const learned_index& get_learned() const
+		{return _learned;}
+		
+		inline std::pair<size_t, size_t> near(const char * val) const
+		{return _learned.window(learned_index::key_of(val));}
+		/* Where the model puts val; see sort_vector for how it's used. */
+		
+		inline void set_front_coded(const matrix<uint>& data_map)
+		{_data_map = &data_map;}
+		/*
+		   The field can then be front coded upon seal(), since the string
+		   of each row can be found in data_map.
+		*/
+		
+		inline bool is_front_coded() const
+		{return (_front_coded.size() > 0);}
+		
+		inline const front_coded& get_front_coded() const
+		{return _front_coded;}
+		
+		inline const uint * rows() const
+		{return _rows.data();}
+		
+		inline size_t front_coded_memory() const
+		{return _front_coded.memory() + _rows.capacity() * sizeof(uint);}
+		/*
+		   A front coded field keeps only the row of each of its values, in
+		   the order of the values, instead of the entries of the field data.
+		   Position i of the front coded values is on row rows()[i], and get()
+		   makes the entry from that row.
+		*/
+		
+		inline const postings& get_postings() const
+		{return _postings;}
+		/*
+		   For a dictionary field, after seal(), the entries of the field data
+		   are the distinct values, and each has the list_id() of its list of
+		   rows in the postings instead of a row.
+		*/
+		
+		inline uint first_line_of(const nfi& entry) const
+		{
+			return (is_dictionary()) ?
+				_postings.first(entry.list_id()) :
+				entry.original_line_number;
+		}
+		/* The first row of entry, whatever the kind of field. */
+		
+		inline bool is_numeric() const
+		{return (_type != TYPE_STRING);}
+		
+		inline field_type get_type() const
+		{return _type;}
+		
+		bool parse(const char * str, num_value& out) const;
+		/* Parses str according to the type of the field. */
+		
+		const char * type_name() const;
+		
+		inline const num_field_key * num_data() const
+		{return _num_data.data();}
+		
+		inline size_t num_lower_bound(
+			gen_comp_less_ctx_lower_bound<num_field_key, num_context>& cmp
+		)
+		{
+			num_field_key dummy(num_value(), -1);
+			return _num_data.lower_bound(dummy, cmp);
+		}
+		
+		inline size_t num_upper_bound(
+			gen_comp_less_ctx_upper_bound<num_field_key, num_context>& cmp
+		)
+		{
+			num_field_key dummy(num_value(), -1);
+			return _num_data.upper_bound(dummy, cmp);
+		}
+		
+		inline size_t num_size() const
+		{return _num_data.size();}
+		
+		static int compare_num(const num_value& a,
+			const num_value& b,
+			field_type type
+		);
 
         inline nfi get(int index) const
-        {return _field_data.get(index);}
+        {
+			if (is_front_coded())
+			{
+				uint row = _rows[index];
+				return nfi(row, _data_map->get(row, _field_num));
+			}
+			return _field_data.get(index);
+		}
+        
+        inline const nfi * data() const
+        {return _field_data.data();}
+        /* Not for a front coded field, which has no entries after seal(). */
 
         inline bool lookup(const nfi ** out,
 			gen_comp_less_ctx_lower_bound<nfi, context_lookup>& less_ctx
@@ -199,6 +1547,18 @@ class ro_string_table
 			return _field_data.lookup(dummy, out, less_ctx);
 		}
 		
+        inline bool lookup(const nfi ** out,
+			gen_comp_less_ctx_lower_bound<nfi, context_lookup>& less_ctx,
+			const char * val
+		)
+        {
+			if (!is_learned())
+				return lookup(out, less_ctx);
+			
+			nfi dummy(-1, -1);
+			return _field_data.lookup(dummy, out, less_ctx, near(val));
+		}
+		
 		inline bool equal_range(std::pair<size_t, size_t>& out,
 			sort_vector<nfi, context_lookup>::equal_range_ctx_compars& cmps
 		)
@@ -207,6 +1567,65 @@ class ro_string_table
 			return _field_data.equal_range(dummy, out, cmps);
 		}
 		
+		inline bool equal_range(std::pair<size_t, size_t>& out,
+			sort_vector<nfi, context_lookup>::equal_range_ctx_compars& cmps,
+			const char * val
+		)
+		{
+			if (!is_learned())
+				return equal_range(out, cmps);
+			
+			nfi dummy(-1, -1);
+			return _field_data.equal_range(dummy, out, cmps, near(val));
+		}
+		
+		inline size_t lower_bound(
+			gen_comp_less_ctx_lower_bound<nfi, context_lookup>& cmp
+		)
+		{
+			nfi dummy(-1, -1);
+			return _field_data.lower_bound(dummy, cmp);
+		}
+		
+		inline size_t upper_bound(
+			gen_comp_less_ctx_upper_bound<nfi, context_lookup>& cmp
+		)
+		{
+			nfi dummy(-1, -1);
+			return _field_data.upper_bound(dummy, cmp);
+		}
+		
+		inline size_t lower_bound(
+			gen_comp_less_ctx_lower_bound<nfi, context_lookup>& cmp,
+			const char * val
+		)
+		{
+			if (!is_learned())
+				return lower_bound(cmp);
+			
+			nfi dummy(-1, -1);
+			return _field_data.lower_bound(dummy, cmp, near(val));
+		}
+		
+		inline size_t upper_bound(
+			gen_comp_less_ctx_upper_bound<nfi, context_lookup>& cmp,
+			const char * val
+		)
+		{
+			if (!is_learned())
+				return upper_bound(cmp);
+			
+			nfi dummy(-1, -1);
+			return _field_data.upper_bound(dummy, cmp, near(val));
+		}
+		/*
+		   Like the above, but a learned field starts the search where its
+		   model puts val, which has to be the value in the context.
+		*/
+		
+		inline size_t size() const
+		{return (is_front_coded()) ? _rows.size() : _field_data.size();}
+		
         inline int field_number() const
         {return _field_num;}
 
@@ -215,47 +1634,382 @@ class ro_string_table
 
 		inline const char * get_name() const
 		{return _str_pool->get(_field_name_id.index_of_string);}
+		
+		void repoint(const matrix<uint>& data_map);
+		/*
+		   Points each entry to the string in data_map on its row, once the
+		   values have been moved to the compressed pool.
+		*/
 
 		inline bool is_unique() const
 		{return _is_unique;}
+		
+		inline int get_collation() const
+		{return _collation;}
 
 		void dbg_dump() const;
 
         private:
         void _check_unique();
+        void _check_unique_num();
+        void _make_dictionary();
+        void _make_fuzzy();
+        void _make_substrings();
+        void _make_tokens();
+        void _make_filter();
+        void _make_learned();
+        void _make_front_coded();
+        const char * _value_of(uint at, std::string& buf) const;
         
         sort_vector<nfi, context_lookup> _field_data;
+        sort_vector<num_field_key, num_context> _num_data;
+        postings _postings;
+        fuzzy::bk_tree _fuzzy;
+        suffix_array _substrings;
+        token_index _tokens;
+        bloom_filter _filter;
+        learned_index _learned;
+        front_coded _front_coded;
+        std::vector<uint> _rows;
+        const matrix<uint> * _data_map;
         num_field_info _field_name_id;
         const string_pool * _str_pool; // can't use default assignment if &
+        const compressed_pool * _packed;
         int _field_num;
+        field_type _type;
+        uint _decimal_places;
+        int _collation;
+        uint _filter_bits;
+        index_kind _kind;
         bool _is_unique;
+        bool _is_fuzzy;
+        bool _has_substrings;
+        bool _has_tokens;
+        bool _has_filter;
+        bool _is_interning;
+        std::unordered_multimap<uint64_t, uint> _interned;
     };
+	/*
+	   _interned maps the hash of each distinct value of an interning field
+	   to where the value is in the pool. The bytes there are compared on a
+	   match, so no value is kept twice and a lookup copies nothing.
+	*/
+	
+	class composite_index
+	{
+		/*
+		   A composite index is a vector of line numbers sorted by the strings
+		   on each line in a number of columns. The strings are compared
+		   column by column, with the collation of their field, and equal
+		   tuples are ordered by line number.
+		*/
+		public:
+		struct context_lookup
+		{
+			context_lookup(const composite_index * index = nullptr,
+				const field_pair * keys = nullptr,
+				uint num_keys = 0
+			) :
+				index(index),
+				keys(keys),
+				num_keys(num_keys)
+			{}
+			
+			const composite_index * index;
+			const field_pair * keys;
+			uint num_keys;
+		};
+		/*
+		   keys are the values a lookup compares the tuples against. When
+		   sorting, keys is null and two lines are compared instead.
+		*/
+		
+		composite_index(const std::vector<uint>& cols,
+			const std::vector<int>& collations,
+			const matrix<uint>& data_map,
+			const string_pool& str_pool,
+			const compressed_pool& packed,
+			bool is_unique
+		);
+		
+		void seal(uint lines);
+		/* Indexes lines 1 to lines-1, sorts them, and checks uniqueness. */
+		
+		bool equal_range(const field_pair * keys,
+			uint num_keys,
+			std::pair<size_t, size_t>& out_range
+		);
+		
+		bool begins_with(const std::vector<field_pair>& keys) const;
+		/* True if keys name the leading fields of the index in order. */
+		
+		int compare_lines(uint a, uint b, uint num_cols) const;
+		/* Compares the first num_cols strings on lines a and b. */
+		
+		inline uint value_index(uint line, uint n) const
+		{return _data_map->get(line, _cols[n]);}
+		/* Where the string of column n on line is in the pool. */
+		
+		inline int collation_of(uint n) const
+		{return _collations[n];}
+		
+		inline uint num_cols() const
+		{return _cols.size();}
+		
+		inline bool is_unique() const
+		{return _is_unique;}
+		
+		inline const uint * data() const
+		{return _lines.data();}
+		
+		std::string get_name() const;
+		/* The names of the fields of the index, separated by ", ". */
+		
+		private:
+		static int _compare(const uint& lhs,
+			const uint& rhs,
+			context_lookup ctx
+		);
+		void _check_unique();
+		
+		sort_vector<uint, context_lookup> _lines;
+		std::vector<uint> _cols;
+		std::vector<int> _collations;
+		const matrix<uint> * _data_map;
+		const string_pool * _str_pool;
+		const compressed_pool * _packed;
+		bool _is_unique;
+	};
+	
+	typedef int (*string_context_lookup) (
+		const ro_string_table::num_field_info& lhs,
+		const ro_string_table::num_field_info& dummy_rhs,
+		ro_string_table::single_field_data::context_lookup ctx
+	);
 	
 	void _set_fields(const std::vector<field_info>& fields);
-	uint _append_to_table(const char * str);
+	uint _append_to_table(const char * str,
+		size_t len,
+		single_field_data * field = nullptr
+	);
 	bool _lookup_field(const char * name, const single_field_data ** out);
+	bool _field_equal_range(const char * field_name,
+		const single_field_data::context_lookup& ctx,
+		string_context_lookup cmp,
+		const single_field_data ** out_field,
+		std::pair<size_t, size_t>& out_range
+	);
+	bool _field_range(const char * field_name,
+		const char * low,
+		const char * high,
+		int incl,
+		const single_field_data ** out_field,
+		std::pair<size_t, size_t>& out_range
+	);
+	void _fill_eq_range(const row_run& run,
+		std::vector<eq_range_result>& in_out_targets,
+		value_buffer * buffer
+	);
+	bool _field_numeric_range(const char * field_name,
+		const char * low,
+		const char * high,
+		int incl,
+		row_run& out
+	);
+	row_run _nfi_run(const single_field_data& source_field,
+		const std::pair<size_t, size_t>& range
+	);
+	void _set_view(const row_run& run, eq_range_view& out);
+	void _set_cursor(const row_run& run, eq_range_cursor& out);
+	
+	inline single_field_data::context_lookup _value_ctx(const char * val,
+		int how = COLL_NONE,
+		size_t len = 0
+	)
+	{
+		// only a pool with lengths, or a compressed one, compares by them
+		const compressed_pool * packed = _packed_pool();
+		if ((_pool.has_lengths() || packed) && !len)
+			len = strlen(val);
+		return single_field_data::context_lookup(&_pool, val, len, how, packed);
+	}
+	
+	inline single_field_data::context_lookup _value_ctx(const field_pair& src)
+	{return _value_ctx(src.field_value, COLL_NONE, src.value_len);}
+	
+	inline single_field_data::context_lookup _prefix_ctx(const field_pair& src)
+	{
+		const char * prefix = src.field_value;
+		size_t len = (src.value_len) ? src.value_len : strlen(prefix);
+		return single_field_data::context_lookup(&_pool,
+			prefix,
+			len,
+			COLL_NONE,
+			_packed_pool()
+		);
+	}
+	
+	inline const compressed_pool * _packed_pool() const
+	{return (_packed.is_trained()) ? &_packed : nullptr;}
+	/* The compressed pool, once the values are in it. */
+	
+	inline bool _is_packed(uint row) const
+	{return (row && _packed.is_trained());}
+	/* True if the values of row are compressed; row 0 has the names. */
+	
+	inline const char * _value_of(uint at, value_buffer * buffer) const
+	{
+		return (_packed.is_trained()) ?
+			buffer->_unpack(_packed, at) :
+			_pool.get(at);
+	}
+	/*
+	   The value at at, decompressed in buffer if the pool is compressed, in
+	   which case buffer has passed _check_buffer().
+	*/
+	
+	inline void _check_buffer(const value_buffer * buffer) const
+	{
+		if (!buffer && _packed.is_trained())
+			_throw_no_buffer();
+	}
+	
+	void _compress_pool();
 	bool _lookup_field_val(const ro_string_table::single_field_data& field,
 		const char * val,
-		const num_field_info ** out
+		uint& out_row,
+		size_t len = 0
 	);
 	
 	void _dbg_dump_pool() const;
+	const composite_index * _find_composite(
+		const std::vector<field_pair>& keys,
+		bool full_unique
+	);
+	bool _composite_range(const std::vector<field_pair>& keys,
+		row_run& out
+	);
+	void _set_composites(const std::vector<field_info>& fields);
+	static size_t _gallop(const row_run& run, size_t from, uint row);
+	const single_field_data& _sealed_field(const char * field_name);
+	size_t _group_end(const single_field_data& field, size_t from);
+	size_t _group_count(const single_field_data& field,
+		size_t begin,
+		size_t end
+	);
+	void _group_parts(const single_field_data& field,
+		uint threads,
+		std::vector<size_t>& out_bounds
+	);
+	
+	typedef std::pair<size_t, value_count> ranked_group;
+	
+	static inline bool _is_better_group(const ranked_group& a,
+		const ranked_group& b
+	)
+	{
+		return (a.second.count > b.second.count ||
+			(a.second.count == b.second.count && a.first < b.first)
+		);
+	}
+	/* Higher count first, then by position in the field data. */
+	
+	void _group_top_part(const single_field_data& field,
+		size_t begin,
+		size_t end,
+		size_t k,
+		std::vector<ranked_group>& out
+	);
+	const single_field_data& _fuzzy_field(const char * field_name);
+	void _fill_fuzzy(const single_field_data& field,
+		const std::vector<fuzzy::bk_tree::match>& matches,
+		std::vector<fuzzy_match>& out,
+		value_buffer * buffer
+	);
+	void _set_ordered(const single_field_data& field,
+		const std::pair<size_t, size_t>& range,
+		int dir,
+		ordered_cursor& out
+	);
+	void _field_rows(const single_field_data& field,
+		const std::pair<size_t, size_t>& range,
+		std::vector<uint>& out_rows
+	);
+	void _fill_field_range(const single_field_data& field,
+		const std::pair<size_t, size_t>& range,
+		std::vector<eq_range_result>& in_out_targets,
+		value_buffer * buffer
+	);
+	void _set_field_view(const single_field_data& field,
+		const std::pair<size_t, size_t>& range,
+		eq_range_view& out
+	);
+	void _set_field_cursor(const single_field_data& field,
+		const std::pair<size_t, size_t>& range,
+		eq_range_cursor& out
+	);
+	
+	template <typename TIsBefore>
+	static size_t _gallop_if(size_t from, size_t end, TIsBefore is_before)
+	{
+		/*
+		   Returns the first index in [from, end) for which is_before() is
+		   false, or end. is_before() has to be true for some prefix of the
+		   range and false for the rest. The step doubles until the answer is
+		   passed, then a binary search finds it, so this costs
+		   log(distance) rather than log(end - from).
+		*/
+		if (from >= end || !is_before(from))
+			return from;
+		
+		size_t lo = from, step = 1, hi = from + 1;
+		while (hi < end && is_before(hi))
+		{
+			lo = hi;
+			step <<= 1;
+			hi = lo + step;
+		}
+		
+		if (hi > end)
+			hi = end;
+		
+		++lo;
+		while (lo < hi)
+		{
+			size_t mid = lo + (hi - lo)/2;
+			if (is_before(mid))
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+		return lo;
+	}
+	
 	void _throw_no_such_field(const char * field_name);
 	void _throw_field_not_unique(const char * field_name);
+	void _throw_field_not_numeric(const char * field_name);
+	void _throw_bad_number(const single_field_data& field, const char * str);
 	void _throw_not_sealed();
-	
-	typedef int (*string_context_lookup) (
-		const ro_string_table::num_field_info& lhs,
-		const ro_string_table::num_field_info& dummy_rhs,
-		ro_string_table::single_field_data::context_lookup ctx
-	);
+	void _throw_no_fuzzy_index(const single_field_data& field);
+	void _throw_no_substring_index(const single_field_data& field);
+	void _throw_no_token_index(const single_field_data& field);
+	void _throw_view_of_dictionary(const single_field_data& field);
+	void _throw_bad_row(uint row);
+	static void _throw_no_buffer();
+	void _cells_of(uint row, cell * out, value_buffer * buffer);
+	void _prefetch_cells(uint row);
 	
 	sort_vector<single_field_data, const char*> _fields;
+	std::vector<composite_index> _composites;
 	matrix<uint> _data_map;
 	string_pool _pool;
+	compressed_pool _packed;
+	pool_mode _pool_mode;
 	string_context_lookup _str_ctx_lup;
+	string_context_lookup _str_ctx_prefix_lup;
 	bool _is_sealed;
 	bool _are_fields_set;
+	bool _shares_strings;
 	uint _num_lines;
 	uint _num_fields;
 	uint _current_line;
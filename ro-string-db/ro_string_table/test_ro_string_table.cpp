@@ -1,14 +1,64 @@
 #include "../test/test.h"
 #include "ro_string_table.hpp"
 
+#include <set>
+#include <map>
+#include <algorithm>
+#include <cstring>
 #include <vector>
 #include <string>
 #include <iostream>
 
 static bool test_ro_string_table(void);
+static bool test_ro_string_table_eq_range_view(void);
+static bool test_ro_string_table_eq_range_cursor(void);
+static bool test_ro_string_table_prefix(void);
+static bool test_ro_string_table_range(void);
+static bool test_ro_string_table_numeric(void);
+static bool test_ro_string_table_collation(void);
+static bool test_ro_string_table_composite(void);
+static bool test_ro_string_table_and(void);
+static bool test_ro_string_table_in(void);
+static bool test_ro_string_table_dictionary(void);
+static bool test_ro_string_table_get_row(void);
+static bool test_ro_string_table_exists_count(void);
+static bool test_ro_string_table_group(void);
+static bool test_ro_string_table_order_by(void);
+static bool test_ro_string_table_fuzzy(void);
+static bool test_ro_string_table_contains(void);
+static bool test_ro_string_table_tokens(void);
+static bool test_ro_string_table_filter(void);
+static bool test_ro_string_table_learned(void);
+static bool test_ro_string_table_lengths(void);
+static bool test_ro_string_table_interning(void);
+static bool test_ro_string_table_front_coded(void);
+static bool test_ro_string_table_compressed_pool(void);
 
 static ftest tests[] = {
 	test_ro_string_table,
+	test_ro_string_table_eq_range_view,
+	test_ro_string_table_eq_range_cursor,
+	test_ro_string_table_prefix,
+	test_ro_string_table_range,
+	test_ro_string_table_numeric,
+	test_ro_string_table_collation,
+	test_ro_string_table_composite,
+	test_ro_string_table_and,
+	test_ro_string_table_in,
+	test_ro_string_table_dictionary,
+	test_ro_string_table_get_row,
+	test_ro_string_table_exists_count,
+	test_ro_string_table_group,
+	test_ro_string_table_order_by,
+	test_ro_string_table_fuzzy,
+	test_ro_string_table_contains,
+	test_ro_string_table_tokens,
+	test_ro_string_table_filter,
+	test_ro_string_table_learned,
+	test_ro_string_table_lengths,
+	test_ro_string_table_interning,
+	test_ro_string_table_front_coded,
+	test_ro_string_table_compressed_pool,
 };
 
 static bool didnt_throw = false;
@@ -374,6 +424,2986 @@ static bool test_ro_string_table(void)
 	return true;
 }
 
+static const int fruit_lines = 6;
+
+static std::vector<ro_string_table::field_info> fruit_fields(void)
+{
+	bool is_unique = true;
+	return std::vector<ro_string_table::field_info>{
+		ro_string_table::field_info("id", is_unique),
+		ro_string_table::field_info("fruit", is_unique),
+		ro_string_table::field_info("type"),
+		ro_string_table::field_info("price")
+	};
+}
+
+static void fill_fruit(ro_string_table& str_tbl)
+{
+	const char * lines[][4] = {
+		{"1", "pineapple", "fancy", "12.25"},
+		{"2", "apple", "normal", "5.32"},
+		{"3", "peach", "normal", "4.22"},
+		{"4", "mango", "fancy", "10.50"},
+		{"5", "pear", "normal", "6.00"},
+	};
+	
+	for (auto& line : lines)
+	{
+		for (auto& str : line)
+			str_tbl.append(str);
+	}
+	str_tbl.seal();
+}
+
+static bool test_ro_string_table_eq_range_view(void)
+{
+	ro_string_table str_tbl(fruit_lines, fruit_fields());
+	
+	{ // throw lookup before seal
+		ro_string_table::field_pair src("type", "normal");
+		ro_string_table::eq_range_view view;
+		
+		try {str_tbl.lookup_equal_range(src, view); check(didnt_throw);}
+		catch(std::runtime_error& e)
+		{
+			std::string expected("ro_string_table: lookup before seal()");
+			check(expected == e.what());
+		}
+	}
+	
+	fill_fruit(str_tbl);
+	
+	{ // get_field_col()
+		check(str_tbl.get_field_col("id") == 0);
+		check(str_tbl.get_field_col("fruit") == 1);
+		check(str_tbl.get_field_col("type") == 2);
+		check(str_tbl.get_field_col("price") == 3);
+		
+		try {str_tbl.get_field_col("banana"); check(didnt_throw);}
+		catch(std::runtime_error& e)
+		{
+			std::string expected("ro_string_table: lookup fail: no such field 'banana'");
+			check(expected == e.what());
+		}
+	}
+	
+	{ // throw no such field
+		ro_string_table::field_pair src("banana", "normal");
+		ro_string_table::eq_range_view view;
+		
+		try {str_tbl.lookup_equal_range(src, view); check(didnt_throw);}
+		catch(std::runtime_error& e)
+		{
+			std::string expected("ro_string_table: lookup fail: no such field 'banana'");
+			check(expected == e.what());
+		}
+	}
+	
+	{ // lookup
+		ro_string_table::field_pair src("type", "!normal");
+		ro_string_table::eq_range_view view;
+		
+		check(!str_tbl.lookup_equal_range(src, view));
+		check(view.empty());
+		check(view.size() == 0);
+		
+		uint fruit = str_tbl.get_field_col("fruit");
+		uint price = str_tbl.get_field_col("price");
+		
+		src.field_value = "normal";
+		check(str_tbl.lookup_equal_range(src, view));
+		check(!view.empty());
+		check(view.size() == 3);
+		
+		std::set<std::string> fruits, prices;
+		for (size_t i = 0; i < view.size(); ++i)
+		{
+			uint row = view.row_at(i);
+			check(std::string(str_tbl.get_str_at(row, 2)) == "normal");
+			check(view.value_at(i, fruit) == str_tbl.get_str_at(row, fruit));
+			fruits.insert(view.value_at(i, fruit));
+			prices.insert(view.value_at(i, price));
+		}
+		check(fruits == std::set<std::string>({"apple", "peach", "pear"}));
+		check(prices == std::set<std::string>({"5.32", "4.22", "6.00"}));
+		
+		// same values as the copying version
+		std::vector<ro_string_table::eq_range_result> eqr{
+			ro_string_table::eq_range_result("fruit")
+		};
+		check(str_tbl.lookup_equal_range(src, eqr));
+		for (size_t i = 0; i < view.size(); ++i)
+			check(eqr[0].values[i] == view.value_at(i, fruit));
+		
+		src.field_name = "id";
+		src.field_value = "4";
+		check(str_tbl.lookup_equal_range(src, view));
+		check(view.size() == 1);
+		check(view.row_at(0) == 4);
+		check(std::string(view.value_at(0, fruit)) == "mango");
+	}
+	
+	return true;
+}
+
+static bool test_ro_string_table_eq_range_cursor(void)
+{
+	ro_string_table str_tbl(fruit_lines, fruit_fields());
+	fill_fruit(str_tbl);
+	
+	ro_string_table::field_pair src("type", "!normal");
+	ro_string_table::eq_range_cursor cur;
+	std::vector<uint> rows{100};
+	
+	{ // no match
+		check(!str_tbl.lookup_equal_range(src, cur));
+		check(cur.count() == 0);
+		check(cur.remaining() == 0);
+		check(cur.skip(10) == 0);
+		check(cur.next(10, rows) == 0);
+		check(rows.empty());
+	}
+	
+	src.field_value = "normal";
+	
+	{ // rows
+		check(str_tbl.lookup_equal_range(src, cur));
+		check(cur.count() == 3);
+		check(cur.remaining() == 3);
+		
+		ro_string_table::eq_range_view view;
+		check(str_tbl.lookup_equal_range(src, view));
+		
+		check(cur.next(2, rows) == 2);
+		check(rows.size() == 2);
+		check(rows[0] == view.row_at(0));
+		check(rows[1] == view.row_at(1));
+		check(cur.remaining() == 1);
+		check(cur.count() == 3);
+		
+		check(cur.next(2, rows) == 1);
+		check(rows.size() == 1);
+		check(rows[0] == view.row_at(2));
+		check(cur.remaining() == 0);
+		
+		check(cur.next(2, rows) == 0);
+		check(rows.empty());
+		
+		cur.rewind();
+		check(cur.remaining() == 3);
+		check(cur.skip(2) == 2);
+		check(cur.skip(2) == 1);
+		check(cur.skip(2) == 0);
+		
+		cur.rewind();
+		check(cur.skip(1) == 1);
+		check(cur.next(10, rows) == 2);
+		check(rows[0] == view.row_at(1));
+		check(rows[1] == view.row_at(2));
+	}
+	
+	{ // values, with and without prefetch
+		std::vector<ro_string_table::eq_range_result> all{
+			ro_string_table::eq_range_result("fruit"),
+			ro_string_table::eq_range_result("price")
+		};
+		check(str_tbl.lookup_equal_range(src, all));
+		
+		for (int prefetch = 0; prefetch < 2; ++prefetch)
+		{
+			cur.set_prefetch(prefetch);
+			check(str_tbl.lookup_equal_range(src, cur));
+			
+			std::vector<ro_string_table::eq_range_result> page{
+				ro_string_table::eq_range_result("fruit"),
+				ro_string_table::eq_range_result("price")
+			};
+			
+			std::vector<const char *> fruits, prices;
+			while (cur.next(2, page))
+			{
+				check(page[0].values.size() <= 2);
+				check(page[0].values.size() == page[1].values.size());
+				for (size_t i = 0; i < page[0].values.size(); ++i)
+				{
+					fruits.push_back(page[0].values[i]);
+					prices.push_back(page[1].values[i]);
+				}
+			}
+			check(page[0].values.empty());
+			check(page[1].values.empty());
+			check(fruits == all[0].values);
+			check(prices == all[1].values);
+		}
+	}
+	
+	{ // throw no such field
+		check(str_tbl.lookup_equal_range(src, cur));
+		std::vector<ro_string_table::eq_range_result> page{
+			ro_string_table::eq_range_result("banana")
+		};
+		
+		try {cur.next(1, page); check(didnt_throw);}
+		catch(std::runtime_error& e)
+		{
+			std::string expected("ro_string_table: lookup fail: no such field 'banana'");
+			check(expected == e.what());
+		}
+	}
+	
+	return true;
+}
+
+static bool test_ro_string_table_prefix(void)
+{
+	ro_string_table str_tbl(fruit_lines, fruit_fields());
+	
+	{ // throw lookup before seal
+		ro_string_table::field_pair src("fruit", "p");
+		std::vector<ro_string_table::eq_range_result> eqr{
+			ro_string_table::eq_range_result("id")
+		};
+		
+		try {str_tbl.lookup_prefix(src, eqr); check(didnt_throw);}
+		catch(std::runtime_error& e)
+		{
+			std::string expected("ro_string_table: lookup before seal()");
+			check(expected == e.what());
+		}
+	}
+	
+	fill_fruit(str_tbl);
+	
+	{ // throw no such field
+		ro_string_table::field_pair src("banana", "p");
+		ro_string_table::eq_range_view view;
+		
+		try {str_tbl.lookup_prefix(src, view); check(didnt_throw);}
+		catch(std::runtime_error& e)
+		{
+			std::string expected("ro_string_table: lookup fail: no such field 'banana'");
+			check(expected == e.what());
+		}
+	}
+	
+	{ // eq_range_result
+		ro_string_table::field_pair src("fruit", "x");
+		std::vector<ro_string_table::eq_range_result> eqr{
+			ro_string_table::eq_range_result("fruit"),
+			ro_string_table::eq_range_result("id")
+		};
+		
+		check(!str_tbl.lookup_prefix(src, eqr));
+		
+		src.field_value = "pea";
+		check(str_tbl.lookup_prefix(src, eqr));
+		check(eqr[0].values.size() == 2);
+		check(std::string(eqr[0].values[0]) == "peach");
+		check(std::string(eqr[0].values[1]) == "pear");
+		check(std::string(eqr[1].values[0]) == "3");
+		check(std::string(eqr[1].values[1]) == "5");
+		
+		src.field_value = "p";
+		check(str_tbl.lookup_prefix(src, eqr));
+		check(eqr[0].values.size() == 3);
+		check(std::string(eqr[0].values[0]) == "peach");
+		check(std::string(eqr[0].values[1]) == "pear");
+		check(std::string(eqr[0].values[2]) == "pineapple");
+		
+		// the whole value is a prefix of itself
+		src.field_value = "pear";
+		check(str_tbl.lookup_prefix(src, eqr));
+		check(eqr[0].values.size() == 1);
+		check(std::string(eqr[0].values[0]) == "pear");
+		
+		src.field_value = "pearl";
+		check(!str_tbl.lookup_prefix(src, eqr));
+		
+		// empty matches all
+		src.field_value = "";
+		check(str_tbl.lookup_prefix(src, eqr));
+		check(eqr[0].values.size() == 5);
+		
+		src.field_name = "price";
+		src.field_value = "1";
+		check(str_tbl.lookup_prefix(src, eqr));
+		check(eqr[0].values.size() == 2);
+		check(std::string(eqr[0].values[0]) == "mango");
+		check(std::string(eqr[0].values[1]) == "pineapple");
+	}
+	
+	{ // view and cursor
+		ro_string_table::field_pair src("fruit", "pe");
+		ro_string_table::eq_range_view view;
+		ro_string_table::eq_range_cursor cur;
+		
+		check(str_tbl.lookup_prefix(src, view));
+		check(view.size() == 2);
+		check(std::string(view.value_at(0, 1)) == "peach");
+		check(std::string(view.value_at(1, 1)) == "pear");
+		
+		check(str_tbl.lookup_prefix(src, cur));
+		check(cur.count() == 2);
+		
+		std::vector<uint> rows;
+		check(cur.next(5, rows) == 2);
+		check(rows[0] == 3);
+		check(rows[1] == 5);
+		
+		src.field_value = "pex";
+		check(!str_tbl.lookup_prefix(src, view));
+		check(view.empty());
+		check(!str_tbl.lookup_prefix(src, cur));
+		check(cur.count() == 0);
+	}
+	
+	return true;
+}
+
+static bool test_ro_string_table_range(void)
+{
+	typedef ro_string_table rst;
+	ro_string_table str_tbl(fruit_lines, fruit_fields());
+	
+	std::vector<rst::eq_range_result> eqr{rst::eq_range_result("fruit")};
+	
+	{ // throw lookup before seal
+		try {str_tbl.lookup_range("id", "1", "3", eqr); check(didnt_throw);}
+		catch(std::runtime_error& e)
+		{
+			std::string expected("ro_string_table: lookup before seal()");
+			check(expected == e.what());
+		}
+	}
+	
+	fill_fruit(str_tbl);
+	
+	{ // throw no such field
+		try {str_tbl.lookup_range("banana", "1", "3", eqr); check(didnt_throw);}
+		catch(std::runtime_error& e)
+		{
+			std::string expected("ro_string_table: lookup fail: no such field 'banana'");
+			check(expected == e.what());
+		}
+	}
+	
+	{ // inclusive flags
+		check(str_tbl.lookup_range("id", "2", "4", eqr));
+		check(eqr[0].values.size() == 3);
+		check(std::string(eqr[0].values[0]) == "apple");
+		check(std::string(eqr[0].values[1]) == "peach");
+		check(std::string(eqr[0].values[2]) == "mango");
+		
+		check(str_tbl.lookup_range("id", "2", "4", eqr, rst::INCL_LOW));
+		check(eqr[0].values.size() == 2);
+		check(std::string(eqr[0].values[0]) == "apple");
+		check(std::string(eqr[0].values[1]) == "peach");
+		
+		check(str_tbl.lookup_range("id", "2", "4", eqr, rst::INCL_HIGH));
+		check(eqr[0].values.size() == 2);
+		check(std::string(eqr[0].values[0]) == "peach");
+		check(std::string(eqr[0].values[1]) == "mango");
+		
+		check(str_tbl.lookup_range("id", "2", "4", eqr, rst::INCL_NONE));
+		check(eqr[0].values.size() == 1);
+		check(std::string(eqr[0].values[0]) == "peach");
+		
+		check(!str_tbl.lookup_range("id", "2", "3", eqr, rst::INCL_NONE));
+		check(str_tbl.lookup_range("id", "3", "3", eqr));
+		check(eqr[0].values.size() == 1);
+		check(!str_tbl.lookup_range("id", "3", "3", eqr, rst::INCL_LOW));
+		
+		// bounds don't have to exist
+		check(str_tbl.lookup_range("id", "20", "39", eqr));
+		check(eqr[0].values.size() == 1);
+		check(std::string(eqr[0].values[0]) == "peach");
+		
+		// low > high
+		check(!str_tbl.lookup_range("id", "4", "2", eqr));
+	}
+	
+	{ // open ended
+		check(str_tbl.lookup_range("id", "4", nullptr, eqr));
+		check(eqr[0].values.size() == 2);
+		check(std::string(eqr[0].values[0]) == "mango");
+		check(std::string(eqr[0].values[1]) == "pear");
+		
+		check(str_tbl.lookup_range("id", "4", nullptr, eqr, rst::INCL_NONE));
+		check(eqr[0].values.size() == 1);
+		check(std::string(eqr[0].values[0]) == "pear");
+		
+		check(str_tbl.lookup_range("id", nullptr, "2", eqr));
+		check(eqr[0].values.size() == 2);
+		check(std::string(eqr[0].values[0]) == "pineapple");
+		check(std::string(eqr[0].values[1]) == "apple");
+		
+		check(str_tbl.lookup_range("id", nullptr, "2", eqr, rst::INCL_NONE));
+		check(eqr[0].values.size() == 1);
+		
+		check(str_tbl.lookup_range("id", nullptr, nullptr, eqr));
+		check(eqr[0].values.size() == 5);
+		
+		check(!str_tbl.lookup_range("id", "6", nullptr, eqr));
+		check(!str_tbl.lookup_range("id", nullptr, "0", eqr));
+	}
+	
+	{ // view and cursor
+		rst::eq_range_view view;
+		check(str_tbl.lookup_range("price", "10", "5", view));
+		check(view.size() == 3);
+		check(std::string(view.value_at(0, 3)) == "10.50");
+		check(std::string(view.value_at(1, 3)) == "12.25");
+		check(std::string(view.value_at(2, 3)) == "4.22");
+		
+		rst::eq_range_cursor cur;
+		check(str_tbl.lookup_range("type", "fancy", "normal", cur,
+			rst::INCL_HIGH
+		));
+		check(cur.count() == 3);
+		
+		check(!str_tbl.lookup_range("type", "x", nullptr, view));
+		check(view.empty());
+		check(!str_tbl.lookup_range("type", "x", nullptr, cur));
+		check(cur.count() == 0);
+	}
+	
+	return true;
+}
+
+static bool test_ro_string_table_numeric(void)
+{
+	typedef ro_string_table rst;
+	
+	bool is_unique = true;
+	std::vector<rst::field_info> fields{
+		rst::field_info("id", is_unique, rst::TYPE_INT64),
+		rst::field_info("fruit", is_unique),
+		rst::field_info("type"),
+		rst::field_info("price", !is_unique, rst::TYPE_DECIMAL, 2),
+		rst::field_info("weight", !is_unique, rst::TYPE_DOUBLE)
+	};
+	
+	const char * lines[][5] = {
+		{"10", "pineapple", "fancy", "12.25", "1.5e3"},
+		{"9", "apple", "normal", "5.32", "150"},
+		{"-3", "peach", "normal", "4.2", "0.2e3"},
+		{"100", "mango", "fancy", "10.50", "300.0"},
+		{"+7", "pear", "normal", "6", "150.00"},
+	};
+	
+	ro_string_table str_tbl(fruit_lines, fields);
+	for (auto& line : lines)
+	{
+		for (auto& str : line)
+			str_tbl.append(str);
+	}
+	
+	std::vector<rst::eq_range_result> eqr{rst::eq_range_result("fruit")};
+	
+	{ // throw lookup before seal
+		try {str_tbl.lookup_numeric(rst::field_pair("id", "9"), eqr); check(didnt_throw);}
+		catch(std::runtime_error& e)
+		{
+			std::string expected("ro_string_table: lookup before seal()");
+			check(expected == e.what());
+		}
+	}
+	
+	str_tbl.seal();
+	
+	{ // exact; the original strings are kept
+		check(str_tbl.lookup_numeric(rst::field_pair("id", "9"), eqr));
+		check(eqr[0].values.size() == 1);
+		check(std::string(eqr[0].values[0]) == "apple");
+		
+		check(str_tbl.lookup_numeric(rst::field_pair("id", "007"), eqr));
+		check(std::string(eqr[0].values[0]) == "pear");
+		check(std::string(str_tbl.get_str_at(5, 0)) == "+7");
+		
+		check(str_tbl.lookup_numeric(rst::field_pair("price", "4.20"), eqr));
+		check(std::string(eqr[0].values[0]) == "peach");
+		
+		check(str_tbl.lookup_numeric(rst::field_pair("price", "6.0"), eqr));
+		check(std::string(eqr[0].values[0]) == "pear");
+		
+		check(str_tbl.lookup_numeric(rst::field_pair("weight", "1.5e2"), eqr));
+		check(eqr[0].values.size() == 2);
+		check(std::string(eqr[0].values[0]) == "apple");
+		check(std::string(eqr[0].values[1]) == "pear");
+		
+		check(!str_tbl.lookup_numeric(rst::field_pair("id", "8"), eqr));
+		check(eqr[0].values.size() == 2);
+		
+		// subnormals are valid doubles
+		check(!str_tbl.lookup_numeric(rst::field_pair("weight", "1e-310"), eqr));
+		check(str_tbl.lookup_numeric_range("weight", "1e-310", "200", eqr));
+		check(eqr[0].values.size() == 3);
+	}
+	
+	{ // numeric, not lexicographic, order
+		check(str_tbl.lookup_numeric_range("id", "7", "99", eqr));
+		check(eqr[0].values.size() == 3);
+		check(std::string(eqr[0].values[0]) == "pear");
+		check(std::string(eqr[0].values[1]) == "apple");
+		check(std::string(eqr[0].values[2]) == "pineapple");
+		
+		check(str_tbl.lookup_numeric_range("id", "7", "10", eqr,
+			rst::INCL_NONE
+		));
+		check(eqr[0].values.size() == 1);
+		check(std::string(eqr[0].values[0]) == "apple");
+		
+		check(str_tbl.lookup_numeric_range("id", nullptr, "0", eqr));
+		check(eqr[0].values.size() == 1);
+		check(std::string(eqr[0].values[0]) == "peach");
+		
+		check(str_tbl.lookup_numeric_range("price", "10", nullptr, eqr));
+		check(eqr[0].values.size() == 2);
+		check(std::string(eqr[0].values[0]) == "mango");
+		check(std::string(eqr[0].values[1]) == "pineapple");
+		
+		check(!str_tbl.lookup_numeric_range("id", "101", nullptr, eqr));
+		check(!str_tbl.lookup_numeric_range("id", "10", "9", eqr));
+		
+		rst::eq_range_view view;
+		check(str_tbl.lookup_numeric_range("weight", "150", "300", view,
+			rst::INCL_HIGH
+		));
+		check(view.size() == 2);
+		check(std::string(view.value_at(0, 1)) == "peach");
+		check(std::string(view.value_at(1, 1)) == "mango");
+		
+		rst::eq_range_cursor cur;
+		check(str_tbl.lookup_numeric_range("id", nullptr, nullptr, cur));
+		check(cur.count() == 5);
+		std::vector<uint> rows;
+		check(cur.next(5, rows) == 5);
+		check(rows == std::vector<uint>({3, 5, 2, 1, 4}));
+	}
+	
+	{ // throw on bad lookup values and fields
+		try {str_tbl.lookup_numeric(rst::field_pair("price", "4.201"), eqr); check(didnt_throw);}
+		catch(std::runtime_error& e)
+		{
+			std::string expected("ro_string_table: numeric lookup: '4.201' is not a valid decimal for field 'price'");
+			check(expected == e.what());
+		}
+		
+		try {str_tbl.lookup_numeric_range("id", "1", "1x", eqr); check(didnt_throw);}
+		catch(std::runtime_error& e)
+		{
+			std::string expected("ro_string_table: numeric lookup: '1x' is not a valid int64 for field 'id'");
+			check(expected == e.what());
+		}
+		
+		try {str_tbl.lookup_numeric(rst::field_pair("weight", "1e400"), eqr); check(didnt_throw);}
+		catch(std::runtime_error& e)
+		{
+			std::string expected("ro_string_table: numeric lookup: '1e400' is not a valid double for field 'weight'");
+			check(expected == e.what());
+		}
+		
+		try {str_tbl.lookup_numeric(rst::field_pair("fruit", "1"), eqr); check(didnt_throw);}
+		catch(std::runtime_error& e)
+		{
+			std::string expected("ro_string_table: numeric lookup of non-numeric field 'fruit'");
+			check(expected == e.what());
+		}
+		
+		try {str_tbl.lookup_numeric(rst::field_pair("banana", "1"), eqr); check(didnt_throw);}
+		catch(std::runtime_error& e)
+		{
+			std::string expected("ro_string_table: lookup fail: no such field 'banana'");
+			check(expected == e.what());
+		}
+	}
+	
+	{ // throw on bad data
+		ro_string_table tbl(fruit_lines, fields);
+		try
+		{
+			tbl.append("1");
+			tbl.append("apple");
+			tbl.append("fancy");
+			tbl.append("1.234");
+			tbl.append("1");
+			check(didnt_throw);
+		}
+		catch(std::runtime_error& e)
+		{
+			std::string expected("single_field_data::append_info(): string '1.234' on line 1 is not a valid decimal for field 'price'");
+			check(expected == e.what());
+		}
+	}
+	
+	{ // throw on numerically equal unique values
+		ro_string_table tbl(fruit_lines, fields);
+		const char * dup[][5] = {
+			{"10", "pineapple", "fancy", "1", "1"},
+			{"010", "apple", "normal", "2", "2"},
+		};
+		for (auto& line : dup)
+		{
+			for (auto& str : line)
+				tbl.append(str);
+		}
+		
+		try {tbl.seal(); check(didnt_throw);}
+		catch(std::runtime_error& e)
+		{
+			std::string expected("single_field_data::check_unique(): number on line 2 equals the one on line 1 in numeric field 'id' marked as unique");
+			check(expected == e.what());
+		}
+	}
+	
+	return true;
+}
+
+static bool test_ro_string_table_collation(void)
+{
+	typedef ro_string_table rst;
+	
+	bool is_unique = true;
+	std::vector<rst::field_info> fields{
+		rst::field_info("vendor", is_unique, rst::TYPE_STRING, 0,
+			rst::COLL_FOLD_ASCII | rst::COLL_TRIM
+		),
+		rst::field_info("city", !is_unique, rst::TYPE_STRING, 0,
+			rst::COLL_FOLD_UTF8
+		),
+		rst::field_info("code")
+	};
+	
+	const char * lines[][3] = {
+		{" Acme Inc", "\xC3\x89vry", "A"},
+		{"globex\t", "\xC3\xA9vry", "b"},
+		{"INITECH  ", "Paris", "a"},
+		{"Umbrella", "PARIS", "B"},
+		{"acme corp", "paris", "c"},
+	};
+	
+	ro_string_table str_tbl(fruit_lines, fields);
+	for (auto& line : lines)
+	{
+		for (auto& str : line)
+			str_tbl.append(str);
+	}
+	str_tbl.seal();
+	
+	std::vector<rst::field_pair> fp{rst::field_pair("vendor")};
+	std::vector<rst::eq_range_result> eqr{rst::eq_range_result("vendor")};
+	
+	{ // unique; the original value is returned
+		check(str_tbl.lookup_unique(rst::field_pair("vendor", "ACME INC"), fp));
+		check(std::string(fp[0].field_value) == " Acme Inc");
+		
+		check(str_tbl.lookup_unique(rst::field_pair("vendor", " Globex "), fp));
+		check(std::string(fp[0].field_value) == "globex\t");
+		
+		check(str_tbl.lookup_unique(rst::field_pair("vendor", "initech"), fp));
+		check(std::string(fp[0].field_value) == "INITECH  ");
+		
+		check(!str_tbl.lookup_unique(rst::field_pair("vendor", "acme"), fp));
+	}
+	
+	{ // equal range
+		check(str_tbl.lookup_equal_range(rst::field_pair("city", "pArIs"), eqr));
+		check(eqr[0].values.size() == 3);
+		check(std::string(eqr[0].values[0]) == "INITECH  ");
+		
+		check(str_tbl.lookup_equal_range(rst::field_pair("city", "\xC3\x89VRY"),
+			eqr
+		));
+		check(eqr[0].values.size() == 2);
+		
+		// no collation, exact match only
+		check(str_tbl.lookup_equal_range(rst::field_pair("code", "a"), eqr));
+		check(eqr[0].values.size() == 1);
+		check(std::string(eqr[0].values[0]) == "INITECH  ");
+	}
+	
+	{ // prefix and range
+		check(str_tbl.lookup_prefix(rst::field_pair("vendor", "  ACME"), eqr));
+		check(eqr[0].values.size() == 2);
+		check(std::string(eqr[0].values[0]) == "acme corp");
+		check(std::string(eqr[0].values[1]) == " Acme Inc");
+		
+		check(str_tbl.lookup_prefix(rst::field_pair("vendor", "acme i"), eqr));
+		check(eqr[0].values.size() == 1);
+		
+		check(str_tbl.lookup_range("vendor", "B", "Initech", eqr));
+		check(eqr[0].values.size() == 2);
+		check(std::string(eqr[0].values[0]) == "globex\t");
+		check(std::string(eqr[0].values[1]) == "INITECH  ");
+		
+		rst::eq_range_view view;
+		check(str_tbl.lookup_range("vendor", "initech ", nullptr, view,
+			rst::INCL_NONE
+		));
+		check(view.size() == 1);
+		check(std::string(view.value_at(0, 0)) == "Umbrella");
+	}
+	
+	{ // unique check uses the collation
+		ro_string_table tbl(fruit_lines, fields);
+		const char * dup[][3] = {
+			{"Acme", "x", "x"},
+			{" acme", "y", "y"},
+		};
+		for (auto& line : dup)
+		{
+			for (auto& str : line)
+				tbl.append(str);
+		}
+		
+		try {tbl.seal(); check(didnt_throw);}
+		catch(std::runtime_error& e)
+		{
+			std::string expected("' appears more than once in field 'vendor' marked as unique");
+			std::string what(e.what());
+			check(what.find(expected) != std::string::npos);
+		}
+	}
+	
+	return true;
+}
+
+static bool test_ro_string_table_composite(void)
+{
+	typedef ro_string_table rst;
+	typedef rst::field_pair fp;
+	
+	bool is_unique = true;
+	std::vector<rst::field_info> fields{
+		rst::field_info("region").index_with({"sku"}, is_unique),
+		rst::field_info("sku", !is_unique, rst::TYPE_STRING, 0,
+			rst::COLL_FOLD_ASCII
+		),
+		rst::field_info("name").index_with({"region", "sku"}),
+		rst::field_info("qty")
+	};
+	
+	const char * lines[][4] = {
+		{"eu", "x2", "bolt", "10"},
+		{"us", "x1", "bolt", "20"},
+		{"eu", "x1", "nut", "30"},
+		{"us", "X2", "nut", "40"},
+		{"eu", "x3", "bolt", "50"},
+		{"asia", "x1", "nut", "60"},
+	};
+	
+	int all_lines = 7;
+	ro_string_table str_tbl(all_lines, fields);
+	for (auto& line : lines)
+	{
+		for (auto& str : line)
+			str_tbl.append(str);
+	}
+	
+	std::vector<fp> keys{fp("region", "eu"), fp("sku", "x1")};
+	std::vector<fp> targets{fp("qty"), fp("name")};
+	std::vector<rst::eq_range_result> eqr{rst::eq_range_result("qty")};
+	
+	{ // throw lookup before seal
+		try {str_tbl.lookup_composite(keys, targets); check(didnt_throw);}
+		catch(std::runtime_error& e)
+		{
+			std::string expected("ro_string_table: lookup before seal()");
+			check(expected == e.what());
+		}
+	}
+	
+	str_tbl.seal();
+	
+	{ // full unique tuple
+		check(str_tbl.lookup_composite(keys, targets));
+		check(std::string(targets[0].field_value) == "30");
+		check(std::string(targets[1].field_value) == "nut");
+		
+		keys[0].field_value = "us";
+		keys[1].field_value = "x2";
+		check(str_tbl.lookup_composite(keys, targets));
+		check(std::string(targets[0].field_value) == "40");
+		
+		keys[0].field_value = "asia";
+		check(!str_tbl.lookup_composite(keys, targets));
+	}
+	
+	{ // leading prefix, sorted by the rest of the tuple
+		std::vector<fp> region{fp("region", "eu")};
+		check(str_tbl.lookup_composite(region, eqr));
+		check(eqr[0].values.size() == 3);
+		check(std::string(eqr[0].values[0]) == "30");
+		check(std::string(eqr[0].values[1]) == "10");
+		check(std::string(eqr[0].values[2]) == "50");
+		
+		region[0].field_value = "mars";
+		check(!str_tbl.lookup_composite(region, eqr));
+		
+		std::vector<fp> name{fp("name", "nut")};
+		rst::eq_range_view view;
+		check(str_tbl.lookup_composite(name, view));
+		check(view.size() == 3);
+		check(std::string(view.value_at(0, 0)) == "asia");
+		check(std::string(view.value_at(1, 0)) == "eu");
+		check(std::string(view.value_at(2, 0)) == "us");
+		
+		std::vector<fp> name_region{fp("name", "bolt"), fp("region", "eu")};
+		rst::eq_range_cursor cur;
+		check(str_tbl.lookup_composite(name_region, cur));
+		check(cur.count() == 2);
+		std::vector<uint> rows;
+		check(cur.next(2, rows) == 2);
+		check(rows == std::vector<uint>({1, 5}));
+		
+		std::vector<fp> all{fp("name", "nut"), fp("region", "us"),
+			fp("sku", "x2")
+		};
+		check(str_tbl.lookup_composite(all, eqr));
+		check(eqr[0].values.size() == 1);
+		check(std::string(eqr[0].values[0]) == "40");
+	}
+	
+	{ // throw on missing and non-unique indexes
+		std::vector<fp> sku{fp("sku", "x1")};
+		try {str_tbl.lookup_composite(sku, eqr); check(didnt_throw);}
+		catch(std::runtime_error& e)
+		{
+			std::string expected("ro_string_table: lookup fail: no composite index on 'sku'");
+			check(expected == e.what());
+		}
+		
+		std::vector<fp> region{fp("region", "eu")};
+		try {str_tbl.lookup_composite(region, targets); check(didnt_throw);}
+		catch(std::runtime_error& e)
+		{
+			std::string expected("ro_string_table: lookup fail: no composite index on 'region'");
+			check(expected == e.what());
+		}
+		
+		std::vector<fp> all{fp("name", "nut"), fp("region", "us"),
+			fp("sku", "x2")
+		};
+		try {str_tbl.lookup_composite(all, targets); check(didnt_throw);}
+		catch(std::runtime_error& e)
+		{
+			std::string expected("ro_string_table: unique lookup of non-unique composite index 'name, region, sku'");
+			check(expected == e.what());
+		}
+	}
+	
+	{ // throw on bad declarations
+		std::vector<rst::field_info> bad{
+			rst::field_info("region").index_with({"skew"}),
+			rst::field_info("sku")
+		};
+		try {ro_string_table tbl(all_lines, bad); check(didnt_throw);}
+		catch(std::runtime_error& e)
+		{
+			std::string expected("ro_string_table: composite index on 'region, skew': no such field 'skew'");
+			check(expected == e.what());
+		}
+	}
+	
+	{ // throw on duplicate tuples
+		ro_string_table tbl(all_lines, fields);
+		const char * dup[][4] = {
+			{"eu", "x1", "bolt", "1"},
+			{"us", "x1", "bolt", "2"},
+			{"eu", "X1", "nut", "3"},
+		};
+		for (auto& line : dup)
+		{
+			for (auto& str : line)
+				tbl.append(str);
+		}
+		
+		try {tbl.seal(); check(didnt_throw);}
+		catch(std::runtime_error& e)
+		{
+			std::string expected("composite_index::check_unique(): the tuple on line 3 equals the one on line 1 in composite index 'region, sku' marked as unique");
+			check(expected == e.what());
+		}
+	}
+	
+	return true;
+}
+
+static bool test_ro_string_table_and(void)
+{
+	typedef ro_string_table rst;
+	typedef rst::field_pair fp;
+	
+	{ // fruit
+		ro_string_table str_tbl(fruit_lines, fruit_fields());
+		std::vector<fp> preds{fp("type", "normal"), fp("price", "4.22")};
+		std::vector<uint> rows;
+		
+		try {str_tbl.lookup_and(preds, rows); check(didnt_throw);}
+		catch(std::runtime_error& e)
+		{
+			std::string expected("ro_string_table: lookup before seal()");
+			check(expected == e.what());
+		}
+		
+		fill_fruit(str_tbl);
+		
+		check(str_tbl.lookup_and(preds, rows));
+		check(rows == std::vector<uint>({3}));
+		
+		std::vector<rst::eq_range_result> eqr{rst::eq_range_result("fruit")};
+		check(str_tbl.lookup_and(preds, eqr));
+		check(eqr[0].values.size() == 1);
+		check(std::string(eqr[0].values[0]) == "peach");
+		
+		preds[1].field_value = "10.50";
+		check(!str_tbl.lookup_and(preds, rows));
+		check(rows.empty());
+		
+		std::vector<fp> one{fp("type", "normal")};
+		check(str_tbl.lookup_and(one, rows));
+		check(rows == std::vector<uint>({2, 3, 5}));
+		
+		std::vector<fp> none;
+		check(!str_tbl.lookup_and(none, rows));
+		
+		std::vector<fp> bad{fp("type", "nope"), fp("banana", "1")};
+		try {str_tbl.lookup_and(bad, rows); check(didnt_throw);}
+		catch(std::runtime_error& e)
+		{
+			std::string expected("ro_string_table: lookup fail: no such field 'banana'");
+			check(expected == e.what());
+		}
+	}
+	
+	{ // against brute force
+		int all_lines = 2001;
+		std::vector<rst::field_info> fields{
+			rst::field_info("a"),
+			rst::field_info("b"),
+			rst::field_info("c")
+		};
+		
+		ro_string_table str_tbl(all_lines, fields);
+		for (int i = 1; i < all_lines; ++i)
+		{
+			str_tbl.append(std::to_string(i % 3));
+			str_tbl.append(std::to_string(i % 50));
+			str_tbl.append(std::to_string((i*i) % 7));
+		}
+		str_tbl.seal();
+		
+		for (int a = 0; a < 3; ++a)
+		{
+			for (int b = 0; b < 50; b += 7)
+			{
+				for (int c = 0; c < 7; ++c)
+				{
+					std::string sa(std::to_string(a));
+					std::string sb(std::to_string(b));
+					std::string sc(std::to_string(c));
+					std::vector<fp> preds{fp("a", sa.c_str()),
+						fp("c", sc.c_str()),
+						fp("b", sb.c_str())
+					};
+					
+					std::vector<uint> expected;
+					for (int i = 1; i < all_lines; ++i)
+					{
+						if (i % 3 == a && i % 50 == b && (i*i) % 7 == c)
+							expected.push_back(i);
+					}
+					
+					std::vector<uint> rows;
+					check(str_tbl.lookup_and(preds, rows) == !expected.empty());
+					check(rows == expected);
+				}
+			}
+		}
+	}
+	
+	return true;
+}
+
+static bool test_ro_string_table_in(void)
+{
+	typedef ro_string_table rst;
+	
+	{ // fruit
+		ro_string_table str_tbl(fruit_lines, fruit_fields());
+		std::vector<const char *> vals{"pear", "apple", "kiwi", "pineapple"};
+		std::vector<uint> rows;
+		
+		try {str_tbl.lookup_in("fruit", vals, rows); check(didnt_throw);}
+		catch(std::runtime_error& e)
+		{
+			std::string expected("ro_string_table: lookup before seal()");
+			check(expected == e.what());
+		}
+		
+		fill_fruit(str_tbl);
+		
+		// grouped by value in sorted order
+		check(str_tbl.lookup_in("fruit", vals, rows));
+		check(rows == std::vector<uint>({2, 5, 1}));
+		
+		check(str_tbl.lookup_in("fruit", vals, rows, rst::IN_ROW_ORDER));
+		check(rows == std::vector<uint>({1, 2, 5}));
+		
+		std::vector<const char *> types{"normal", "fancy", "normal"};
+		check(str_tbl.lookup_in("type", types, rows));
+		check(rows == std::vector<uint>({1, 4, 2, 3, 5, 2, 3, 5}));
+		
+		check(str_tbl.lookup_in("type", types, rows, rst::IN_DEDUP));
+		check(rows == std::vector<uint>({1, 4, 2, 3, 5}));
+		
+		check(str_tbl.lookup_in("type", types, rows,
+			rst::IN_DEDUP | rst::IN_ROW_ORDER
+		));
+		check(rows == std::vector<uint>({1, 2, 3, 4, 5}));
+		
+		std::vector<rst::eq_range_result> eqr{rst::eq_range_result("id")};
+		check(str_tbl.lookup_in("fruit", vals, eqr, rst::IN_ROW_ORDER));
+		check(eqr[0].values.size() == 3);
+		check(std::string(eqr[0].values[0]) == "1");
+		check(std::string(eqr[0].values[1]) == "2");
+		check(std::string(eqr[0].values[2]) == "5");
+		
+		std::vector<const char *> none{"kiwi", "banana"};
+		check(!str_tbl.lookup_in("fruit", none, rows));
+		check(rows.empty());
+		
+		std::vector<const char *> empty;
+		check(!str_tbl.lookup_in("fruit", empty, rows));
+		
+		try {str_tbl.lookup_in("banana", vals, rows); check(didnt_throw);}
+		catch(std::runtime_error& e)
+		{
+			std::string expected("ro_string_table: lookup fail: no such field 'banana'");
+			check(expected == e.what());
+		}
+	}
+	
+	{ // against brute force
+		int all_lines = 3001;
+		std::vector<rst::field_info> fields{
+			rst::field_info("status", false, rst::TYPE_STRING, 0,
+				rst::COLL_FOLD_ASCII
+			)
+		};
+		
+		ro_string_table str_tbl(all_lines, fields);
+		for (int i = 1; i < all_lines; ++i)
+			str_tbl.append(std::string("s") + std::to_string((i * 37) % 500));
+		str_tbl.seal();
+		
+		std::vector<std::string> strs;
+		std::set<int> wanted;
+		for (int i = 0; i < 300; ++i)
+		{
+			int n = (i * 13) % 600;
+			strs.push_back(std::string((i % 2) ? "S" : "s") + std::to_string(n));
+			if (n < 500)
+				wanted.insert(n);
+		}
+		
+		std::vector<const char *> vals;
+		for (auto& str : strs)
+			vals.push_back(str.c_str());
+		
+		std::vector<uint> expected;
+		for (int i = 1; i < all_lines; ++i)
+		{
+			if (wanted.count((i * 37) % 500))
+				expected.push_back(i);
+		}
+		
+		std::vector<uint> rows;
+		check(str_tbl.lookup_in("status", vals, rows,
+			rst::IN_DEDUP | rst::IN_ROW_ORDER
+		));
+		check(rows == expected);
+	}
+	
+	return true;
+}
+
+static bool test_ro_string_table_dictionary(void)
+{
+	typedef ro_string_table rst;
+	typedef rst::field_pair fp;
+	
+	int all_lines = 1001;
+	std::vector<rst::field_info> fields{
+		rst::field_info("id", true),
+		rst::field_info("type", false, rst::TYPE_STRING, 0,
+			rst::COLL_FOLD_ASCII
+		).use_index(rst::INDEX_DICTIONARY),
+		rst::field_info("sorted_type")
+	};
+	
+	// the same data, once in a dictionary and once in a sorted field
+	ro_string_table str_tbl(all_lines, fields);
+	for (int i = 1; i < all_lines; ++i)
+	{
+		std::string type(std::string((i % 2) ? "T" : "t") +
+			std::to_string((i * 7) % 13)
+		);
+		str_tbl.append(std::string("id_") + std::to_string(i));
+		str_tbl.append(type);
+		str_tbl.append(std::string("t") + std::to_string((i * 7) % 13));
+	}
+	str_tbl.seal();
+	
+	std::vector<rst::eq_range_result> dict{rst::eq_range_result("id")};
+	std::vector<rst::eq_range_result> sorted{rst::eq_range_result("id")};
+	
+	{ // same results as the sorted field
+		for (int t = 0; t < 14; ++t)
+		{
+			std::string type(std::string("T") + std::to_string(t));
+			std::string sorted_type(std::string("t") + std::to_string(t));
+			
+			bool found = str_tbl.lookup_equal_range(fp("type", type.c_str()),
+				dict
+			);
+			check(found == str_tbl.lookup_equal_range(
+				fp("sorted_type", sorted_type.c_str()), sorted
+			));
+			check(found == (t < 13));
+			if (found)
+				check(dict[0].values == sorted[0].values);
+			
+			rst::eq_range_cursor cur_dict, cur_sorted;
+			cur_dict.set_prefetch(true);
+			check(found == str_tbl.lookup_equal_range(fp("type", type.c_str()),
+				cur_dict
+			));
+			str_tbl.lookup_equal_range(fp("sorted_type", sorted_type.c_str()),
+				cur_sorted
+			);
+			check(cur_dict.count() == cur_sorted.count());
+			
+			std::vector<uint> rows_dict, rows_sorted;
+			cur_dict.skip(3);
+			cur_sorted.skip(3);
+			while (cur_dict.next(10, rows_dict))
+			{
+				cur_sorted.next(10, rows_sorted);
+				check(rows_dict == rows_sorted);
+			}
+			check(cur_sorted.remaining() == 0);
+			
+			cur_dict.rewind();
+			cur_dict.next(1, dict);
+			if (found)
+				check(dict[0].values[0] == sorted[0].values[0]);
+		}
+		
+		check(str_tbl.lookup_prefix(fp("type", "t1"), dict));
+		check(str_tbl.lookup_prefix(fp("sorted_type", "t1"), sorted));
+		check(dict[0].values == sorted[0].values);
+		
+		check(str_tbl.lookup_range("type", "t10", "T3", dict));
+		check(str_tbl.lookup_range("sorted_type", "t10", "t3", sorted));
+		check(dict[0].values == sorted[0].values);
+		
+		std::vector<const char *> vals{"T5", "t2", "t100", "T2"};
+		std::vector<const char *> sorted_vals{"t5", "t2", "t100", "t2"};
+		std::vector<uint> rows_dict, rows_sorted;
+		check(str_tbl.lookup_in("type", vals, rows_dict));
+		check(str_tbl.lookup_in("sorted_type", sorted_vals, rows_sorted));
+		check(rows_dict == rows_sorted);
+		
+		std::vector<fp> preds{fp("type", "t1"), fp("id", "id_41")};
+		check(str_tbl.lookup_and(preds, rows_dict));
+		check(rows_dict == std::vector<uint>({41}));
+	}
+	
+	{ // throw on views
+		rst::eq_range_view view;
+		try {str_tbl.lookup_equal_range(fp("type", "t1"), view); check(didnt_throw);}
+		catch(std::runtime_error& e)
+		{
+			std::string expected("ro_string_table: eq_range_view of dictionary field 'type'; use a cursor or a vector instead");
+			check(expected == e.what());
+		}
+		
+		try {str_tbl.lookup_range("type", "x", "y", view); check(didnt_throw);}
+		catch(std::runtime_error& e)
+		{
+			std::string expected("ro_string_table: eq_range_view of dictionary field 'type'; use a cursor or a vector instead");
+			check(expected == e.what());
+		}
+	}
+	
+	{ // unique dictionary field
+		std::vector<rst::field_info> ufields{
+			rst::field_info("id", true).use_index(rst::INDEX_DICTIONARY),
+			rst::field_info("fruit")
+		};
+		ro_string_table tbl(4, ufields);
+		const char * lines[][2] = {{"2", "apple"}, {"1", "pear"}, {"3", "fig"}};
+		for (auto& line : lines)
+		{
+			for (auto& str : line)
+				tbl.append(str);
+		}
+		tbl.seal();
+		
+		std::vector<fp> targets{fp("fruit")};
+		check(tbl.lookup_unique(fp("id", "1"), targets));
+		check(std::string(targets[0].field_value) == "pear");
+		check(tbl.lookup_unique(fp("id", "3"), targets));
+		check(std::string(targets[0].field_value) == "fig");
+		check(!tbl.lookup_unique(fp("id", "4"), targets));
+	}
+	
+	return true;
+}
+
+static bool test_ro_string_table_get_row(void)
+{
+	typedef ro_string_table rst;
+	
+	ro_string_table str_tbl(fruit_lines, fruit_fields());
+	std::vector<rst::cell> cells;
+	
+	{ // before and after seal
+		str_tbl.get_row(0, cells);
+		check(cells.size() == 4);
+		check(std::string(cells[3].str) == "price");
+		check(cells[3].len == 5);
+		
+		try {str_tbl.get_row(1, cells); check(didnt_throw);}
+		catch(std::runtime_error& e)
+		{
+			std::string expected("ro_string_table: row 1 out of range; rows appended: 1");
+			check(expected == e.what());
+		}
+		
+		str_tbl.append("1");
+		str_tbl.get_row(0, cells);
+		check(cells[3].len == 5);
+		
+		ro_string_table tbl(fruit_lines, fruit_fields());
+		fill_fruit(tbl);
+		
+		try {tbl.get_row(6, cells); check(didnt_throw);}
+		catch(std::runtime_error& e)
+		{
+			std::string expected("ro_string_table: row 6 out of range; rows appended: 6");
+			check(expected == e.what());
+		}
+		
+		for (uint row = 0; row < tbl.get_num_rows(); ++row)
+		{
+			tbl.get_row(row, cells);
+			for (uint col = 0; col < tbl.get_num_cols(); ++col)
+			{
+				const char * str = tbl.get_str_at(row, col);
+				check(cells[col].str == str);
+				check(cells[col].len == strlen(str));
+			}
+		}
+	}
+	
+	{ // batches, empty strings
+		int all_lines = 101;
+		std::vector<rst::field_info> fields{
+			rst::field_info("a"),
+			rst::field_info("b"),
+			rst::field_info("c")
+		};
+		
+		ro_string_table tbl(all_lines, fields);
+		for (int i = 1; i < all_lines; ++i)
+		{
+			tbl.append(std::string(i % 7, 'x'));
+			tbl.append((i % 3) ? "" : "three");
+			tbl.append(std::to_string(i));
+		}
+		tbl.seal();
+		
+		std::vector<uint> rows;
+		for (uint i = 0; i < 300; ++i)
+			rows.push_back((i * 31) % all_lines);
+		
+		tbl.get_rows(rows, cells);
+		check(cells.size() == rows.size() * 3);
+		for (size_t i = 0; i < rows.size(); ++i)
+		{
+			for (uint col = 0; col < 3; ++col)
+			{
+				const rst::cell& cl = cells[i*3 + col];
+				const char * str = tbl.get_str_at(rows[i], col);
+				check(cl.str == str);
+				check(cl.len == strlen(str));
+			}
+		}
+		
+		std::vector<uint> none;
+		tbl.get_rows(none, cells);
+		check(cells.empty());
+		
+		rows.push_back(all_lines);
+		try {tbl.get_rows(rows, cells); check(didnt_throw);}
+		catch(std::runtime_error& e)
+		{
+			std::string expected("ro_string_table: row 101 out of range; rows appended: 101");
+			check(expected == e.what());
+		}
+	}
+	
+	return true;
+}
+
+static bool test_ro_string_table_exists_count(void)
+{
+	typedef ro_string_table rst;
+	typedef rst::field_pair fp;
+	
+	{ // fruit
+		ro_string_table str_tbl(fruit_lines, fruit_fields());
+		
+		try {str_tbl.exists(fp("id", "1")); check(didnt_throw);}
+		catch(std::runtime_error& e)
+		{
+			std::string expected("ro_string_table: lookup before seal()");
+			check(expected == e.what());
+		}
+		
+		try {str_tbl.count(fp("id", "1")); check(didnt_throw);}
+		catch(std::runtime_error& e)
+		{
+			std::string expected("ro_string_table: lookup before seal()");
+			check(expected == e.what());
+		}
+		
+		fill_fruit(str_tbl);
+		
+		check(str_tbl.exists(fp("id", "1")));
+		check(str_tbl.exists(fp("type", "normal")));
+		check(!str_tbl.exists(fp("type", "norma")));
+		check(!str_tbl.exists(fp("fruit", "kiwi")));
+		
+		check(str_tbl.count(fp("id", "1")) == 1);
+		check(str_tbl.count(fp("type", "normal")) == 3);
+		check(str_tbl.count(fp("type", "fancy")) == 2);
+		check(str_tbl.count(fp("type", "plain")) == 0);
+		
+		try {str_tbl.exists(fp("banana", "1")); check(didnt_throw);}
+		catch(std::runtime_error& e)
+		{
+			std::string expected("ro_string_table: lookup fail: no such field 'banana'");
+			check(expected == e.what());
+		}
+		
+		try {str_tbl.count(fp("banana", "1")); check(didnt_throw);}
+		catch(std::runtime_error& e)
+		{
+			std::string expected("ro_string_table: lookup fail: no such field 'banana'");
+			check(expected == e.what());
+		}
+	}
+	
+	{ // collation and dictionary
+		int all_lines = 301;
+		std::vector<rst::field_info> fields{
+			rst::field_info("status", false, rst::TYPE_STRING, 0,
+				rst::COLL_FOLD_ASCII
+			).use_index(rst::INDEX_DICTIONARY),
+			rst::field_info("code", false, rst::TYPE_STRING, 0, rst::COLL_TRIM)
+		};
+		
+		ro_string_table tbl(all_lines, fields);
+		for (int i = 1; i < all_lines; ++i)
+		{
+			tbl.append((i % 3) ? "Open" : "CLOSED");
+			tbl.append((i % 2) ? " a" : "b ");
+		}
+		tbl.seal();
+		
+		check(tbl.count(fp("status", "open")) == 200);
+		check(tbl.count(fp("status", "closed")) == 100);
+		check(tbl.count(fp("status", "pending")) == 0);
+		check(tbl.exists(fp("status", "OPEN")));
+		check(!tbl.exists(fp("status", "pending")));
+		
+		check(tbl.count(fp("code", "a")) == 150);
+		check(tbl.exists(fp("code", "b")));
+		check(!tbl.exists(fp("code", "B")));
+	}
+	
+	return true;
+}
+
+
+static bool test_ro_string_table_group(void)
+{
+	typedef ro_string_table rst;
+	
+	{ // fruit
+		ro_string_table str_tbl(fruit_lines, fruit_fields());
+		std::vector<rst::value_count> out;
+		
+		try {str_tbl.group_counts("type", out); check(didnt_throw);}
+		catch(std::runtime_error& e)
+		{
+			std::string expected("ro_string_table: lookup before seal()");
+			check(expected == e.what());
+		}
+		
+		fill_fruit(str_tbl);
+		
+		str_tbl.group_counts("type", out);
+		check(out.size() == 2);
+		check(std::string(out[0].value) == "fancy");
+		check(out[0].count == 2);
+		check(std::string(out[1].value) == "normal");
+		check(out[1].count == 3);
+		
+		str_tbl.group_top("type", 1, out);
+		check(out.size() == 1);
+		check(std::string(out[0].value) == "normal");
+		
+		str_tbl.group_top("id", 0, out);
+		check(out.empty());
+		
+		// ties go in sorted order
+		str_tbl.group_top("fruit", 2, out);
+		check(out.size() == 2);
+		check(std::string(out[0].value) == "apple");
+		check(std::string(out[1].value) == "mango");
+		
+		rst::group_cursor cur;
+		check(cur.at_end());
+		check(cur.next(10, out) == 0);
+		
+		str_tbl.group_by("fruit", cur);
+		check(cur.next(3, out) == 3);
+		check(std::string(out[2].value) == "peach");
+		check(cur.next(3, out) == 2);
+		check(std::string(out[1].value) == "pineapple");
+		check(cur.at_end());
+		check(cur.next(3, out) == 0);
+		cur.rewind();
+		check(cur.next(1, out) == 1);
+		check(std::string(out[0].value) == "apple");
+		
+		try {str_tbl.group_counts("banana", out); check(didnt_throw);}
+		catch(std::runtime_error& e)
+		{
+			std::string expected("ro_string_table: lookup fail: no such field 'banana'");
+			check(expected == e.what());
+		}
+	}
+	
+	{ // against a map, sorted and dictionary, 1 to 4 threads
+		int all_lines = 2001;
+		std::vector<rst::field_info> fields{
+			rst::field_info("sorted"),
+			rst::field_info("dict").use_index(rst::INDEX_DICTIONARY)
+		};
+		
+		ro_string_table tbl(all_lines, fields);
+		std::map<std::string, size_t> expected;
+		for (int i = 1; i < all_lines; ++i)
+		{
+			std::string val = std::string("v_") + std::to_string((i * i) % 97);
+			tbl.append(val);
+			tbl.append(val);
+			++expected[val];
+		}
+		tbl.seal();
+		
+		std::vector<std::pair<std::string, size_t>> by_count(
+			expected.begin(),
+			expected.end()
+		);
+		std::stable_sort(by_count.begin(), by_count.end(),
+			[](const std::pair<std::string, size_t>& a,
+				const std::pair<std::string, size_t>& b)
+			{return a.second > b.second;}
+		);
+		
+		std::vector<rst::value_count> out;
+		for (const char * field : {"sorted", "dict"})
+		{
+			for (uint threads = 0; threads <= 4; ++threads)
+			{
+				tbl.group_counts(field, out, threads);
+				check(out.size() == expected.size());
+				
+				auto it = expected.begin();
+				for (auto& grp : out)
+				{
+					check(it->first == grp.value);
+					check(it->second == grp.count);
+					++it;
+				}
+				
+				for (size_t k : {1, 5, 20, 200})
+				{
+					tbl.group_top(field, k, out, threads);
+					check(out.size() == std::min(k, by_count.size()));
+					for (size_t i = 0; i < out.size(); ++i)
+					{
+						check(by_count[i].first == out[i].value);
+						check(by_count[i].second == out[i].count);
+					}
+				}
+			}
+			
+			rst::group_cursor cur;
+			tbl.group_by(field, cur);
+			size_t seen = 0, rows = 0;
+			while (cur.next(7, out))
+			{
+				seen += out.size();
+				for (auto& grp : out)
+					rows += grp.count;
+			}
+			check(seen == expected.size());
+			check(rows == (size_t)(all_lines - 1));
+		}
+	}
+	
+	return true;
+}
+
+static bool test_ro_string_table_order_by(void)
+{
+	typedef ro_string_table rst;
+	
+	{ // fruit
+		ro_string_table str_tbl(fruit_lines, fruit_fields());
+		rst::ordered_cursor cur;
+		
+		try {str_tbl.order_by("fruit", cur); check(didnt_throw);}
+		catch(std::runtime_error& e)
+		{
+			std::string expected("ro_string_table: lookup before seal()");
+			check(expected == e.what());
+		}
+		
+		fill_fruit(str_tbl);
+		
+		std::vector<uint> rows;
+		check(cur.remaining() == 0);
+		check(cur.next(10, rows) == 0);
+		
+		str_tbl.order_by("fruit", cur);
+		check(cur.count() == 5);
+		check(cur.next(10, rows) == 5);
+		check(rows == std::vector<uint>({2, 4, 3, 5, 1}));
+		
+		str_tbl.order_by("fruit", cur, rst::ORDER_DESC);
+		check(cur.next(2, rows) == 2);
+		check(rows == std::vector<uint>({1, 5}));
+		check(cur.next(10, rows) == 3);
+		check(rows == std::vector<uint>({3, 4, 2}));
+		cur.rewind();
+		check(cur.skip(4) == 4);
+		check(cur.next(10, rows) == 1);
+		check(rows[0] == 2);
+		
+		str_tbl.order_by("fruit", "pe", cur);
+		check(cur.next(10, rows) == 3);
+		check(rows == std::vector<uint>({3, 5, 1}));
+		
+		str_tbl.order_by("fruit", "pear", cur, rst::ORDER_DESC);
+		check(cur.next(10, rows) == 4);
+		check(rows == std::vector<uint>({5, 3, 4, 2}));
+		
+		str_tbl.order_by("fruit", "pear", cur, rst::ORDER_DESC, false);
+		check(cur.next(10, rows) == 3);
+		check(rows == std::vector<uint>({3, 4, 2}));
+		
+		str_tbl.order_by("fruit", "zucchini", cur);
+		check(cur.count() == 0);
+		check(cur.next(10, rows) == 0);
+		
+		// equal values in line order, reversed when walking back
+		str_tbl.order_by("type", cur);
+		cur.next(10, rows);
+		check(rows == std::vector<uint>({1, 4, 2, 3, 5}));
+		str_tbl.order_by("type", cur, rst::ORDER_DESC);
+		cur.next(10, rows);
+		check(rows == std::vector<uint>({5, 3, 2, 4, 1}));
+		
+		std::vector<rst::eq_range_result> targets{
+			rst::eq_range_result("fruit"),
+			rst::eq_range_result("price")
+		};
+		str_tbl.order_by("price", "5", cur);
+		check(cur.next(3, targets) == 2);
+		check(std::string(targets[0].values[1]) == "pear");
+		check(std::string(targets[1].values[0]) == "5.32");
+		
+		targets[1].field_name = "banana";
+		cur.rewind();
+		try {cur.next(2, targets); check(didnt_throw);}
+		catch(std::runtime_error& e)
+		{
+			std::string expected("ro_string_table: lookup fail: no such field 'banana'");
+			check(expected == e.what());
+		}
+		
+		try {str_tbl.order_by("banana", cur); check(didnt_throw);}
+		catch(std::runtime_error& e)
+		{
+			std::string expected("ro_string_table: lookup fail: no such field 'banana'");
+			check(expected == e.what());
+		}
+	}
+	
+	{ // numeric
+		std::vector<rst::field_info> fields{
+			rst::field_info("id", true),
+			rst::field_info("qty", false, rst::TYPE_INT64)
+		};
+		
+		ro_string_table tbl(6, fields);
+		const char * qty[] = {"100", "9", "-3", "20", "9"};
+		for (int i = 0; i < 5; ++i)
+		{
+			tbl.append(std::to_string(i + 1));
+			tbl.append(qty[i]);
+		}
+		tbl.seal();
+		
+		rst::ordered_cursor cur;
+		std::vector<uint> rows;
+		tbl.order_by("qty", cur);
+		cur.next(10, rows);
+		check(rows == std::vector<uint>({3, 2, 5, 4, 1}));
+		
+		tbl.order_by("qty", "10", cur, rst::ORDER_DESC);
+		cur.next(10, rows);
+		check(rows == std::vector<uint>({5, 2, 3}));
+		
+		tbl.order_by("qty", "9", cur, rst::ORDER_ASC, false);
+		cur.next(10, rows);
+		check(rows == std::vector<uint>({4, 1}));
+		
+		try {tbl.order_by("qty", "x", cur); check(didnt_throw);}
+		catch(std::runtime_error& e)
+		{check(std::string(e.what()).find("numeric lookup") != std::string::npos);}
+	}
+	
+	{ // dictionary walks like the sorted field, with skips across values
+		int all_lines = 1001;
+		std::vector<rst::field_info> fields{
+			rst::field_info("sorted"),
+			rst::field_info("dict").use_index(rst::INDEX_DICTIONARY)
+		};
+		
+		ro_string_table tbl(all_lines, fields);
+		for (int i = 1; i < all_lines; ++i)
+		{
+			std::string val = std::string("v_") + std::to_string((i * 7) % 31);
+			tbl.append(val);
+			tbl.append(val);
+		}
+		tbl.seal();
+		
+		for (int dir : {rst::ORDER_ASC, rst::ORDER_DESC})
+		{
+			for (const char * from : {(const char *)nullptr, "v_17", "v_3"})
+			{
+				rst::ordered_cursor srt, dct;
+				tbl.order_by("sorted", from, srt, dir);
+				tbl.order_by("dict", from, dct, dir);
+				check(srt.count() == dct.count());
+				check(srt.count() > 0);
+				
+				std::vector<uint> srt_rows, dct_rows;
+				for (size_t step : {1, 5, 40, 13, 100})
+				{
+					check(srt.skip(step) == dct.skip(step));
+					srt.next(step, srt_rows);
+					dct.next(step, dct_rows);
+					check(srt_rows == dct_rows);
+					check(srt.remaining() == dct.remaining());
+				}
+				
+				dct.rewind();
+				srt.rewind();
+				srt.next(all_lines, srt_rows);
+				dct.next(all_lines, dct_rows);
+				check(srt_rows == dct_rows);
+			}
+		}
+	}
+	
+	return true;
+}
+
+static bool test_ro_string_table_fuzzy(void)
+{
+	typedef ro_string_table rst;
+	typedef rst::field_pair fp;
+	
+	std::vector<rst::field_info> fields{
+		rst::field_info("id", true),
+		rst::field_info("vendor").use_fuzzy(),
+		rst::field_info("city", false, rst::TYPE_STRING, 0,
+			rst::COLL_FOLD_ASCII
+		).use_index(rst::INDEX_DICTIONARY).use_fuzzy(),
+		rst::field_info("note")
+	};
+	
+	const char * lines[][4] = {
+		{"1", "acme", "Berlin", "a"},
+		{"2", "acne", "berlin", "b"},
+		{"3", "acme", "Bern", "c"},
+		{"4", "apex", "Brno", "d"},
+		{"5", "zenith", "Basel", "e"},
+		{"6", "acme", "BERLIN", "f"},
+	};
+	
+	ro_string_table tbl(7, fields);
+	std::vector<rst::fuzzy_match> out;
+	
+	try {tbl.lookup_fuzzy(fp("vendor", "acme"), 1, out); check(didnt_throw);}
+	catch(std::runtime_error& e)
+	{
+		std::string expected("ro_string_table: lookup before seal()");
+		check(expected == e.what());
+	}
+	
+	for (auto& line : lines)
+	{
+		for (auto& str : line)
+			tbl.append(str);
+	}
+	tbl.seal();
+	
+	check(tbl.lookup_fuzzy(fp("vendor", "acme"), 0, out));
+	check(out.size() == 1);
+	check(std::string(out[0].value) == "acme");
+	check(out[0].distance == 0);
+	check(out[0].count == 3);
+	
+	check(tbl.lookup_fuzzy(fp("vendor", "acme"), 1, out));
+	check(out.size() == 2);
+	check(std::string(out[0].value) == "acme");
+	check(std::string(out[1].value) == "acne");
+	check(out[1].distance == 1);
+	check(out[1].count == 1);
+	
+	check(!tbl.lookup_fuzzy(fp("vendor", "xyz"), 2, out));
+	check(out.empty());
+	
+	check(tbl.lookup_nearest(fp("vendor", "apexx"), 2, out));
+	check(out.size() == 2);
+	check(std::string(out[0].value) == "apex");
+	check(out[0].distance == 1);
+	check(std::string(out[1].value) == "acme");
+	check(out[1].distance == 4);
+	
+	check(!tbl.lookup_nearest(fp("vendor", "acme"), 0, out));
+	
+	// distinct by collation, measured on the first value as appended
+	check(tbl.lookup_fuzzy(fp("city", "Bern"), 2, out));
+	check(out.size() == 3);
+	check(std::string(out[0].value) == "Bern");
+	check(out[0].count == 1);
+	check(std::string(out[1].value) == "Berlin");
+	check(out[1].distance == 2);
+	check(out[1].count == 3);
+	check(std::string(out[2].value) == "Brno");
+	check(out[2].distance == 2);
+	
+	try {tbl.lookup_fuzzy(fp("note", "a"), 1, out); check(didnt_throw);}
+	catch(std::runtime_error& e)
+	{
+		std::string expected("ro_string_table: fuzzy lookup of field 'note' without a fuzzy index");
+		check(expected == e.what());
+	}
+	
+	try {tbl.lookup_nearest(fp("banana", "a"), 1, out); check(didnt_throw);}
+	catch(std::runtime_error& e)
+	{
+		std::string expected("ro_string_table: lookup fail: no such field 'banana'");
+		check(expected == e.what());
+	}
+	
+	return true;
+}
+
+static bool test_ro_string_table_contains(void)
+{
+	typedef ro_string_table rst;
+	typedef rst::field_pair fp;
+	
+	std::vector<rst::field_info> fields{
+		rst::field_info("id", true),
+		rst::field_info("desc").use_substrings(),
+		rst::field_info("kind").use_index(rst::INDEX_DICTIONARY).use_substrings()
+	};
+	
+	const char * lines[][3] = {
+		{"1", "red apple pie", "dessert"},
+		{"2", "green apple", "fruit"},
+		{"3", "", "fruit"},
+		{"4", "pineapple juice", "drink"},
+		{"5", "apple", "fruit"},
+	};
+	
+	ro_string_table tbl(6, fields);
+	std::vector<uint> rows;
+	
+	try {tbl.lookup_contains(fp("desc", "apple"), rows); check(didnt_throw);}
+	catch(std::runtime_error& e)
+	{
+		std::string expected("ro_string_table: lookup before seal()");
+		check(expected == e.what());
+	}
+	
+	for (auto& line : lines)
+	{
+		for (auto& str : line)
+			tbl.append(str);
+	}
+	tbl.seal();
+	
+	check(tbl.lookup_contains(fp("desc", "apple"), rows));
+	check(rows == std::vector<uint>({1, 2, 4, 5}));
+	
+	check(tbl.lookup_contains(fp("desc", "pie"), rows));
+	check(rows == std::vector<uint>({1}));
+	
+	check(!tbl.lookup_contains(fp("desc", "Apple"), rows));
+	check(rows.empty());
+	
+	check(tbl.lookup_contains(fp("desc", ""), rows));
+	check(rows.size() == 5);
+	
+	check(tbl.lookup_contains(fp("kind", "ui"), rows));
+	check(rows == std::vector<uint>({2, 3, 5}));
+	
+	std::vector<rst::eq_range_result> targets{
+		rst::eq_range_result("id"),
+		rst::eq_range_result("kind")
+	};
+	check(tbl.lookup_contains(fp("desc", "e j"), targets));
+	check(targets[0].values.size() == 1);
+	check(std::string(targets[0].values[0]) == "4");
+	check(std::string(targets[1].values[0]) == "drink");
+	
+	// a miss leaves the targets alone
+	check(!tbl.lookup_contains(fp("desc", "kiwi"), targets));
+	check(targets[0].values.size() == 1);
+	
+	check(tbl.get_substring_memory("desc") >= 10 * strlen("red apple pie"));
+	check(tbl.get_substring_memory("id") == 0);
+	
+	try {tbl.lookup_contains(fp("id", "1"), rows); check(didnt_throw);}
+	catch(std::runtime_error& e)
+	{
+		std::string expected("ro_string_table: substring lookup of field 'id' without a substring index");
+		check(expected == e.what());
+	}
+	
+	try {tbl.get_substring_memory("banana"); check(didnt_throw);}
+	catch(std::runtime_error& e)
+	{
+		std::string expected("ro_string_table: lookup fail: no such field 'banana'");
+		check(expected == e.what());
+	}
+	
+	return true;
+}
+
+static bool test_ro_string_table_tokens(void)
+{
+	typedef ro_string_table rst;
+	
+	std::vector<rst::field_info> fields{
+		rst::field_info("id", true),
+		rst::field_info("tags").use_tokens(" ,"),
+		rst::field_info("title").use_tokens(" ", false)
+	};
+	
+	const char * lines[][3] = {
+		{"1", "Red,sale new", "Red Shoes"},
+		{"2", "blue", "red hat"},
+		{"3", "", "Blue Hat"},
+		{"4", "red  SALE", "Hat"},
+		{"5", "sale,blue,sale", "Shoes"},
+	};
+	
+	ro_string_table tbl(6, fields);
+	std::vector<uint> rows;
+	
+	try {tbl.lookup_tokens("tags", {"red"}, rows); check(didnt_throw);}
+	catch(std::runtime_error& e)
+	{
+		std::string expected("ro_string_table: lookup before seal()");
+		check(expected == e.what());
+	}
+	
+	for (auto& line : lines)
+	{
+		for (auto& str : line)
+			tbl.append(str);
+	}
+	tbl.seal();
+	
+	check(tbl.lookup_tokens("tags", {"sale"}, rows));
+	check(rows == std::vector<uint>({1, 4, 5}));
+	
+	check(tbl.lookup_tokens("tags", {"RED", "sale"}, rows));
+	check(rows == std::vector<uint>({1, 4}));
+	
+	check(!tbl.lookup_tokens("tags", {"red", "blue"}, rows));
+	check(rows.empty());
+	
+	check(tbl.lookup_tokens("tags", {"new", "blue"}, rows, rst::TOKENS_ANY));
+	check(rows == std::vector<uint>({1, 2, 5}));
+	
+	check(!tbl.lookup_tokens("tags", {"green"}, rows, rst::TOKENS_ANY));
+	check(!tbl.lookup_tokens("tags", {}, rows));
+	
+	// case kept
+	check(tbl.lookup_tokens("title", {"Hat"}, rows));
+	check(rows == std::vector<uint>({3, 4}));
+	check(tbl.lookup_tokens("title", {"hat", "red"}, rows));
+	check(rows == std::vector<uint>({2}));
+	
+	std::vector<rst::eq_range_result> targets{rst::eq_range_result("title")};
+	check(tbl.lookup_tokens("tags", {"blue", "sale"}, targets));
+	check(targets[0].values.size() == 1);
+	check(std::string(targets[0].values[0]) == "Shoes");
+	
+	// a miss leaves the targets alone
+	check(!tbl.lookup_tokens("tags", {"green"}, targets));
+	check(targets[0].values.size() == 1);
+	
+	try {tbl.lookup_tokens("id", {"1"}, rows); check(didnt_throw);}
+	catch(std::runtime_error& e)
+	{
+		std::string expected("ro_string_table: token lookup of field 'id' without a token index");
+		check(expected == e.what());
+	}
+	
+	try {tbl.lookup_tokens("banana", {"1"}, rows); check(didnt_throw);}
+	catch(std::runtime_error& e)
+	{
+		std::string expected("ro_string_table: lookup fail: no such field 'banana'");
+		check(expected == e.what());
+	}
+	
+	return true;
+}
+
+static bool test_ro_string_table_filter(void)
+{
+	typedef ro_string_table rst;
+	
+	std::vector<rst::field_info> fields{
+		rst::field_info("id", true).use_filter(),
+		rst::field_info("name", false, rst::TYPE_STRING, 0,
+			rst::COLL_FOLD_ASCII
+		).use_filter(16),
+		rst::field_info("type").use_index(rst::INDEX_DICTIONARY).use_filter(),
+		rst::field_info("note")
+	};
+	
+	const uint lines = 1000;
+	ro_string_table tbl(lines + 1, fields);
+	
+	rst::filter_stats stats{0, 0, 0};
+	try {tbl.get_filter_stats("id", stats); check(didnt_throw);}
+	catch(std::runtime_error& e)
+	{
+		std::string expected("ro_string_table: lookup before seal()");
+		check(expected == e.what());
+	}
+	
+	std::vector<std::string> strs;
+	for (uint i = 0; i < lines; ++i)
+	{
+		strs.push_back(std::to_string(i * 2));
+		tbl.append(strs.back().c_str());
+		strs.push_back("Name" + std::to_string(i % 100));
+		tbl.append(strs.back().c_str());
+		tbl.append((i % 3) ? "normal" : "fancy");
+		tbl.append("x");
+	}
+	tbl.seal();
+	
+	check(tbl.get_filter_stats("id", stats));
+	check(stats.keys == lines);
+	check(stats.bytes >= lines * 10 / 8);
+	check(stats.false_positive_rate > 0 && stats.false_positive_rate < 0.03);
+	
+	check(tbl.get_filter_stats("name", stats));
+	check(stats.keys == 100);
+	check(tbl.get_filter_stats("type", stats));
+	check(stats.keys == 2);
+	check(!tbl.get_filter_stats("note", stats));
+	
+	// every value present is found
+	bool all_found = true;
+	for (uint i = 0; i < lines; ++i)
+	{
+		std::string id = std::to_string(i * 2);
+		all_found = all_found && tbl.exists(rst::field_pair("id", id.c_str()));
+	}
+	check(all_found);
+	
+	std::vector<rst::field_pair> targets{rst::field_pair("name")};
+	check(tbl.lookup_unique(rst::field_pair("id", "42"), targets));
+	check(std::string(targets[0].field_value) == "Name21");
+	check(!tbl.lookup_unique(rst::field_pair("id", "43"), targets));
+	
+	// odd ids are absent, filtered or not
+	bool none_found = true;
+	for (uint i = 0; i < lines; ++i)
+	{
+		std::string id = std::to_string(i * 2 + 1);
+		none_found = none_found &&
+			!tbl.exists(rst::field_pair("id", id.c_str()));
+	}
+	check(none_found);
+	
+	// hashed with the collation of the field
+	check(tbl.count(rst::field_pair("name", "NAME7")) == 10);
+	check(tbl.count(rst::field_pair("name", "name77")) == 10);
+	check(tbl.count(rst::field_pair("name", "name100")) == 0);
+	
+	std::vector<rst::eq_range_result> rng{rst::eq_range_result("id")};
+	check(tbl.lookup_equal_range(rst::field_pair("type", "fancy"), rng));
+	check(rng[0].values.size() == 334);
+	check(!tbl.lookup_equal_range(rst::field_pair("type", "plain"), rng));
+	check(tbl.count(rst::field_pair("type", "normal")) == 666);
+	
+	rst::eq_range_cursor cur;
+	check(!tbl.lookup_equal_range(rst::field_pair("name", "nope"), cur));
+	
+	// prefixes are not filtered
+	check(tbl.lookup_prefix(rst::field_pair("name", "name9"), rng));
+	check(rng[0].values.size() == 110);
+	
+	try {tbl.get_filter_stats("banana", stats); check(didnt_throw);}
+	catch(std::runtime_error& e)
+	{
+		std::string expected("ro_string_table: lookup fail: no such field 'banana'");
+		check(expected == e.what());
+	}
+	
+	return true;
+}
+
+static bool test_ro_string_table_learned(void)
+{
+	typedef ro_string_table rst;
+	
+	// the same values in a sorted and a learned field, so every lookup can
+	// be checked against the other
+	std::vector<rst::field_info> fields{
+		rst::field_info("id"),
+		rst::field_info("id_learned").use_index(rst::INDEX_LEARNED),
+		rst::field_info("name", false, rst::TYPE_STRING, 0,
+			rst::COLL_FOLD_ASCII
+		).use_index(rst::INDEX_LEARNED)
+	};
+	
+	const uint lines = 5000;
+	ro_string_table tbl(lines + 1, fields);
+	
+	std::vector<std::string> strs;
+	for (uint i = 0; i < lines; ++i)
+	{
+		// mostly distinct, some repeated, like generate_csv.txt makes
+		strs.push_back("id_" + std::to_string((i % 7) ? i : i / 7));
+		tbl.append(strs.back().c_str());
+		tbl.append(strs.back().c_str());
+		tbl.append((i % 2) ? "Name" : "NAME");
+	}
+	tbl.seal();
+	
+	rst::learned_stats stats{0, 0, 0};
+	check(tbl.get_learned_stats("id_learned", stats));
+	check(stats.segments > 0 && stats.segments < lines / 10);
+	check(stats.max_error <= 33);
+	check(stats.bytes > 0);
+	check(!tbl.get_learned_stats("id", stats));
+	check(!tbl.get_learned_stats("name", stats));
+	
+	std::vector<std::string> probes{"", "a", "id_", "id_0", "id_1", "id_2",
+		"id_4999", "id_5000", "id_99999", "id_4", "zzz", "id_12a"
+	};
+	for (uint i = 0; i < lines; i += 37)
+		probes.push_back("id_" + std::to_string(i));
+	
+	bool all_same = true;
+	for (auto& probe : probes)
+	{
+		const char * val = probe.c_str();
+		
+		all_same = all_same &&
+			tbl.count(rst::field_pair("id", val)) ==
+			tbl.count(rst::field_pair("id_learned", val));
+		
+		rst::eq_range_view v1, v2;
+		tbl.lookup_prefix(rst::field_pair("id", val), v1);
+		tbl.lookup_prefix(rst::field_pair("id_learned", val), v2);
+		all_same = all_same && v1.size() == v2.size();
+		
+		tbl.lookup_range("id", val, "id_3", v1, rst::INCL_LOW);
+		tbl.lookup_range("id_learned", val, "id_3", v2, rst::INCL_LOW);
+		all_same = all_same && v1.size() == v2.size();
+		
+		tbl.lookup_range("id", "id_2", val, v1, rst::INCL_BOTH);
+		tbl.lookup_range("id_learned", "id_2", val, v2, rst::INCL_BOTH);
+		all_same = all_same && v1.size() == v2.size();
+		
+		tbl.lookup_range("id", val, nullptr, v1, rst::INCL_NONE);
+		tbl.lookup_range("id_learned", val, nullptr, v2, rst::INCL_NONE);
+		all_same = all_same && v1.size() == v2.size();
+	}
+	check(all_same);
+	
+	std::vector<rst::eq_range_result> targets{rst::eq_range_result("id")};
+	check(tbl.lookup_equal_range(rst::field_pair("id_learned", "id_1"),
+		targets
+	));
+	check(targets[0].values.size() == 2);
+	check(std::string(targets[0].values[0]) == "id_1");
+	
+	check(tbl.exists(rst::field_pair("id_learned", "id_4997")));
+	check(!tbl.exists(rst::field_pair("id_learned", "id_4997 ")));
+	
+	// no model, but still the collation
+	check(tbl.count(rst::field_pair("name", "name")) == lines);
+	
+	return true;
+}
+
+static bool test_ro_string_table_lengths(void)
+{
+	typedef ro_string_table rst;
+	typedef rst::field_pair fp;
+	
+	std::vector<rst::field_info> fields{
+		rst::field_info("id", true),
+		rst::field_info("tag").use_index(rst::INDEX_DICTIONARY),
+		rst::field_info("name", false, rst::TYPE_STRING, 0,
+			rst::COLL_FOLD_ASCII
+		),
+		rst::field_info("blob").index_with({"tag"})
+	};
+	
+	// values which differ only after a '\0'
+	std::vector<std::vector<std::string>> lines{
+		{std::string("a"), std::string("x\0y", 3), "Foo", "b1"},
+		{std::string("a\0b", 3), std::string("x"), "foo", "b2"},
+		{std::string("a\0c", 3), std::string("x\0y", 3), "bar", "b3"},
+		{std::string("ab"), std::string("x"), "BAR", "b4"},
+		{std::string(""), std::string("x\0", 2), "baz", "b5"},
+	};
+	
+	{ // throw '\0' without lengths
+		ro_string_table tbl(lines.size() + 1, fields);
+		check(tbl.get_pool_mode() == rst::POOL_PLAIN);
+		tbl.append("a", 1);
+		try {tbl.append("x\0y", 3); check(didnt_throw);}
+		catch(std::runtime_error& e)
+		{
+			std::string expected(
+				"ro_string_table: append() of a value with '\\0' needs "
+				"POOL_LENGTHS"
+			);
+			check(expected == e.what());
+		}
+	}
+	
+	ro_string_table tbl(lines.size() + 1, fields, 0, rst::POOL_LENGTHS);
+	check(tbl.get_pool_mode() == rst::POOL_LENGTHS);
+	for (auto& line : lines)
+	{
+		for (auto& str : line)
+			tbl.append(str);
+	}
+	tbl.seal();
+	
+	{ // unique lookups tell the values apart
+		std::vector<fp> targets{fp("blob"), fp("tag")};
+		check(tbl.lookup_unique(fp("id", "a\0b", 3), targets));
+		check(std::string(targets[0].field_value) == "b2");
+		check(targets[0].value_len == 2);
+		check(targets[1].value_len == 1);
+		
+		check(tbl.lookup_unique(fp("id", "a"), targets));
+		check(std::string(targets[0].field_value) == "b1");
+		check(targets[1].value_len == 3);
+		check(0 == memcmp(targets[1].field_value, "x\0y", 3));
+		check(tbl.get_value_len(targets[1].field_value) == 3);
+		
+		check(tbl.lookup_unique(fp("id", ""), targets));
+		check(std::string(targets[0].field_value) == "b5");
+		check(targets[1].value_len == 2);
+		
+		check(!tbl.lookup_unique(fp("id", "a\0d", 3), targets));
+		check(!tbl.exists(fp("id", "a\0", 2)));
+		check(tbl.exists(fp("id", "a\0c", 3)));
+	}
+	
+	{ // equal ranges over the dictionary
+		check(tbl.count(fp("tag", "x\0y", 3)) == 2);
+		check(tbl.count(fp("tag", "x")) == 2);
+		check(tbl.count(fp("tag", "x\0", 2)) == 1);
+		check(tbl.count(fp("tag", "x\0z", 3)) == 0);
+		
+		std::vector<rst::eq_range_result> targets{rst::eq_range_result("id")};
+		check(tbl.lookup_equal_range(fp("tag", "x\0y", 3), targets));
+		check(targets[0].values.size() == 2);
+		check(tbl.get_value_len(targets[0].values[0]) == 1);
+		check(tbl.get_value_len(targets[0].values[1]) == 3);
+	}
+	
+	{ // prefixes and ranges
+		rst::eq_range_view view;
+		check(tbl.lookup_prefix(fp("id", "a"), view));
+		check(view.size() == 4);
+		check(tbl.lookup_prefix(fp("id", "a\0", 2), view));
+		check(view.size() == 2);
+		check(!tbl.lookup_prefix(fp("id", "a\0d", 3), view));
+		
+		check(tbl.lookup_range("id", "a", "ab", view, rst::INCL_LOW));
+		check(view.size() == 3);
+		check(tbl.lookup_range("id", "", "a", view, rst::INCL_BOTH));
+		check(view.size() == 2);
+		
+		std::vector<uint> rows;
+		check(tbl.lookup_in("tag", {"x", "x"}, rows));
+		check(rows.size() == 4);
+		check(tbl.lookup_in("tag", {"x"}, rows, rst::IN_DEDUP));
+		check(rows.size() == 2);
+	}
+	
+	{ // collations still apply
+		check(tbl.count(fp("name", "FOO")) == 2);
+		check(tbl.count(fp("name", "bar")) == 2);
+	}
+	
+	{ // composite keys with '\0'
+		std::vector<rst::eq_range_result> targets{rst::eq_range_result("id")};
+		check(tbl.lookup_composite({fp("blob", "b3"), fp("tag", "x\0y", 3)},
+			targets
+		));
+		check(targets[0].values.size() == 1);
+		check(tbl.get_value_len(targets[0].values[0]) == 3);
+		check(!tbl.lookup_composite({fp("blob", "b3"), fp("tag", "x")},
+			targets
+		));
+	}
+	
+	{ // cells come with their lengths
+		uint col_id = tbl.get_field_col("id");
+		uint col_tag = tbl.get_field_col("tag");
+		
+		rst::cell cl = tbl.get_cell_at(2, col_id);
+		check(cl.len == 3);
+		check(0 == memcmp(cl.str, "a\0b", 3));
+		
+		std::vector<rst::cell> cells;
+		for (uint row = 1; row <= lines.size(); ++row)
+		{
+			tbl.get_row(row, cells);
+			check(cells.size() == 4);
+			check(cells[col_id].len == lines[row-1][0].size());
+			check(cells[col_tag].len == lines[row-1][1].size());
+			check(std::string(cells[col_tag].str, cells[col_tag].len) ==
+				lines[row-1][1]
+			);
+		}
+		
+		std::vector<uint> rows{5, 1, 3};
+		tbl.get_rows(rows, cells);
+		check(cells.size() == 12);
+		check(cells[col_tag].len == 2);
+		check(cells[4 + col_id].len == 1);
+		check(cells[8 + col_id].len == 3);
+	}
+	
+	return true;
+}
+
+static bool test_ro_string_table_interning(void)
+{
+	typedef ro_string_table rst;
+	typedef rst::field_pair fp;
+	
+	std::vector<rst::field_info> fields{
+		rst::field_info("id", true).use_interning(),
+		rst::field_info("type").use_interning(),
+		rst::field_info("country", false, rst::TYPE_STRING, 0,
+			rst::COLL_FOLD_ASCII
+		).use_interning().use_filter(),
+		rst::field_info("code").use_index(rst::INDEX_DICTIONARY)
+			.use_interning(),
+		rst::field_info("note")
+	};
+	std::vector<rst::field_info> plain_fields{
+		rst::field_info("id", true),
+		rst::field_info("type"),
+		rst::field_info("country", false, rst::TYPE_STRING, 0,
+			rst::COLL_FOLD_ASCII
+		),
+		rst::field_info("code").use_index(rst::INDEX_DICTIONARY),
+		rst::field_info("note")
+	};
+	
+	const uint lines = 10000;
+	const char * countries[] = {"US", "us", "germany"};
+	std::vector<std::vector<std::string>> rows;
+	for (uint i = 0; i < lines; ++i)
+	{
+		rows.push_back({
+			"id_" + std::to_string(i),
+			"type_" + std::to_string(i % 10),
+			countries[i % 3],
+			"code_" + std::to_string(i % 4),
+			"note"
+		});
+	}
+	
+	ro_string_table tbl(lines + 1, fields);
+	ro_string_table plain(lines + 1, plain_fields);
+	ro_string_table lens(lines + 1, fields, 0, rst::POOL_LENGTHS);
+	for (auto& row : rows)
+	{
+		for (auto& str : row)
+		{
+			tbl.append(str);
+			plain.append(str);
+			lens.append(str);
+		}
+	}
+	
+	try {tbl.is_interned("type"); check(didnt_throw);}
+	catch(std::runtime_error& e)
+	{
+		std::string expected("ro_string_table: lookup before seal()");
+		check(expected == e.what());
+	}
+	
+	tbl.seal();
+	plain.seal();
+	lens.seal();
+	
+	{ // the ids were too many to intern
+		check(tbl.is_interned("type"));
+		check(tbl.is_interned("country"));
+		check(tbl.is_interned("code"));
+		check(!tbl.is_interned("id"));
+		check(!tbl.is_interned("note"));
+		check(!plain.is_interned("type"));
+		check(tbl.get_pool_size() * 2 < plain.get_pool_size());
+		check(lens.get_pool_size() * 2 < plain.get_pool_size());
+	}
+	
+	{ // equal values share their string
+		uint col = tbl.get_field_col("type");
+		check(tbl.get_str_at(1, col) == tbl.get_str_at(11, col));
+		check(tbl.get_str_at(1, col) != tbl.get_str_at(2, col));
+		check(plain.get_str_at(1, col) != plain.get_str_at(11, col));
+	}
+	
+	{ // lookups don't change
+		std::vector<fp> targets{fp("type"), fp("country")};
+		check(tbl.lookup_unique(fp("id", "id_42"), targets));
+		check(std::string(targets[0].field_value) == "type_2");
+		check(std::string(targets[1].field_value) == "US");
+		
+		bool all_same = true;
+		const char * probes[][2] = {
+			{"type", "type_3"}, {"type", "type_10"}, {"country", "us"},
+			{"country", "GERMANY"}, {"country", "france"}, {"code", "code_1"},
+			{"code", "code_4"}, {"note", "note"}, {"id", "id_9999"}
+		};
+		for (auto& probe : probes)
+		{
+			size_t expected = plain.count(fp(probe[0], probe[1]));
+			all_same = all_same &&
+				tbl.count(fp(probe[0], probe[1])) == expected &&
+				lens.count(fp(probe[0], probe[1])) == expected;
+		}
+		check(all_same);
+		check(tbl.count(fp("type", "type_3")) == lines / 10);
+		check(tbl.count(fp("country", "us")) == 6667);
+		
+		std::vector<uint> rows_a, rows_b;
+		check(tbl.lookup_in("type", {"type_1", "type_7"}, rows_a));
+		check(plain.lookup_in("type", {"type_1", "type_7"}, rows_b));
+		check(rows_a == rows_b);
+	}
+	
+	{ // cells still get their lengths
+		std::vector<rst::cell> a, b, c;
+		bool all_same = true;
+		for (uint row = 1; row <= lines; row += 97)
+		{
+			tbl.get_row(row, a);
+			plain.get_row(row, b);
+			lens.get_row(row, c);
+			for (uint col = 0; col < a.size(); ++col)
+			{
+				all_same = all_same &&
+					a[col].len == b[col].len &&
+					c[col].len == b[col].len &&
+					std::string(a[col].str) == b[col].str;
+			}
+		}
+		check(all_same);
+		
+		std::vector<uint> some{lines, 1, 5000};
+		tbl.get_rows(some, a);
+		plain.get_rows(some, b);
+		check(a.size() == b.size());
+		for (uint i = 0; i < a.size(); ++i)
+			all_same = all_same && a[i].len == b[i].len;
+		check(all_same);
+	}
+	
+	{ // values are matched by all of their bytes, '\0' and all
+		std::vector<rst::field_info> one{rst::field_info("v").use_interning()};
+		ro_string_table nul(5, one, 0, rst::POOL_LENGTHS);
+		nul.append("a\0b", 3);
+		nul.append("a", 1);
+		nul.append("a\0c", 3);
+		nul.append("a\0b", 3);
+		nul.seal();
+		
+		check(nul.get_str_at(1, 0) == nul.get_str_at(4, 0));
+		check(nul.get_str_at(1, 0) != nul.get_str_at(2, 0));
+		check(nul.get_str_at(1, 0) != nul.get_str_at(3, 0));
+		check(nul.get_cell_at(2, 0).len == 1);
+		check(nul.get_cell_at(3, 0).len == 3);
+		check(0 == memcmp(nul.get_str_at(3, 0), "a\0c", 3));
+	}
+	
+	return true;
+}
+
+static bool test_ro_string_table_front_coded(void)
+{
+	typedef ro_string_table rst;
+	typedef rst::field_pair fp;
+	
+	// the same values in sorted and front coded fields, so every lookup can
+	// be checked against the other
+	std::vector<rst::field_info> fields{
+		rst::field_info("id", true),
+		rst::field_info("id_fc", true).use_index(rst::INDEX_FRONT_CODED)
+			.use_filter(),
+		rst::field_info("sku"),
+		rst::field_info("sku_fc").use_index(rst::INDEX_FRONT_CODED),
+		rst::field_info("name", false, rst::TYPE_STRING, 0,
+			rst::COLL_FOLD_ASCII
+		).use_index(rst::INDEX_FRONT_CODED)
+	};
+	
+	const uint lines = 5000;
+	ro_string_table tbl(lines + 1, fields);
+	
+	for (uint i = 0; i < lines; ++i)
+	{
+		std::string id = "user/" + std::to_string(100000 + i * 3);
+		std::string sku = "sku-" + std::to_string(i % 613);
+		tbl.append(id);
+		tbl.append(id);
+		tbl.append(sku);
+		tbl.append(sku);
+		tbl.append((i % 2) ? "Name" : "NAME");
+	}
+	tbl.seal();
+	
+	rst::front_coded_stats stats{0, 0};
+	check(tbl.get_front_coded_stats("id_fc", stats));
+	check(stats.blocks == (lines + 31) / 32);
+	// smaller than the eight bytes a value of the sorted field
+	check(stats.bytes > 0 && stats.bytes < lines * 8);
+	check(tbl.get_front_coded_stats("sku_fc", stats));
+	check(!tbl.get_front_coded_stats("id", stats));
+	check(!tbl.get_front_coded_stats("name", stats));
+	
+	std::vector<std::string> probes{"", "a", "user", "user/", "user/1",
+		"user/100000", "user/100001", "user/114997", "user/114998", "user/2",
+		"sku-", "sku-1", "sku-612", "sku-613", "sku-99", "zzz"
+	};
+	for (uint i = 0; i < lines; i += 37)
+	{
+		probes.push_back("user/" + std::to_string(100000 + i * 3));
+		probes.push_back("sku-" + std::to_string(i % 613));
+	}
+	
+	bool all_same = true;
+	for (auto& probe : probes)
+	{
+		const char * val = probe.c_str();
+		const char * pairs[][2] = {{"id", "id_fc"}, {"sku", "sku_fc"}};
+		for (auto& pair : pairs)
+		{
+			all_same = all_same &&
+				tbl.count(fp(pair[0], val)) == tbl.count(fp(pair[1], val));
+			
+			rst::eq_range_view v1, v2;
+			tbl.lookup_prefix(fp(pair[0], val), v1);
+			tbl.lookup_prefix(fp(pair[1], val), v2);
+			all_same = all_same && v1.size() == v2.size();
+			
+			tbl.lookup_range(pair[0], val, "user/11", v1, rst::INCL_LOW);
+			tbl.lookup_range(pair[1], val, "user/11", v2, rst::INCL_LOW);
+			all_same = all_same && v1.size() == v2.size();
+			
+			tbl.lookup_range(pair[0], "sku-2", val, v1, rst::INCL_BOTH);
+			tbl.lookup_range(pair[1], "sku-2", val, v2, rst::INCL_BOTH);
+			all_same = all_same && v1.size() == v2.size();
+			
+			tbl.lookup_range(pair[0], val, nullptr, v1, rst::INCL_NONE);
+			tbl.lookup_range(pair[1], val, nullptr, v2, rst::INCL_NONE);
+			all_same = all_same && v1.size() == v2.size();
+			
+			tbl.lookup_range(pair[0], nullptr, val, v1, rst::INCL_NONE);
+			tbl.lookup_range(pair[1], nullptr, val, v2, rst::INCL_NONE);
+			all_same = all_same && v1.size() == v2.size();
+		}
+	}
+	check(all_same);
+	
+	{ // rows are found as with the sorted field
+		std::vector<fp> targets{fp("id"), fp("sku")};
+		check(tbl.lookup_unique(fp("id_fc", "user/100042"), targets));
+		check(std::string(targets[0].field_value) == "user/100042");
+		check(std::string(targets[1].field_value) == "sku-14");
+		check(!tbl.lookup_unique(fp("id_fc", "user/100043"), targets));
+		check(!tbl.lookup_unique(fp("id_fc", "user/10004"), targets));
+		
+		std::vector<rst::eq_range_result> results{rst::eq_range_result("id")};
+		check(tbl.lookup_equal_range(fp("sku_fc", "sku-14"), results));
+		check(results[0].values.size() == 9);
+		check(std::string(results[0].values[0]) == "user/100042");
+		
+		check(tbl.exists(fp("id_fc", "user/114997")));
+		check(!tbl.exists(fp("id_fc", "user/114997 ")));
+	}
+	
+	{ // rows come through the data map in the same order
+		std::vector<const char *> values{"sku-7", "sku-600", "sku-x", "sku-7"};
+		std::vector<uint> rows_a, rows_b;
+		check(tbl.lookup_in("sku", values, rows_a));
+		check(tbl.lookup_in("sku_fc", values, rows_b));
+		check(rows_a == rows_b);
+		
+		rst::ordered_cursor ca, cb;
+		tbl.order_by("sku", "sku-5", ca, rst::ORDER_DESC);
+		tbl.order_by("sku_fc", "sku-5", cb, rst::ORDER_DESC);
+		check(ca.count() == cb.count());
+		check(ca.skip(100) == cb.skip(100));
+		check(ca.next(2000, rows_a) == cb.next(2000, rows_b));
+		check(rows_a == rows_b);
+		
+		std::vector<rst::value_count> groups_a, groups_b;
+		tbl.group_counts("sku", groups_a);
+		tbl.group_counts("sku_fc", groups_b, 2);
+		check(groups_a.size() == 613 && groups_a.size() == groups_b.size());
+		for (uint i = 0; i < groups_a.size(); ++i)
+		{
+			all_same = all_same && groups_a[i].count == groups_b[i].count &&
+				0 == strcmp(groups_a[i].value, groups_b[i].value);
+		}
+		check(all_same);
+	}
+	
+	{ // values which differ only after a '\0'
+		std::vector<rst::field_info> len_fields{
+			rst::field_info("key", true),
+			rst::field_info("key_fc", true).use_index(rst::INDEX_FRONT_CODED)
+		};
+		std::vector<std::string> keys{std::string("a"), std::string("a\0b", 3),
+			std::string("a\0c", 3), std::string("ab"), std::string("")
+		};
+		ro_string_table lens(keys.size() + 1, len_fields, 0, rst::POOL_LENGTHS);
+		for (auto& key : keys)
+		{
+			lens.append(key);
+			lens.append(key);
+		}
+		lens.seal();
+		
+		for (auto& key : keys)
+		{
+			fp source("key_fc", key.c_str());
+			source.value_len = key.size();
+			std::vector<fp> targets{fp("key")};
+			all_same = all_same && lens.lookup_unique(source, targets) &&
+				targets[0].value_len == key.size() &&
+				0 == memcmp(targets[0].field_value, key.data(), key.size());
+		}
+		check(all_same);
+		
+		fp prefix("key_fc", "a\0", 2);
+		check(lens.count(prefix) == 0);
+		rst::eq_range_view view;
+		check(lens.lookup_prefix(prefix, view));
+		check(view.size() == 2);
+	}
+	
+	// not front coded, but still the collation
+	check(tbl.count(fp("name", "name")) == lines);
+	
+	return true;
+}
+
+static bool same_strings(const std::vector<const char *>& a,
+	const std::vector<const char *>& b
+)
+{
+	if (a.size() != b.size())
+		return false;
+	for (size_t i = 0; i < a.size(); ++i)
+	{
+		if (strcmp(a[i], b[i]) != 0)
+			return false;
+	}
+	return true;
+}
+
+static bool test_ro_string_table_compressed_pool(void)
+{
+	typedef ro_string_table rst;
+	typedef rst::field_pair fp;
+	
+	// every kind of field, so each lookup can be checked against a plain
+	// table with the same values
+	bool is_unique = true;
+	std::vector<rst::field_info> fields{
+		rst::field_info("id", is_unique).use_fuzzy().use_substrings(),
+		rst::field_info("name", !is_unique, rst::TYPE_STRING, 0,
+			rst::COLL_FOLD_ASCII
+		),
+		rst::field_info("type").use_index(rst::INDEX_DICTIONARY),
+		rst::field_info("city").use_interning().use_fuzzy().use_substrings(),
+		rst::field_info("sku").use_index(rst::INDEX_FRONT_CODED),
+		rst::field_info("code").use_index(rst::INDEX_LEARNED),
+		rst::field_info("region").index_with({"sku"})
+	};
+	
+	const uint lines = 3000;
+	const char * cities[] = {"Berlin", "Bern", "Boston", "Austin", "Paris"};
+	const char * names[] = {"Apple", "apple", "Pear", "pEAR", "Plum"};
+	ro_string_table plain(lines + 1, fields);
+	ro_string_table packed(lines + 1, fields, 0, rst::POOL_COMPRESSED);
+	for (uint i = 0; i < lines; ++i)
+	{
+		std::vector<std::string> row{
+			"order/" + std::to_string(200000 + i * 7),
+			names[i % 5],
+			"type_" + std::to_string(i % 6),
+			cities[i % 5],
+			"sku-" + std::to_string(i % 211),
+			std::to_string(100000 + i * 13),
+			(i % 3) ? "eu" : "us"
+		};
+		for (auto& str : row)
+		{
+			plain.append(str);
+			packed.append(str);
+		}
+	}
+	
+	try {packed.append("a\0b", 3); check(didnt_throw);}
+	catch (std::runtime_error& e)
+	{
+		std::string expected("ro_string_table: append() of a value with '\\0' needs POOL_LENGTHS");
+		check(expected == e.what());
+	}
+	
+	plain.seal();
+	packed.seal();
+	
+	check(packed.get_pool_mode() == rst::POOL_COMPRESSED);
+	check(packed.get_pool_size() * 3 < plain.get_pool_size() * 2);
+	
+	rst::value_buffer buf;
+	{ // the names stay plain, the values are decompressed in the buffer
+		try {packed.get_str_at(1, 0); check(didnt_throw);}
+		catch (std::runtime_error& e)
+		{
+			std::string expected("ro_string_table: no value_buffer for a table with POOL_COMPRESSED");
+			check(expected == e.what());
+		}
+		
+		std::vector<fp> none{fp("name")};
+		try {packed.lookup_unique(fp("id", "zzz"), none); check(didnt_throw);}
+		catch (std::runtime_error& e)
+		{
+			std::string expected("ro_string_table: no value_buffer for a table with POOL_COMPRESSED");
+			check(expected == e.what());
+		}
+		
+		uint cols = plain.get_num_cols();
+		bool all_same = true;
+		for (uint col = 0; col < cols; ++col)
+		{
+			all_same = all_same &&
+				0 == strcmp(packed.get_str_at(0, col, &buf),
+					plain.get_str_at(0, col)
+				);
+		}
+		for (uint row = 1; row <= lines; row += 41)
+		{
+			for (uint col = 0; col < cols; ++col)
+			{
+				rst::cell cell = packed.get_cell_at(row, col, &buf);
+				all_same = all_same &&
+					0 == strcmp(packed.get_str_at(row, col, &buf),
+						plain.get_str_at(row, col)
+					) &&
+					cell.len == strlen(plain.get_str_at(row, col));
+			}
+		}
+		check(all_same);
+		
+		// the values stay until the buffer is cleared, whatever is
+		// decompressed after them
+		const char * a = packed.get_str_at(1, 0, &buf);
+		const char * b = packed.get_str_at(1, 0, &buf);
+		std::vector<fp> targets{fp("name"), fp("sku")};
+		check(packed.lookup_unique(fp("id", "order/200007"), targets, &buf));
+		check(std::string(a) == "order/200000" && a != b);
+		check(std::string(b) == "order/200000");
+		check(std::string(targets[0].field_value) == "apple");
+		check(std::string(targets[1].field_value) == "sku-1");
+		
+		size_t held = buf.size();
+		check(held > rst::value_buffer::KEEP);
+		buf.clear();
+		check(0 == buf.size());
+		check(std::string(packed.get_str_at(2, 1, &buf)) == "apple");
+		check(1 == buf.size());
+		buf.clear();
+		
+		std::vector<rst::cell> ca, cb;
+		std::vector<uint> rows{lines, 0, 1, 777};
+		packed.get_rows(rows, ca, &buf);
+		plain.get_rows(rows, cb);
+		check(ca.size() == cb.size());
+		for (uint i = 0; i < ca.size(); ++i)
+		{
+			all_same = all_same && ca[i].len == cb[i].len &&
+				0 == strcmp(ca[i].str, cb[i].str);
+		}
+		packed.get_row(lines, ca, &buf);
+		plain.get_row(lines, cb);
+		for (uint i = 0; i < ca.size(); ++i)
+			all_same = all_same && 0 == strcmp(ca[i].str, cb[i].str);
+		check(all_same);
+	}
+	
+	std::vector<std::string> probes{"", "a", "apple", "PEAR", "Plum ",
+		"type_0", "type_5", "type_6", "Bern", "Berlin", "berlin", "sku-",
+		"sku-1", "sku-210", "sku-211", "eu", "us", "order/2", "order/200007",
+		"order/200008", "100013", "1", "zzz"
+	};
+	for (uint i = 0; i < lines; i += 97)
+	{
+		probes.push_back("order/" + std::to_string(200000 + i * 7));
+		probes.push_back(std::to_string(100000 + i * 13));
+	}
+	
+	bool all_same = true;
+	const char * field_names[] = {"id", "name", "type", "city", "sku", "code",
+		"region"
+	};
+	for (auto& probe : probes)
+	{
+		const char * val = probe.c_str();
+		buf.clear();
+		for (auto name : field_names)
+		{
+			all_same = all_same &&
+				packed.count(fp(name, val)) == plain.count(fp(name, val)) &&
+				packed.exists(fp(name, val)) == plain.exists(fp(name, val));
+			
+			std::vector<rst::eq_range_result> ra{rst::eq_range_result("id"),
+				rst::eq_range_result("city")
+			};
+			std::vector<rst::eq_range_result> rb(ra);
+			bool found = plain.lookup_equal_range(fp(name, val), rb);
+			all_same = all_same &&
+				packed.lookup_equal_range(fp(name, val), ra, &buf) == found &&
+				same_strings(ra[0].values, rb[0].values) &&
+				same_strings(ra[1].values, rb[1].values);
+			
+			rst::eq_range_view va, vb;
+			if (strcmp(name, "type") != 0)
+			{
+				packed.lookup_prefix(fp(name, val), va);
+				plain.lookup_prefix(fp(name, val), vb);
+				all_same = all_same && va.size() == vb.size();
+				
+				packed.lookup_range(name, val, "sku-5", va, rst::INCL_LOW);
+				plain.lookup_range(name, val, "sku-5", vb, rst::INCL_LOW);
+				all_same = all_same && va.size() == vb.size();
+				for (size_t i = 0; i < va.size() && i < 50; ++i)
+				{
+					all_same = all_same &&
+						0 == strcmp(va.value_at(i, 4, &buf), vb.value_at(i, 4));
+				}
+			}
+		}
+		
+		// the suffix arrays read the values they search from the pool
+		for (auto name : {"id", "city"})
+		{
+			std::vector<uint> rows_a, rows_b;
+			all_same = all_same &&
+				packed.lookup_contains(fp(name, val), rows_a) ==
+					plain.lookup_contains(fp(name, val), rows_b) &&
+				rows_a == rows_b;
+		}
+		
+		std::vector<fp> ta{fp("name"), fp("sku")};
+		std::vector<fp> tb(ta);
+		bool found = plain.lookup_unique(fp("id", val), tb);
+		all_same = all_same &&
+			packed.lookup_unique(fp("id", val), ta, &buf) == found;
+		if (found)
+		{
+			all_same = all_same &&
+				0 == strcmp(ta[0].field_value, tb[0].field_value) &&
+				0 == strcmp(ta[1].field_value, tb[1].field_value);
+		}
+	}
+	check(all_same);
+	
+	{ // lists, composites and fuzzy lookups
+		std::vector<const char *> values{"pear", "Plum", "kiwi", "PEAR"};
+		std::vector<uint> rows_a, rows_b;
+		check(packed.lookup_in("name", values, rows_a, rst::IN_DEDUP));
+		check(plain.lookup_in("name", values, rows_b, rst::IN_DEDUP));
+		check(rows_a == rows_b && rows_a.size() == lines * 3 / 5);
+		
+		std::vector<fp> keys{fp("region", "us"), fp("sku", "sku-3")};
+		std::vector<rst::eq_range_result> ra{rst::eq_range_result("id")};
+		std::vector<rst::eq_range_result> rb(ra);
+		check(packed.lookup_composite(keys, ra, &buf));
+		check(plain.lookup_composite(keys, rb));
+		check(same_strings(ra[0].values, rb[0].values));
+		
+		std::vector<rst::fuzzy_match> fa, fb;
+		check(packed.lookup_fuzzy(fp("city", "Bernn"), 2, fa, &buf));
+		check(plain.lookup_fuzzy(fp("city", "Bernn"), 2, fb));
+		check(fa.size() == fb.size() && fa.size() == 2);
+		for (uint i = 0; i < fa.size(); ++i)
+		{
+			check(0 == strcmp(fa[i].value, fb[i].value));
+			check(fa[i].distance == fb[i].distance);
+			check(fa[i].count == fb[i].count);
+		}
+		check(packed.lookup_nearest(fp("id", "order/200015"), 3, fa, &buf));
+		check(std::string(fa[0].value) == "order/200014");
+	}
+	
+	{ // groups and cursors get their own values
+		const char * group_fields[] = {"name", "type", "city", "sku", "id"};
+		for (auto name : group_fields)
+		{
+			std::vector<rst::value_count> ga, gb;
+			buf.clear();
+			packed.group_counts(name, ga, 3, &buf);
+			plain.group_counts(name, gb, 1);
+			all_same = all_same && ga.size() == gb.size();
+			for (uint i = 0; i < ga.size() && i < gb.size(); ++i)
+			{
+				all_same = all_same && ga[i].count == gb[i].count &&
+					0 == strcmp(ga[i].value, gb[i].value);
+			}
+			
+			packed.group_top(name, 4, ga, 2, &buf);
+			plain.group_top(name, 4, gb, 1);
+			all_same = all_same && ga.size() == gb.size();
+			for (uint i = 0; i < ga.size() && i < gb.size(); ++i)
+			{
+				all_same = all_same && ga[i].count == gb[i].count &&
+					0 == strcmp(ga[i].value, gb[i].value);
+			}
+			
+			rst::group_cursor ca, cb;
+			packed.group_by(name, ca);
+			plain.group_by(name, cb);
+			while (!cb.at_end())
+			{
+				ca.next(7, ga);
+				cb.next(7, gb);
+				all_same = all_same && ga.size() == gb.size();
+				for (uint i = 0; i < ga.size() && i < gb.size(); ++i)
+					all_same = all_same && 0 == strcmp(ga[i].value, gb[i].value);
+			}
+			all_same = all_same && ca.at_end();
+		}
+		check(all_same);
+		
+		rst::ordered_cursor oa, ob;
+		packed.order_by("sku", "sku-5", oa, rst::ORDER_DESC);
+		plain.order_by("sku", "sku-5", ob, rst::ORDER_DESC);
+		check(oa.count() == ob.count());
+		std::vector<rst::eq_range_result> ra{rst::eq_range_result("sku"),
+			rst::eq_range_result("name")
+		};
+		std::vector<rst::eq_range_result> rb(ra);
+		while (ob.remaining())
+		{
+			oa.next(100, ra);
+			ob.next(100, rb);
+			all_same = all_same &&
+				same_strings(ra[0].values, rb[0].values) &&
+				same_strings(ra[1].values, rb[1].values);
+		}
+		check(all_same);
+		
+		rst::eq_range_cursor ea, eb;
+		check(packed.lookup_equal_range(fp("type", "type_2"), ea));
+		check(plain.lookup_equal_range(fp("type", "type_2"), eb));
+		check(ea.count() == eb.count());
+		while (eb.remaining())
+		{
+			ea.next(64, ra);
+			eb.next(64, rb);
+			all_same = all_same &&
+				same_strings(ra[0].values, rb[0].values) &&
+				same_strings(ra[1].values, rb[1].values);
+		}
+		check(all_same);
+	}
+	
+	{ // a small pool to start with grows as with POOL_PLAIN
+		std::vector<rst::field_info> few{rst::field_info("key", is_unique)};
+		ro_string_table tbl(4, few, 8, rst::POOL_COMPRESSED);
+		const char * keys[] = {"a", "bb", "a longer value than the pool"};
+		for (auto key : keys)
+			tbl.append(key);
+		tbl.seal();
+		
+		std::vector<fp> targets{fp("key")};
+		for (auto key : keys)
+		{
+			check(tbl.lookup_unique(fp("key", key), targets, &buf));
+			check(0 == strcmp(targets[0].field_value, key));
+		}
+		check(!tbl.exists(fp("key", "b")));
+	}
+	
+	return true;
+}
+
 static int passed, failed;
 void run_test_ro_string_table(void)
 {
@@ -117,12 +117,80 @@ class sort_vector
 	   is used instead of _compar.
 	*/
 
+    size_t lower_bound(const T& dummy,
+		gen_comp_less_ctx_lower_bound<T, TContextLookup>& lower_bound_cmp
+	)
+    {return _bound(dummy, lower_bound_cmp, true);}
+    
+    size_t upper_bound(const T& dummy,
+		gen_comp_less_ctx_upper_bound<T, TContextLookup>& upper_bound_cmp
+	)
+    {return _bound(dummy, upper_bound_cmp, false);}
+	/*
+	   Return the index of the first element not less than, and greater than,
+	   the context value respectively, or size() if there is no such element.
+	   Like equal_range(), these are meant for context lookups, so the value
+	   of dummy is ignored. The context has to be set in the comparison
+	   object.
+	*/
+	
+	bool equal_range(const T& dummy,
+		std::pair<size_t, size_t>& out,
+		equal_range_ctx_compars& compars,
+		const std::pair<size_t, size_t>& near
+	)
+	{return _equal_range_near(dummy, out, compars, near);}
+	
+    bool lookup(const T& dummy,
+		const T ** out,
+		gen_comp_less_ctx_lower_bound<T, TContextLookup>& lower_bound_cmp,
+		const std::pair<size_t, size_t>& near
+	)
+    {return _lookup_near(dummy, out, lower_bound_cmp, near);}
+	
+    size_t lower_bound(const T& dummy,
+		gen_comp_less_ctx_lower_bound<T, TContextLookup>& lower_bound_cmp,
+		const std::pair<size_t, size_t>& near
+	)
+    {return _bound_near(dummy, lower_bound_cmp, true, near);}
+    
+    size_t upper_bound(const T& dummy,
+		gen_comp_less_ctx_upper_bound<T, TContextLookup>& upper_bound_cmp,
+		const std::pair<size_t, size_t>& near
+	)
+    {return _bound_near(dummy, upper_bound_cmp, false, near);}
+	/*
+	   Like the above, but the search starts between the positions near.first
+	   and near.second, where the caller expects the lower bound to be, e.g.
+	   from a model of the data. If the bound turns out to be outside, the
+	   range is widened towards it in steps which double each time, so the
+	   result is always the same as without near, and costs about the log of
+	   how far off near was. For equal_range() the upper bound is searched
+	   from the lower bound on.
+	*/
+
     void reserve(size_t how_many)
     {_vect.reserve(how_many);}
 
+    void clear()
+    {
+        _vect.clear();
+        _vect.shrink_to_fit();
+        _sorted = false;
+    }
+    /* Removes all elements and frees their memory. */
+
     const T& get(int index) const
     {return _vect[index];}
 
+    void set(int index, const T& what)
+    {_vect[index] = what;}
+    /* Replaces an element by one which sorts to the same place. */
+
+    const T * data() const
+    {return _vect.data();}
+    /* The elements in sorted order, if sealed. Valid until the next append(). */
+
     size_t size() const
     {return _vect.size();}
 
@@ -156,6 +224,30 @@ class sort_vector
 		return false; // make gcc happy
 	}
     
+    template <typename TCompar>
+    size_t _bound(const T& what, TCompar& compar, bool is_lower)
+	{
+		/*
+		   A template, so compar is passed to the stl algorithms as its own
+		   type, rather than sliced down to gen_comp_less.
+		*/
+		if (_sorted)
+		{
+			auto begin = _vect.begin();
+			auto end = _vect.end();
+			
+			auto found = (is_lower) ?
+				std::lower_bound(begin, end, what, compar) :
+				std::upper_bound(begin, end, what, compar);
+			
+			return (found - begin);
+		}
+		else
+			_throw(throw_str("bound on unsorted data"));
+			
+		return 0; // make gcc happy
+	}
+	
     bool _lookup(const T& what,
 		const T ** out,
 		gen_comp_less<T, TContextLookup>& compar
@@ -183,6 +275,95 @@ class sort_vector
 		return false; // make gcc happy
     }
 
+    template <typename TIsBefore>
+    size_t _partition_near(TIsBefore is_before,
+		const std::pair<size_t, size_t>& near
+	)
+    {
+		size_t size = _vect.size();
+		size_t lo = std::min(near.first, size);
+		size_t hi = std::min(std::max(near.second, lo), size);
+		
+		// the bound is at most hi while the element before lo is not before
+		for (size_t step = 1; lo > 0 && !is_before(_vect[lo-1]); step *= 2)
+		{
+			hi = lo - 1;
+			lo = (hi > step) ? hi - step : 0;
+		}
+		
+		// and more than hi while the element at hi is
+		for (size_t step = 1; hi < size && is_before(_vect[hi]); step *= 2)
+		{
+			lo = hi + 1;
+			hi = std::min(lo + step, size);
+		}
+		
+		auto begin = _vect.begin();
+		return std::partition_point(begin + lo, begin + hi, is_before) - begin;
+	}
+	
+    template <typename TCompar>
+    size_t _bound_near(const T& what,
+		TCompar& compar,
+		bool is_lower,
+		const std::pair<size_t, size_t>& near
+	)
+	{
+		if (!_sorted)
+			_throw(throw_str("bound on unsorted data"));
+		
+		if (is_lower)
+		{
+			return _partition_near(
+				[&compar, &what](const T& elem) {return compar(elem, what);},
+				near
+			);
+		}
+		return _partition_near(
+			[&compar, &what](const T& elem) {return !compar(what, elem);},
+			near
+		);
+	}
+	
+    bool _equal_range_near(const T& what,
+		std::pair<size_t, size_t>& out,
+		equal_range_ctx_compars& compars,
+		const std::pair<size_t, size_t>& near
+	)
+	{
+		if (!_sorted)
+			_throw(throw_str("equal_range on unsorted data"));
+		
+		compars.set_context();
+		out.first = _bound_near(what, compars.lower_bound_cmp, true, near);
+		out.second = _bound_near(what,
+			compars.upper_bound_cmp,
+			false,
+			std::make_pair(out.first, std::max(out.first, near.second))
+		);
+		return (out.first != out.second);
+	}
+	
+    bool _lookup_near(const T& what,
+		const T ** out,
+		gen_comp_less_ctx_lower_bound<T, TContextLookup>& compar,
+		const std::pair<size_t, size_t>& near
+	)
+    {
+		if (!_sorted)
+			_throw(throw_str("lookup on unsorted data"));
+		
+		size_t found = _bound_near(what, compar, true, near);
+		if (found < _vect.size() &&
+			(compar.three_way_cmp(_vect[found], what) == 0)
+		)
+		{
+			*out = &_vect[found];
+			return true;
+		}
+		return false;
+	}
+	
 	void _throw(const char * str)
 	{throw std::runtime_error(str);}
 
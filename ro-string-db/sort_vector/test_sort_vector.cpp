@@ -3,10 +3,12 @@
 
 static bool test_sort_vector_lookup(void);
 static bool test_sort_vector_equal_range(void);
+static bool test_sort_vector_near(void);
 
 static ftest tests[] = {
 	test_sort_vector_lookup,
 	test_sort_vector_equal_range,
+	test_sort_vector_near,
 };
 
 static bool didnt_throw = false;
@@ -92,6 +94,17 @@ static bool test_sort_vector_equal_range(void)
 		check(expected == e.what());
 	}
 	
+	try
+	{
+		sort_vect.lower_bound(my_int_in_a_struct, ctx_lower);
+		check(didnt_throw);
+	}
+	catch(std::runtime_error& e)
+	{
+		std::string expected("sort_vector: bound on unsorted data");
+		check(expected == e.what());
+	}
+	
 	sort_vect.seal();
 	
 	int sorted[] = {1, 5, 5, 5, 6, 9, 9};
@@ -148,6 +161,22 @@ static bool test_sort_vector_equal_range(void)
 	for (size_t i = pres.first; i < pres.second; ++i)
 		check(sort_vect.get(i).i == 9);
 	
+	// lower and upper bound alone
+	ctx_lower.set_context(5);
+	ctx_upper.set_context(5);
+	check(sort_vect.lower_bound(my_int_in_a_struct, ctx_lower) == 1);
+	check(sort_vect.upper_bound(my_int_in_a_struct, ctx_upper) == 4);
+	
+	ctx_lower.set_context(7);
+	ctx_upper.set_context(7);
+	check(sort_vect.lower_bound(my_int_in_a_struct, ctx_lower) == 5);
+	check(sort_vect.upper_bound(my_int_in_a_struct, ctx_upper) == 5);
+	
+	ctx_lower.set_context(100);
+	ctx_upper.set_context(-100);
+	check(sort_vect.lower_bound(my_int_in_a_struct, ctx_lower) == 7);
+	check(sort_vect.upper_bound(my_int_in_a_struct, ctx_upper) == 0);
+	
 	eq_range.change_context(1000);
 	check(!sort_vect.equal_range(my_int_in_a_struct, pres, eq_range));
 	check(pres.first == 7);
@@ -251,6 +280,88 @@ static bool test_sort_vector_lookup(void)
 	return true;
 }
 
+static bool test_sort_vector_near(void)
+{
+	auto cmp = [](const int_in_a_struct& lhs,
+		const int_in_a_struct& rhs,
+		int context
+	)
+	{
+		int a = lhs.i;
+		int b = context;
+		return ((a > b) - (a < b));
+	};
+	
+	gen_comp_less<int_in_a_struct, int> normal_less(
+		[](const int_in_a_struct& lhs,
+			const int_in_a_struct& rhs,
+			int context
+		)
+		{return ((lhs.i > rhs.i) - (lhs.i < rhs.i));}
+	);
+	
+	gen_comp_less_ctx_lower_bound<int_in_a_struct, int> ctx_lower(cmp);
+	gen_comp_less_ctx_upper_bound<int_in_a_struct, int> ctx_upper(cmp);
+	
+	int_in_a_struct dummy(0);
+	sort_vector<int_in_a_struct, int> sort_vect(normal_less);
+	
+	try
+	{
+		sort_vect.lower_bound(dummy, ctx_lower, std::make_pair(0, 0));
+		check(didnt_throw);
+	}
+	catch(std::runtime_error& e)
+	{
+		std::string expected("sort_vector: bound on unsorted data");
+		check(expected == e.what());
+	}
+	
+	// even numbers from 0 to 198, each one three times
+	for (int i = 0; i < 300; ++i)
+		sort_vect.append(int_in_a_struct((i % 100) * 2));
+	sort_vect.seal();
+	
+	size_t size = sort_vect.size();
+	std::vector<std::pair<size_t, size_t>> nears{
+		{0, 0}, {0, size}, {size, size}, {150, 151}, {7, 3}, {500, 900}
+	};
+	
+	bool all_same = true;
+	for (int val = -1; val <= 200; ++val)
+	{
+		ctx_lower.set_context(val);
+		ctx_upper.set_context(val);
+		size_t lower = sort_vect.lower_bound(dummy, ctx_lower);
+		size_t upper = sort_vect.upper_bound(dummy, ctx_upper);
+		
+		std::vector<std::pair<size_t, size_t>> tries(nears);
+		tries.push_back(std::make_pair(lower, lower + 1));
+		tries.push_back(std::make_pair(lower > 5 ? lower - 5 : 0, lower + 5));
+		for (auto& near : tries)
+		{
+			all_same = all_same &&
+				sort_vect.lower_bound(dummy, ctx_lower, near) == lower &&
+				sort_vect.upper_bound(dummy, ctx_upper, near) == upper;
+			
+			sort_vector<int_in_a_struct, int>::equal_range_ctx_compars
+				compars(ctx_lower, ctx_upper, val);
+			std::pair<size_t, size_t> range;
+			bool found = sort_vect.equal_range(dummy, range, compars, near);
+			all_same = all_same && found == (lower != upper) &&
+				range.first == lower && range.second == upper;
+			
+			const int_in_a_struct * res = nullptr;
+			found = sort_vect.lookup(dummy, &res, ctx_lower, near);
+			all_same = all_same && found == (lower != upper) &&
+				(!found || res == sort_vect.data() + lower);
+		}
+	}
+	check(all_same);
+	
+	return true;
+}
+
 static int passed, failed;
 void run_test_sort_vector(void)
 {
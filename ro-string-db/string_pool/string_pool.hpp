@@ -3,21 +3,38 @@
 
 #include <vector>
 #include <string>
+#include <cstring>
 
 class string_pool
 {
+	/*
+	   All strings one after the other, each ended by a '\0'. An index is
+	   where a string begins. With lengths, each string is also preceded by
+	   its length as a varint which is read backwards from the index, so
+	   get_len() costs a byte or two next to the string instead of a
+	   strlen(), and strings may hold '\0'. Such a string is still followed
+	   by a '\0', so get() works for it as a C string, if it holds none.
+	*/
     public:
     typedef unsigned int uint;
     typedef unsigned char byte;
 
-    inline string_pool(size_t size = 0)
+    inline string_pool(size_t size = 0, bool has_lengths = false) :
+		_has_lengths(has_lengths)
     {_pool.reserve(size);}
 
 	inline uint append(const std::string& str)
-    {return append(str.c_str());}
+    {
+		return (_has_lengths) ?
+			append(str.data(), str.size()) :
+			append(str.c_str());
+	}
 
 	inline uint append(const char * str)
 	{
+		if (_has_lengths)
+			return append(str, strlen(str));
+		
 		uint start = _pool.size();
 		for (char ch = *str; ch; ch = *(++str))
 			_pool.push_back(ch);
@@ -25,9 +42,42 @@ class string_pool
 		return start;
 	}
 	
+	inline uint append(const char * str, size_t len)
+	{
+		if (_has_lengths)
+			_push_len(len);
+		
+		uint start = _pool.size();
+		_pool.insert(_pool.end(), str, str + len);
+		_pool.push_back('\0');
+		return start;
+	}
+	/* Copies len bytes of str, which may hold '\0' if the pool has lengths. */
+
     inline const char * get(uint index) const
 	{return reinterpret_cast<const char *>(_pool.data() + index);}
 
+	inline size_t get_len(uint index) const
+	{
+		if (!_has_lengths)
+			return strlen(get(index));
+		
+		// the byte before the string has the low bits; a set high bit means
+		// the byte before it has more
+		const byte * pb = _pool.data() + index - 1;
+		size_t len = *pb & 0x7F;
+		for (uint shift = 7; *pb & 0x80; shift += 7)
+		{
+			--pb;
+			len |= (size_t)(*pb & 0x7F) << shift;
+		}
+		return len;
+	}
+	/* The length of the string at index, with strlen() without lengths. */
+	
+	inline bool has_lengths() const
+	{return _has_lengths;}
+
     inline void reserve_chars(size_t how_many)
 	{_pool.reserve(how_many);}
 
@@ -38,6 +88,23 @@ class string_pool
 	{return _pool.size();}
 
     private:
+    inline void _push_len(size_t len)
+    {
+		byte groups[10];
+		uint num = 0;
+		do
+		{
+			groups[num++] = len & 0x7F;
+			len >>= 7;
+		} while (len);
+		
+		// most significant first, so the least is next to the string
+		_pool.push_back(groups[--num]);
+		while (num)
+			_pool.push_back(groups[--num] | 0x80);
+	}
+
     std::vector<byte> _pool;
+    bool _has_lengths;
 };
 #endif
@@ -3,11 +3,14 @@
 
 #include <string>
 #include <vector>
+#include <cstring>
 
 static bool test_string_pool(void);
+static bool test_string_pool_lengths(void);
 
 static ftest tests[] = {
 	test_string_pool,
+	test_string_pool_lengths,
 };
 
 static bool test_string_pool(void)
@@ -38,6 +41,51 @@ static bool test_string_pool(void)
 	check(*spool.get(11) == 'z');
 	check(*spool.get(12) == '\0');
 	
+	check(spool.get_len(0) == 3);
+	check(spool.get_len(4) == 4);
+	check(!spool.has_lengths());
+	
+	return true;
+}
+
+static bool test_string_pool_lengths(void)
+{
+	string_pool spool(0, true);
+	check(spool.has_lengths());
+	
+	// one byte of length before each string
+	check(spool.append("foo") == 1);
+	check(spool.size() == 5);
+	check(spool.get_len(1) == 3);
+	check(strcmp(spool.get(1), "foo") == 0);
+	
+	std::string nul("a\0b", 3);
+	check(spool.append(nul) == 6);
+	check(spool.get_len(6) == 3);
+	check(memcmp(spool.get(6), "a\0b", 4) == 0);
+	
+	check(spool.append("", 0) == 11);
+	check(spool.get_len(11) == 0);
+	check(*spool.get(11) == '\0');
+	
+	// lengths of two and three bytes
+	std::vector<size_t> lens = {127, 128, 300, 16383, 16384, 70000};
+	std::vector<string_pool::uint> at;
+	for (size_t len : lens)
+		at.push_back(spool.append(std::string(len, 'x')));
+	
+	for (size_t i = 0; i < lens.size(); ++i)
+	{
+		check(spool.get_len(at[i]) == lens[i]);
+		check(spool.get(at[i])[0] == 'x');
+		check(spool.get(at[i])[lens[i]] == '\0');
+	}
+	check(at[1] - at[0] == 127 + 1 + 2);
+	check(at[5] - at[4] == 16384 + 1 + 3);
+	
+	check(spool.get_len(1) == 3);
+	check(spool.get_len(6) == 3);
+	
 	return true;
 }
 
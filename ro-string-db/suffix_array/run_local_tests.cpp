@@ -0,0 +1,7 @@
+#include "test_suffix_array.hpp"
+
+int main()
+{
+	run_test_suffix_array();
+	return test_suffix_array_failed();
+}
@@ -0,0 +1,243 @@
+#include "suffix_array.hpp"
+
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
+#include <thread>
+
+#define throw_str(str) "suffix_array: " str
+
+static const size_t max_lcp = 255;
+
+void suffix_array::add(uint id, size_t len)
+{
+	if (_is_built)
+		throw std::runtime_error(throw_str("add() after build()"));
+	
+	if (_sa.size() + len >= 0xFFFFFFFF)
+		throw std::runtime_error(throw_str("more than 4GB of strings"));
+	
+	_ids.push_back(id);
+	for (size_t pos = 0; pos < len; ++pos)
+		_sa.push_back(suffix{id, (uint)pos});
+}
+
+void suffix_array::build(get_str get, const void * ctx, uint threads)
+{
+	if (!threads)
+		threads = std::max(std::thread::hardware_concurrency(), 1u);
+	
+	size_t size = _sa.size();
+	if (threads > size)
+		threads = std::max(size, (size_t)1);
+	
+	// the suffixes are sorted by where they were added, so _sa stays in
+	// that order for _make_lcp()
+	std::vector<uint> order(size);
+	for (size_t i = 0; i < size; ++i)
+		order[i] = i;
+	
+	const suffix * added = _sa.data();
+	auto less = [added, get, ctx](uint a, uint b)
+	{
+		// each string ends in '\0', so strcmp() stops at its end
+		const suffix& x = added[a];
+		const suffix& y = added[b];
+		int cmp = strcmp(get(ctx, x.id) + x.pos, get(ctx, y.id) + y.pos);
+		return (cmp < 0 || (0 == cmp && a < b));
+	};
+	
+	std::vector<size_t> bounds;
+	for (uint i = 0; i <= threads; ++i)
+		bounds.push_back((size * i) / threads);
+	
+	{ // sort the parts
+		std::vector<std::thread> workers;
+		for (uint i = 1; i < threads; ++i)
+		{
+			workers.push_back(std::thread([&order, &bounds, less, i]()
+				{
+					std::sort(order.begin() + bounds[i],
+						order.begin() + bounds[i+1],
+						less
+					);
+				}
+			));
+		}
+		std::sort(order.begin() + bounds[0], order.begin() + bounds[1],
+			less
+		);
+		for (auto& thr : workers)
+			thr.join();
+	}
+	
+	// merge neighbouring parts in pairs until one is left
+	for (size_t width = 1; width < threads; width *= 2)
+	{
+		std::vector<std::thread> workers;
+		for (size_t i = 0; i + width < threads; i += 2 * width)
+		{
+			size_t lo = bounds[i];
+			size_t mid = bounds[i + width];
+			size_t hi = bounds[std::min(i + 2 * width, (size_t)threads)];
+			workers.push_back(std::thread([&order, less, lo, mid, hi]()
+				{
+					std::inplace_merge(order.begin() + lo,
+						order.begin() + mid,
+						order.begin() + hi,
+						less
+					);
+				}
+			));
+		}
+		for (auto& thr : workers)
+			thr.join();
+	}
+	
+	std::vector<suffix> sorted(size);
+	for (size_t i = 0; i < size; ++i)
+		sorted[i] = _sa[order[i]];
+	
+	_make_lcp(sorted, order, get, ctx);
+	_sa.swap(sorted);
+	
+	std::sort(_ids.begin(), _ids.end());
+	_ids.erase(std::unique(_ids.begin(), _ids.end()), _ids.end());
+	
+	_sa.shrink_to_fit();
+	_ids.shrink_to_fit();
+	_is_built = true;
+}
+
+void suffix_array::_make_lcp(const std::vector<suffix>& sorted,
+	const std::vector<uint>& order,
+	get_str get,
+	const void * ctx
+)
+{
+	// Kasai et al.: going through the suffixes of a string from the longest,
+	// the common prefix with the suffix before in sorted order shrinks by at
+	// most one each step, so it's never compared from the start again
+	size_t size = _sa.size();
+	std::vector<uint> rank(size);
+	for (size_t i = 0; i < size; ++i)
+		rank[order[i]] = i;
+	
+	_lcp.assign(size, 0);
+	const char * str = nullptr;
+	size_t h = 0;
+	for (size_t i = 0; i < size; ++i)
+	{
+		const suffix& suf = _sa[i];
+		if (!suf.pos)
+		{
+			str = get(ctx, suf.id);
+			h = 0;
+		}
+		
+		uint r = rank[i];
+		if (!r)
+		{
+			h = 0;
+			continue;
+		}
+		
+		const suffix& prev = sorted[r-1];
+		const char * a = str + suf.pos;
+		const char * b = get(ctx, prev.id) + prev.pos;
+		while (a[h] && a[h] == b[h])
+			++h;
+		
+		_lcp[r] = std::min(h, max_lcp);
+		if (h)
+			--h;
+	}
+}
+
+size_t suffix_array::_lower_bound(const char * pattern,
+	size_t len,
+	get_str get,
+	const void * ctx
+) const
+{
+	size_t lo = 0, hi = _sa.size();
+	while (lo < hi)
+	{
+		size_t mid = lo + (hi - lo)/2;
+		const suffix& suf = _sa[mid];
+		if (strncmp(get(ctx, suf.id) + suf.pos, pattern, len) < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+size_t suffix_array::_upper_bound(const char * pattern,
+	size_t len,
+	get_str get,
+	const void * ctx
+) const
+{
+	size_t lo = 0, hi = _sa.size();
+	while (lo < hi)
+	{
+		size_t mid = lo + (hi - lo)/2;
+		const suffix& suf = _sa[mid];
+		if (strncmp(get(ctx, suf.id) + suf.pos, pattern, len) <= 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+size_t suffix_array::find(const char * pattern,
+	get_str get,
+	const void * ctx,
+	std::vector<uint>& out_ids
+) const
+{
+	if (!_is_built)
+		throw std::runtime_error(throw_str("find() before build()"));
+	
+	out_ids.clear();
+	size_t len = strlen(pattern);
+	if (!len)
+	{
+		out_ids = _ids;
+		return out_ids.size();
+	}
+	
+	size_t size = _sa.size();
+	size_t begin = _lower_bound(pattern, len, get, ctx);
+	size_t end = begin;
+	if (len <= max_lcp)
+	{
+		if (end < size &&
+			0 == strncmp(get(ctx, _sa[end].id) + _sa[end].pos, pattern, len)
+		)
+		{
+			++end;
+			while (end < size && _lcp[end] >= len)
+				++end;
+		}
+	}
+	else
+		end = _upper_bound(pattern, len, get, ctx);
+	
+	for (size_t i = begin; i < end; ++i)
+		out_ids.push_back(_sa[i].id);
+	std::sort(out_ids.begin(), out_ids.end());
+	out_ids.erase(std::unique(out_ids.begin(), out_ids.end()),
+		out_ids.end()
+	);
+	
+	return out_ids.size();
+}
+
+size_t suffix_array::memory() const
+{
+	return _sa.capacity() * sizeof(suffix) + _lcp.capacity() +
+		_ids.capacity() * sizeof(uint);
+}
@@ -0,0 +1,107 @@
+#ifndef SUFFIX_ARRAY_HPP
+#define SUFFIX_ARRAY_HPP
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+class suffix_array
+{
+	/*
+	   A substring index over a number of strings, each known by an id. The
+	   strings aren't kept, only where each of their suffixes begins: every
+	   byte of a string is the beginning of a suffix, which is its id and
+	   the offset of the byte. The strings are fetched through a get_str
+	   function when needed. The suffixes are sorted in _sa, and since all
+	   occurrences of a pattern begin a suffix which starts with it, they are
+	   next to each other in _sa and are found by binary search in
+	   m log(n) time for a pattern of length m. _lcp holds the length of
+	   the common prefix of each suffix and the one before it, capped at
+	   255, so the end of the occurrences is found by walking forward while
+	   the common prefix is at least m, which costs one step per occurrence
+	   rather than another binary search.
+	*/
+	public:
+	typedef unsigned int uint;
+	typedef unsigned char byte;
+	
+	typedef const char * (*get_str)(const void * ctx, uint id);
+	/* Returns the string with id, ended by a '\0'; ctx is passed along. */
+	
+	suffix_array() : _is_built(false) {}
+	
+	void add(uint id, size_t len);
+	/*
+	   Adds the string with id, which is len bytes long and holds no '\0'.
+	   Throws after build().
+	*/
+	
+	void build(get_str get, const void * ctx, uint threads = 1);
+	/*
+	   Sorts the suffixes and computes the common prefixes. With more than
+	   one thread, 0 meaning all hardware threads, the suffixes are split in
+	   as many parts, each part is sorted by its own thread, and the parts
+	   are then merged in pairs, also in parallel. get is called from all
+	   threads at once and two strings it returns are compared, so they must
+	   stay where they are, e.g. in a pool.
+	*/
+	
+	size_t find(const char * pattern,
+		get_str get,
+		const void * ctx,
+		std::vector<uint>& out_ids
+	) const;
+	/*
+	   Places the ids of all strings which contain pattern in out_ids,
+	   replacing its contents, in ascending order and each id once. An
+	   empty pattern is contained in every string. get is called once for
+	   each step of the search and only the string it returned last is
+	   read, so it may reuse a buffer. Returns the number of ids placed.
+	   Throws before build().
+	   
+	   The k occurrences are found in m log(n) + k steps, but they come in
+	   suffix order and a string may contain pattern more than once, so
+	   their ids are then sorted and repeats dropped, which costs k log(k).
+	*/
+	
+	inline size_t size() const
+	{return _sa.size();}
+	/* The number of suffixes. */
+	
+	size_t memory() const;
+	/* Bytes used by the suffixes and their bookkeeping. */
+	
+	private:
+	struct suffix
+	{
+		uint id;
+		uint pos;
+	};
+	
+	size_t _lower_bound(const char * pattern,
+		size_t len,
+		get_str get,
+		const void * ctx
+	) const;
+	size_t _upper_bound(const char * pattern,
+		size_t len,
+		get_str get,
+		const void * ctx
+	) const;
+	void _make_lcp(const std::vector<suffix>& sorted,
+		const std::vector<uint>& order,
+		get_str get,
+		const void * ctx
+	);
+	
+	std::vector<suffix> _sa;
+	std::vector<byte> _lcp;
+	std::vector<uint> _ids;
+	bool _is_built;
+};
+/*
+   Before build(), _sa has the suffixes in the order they were added, each
+   string's one after the other. _ids are the ids of all strings, for the
+   empty pattern.
+*/
+#endif
@@ -0,0 +1,175 @@
+#include "../test/test.h"
+#include "suffix_array.hpp"
+
+#include <vector>
+#include <string>
+#include <random>
+#include <stdexcept>
+
+static bool test_suffix_array();
+static bool test_suffix_array_parallel();
+
+static ftest tests[] = {
+	test_suffix_array,
+	test_suffix_array_parallel,
+};
+
+static bool didnt_throw = false;
+
+typedef suffix_array::uint uint;
+
+// the strings of the tests, by id
+static const char * str_of(const void * ctx, uint id)
+{
+	const std::vector<std::string>& strs =
+		*(const std::vector<std::string> *)ctx;
+	return strs[id].c_str();
+}
+
+static std::vector<uint> scan(const std::vector<std::string>& strs,
+	const std::string& pattern
+)
+{
+	std::vector<uint> ids;
+	for (uint i = 0; i < strs.size(); ++i)
+	{
+		if (strs[i].find(pattern) != std::string::npos)
+			ids.push_back(i);
+	}
+	return ids;
+}
+
+static bool test_suffix_array()
+{
+	suffix_array sa;
+	std::vector<uint> out;
+	std::vector<std::string> strs{"", "banana", "", "bandana", "", "cabana"};
+	const void * ctx = &strs;
+	
+	try {sa.find("a", str_of, ctx, out); check(didnt_throw);}
+	catch (std::runtime_error& e)
+	{
+		std::string expected("suffix_array: find() before build()");
+		check(expected == e.what());
+	}
+	
+	for (uint id : {1, 2, 3, 5})
+		sa.add(id, strs[id].size());
+	sa.build(str_of, ctx);
+	
+	check(sa.size() == 19);
+	check(sa.memory() >= 19 * 2 * sizeof(uint));
+	
+	check(sa.find("ana", str_of, ctx, out) == 3);
+	check(out == std::vector<uint>({1, 3, 5}));
+	
+	check(sa.find("band", str_of, ctx, out) == 1);
+	check(out[0] == 3);
+	
+	check(sa.find("banana", str_of, ctx, out) == 1);
+	check(out[0] == 1);
+	
+	check(sa.find("bananas", str_of, ctx, out) == 0);
+	check(out.empty());
+	
+	check(sa.find("zzz", str_of, ctx, out) == 0);
+	check(sa.find("a", str_of, ctx, out) == 3);
+	
+	// no match across the end of a string
+	check(sa.find("aband", str_of, ctx, out) == 0);
+	
+	check(sa.find("", str_of, ctx, out) == 4);
+	check(out == std::vector<uint>({1, 2, 3, 5}));
+	
+	try {sa.add(4, 1); check(didnt_throw);}
+	catch (std::runtime_error& e)
+	{
+		std::string expected("suffix_array: add() after build()");
+		check(expected == e.what());
+	}
+	
+	{ // empty
+		suffix_array empty;
+		empty.build(str_of, ctx, 4);
+		check(empty.size() == 0);
+		check(empty.find("a", str_of, ctx, out) == 0);
+	}
+	
+	return true;
+}
+
+static bool test_suffix_array_parallel()
+{
+	std::mt19937 rng(3);
+	std::uniform_int_distribution<int> len(0, 40);
+	std::uniform_int_distribution<int> ch('a', 'c');
+	
+	std::vector<std::string> strs;
+	for (int i = 0; i < 400; ++i)
+	{
+		std::string str(len(rng), ' ');
+		for (auto& c : str)
+			c = ch(rng);
+		strs.push_back(str);
+	}
+	
+	// long repeats go past what the common prefixes keep
+	strs.push_back(std::string(600, 'a'));
+	strs.push_back(std::string(300, 'a') + "b");
+	
+	for (uint threads : {1, 2, 3, 8})
+	{
+		suffix_array sa;
+		for (uint i = 0; i < strs.size(); ++i)
+			sa.add(i, strs[i].size());
+		sa.build(str_of, &strs, threads);
+		
+		std::vector<uint> out;
+		for (int q = 0; q < 200; ++q)
+		{
+			std::string pattern(1 + q % 6, ' ');
+			for (auto& c : pattern)
+				c = ch(rng);
+			
+			sa.find(pattern.c_str(), str_of, &strs, out);
+			check(out == scan(strs, pattern));
+		}
+		
+		for (size_t n : {200, 255, 256, 301, 600, 601})
+		{
+			std::string pattern(n, 'a');
+			sa.find(pattern.c_str(), str_of, &strs, out);
+			check(out == scan(strs, pattern));
+			
+			pattern.back() = 'b';
+			sa.find(pattern.c_str(), str_of, &strs, out);
+			check(out == scan(strs, pattern));
+		}
+	}
+	
+	return true;
+}
+
+static int passed, failed;
+void run_test_suffix_array(void)
+{
+    int i, end = sizeof(tests)/sizeof(*tests);
+
+    passed = 0;
+    for (i = 0; i < end; ++i)
+        if (tests[i]())
+            ++passed;
+
+    if (passed != end)
+        putchar('\n');
+
+    failed = end - passed;
+    report(passed, failed);
+    return;
+}
+
+int test_suffix_array_passed(void)
+{return passed;}
+
+int test_suffix_array_failed(void)
+{return failed;}
@@ -0,0 +1,6 @@
+#ifndef TEST_SUFFIX_ARRAY_HPP
+#define TEST_SUFFIX_ARRAY_HPP
+void run_test_suffix_array(void);
+int test_suffix_array_passed(void);
+int test_suffix_array_failed(void);
+#endif
@@ -4,6 +4,17 @@
 #include "test_ro_string_db.hpp"
 #include "test_input.hpp"
 #include "test_sort_vector.hpp"
+#include "test_batch_query.hpp"
+#include "test_collation.hpp"
+#include "test_postings.hpp"
+#include "test_fuzzy.hpp"
+#include "test_suffix_array.hpp"
+#include "test_token_index.hpp"
+#include "test_bloom_filter.hpp"
+#include "test_lookup_cache.hpp"
+#include "test_learned_index.hpp"
+#include "test_compressed_pool.hpp"
+#include "test_front_coded.hpp"
 
 #include <cstdio>
 
@@ -20,6 +31,18 @@ static test_funs all_tests[] = {
 	{run_test_ro_string_db, test_ro_string_db_passed, test_ro_string_db_failed},
 	{run_test_input, test_input_passed, test_input_failed},
 	{run_test_sort_vector, test_sort_vector_passed, test_sort_vector_failed},
+	{run_test_batch_query, test_batch_query_passed, test_batch_query_failed},
+	{run_test_collation, test_collation_passed, test_collation_failed},
+	{run_test_postings, test_postings_passed, test_postings_failed},
+	{run_test_fuzzy, test_fuzzy_passed, test_fuzzy_failed},
+	{run_test_suffix_array, test_suffix_array_passed, test_suffix_array_failed},
+	{run_test_token_index, test_token_index_passed, test_token_index_failed},
+	{run_test_bloom_filter, test_bloom_filter_passed, test_bloom_filter_failed},
+	{run_test_lookup_cache, test_lookup_cache_passed, test_lookup_cache_failed},
+	{run_test_learned_index, test_learned_index_passed, test_learned_index_failed},
+	{run_test_compressed_pool, test_compressed_pool_passed,
+		test_compressed_pool_failed},
+	{run_test_front_coded, test_front_coded_passed, test_front_coded_failed},
 };
 
 int main()
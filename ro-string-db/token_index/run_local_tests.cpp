@@ -0,0 +1,7 @@
+#include "test_token_index.hpp"
+
+int main()
+{
+	run_test_token_index();
+	return test_token_index_failed();
+}
@@ -0,0 +1,172 @@
+#include "../test/test.h"
+#include "token_index.hpp"
+
+#include <set>
+#include <vector>
+#include <string>
+#include <random>
+#include <stdexcept>
+#include <algorithm>
+
+static bool test_token_index();
+static bool test_token_index_random();
+
+static ftest tests[] = {
+	test_token_index,
+	test_token_index_random,
+};
+
+static bool didnt_throw = false;
+
+typedef token_index::uint uint;
+
+static bool test_token_index()
+{
+	token_index idx(" ,", true);
+	std::vector<uint> out;
+	uint list = 0;
+	
+	try {idx.find("a", list); check(didnt_throw);}
+	catch (std::runtime_error& e)
+	{
+		std::string expected("token_index: find() before build()");
+		check(expected == e.what());
+	}
+	
+	idx.add("red,Sale  new", 1);
+	idx.add("", 2);
+	idx.add("new NEW New", 3);
+	idx.add(" ,sale, ", 4);
+	idx.add("Red", 7);
+	idx.build();
+	
+	check(idx.num_tokens() == 3);
+	check(idx.memory() > 0);
+	
+	check(idx.find("new", list));
+	check(idx.get_postings().count(list) == 2);
+	check(idx.find("SALE", list));
+	check(idx.get_postings().count(list) == 2);
+	check(!idx.find("blue", list));
+	check(!idx.find("red sale", list));
+	check(!idx.find("", list));
+	
+	idx.find_all({"red"}, out);
+	check(out == std::vector<uint>({1, 7}));
+	
+	idx.find_all({"Red", "sale"}, out);
+	check(out == std::vector<uint>({1}));
+	
+	idx.find_all({"red", "sale", "new"}, out);
+	check(out == std::vector<uint>({1}));
+	
+	idx.find_all({"red", "blue"}, out);
+	check(out.empty());
+	
+	idx.find_all({}, out);
+	check(out.empty());
+	
+	idx.find_any({"red", "sale", "blue"}, out);
+	check(out == std::vector<uint>({1, 4, 7}));
+	
+	idx.find_any({}, out);
+	check(out.empty());
+	
+	try {idx.add("x", 8); check(didnt_throw);}
+	catch (std::runtime_error& e)
+	{
+		std::string expected("token_index: add() after build()");
+		check(expected == e.what());
+	}
+	
+	{ // case kept
+		token_index keep(" ", false);
+		keep.add("Red red", 1);
+		keep.add("RED", 2);
+		keep.build();
+		check(keep.num_tokens() == 3);
+		keep.find_any({"red"}, out);
+		check(out == std::vector<uint>({1}));
+	}
+	
+	return true;
+}
+
+static bool test_token_index_random()
+{
+	std::mt19937 rng(5);
+	std::uniform_int_distribution<int> num(0, 6);
+	std::uniform_int_distribution<int> word(0, 30);
+	
+	token_index idx;
+	std::vector<std::set<std::string>> lines;
+	for (uint line = 0; line < 2000; ++line)
+	{
+		std::string str;
+		std::set<std::string> words;
+		for (int i = 0, end = num(rng); i < end; ++i)
+		{
+			std::string w = "w" + std::to_string(word(rng) * word(rng));
+			words.insert(w);
+			str += w + ((i % 2) ? " " : "\t");
+		}
+		lines.push_back(words);
+		idx.add(str.c_str(), line);
+	}
+	idx.build();
+	
+	std::vector<uint> out;
+	for (int q = 0; q < 300; ++q)
+	{
+		std::vector<std::string> words;
+		for (int i = 0, end = 1 + q % 3; i < end; ++i)
+			words.push_back("w" + std::to_string(word(rng) * (q % 5)));
+		
+		std::vector<const char *> tokens;
+		for (auto& w : words)
+			tokens.push_back(w.c_str());
+		
+		std::vector<uint> all, any;
+		for (uint line = 0; line < lines.size(); ++line)
+		{
+			size_t has = 0;
+			for (auto& w : words)
+				has += lines[line].count(w);
+			if (has == words.size())
+				all.push_back(line);
+			if (has)
+				any.push_back(line);
+		}
+		
+		idx.find_all(tokens, out);
+		check(out == all);
+		idx.find_any(tokens, out);
+		check(out == any);
+	}
+	
+	return true;
+}
+
+static int passed, failed;
+void run_test_token_index(void)
+{
+    int i, end = sizeof(tests)/sizeof(*tests);
+
+    passed = 0;
+    for (i = 0; i < end; ++i)
+        if (tests[i]())
+            ++passed;
+
+    if (passed != end)
+        putchar('\n');
+
+    failed = end - passed;
+    report(passed, failed);
+    return;
+}
+
+int test_token_index_passed(void)
+{return passed;}
+
+int test_token_index_failed(void)
+{return failed;}
@@ -0,0 +1,6 @@
+#ifndef TEST_TOKEN_INDEX_HPP
+#define TEST_TOKEN_INDEX_HPP
+void run_test_token_index(void);
+int test_token_index_passed(void);
+int test_token_index_failed(void);
+#endif
@@ -0,0 +1,194 @@
+#include "token_index.hpp"
+
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
+
+#define throw_str(str) "token_index: " str
+
+static inline char fold_ascii(char ch)
+{
+	return ('A' <= ch && ch <= 'Z') ? ch + ('a' - 'A') : ch;
+}
+
+token_index::token_index(const char * delimiters, bool lowercase) :
+	_lowercase(lowercase),
+	_is_built(false)
+{
+	memset(_is_delim, 0, sizeof(_is_delim));
+	for (; *delimiters; ++delimiters)
+		_is_delim[(unsigned char)*delimiters] = true;
+}
+
+void token_index::add(const char * str, uint line)
+{
+	if (_is_built)
+		throw std::runtime_error(throw_str("add() after build()"));
+	
+	std::string token;
+	const unsigned char * ch = (const unsigned char *)str;
+	while (*ch)
+	{
+		while (*ch && _is_delim[*ch])
+			++ch;
+		
+		token.clear();
+		for (; *ch && !_is_delim[*ch]; ++ch)
+			token += (_lowercase) ? fold_ascii(*ch) : *ch;
+		
+		if (!token.empty())
+		{
+			auto ins = _ids.insert(std::make_pair(token, (uint)_ids.size()));
+			_hits.push_back(std::make_pair(ins.first->second, line));
+		}
+	}
+}
+
+void token_index::build()
+{
+	// sorts the tokens, then renumbers the hits in that order
+	std::vector<const std::pair<const std::string, uint> *> sorted;
+	sorted.reserve(_ids.size());
+	for (auto& id : _ids)
+		sorted.push_back(&id);
+	
+	std::sort(sorted.begin(), sorted.end(),
+		[](const std::pair<const std::string, uint> * a,
+			const std::pair<const std::string, uint> * b)
+		{return a->first < b->first;}
+	);
+	
+	std::vector<uint> rank(sorted.size());
+	for (uint i = 0; i < sorted.size(); ++i)
+	{
+		rank[sorted[i]->second] = i;
+		_token_at.push_back(_chars.size());
+		_chars.insert(_chars.end(),
+			sorted[i]->first.begin(),
+			sorted[i]->first.end()
+		);
+		_chars.push_back('\0');
+	}
+	
+	for (auto& hit : _hits)
+		hit.first = rank[hit.first];
+	std::sort(_hits.begin(), _hits.end());
+	_hits.erase(std::unique(_hits.begin(), _hits.end()), _hits.end());
+	
+	std::vector<uint> lines;
+	for (size_t i = 0, end = _hits.size(); i < end; )
+	{
+		uint token = _hits[i].first;
+		lines.clear();
+		for (; i < end && _hits[i].first == token; ++i)
+			lines.push_back(_hits[i].second);
+		_postings.append_list(lines.data(), lines.size());
+	}
+	
+	std::unordered_map<std::string, uint>().swap(_ids);
+	std::vector<std::pair<uint, uint>>().swap(_hits);
+	_chars.shrink_to_fit();
+	_token_at.shrink_to_fit();
+	_postings.shrink_to_fit();
+	_is_built = true;
+}
+
+void token_index::_normalize(const char * token, std::string& out) const
+{
+	out = token;
+	if (_lowercase)
+	{
+		for (auto& ch : out)
+			ch = fold_ascii(ch);
+	}
+}
+
+bool token_index::find(const char * token, uint& out_list) const
+{
+	if (!_is_built)
+		throw std::runtime_error(throw_str("find() before build()"));
+	
+	std::string norm;
+	_normalize(token, norm);
+	
+	const char * chars = _chars.data();
+	auto it = std::lower_bound(_token_at.begin(), _token_at.end(), norm,
+		[chars](uint at, const std::string& val)
+		{return strcmp(chars + at, val.c_str()) < 0;}
+	);
+	
+	if (it == _token_at.end() || strcmp(chars + *it, norm.c_str()) != 0)
+		return false;
+	
+	out_list = it - _token_at.begin();
+	return true;
+}
+
+void token_index::find_all(const std::vector<const char *>& tokens,
+	std::vector<uint>& out_lines
+) const
+{
+	out_lines.clear();
+	
+	std::vector<uint> lists;
+	for (auto token : tokens)
+	{
+		uint list = 0;
+		if (!find(token, list))
+			return;
+		lists.push_back(list);
+	}
+	
+	if (lists.empty())
+		return;
+	
+	std::sort(lists.begin(), lists.end(),
+		[this](uint a, uint b)
+		{return _postings.count(a) < _postings.count(b);}
+	);
+	
+	_postings.decode(lists[0], lists[0] + 1, out_lines);
+	for (size_t i = 1; i < lists.size() && !out_lines.empty(); ++i)
+	{
+		postings::reader rd(_postings, lists[i], lists[i] + 1);
+		uint line = 0;
+		bool has_line = rd.next(line);
+		
+		size_t kept = 0;
+		for (uint cand : out_lines)
+		{
+			while (has_line && line < cand)
+				has_line = rd.next(line);
+			if (!has_line)
+				break;
+			if (line == cand)
+				out_lines[kept++] = cand;
+		}
+		out_lines.resize(kept);
+	}
+}
+
+void token_index::find_any(const std::vector<const char *>& tokens,
+	std::vector<uint>& out_lines
+) const
+{
+	out_lines.clear();
+	
+	for (auto token : tokens)
+	{
+		uint list = 0;
+		if (find(token, list))
+			_postings.decode(list, list + 1, out_lines);
+	}
+	
+	std::sort(out_lines.begin(), out_lines.end());
+	out_lines.erase(std::unique(out_lines.begin(), out_lines.end()),
+		out_lines.end()
+	);
+}
+
+size_t token_index::memory() const
+{
+	return _chars.capacity() + _token_at.capacity() * sizeof(uint) +
+		_postings.memory();
+}
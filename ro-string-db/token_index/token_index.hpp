@@ -0,0 +1,83 @@
+#ifndef TOKEN_INDEX_HPP
+#define TOKEN_INDEX_HPP
+
+#include "postings.hpp"
+
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <unordered_map>
+
+class token_index
+{
+	/*
+	   An inverted index of the tokens in a number of strings, each tagged
+	   with a line number. A string is split in tokens on any of a set of
+	   delimiter bytes, and the tokens are optionally lowercased, ASCII only.
+	   Upon build() the distinct tokens are sorted in a dictionary, and each
+	   gets the ascending list of lines it appears on in a postings, delta and
+	   varint compressed.
+	*/
+	public:
+	typedef unsigned int uint;
+	
+	token_index(const char * delimiters = " \t", bool lowercase = true);
+	
+	void add(const char * str, uint line);
+	/* Adds the tokens of str, found on line. Throws after build(). */
+	
+	void build();
+	
+	bool find(const char * token, uint& out_list) const;
+	/*
+	   Places the number of the postings list of token in out_list. Returns
+	   false if no string has token. token is lowercased like the strings,
+	   if so configured, but not split. Throws before build().
+	*/
+	
+	void find_all(const std::vector<const char *>& tokens,
+		std::vector<uint>& out_lines
+	) const;
+	/*
+	   Places in out_lines, replacing its contents, the lines on which all
+	   tokens appear. The lists are intersected from the shortest one up, so
+	   the candidates never outnumber the rarest token, and the rest of the
+	   lists are streamed past them without being decoded anywhere. No
+	   tokens match no lines.
+	*/
+	
+	void find_any(const std::vector<const char *>& tokens,
+		std::vector<uint>& out_lines
+	) const;
+	/* Like find_all(), but for the lines on which any of tokens appears. */
+	
+	inline const postings& get_postings() const
+	{return _postings;}
+	
+	inline size_t num_tokens() const
+	{return _token_at.size();}
+	
+	size_t memory() const;
+	/* Bytes used by the dictionary and the postings. */
+	
+	private:
+	void _normalize(const char * token, std::string& out) const;
+	
+	bool _is_delim[256];
+	bool _lowercase;
+	bool _is_built;
+	
+	std::vector<char> _chars;
+	std::vector<uint> _token_at;
+	postings _postings;
+	
+	std::unordered_map<std::string, uint> _ids;
+	std::vector<std::pair<uint, uint>> _hits;
+};
+/*
+   The dictionary is _chars, the '\0' ended tokens one after the other, and
+   _token_at, the offset of each token in _chars, in sorted order of the
+   tokens. Token i has postings list i. Until build() _ids numbers the tokens
+   in the order they are first seen, and _hits holds each token id and line.
+*/
+#endif